@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "ArithmeticCoder.hpp"
+
+
+namespace {
+    constexpr uint TOP = 1u << 24;  // Range is renormalized when it drops below this value.
+
+    /// <summary>
+    /// Table of binary logarithms of all possible frequencies.
+    /// </summary>
+    /// <returns>Reference to the table</returns>
+    const std::vector<float>& log2Table() {
+        static const std::vector<float> table = []() {
+            std::vector<float> values((1 << 16) + 1024);
+            values[0] = 0.0f;
+            for (uint i = 1; i < values.size(); i++) {
+                values[i] = static_cast<float>(std::log2(static_cast<double>(i)));
+            }
+            return values;
+        }();
+        return table;
+    }
+
+
+    /// <summary>
+    /// Range encoder with carry propagation (LZMA style).
+    /// </summary>
+    class RangeEncoder {
+    private:
+        u64 m_Low = 0;
+        uint m_Range = 0xFFFFFFFF;
+        unsigned char m_Cache = 0;
+        u64 m_CacheSize = 1;
+        std::vector<unsigned char>& m_Output;
+
+        void shiftLow() {
+            if (static_cast<uint>(m_Low) < 0xFF000000u || (m_Low >> 32) != 0) {
+                const unsigned char carry = static_cast<unsigned char>(m_Low >> 32);
+                unsigned char temp = m_Cache;
+                do {
+                    m_Output.push_back(static_cast<unsigned char>(temp + carry));
+                    temp = 0xFF;
+                } while (--m_CacheSize != 0);
+                m_Cache = static_cast<unsigned char>(m_Low >> 24);
+            }
+            m_CacheSize++;
+            m_Low = (m_Low & 0x00FFFFFF) << 8;
+        }
+
+    public:
+        RangeEncoder(std::vector<unsigned char>& output) : m_Output(output) {}
+
+        void encode(const uint cumulative, const uint frequency, const uint total) {
+            const uint r = m_Range / total;
+            m_Low += static_cast<u64>(r) * cumulative;
+            m_Range = r * frequency;
+            while (m_Range < TOP) {
+                m_Range <<= 8;
+                shiftLow();
+            }
+        }
+
+        void flush() {
+            for (uint i = 0; i < 5; i++) {
+                shiftLow();
+            }
+        }
+    };
+
+
+    /// <summary>
+    /// Range decoder matching RangeEncoder.
+    /// </summary>
+    class RangeDecoder {
+    private:
+        uint m_Code = 0;
+        uint m_Range = 0xFFFFFFFF;
+        const std::vector<unsigned char>& m_Input;
+        size_t m_Position = 0;
+
+        unsigned char next() {
+            return m_Position < m_Input.size() ? m_Input[m_Position++] : 0;
+        }
+
+    public:
+        RangeDecoder(const std::vector<unsigned char>& input) : m_Input(input) {
+            for (uint i = 0; i < 5; i++) {
+                m_Code = (m_Code << 8) | next();
+            }
+        }
+
+        uint decode(const uint* frequencies, const uint alphabet, const uint total) {
+            const uint r = m_Range / total;
+            const uint value = std::min(m_Code / r, total - 1);
+
+            // Searching the symbol whose cumulative interval contains the value.
+            uint symbol = 0;
+            uint cumulative = 0;
+            while (symbol + 1 < alphabet && cumulative + frequencies[symbol] <= value) {
+                cumulative += frequencies[symbol];
+                symbol++;
+            }
+
+            m_Code -= r * cumulative;
+            m_Range = r * frequencies[symbol];
+            while (m_Range < TOP) {
+                m_Code = (m_Code << 8) | next();
+                m_Range <<= 8;
+            }
+
+            return symbol;
+        }
+    };
+}
+
+
+
+double CompressionReport::totalBits() const {
+    return std::accumulate(bits.begin(), bits.end(), 0.0);
+}
+
+double CompressionReport::bitsPerSymbol() const {
+    const u64 symbolCount = std::accumulate(symbols.begin(), symbols.end(), u64(0));
+    return symbolCount == 0 ? 0.0 : totalBits() / symbolCount;
+}
+
+
+
+ContextModel::ContextModel(const uint alphabet, const uint order) :
+    m_Alphabet(alphabet),
+    m_Contexts(1)
+{
+    for (uint i = 0; i < order; i++) {
+        m_Contexts *= alphabet;
+    }
+
+    m_Frequencies.resize(static_cast<size_t>(m_Contexts) * m_Alphabet);
+    m_Totals.resize(m_Contexts);
+    reset();
+}
+
+void ContextModel::reset() {
+    std::fill(m_Frequencies.begin(), m_Frequencies.end(), 1);
+    std::fill(m_Totals.begin(), m_Totals.end(), m_Alphabet);
+    m_Context = 0;
+}
+
+const uint* ContextModel::frequencies() const {
+    return &m_Frequencies[static_cast<size_t>(m_Context) * m_Alphabet];
+}
+
+uint ContextModel::total() const {
+    return m_Totals[m_Context];
+}
+
+uint ContextModel::alphabet() const {
+    return m_Alphabet;
+}
+
+void ContextModel::update(const uint symbol) {
+    uint* frequencies = &m_Frequencies[static_cast<size_t>(m_Context) * m_Alphabet];
+    frequencies[symbol] += INCREMENT;
+    m_Totals[m_Context] += INCREMENT;
+
+    // Halving the statistics keeps the total within the precision of the coder and lets the model adapt.
+    if (m_Totals[m_Context] >= MAX_TOTAL) {
+        uint total = 0;
+        for (uint i = 0; i < m_Alphabet; i++) {
+            frequencies[i] = (frequencies[i] + 1) / 2;
+            total += frequencies[i];
+        }
+        m_Totals[m_Context] = total;
+    }
+
+    // Sliding the context window by one command.
+    m_Context = (m_Context * m_Alphabet + symbol) % m_Contexts;
+}
+
+
+
+ArithmeticCoder::ArithmeticCoder(const ChainCodeType type, const uint order) :
+    m_Type(type),
+    m_Model(ChainCodeFunctions::alphabetSize(type), order)
+{
+    if (order > 6) {
+        throw std::logic_error("Context order is too large.");
+    }
+}
+
+std::vector<unsigned char> ArithmeticCoder::encode(const ChainCode& chainCode) {
+    std::vector<unsigned char> output;
+    output.reserve(chainCode.code.size() / 4 + 16);
+
+    m_Model.reset();
+    RangeEncoder encoder(output);
+    const uint alphabet = m_Model.alphabet();
+
+    for (const short command : chainCode.code) {
+        const uint symbol = static_cast<uint>(command);
+        if (symbol >= alphabet) {
+            throw std::logic_error("Invalid chain code command.");
+        }
+
+        // Cumulative frequency of the preceding symbols.
+        const uint* frequencies = m_Model.frequencies();
+        uint cumulative = 0;
+        for (uint i = 0; i < symbol; i++) {
+            cumulative += frequencies[i];
+        }
+
+        encoder.encode(cumulative, frequencies[symbol], m_Model.total());
+        m_Model.update(symbol);
+    }
+    encoder.flush();
+
+    return output;
+}
+
+std::vector<short> ArithmeticCoder::decode(const std::vector<unsigned char>& data, const size_t symbolCount) {
+    std::vector<short> commands;
+    commands.reserve(symbolCount);
+
+    m_Model.reset();
+    RangeDecoder decoder(data);
+
+    for (size_t i = 0; i < symbolCount; i++) {
+        const uint symbol = decoder.decode(m_Model.frequencies(), m_Model.alphabet(), m_Model.total());
+        commands.push_back(static_cast<short>(symbol));
+        m_Model.update(symbol);
+    }
+
+    return commands;
+}
+
+double ArithmeticCoder::estimateBits(const ChainCode& chainCode) {
+    const std::vector<float>& log2 = log2Table();
+    const uint alphabet = m_Model.alphabet();
+
+    m_Model.reset();
+    double bits = 0.0;
+
+    // Ideal code length of each symbol under the adaptive model: log2(total / frequency).
+    for (const short command : chainCode.code) {
+        const uint symbol = static_cast<uint>(command);
+        if (symbol >= alphabet) {
+            throw std::logic_error("Invalid chain code command.");
+        }
+
+        bits += log2[m_Model.total()] - log2[m_Model.frequencies()[symbol]];
+        m_Model.update(symbol);
+    }
+
+    return bits;
+}
+
+CompressionReport ArithmeticCoder::compressedSize(const std::vector<ChainCode>& chainCodes, const bool estimateOnly) {
+    CompressionReport report;
+
+    for (const ChainCode& chainCode : chainCodes) {
+        if (chainCode.type != m_Type) {
+            throw std::logic_error("Chain code type does not match the coder.");
+        }
+
+        report.symbols.push_back(chainCode.code.size());
+        report.bits.push_back(estimateOnly ? estimateBits(chainCode) : 8.0 * encode(chainCode).size());
+    }
+
+    return report;
+}
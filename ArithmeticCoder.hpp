@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+
+
+/// <summary>
+/// Compressed size of a group of chain codes.
+/// </summary>
+struct CompressionReport {
+    std::vector<u64> symbols;  // Number of commands of each chain code.
+    std::vector<double> bits;  // Compressed size of each chain code in bits.
+
+    /// <summary>
+    /// Total compressed size.
+    /// </summary>
+    /// <returns>Number of bits</returns>
+    double totalBits() const;
+
+    /// <summary>
+    /// Average compressed size of a command.
+    /// </summary>
+    /// <returns>Bits per symbol</returns>
+    double bitsPerSymbol() const;
+};
+
+
+/// <summary>
+/// Adaptive frequency model over order-k contexts of chain code commands.
+/// </summary>
+class ContextModel {
+private:
+    static constexpr uint INCREMENT = 24;        // Frequency increment after coding a symbol.
+    static constexpr uint MAX_TOTAL = 1 << 16;   // Frequencies are halved when the total reaches this value.
+
+    uint m_Alphabet;                  // Number of different commands.
+    uint m_Contexts;                  // Number of contexts (alphabet^order).
+    uint m_Context = 0;               // Index of the current context.
+    std::vector<uint> m_Frequencies;  // Frequencies of the symbols, grouped by contexts.
+    std::vector<uint> m_Totals;       // Sum of frequencies of each context.
+
+public:
+    /// <summary>
+    /// Constructor of the model.
+    /// </summary>
+    /// <param name="alphabet">: number of different commands</param>
+    /// <param name="order">: number of previous commands that form the context</param>
+    ContextModel(const uint alphabet, const uint order);
+
+    /// <summary>
+    /// Resetting the model into the initial (uniform) state.
+    /// </summary>
+    void reset();
+
+    /// <summary>
+    /// Frequencies of the symbols in the current context.
+    /// </summary>
+    /// <returns>Pointer to the alphabet-sized array of frequencies</returns>
+    const uint* frequencies() const;
+
+    /// <summary>
+    /// Sum of the frequencies in the current context.
+    /// </summary>
+    /// <returns>Total frequency</returns>
+    uint total() const;
+
+    /// <summary>
+    /// Number of different commands.
+    /// </summary>
+    /// <returns>Alphabet size</returns>
+    uint alphabet() const;
+
+    /// <summary>
+    /// Updating the statistics with a coded symbol and moving to the next context.
+    /// </summary>
+    /// <param name="symbol">: coded symbol</param>
+    void update(const uint symbol);
+};
+
+
+/// <summary>
+/// Adaptive multi-symbol arithmetic (range) coder of chain codes.
+/// </summary>
+class ArithmeticCoder {
+private:
+    ChainCodeType m_Type;  // Type of the coded chain codes.
+    ContextModel m_Model;  // Adaptive context model.
+
+public:
+    /// <summary>
+    /// Constructor of the coder.
+    /// </summary>
+    /// <param name="type">: type of the coded chain codes</param>
+    /// <param name="order">: context order (number of previous commands)</param>
+    ArithmeticCoder(const ChainCodeType type, const uint order = 2);
+
+    /// <summary>
+    /// Encoding a chain code into a byte stream.
+    /// </summary>
+    /// <param name="chainCode">: chain code</param>
+    /// <returns>Encoded bytes</returns>
+    std::vector<unsigned char> encode(const ChainCode& chainCode);
+
+    /// <summary>
+    /// Decoding a byte stream into chain code commands.
+    /// </summary>
+    /// <param name="data">: encoded bytes</param>
+    /// <param name="symbolCount">: number of encoded commands</param>
+    /// <returns>Decoded commands</returns>
+    std::vector<short> decode(const std::vector<unsigned char>& data, const size_t symbolCount);
+
+    /// <summary>
+    /// Estimating the compressed size of a chain code without producing the output (ideal code length of the model).
+    /// </summary>
+    /// <param name="chainCode">: chain code</param>
+    /// <returns>Compressed size in bits</returns>
+    double estimateBits(const ChainCode& chainCode);
+
+    /// <summary>
+    /// Compressed size of each chain code in a group.
+    /// </summary>
+    /// <param name="chainCodes">: vector of chain codes</param>
+    /// <param name="estimateOnly">: if true, the size is estimated without bit output</param>
+    /// <returns>Compression report</returns>
+    CompressionReport compressedSize(const std::vector<ChainCode>& chainCodes, const bool estimateOnly = true);
+};
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ChainCodeBenchmark.hpp"
+#include "ChainCodeGenerator.hpp"
+
+
+// Generating a synthetic input: generate family type symbols file [--contours n] [--complexity n] [--seed n].
+int generate(int argc, char* argv[]) {
+    if (argc < 6) {
+        std::cerr << "Usage: ChainCodeBenchmark generate hilbert|minkowski|monotone F4|F8 symbols file [--contours n] [--complexity n] [--seed n]" << std::endl;
+        return 1;
+    }
+
+    GeneratorSettings settings;
+    settings.family = ChainCodeGenerator::stringToFamily(argv[2]);
+    settings.type = ChainCodeFunctions::stringToType(argv[3]);
+    settings.symbols = std::stoull(argv[4]);
+    for (int i = 6; i + 1 < argc; i += 2) {
+        const std::string argument = argv[i];
+        if (argument == "--contours") {
+            settings.contours = std::stoul(argv[i + 1]);
+        }
+        else if (argument == "--complexity") {
+            settings.complexity = std::stoul(argv[i + 1]);
+        }
+        else if (argument == "--seed") {
+            settings.seed = std::stoul(argv[i + 1]);
+        }
+    }
+
+    const u64 commands = ChainCodeGenerator::generate(argv[5], settings);
+    std::cerr << "[INFO] Generated " << commands << " commands into " << argv[5] << std::endl;
+    return 0;
+}
+
+
+// Checking the run variants against the plain run on each file (ChainCodeBenchmark::verify).
+int verify(const std::vector<std::string>& files, const BenchmarkSettings& settings) {
+    uint failedFiles = 0;
+    for (const std::string& file : files) {
+        try {
+            const std::vector<std::string> failures = ChainCodeBenchmark::verify(file, settings);
+            for (const std::string& failure : failures) {
+                std::cerr << "[FAIL] " << file << ": " << failure << std::endl;
+            }
+            failedFiles += !failures.empty();
+        }
+        catch (const std::exception& exception) {
+            std::cerr << "[ERROR] " << file << ": " << exception.what() << std::endl;
+            failedFiles++;
+        }
+    }
+
+    std::cerr << "[INFO] Verified " << files.size() - failedFiles << " of " << files.size() << " files" << std::endl;
+    return failedFiles == 0 ? 0 : 1;
+}
+
+
+// Usage: ChainCodeBenchmark [verify] [--csv file] [--json file] [--samples n] [--min-time seconds] [--window n]
+//                           [--seed n] [--pipeline-iterations n] [--pipeline-depths d1,d2,...] [inputs...]
+// Inputs are chain code files or directories of them (F4 and F8 by default); results are written to stdout as CSV
+// unless an output file is given, progress is written to stderr. With verify, the inputs are only checked and the
+// exit code is 1 if a check failed.
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "generate") {
+        try {
+            return generate(argc, argv);
+        }
+        catch (const std::exception& exception) {
+            std::cerr << "[ERROR] " << exception.what() << std::endl;
+            return 1;
+        }
+    }
+
+    BenchmarkSettings settings;
+    std::string csvFile;
+    std::string jsonFile;
+    std::vector<std::string> inputs;
+    const bool verifyRuns = argc > 1 && std::string(argv[1]) == "verify";
+
+    for (int i = verifyRuns ? 2 : 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--csv" && hasValue) {
+            csvFile = argv[++i];
+        }
+        else if (argument == "--json" && hasValue) {
+            jsonFile = argv[++i];
+        }
+        else if (argument == "--samples" && hasValue) {
+            settings.samples = std::stoul(argv[++i]);
+        }
+        else if (argument == "--min-time" && hasValue) {
+            settings.minSampleSeconds = std::stod(argv[++i]);
+        }
+        else if (argument == "--window" && hasValue) {
+            settings.replacementWindow = std::stoul(argv[++i]);
+        }
+        else if (argument == "--seed" && hasValue) {
+            settings.seed = std::stoul(argv[++i]);
+        }
+        else if (argument == "--pipeline-iterations" && hasValue) {
+            settings.pipelineIterations = std::stoul(argv[++i]);
+        }
+        else if (argument == "--pipeline-depths" && hasValue) {
+            settings.pipelineDepths.clear();
+            std::stringstream depths(argv[++i]);
+            for (std::string depth; std::getline(depths, depth, ',');) {
+                settings.pipelineDepths.push_back(std::stoul(depth));
+            }
+        }
+        else {
+            inputs.push_back(argument);
+        }
+    }
+    if (inputs.empty()) {
+        inputs = { "F4", "F8" };
+    }
+
+    // Files of the directories are measured in the order of their names.
+    std::vector<std::string> files;
+    for (const std::string& input : inputs) {
+        if (std::filesystem::is_directory(input)) {
+            std::vector<std::string> directoryFiles;
+            for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(input)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                    directoryFiles.push_back(entry.path().generic_string());
+                }
+            }
+            std::sort(directoryFiles.begin(), directoryFiles.end());
+            files.insert(files.end(), directoryFiles.begin(), directoryFiles.end());
+        }
+        else {
+            files.push_back(input);
+        }
+    }
+
+    if (verifyRuns) {
+        return verify(files, settings);
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (const std::string& file : files) {
+        std::cerr << "[INFO] Benchmarking " << file << std::endl;
+        try {
+            const std::vector<BenchmarkResult> fileResults = ChainCodeBenchmark::run(file, settings);
+            results.insert(results.end(), fileResults.begin(), fileResults.end());
+        }
+        catch (const std::exception& exception) {
+            std::cerr << "[ERROR] " << file << ": " << exception.what() << std::endl;
+        }
+    }
+
+    if (!csvFile.empty()) {
+        std::ofstream out(csvFile, std::ios_base::trunc);
+        ChainCodeBenchmark::writeCsv(out, results);
+    }
+    if (!jsonFile.empty()) {
+        std::ofstream out(jsonFile, std::ios_base::trunc);
+        ChainCodeBenchmark::writeJson(out, settings, results);
+    }
+    if (csvFile.empty() && jsonFile.empty()) {
+        ChainCodeBenchmark::writeCsv(std::cout, results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "BinaryFormat.hpp"
+
+
+namespace {
+    /// <summary>
+    /// Number of bits of a packed command.
+    /// </summary>
+    uint commandBits(const ChainCodeType& type) {
+        return ChainCodeFunctions::alphabetSize(type) <= 4 ? 2 : 3;
+    }
+}
+
+
+
+void BinaryFormat::writeVarint(std::vector<unsigned char>& out, u64 value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+void BinaryFormat::writeSignedVarint(std::vector<unsigned char>& out, const int64_t value) {
+    writeVarint(out, (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63));
+}
+
+void BinaryFormat::writeString(std::vector<unsigned char>& out, const std::string& value) {
+    writeVarint(out, value.size());
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+void BinaryFormat::writeCommands(std::vector<unsigned char>& out, const ChainCodeType& type, const std::vector<short>& code) {
+    const uint bits = commandBits(type);
+    writeVarint(out, code.size());
+
+    // Commands are packed into bytes, starting with the lowest bits.
+    u64 buffer = 0;
+    uint bufferBits = 0;
+    for (const short command : code) {
+        buffer |= static_cast<u64>(command) << bufferBits;
+        bufferBits += bits;
+        while (bufferBits >= 8) {
+            out.push_back(static_cast<unsigned char>(buffer));
+            buffer >>= 8;
+            bufferBits -= 8;
+        }
+    }
+    if (bufferBits > 0) {
+        out.push_back(static_cast<unsigned char>(buffer));
+    }
+}
+
+void BinaryFormat::writeFileAtomically(const std::string& file, const std::vector<unsigned char>& data) {
+    const std::string temporaryFile = file + ".tmp";
+    {
+        std::ofstream out(temporaryFile, std::ios_base::binary | std::ios_base::trunc);
+        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!out.flush()) {
+            throw std::logic_error("File cannot be written.");
+        }
+    }
+    std::filesystem::rename(temporaryFile, file);
+}
+
+
+
+BinaryFormat::ByteReader::ByteReader(const unsigned char* data, const size_t size, const size_t position) :
+    m_Data(data),
+    m_Size(size),
+    m_Position(position)
+{}
+
+unsigned char BinaryFormat::ByteReader::byte() {
+    if (m_Position >= m_Size) {
+        throw std::logic_error("Unexpected end of binary data.");
+    }
+    return m_Data[m_Position++];
+}
+
+u64 BinaryFormat::ByteReader::varint() {
+    u64 value = 0;
+    for (uint shift = 0; shift < 64; shift += 7) {
+        const unsigned char current = byte();
+        value |= static_cast<u64>(current & 0x7F) << shift;
+        if ((current & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::logic_error("Invalid varint in binary data.");
+}
+
+int64_t BinaryFormat::ByteReader::signedVarint() {
+    const u64 value = varint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+std::string BinaryFormat::ByteReader::string() {
+    const size_t length = varint();
+    const unsigned char* data = bytes(length);
+    return std::string(data, data + length);
+}
+
+std::vector<short> BinaryFormat::ByteReader::commands(const ChainCodeType& type) {
+    const uint bits = commandBits(type);
+    const uint mask = (1u << bits) - 1;
+    const size_t length = varint();
+    const unsigned char* data = bytes((length * bits + 7) / 8);
+
+    std::vector<short> code(length);
+    for (size_t i = 0; i < length; i++) {
+        // A command spans at most two bytes.
+        const size_t bit = i * bits;
+        uint value = data[bit / 8];
+        if (bit % 8 + bits > 8) {
+            value |= static_cast<uint>(data[bit / 8 + 1]) << 8;
+        }
+        code[i] = static_cast<short>((value >> (bit % 8)) & mask);
+    }
+
+    return code;
+}
+
+const unsigned char* BinaryFormat::ByteReader::bytes(const size_t count) {
+    if (count > m_Size - m_Position) {
+        throw std::logic_error("Unexpected end of binary data.");
+    }
+    const unsigned char* data = m_Data + m_Position;
+    m_Position += count;
+    return data;
+}
+
+size_t BinaryFormat::ByteReader::position() const {
+    return m_Position;
+}
+
+bool BinaryFormat::ByteReader::atEnd() const {
+    return m_Position >= m_Size;
+}
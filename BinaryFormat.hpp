@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+
+
+/// <summary>
+/// Helpers for the compact binary files (noise journal, checkpoints).
+/// Integers are stored as LEB128 varints (signed values zigzag-encoded), chain code commands are
+/// packed into 2 bits (4-direction alphabets) or 3 bits (8-direction alphabets).
+/// </summary>
+namespace BinaryFormat {
+    /// <summary>
+    /// Appending an unsigned varint.
+    /// </summary>
+    /// <param name="out">: output buffer</param>
+    /// <param name="value">: value</param>
+    void writeVarint(std::vector<unsigned char>& out, u64 value);
+
+    /// <summary>
+    /// Appending a signed (zigzag-encoded) varint.
+    /// </summary>
+    /// <param name="out">: output buffer</param>
+    /// <param name="value">: value</param>
+    void writeSignedVarint(std::vector<unsigned char>& out, const int64_t value);
+
+    /// <summary>
+    /// Appending a length-prefixed string.
+    /// </summary>
+    /// <param name="out">: output buffer</param>
+    /// <param name="value">: string</param>
+    void writeString(std::vector<unsigned char>& out, const std::string& value);
+
+    /// <summary>
+    /// Appending a length-prefixed sequence of bit-packed chain code commands.
+    /// </summary>
+    /// <param name="out">: output buffer</param>
+    /// <param name="type">: type of the chain code</param>
+    /// <param name="code">: commands</param>
+    void writeCommands(std::vector<unsigned char>& out, const ChainCodeType& type, const std::vector<short>& code);
+
+    /// <summary>
+    /// Writing a buffer into a temporary file that replaces the given file once it is complete,
+    /// so an interrupted write never damages the previous content.
+    /// </summary>
+    /// <param name="file">: path to the file</param>
+    /// <param name="data">: content of the file</param>
+    void writeFileAtomically(const std::string& file, const std::vector<unsigned char>& data);
+
+
+    /// <summary>
+    /// Sequential reader of a byte buffer with bounds checking (throws std::logic_error at the end of the buffer).
+    /// </summary>
+    class ByteReader {
+    private:
+        const unsigned char* m_Data;  // Start of the buffer.
+        size_t m_Size;                // Size of the buffer (end of reading).
+        size_t m_Position;            // Current position.
+
+    public:
+        /// <summary>
+        /// Constructor of the reader.
+        /// </summary>
+        /// <param name="data">: start of the buffer</param>
+        /// <param name="size">: size of the buffer</param>
+        /// <param name="position">: position of the first read byte</param>
+        ByteReader(const unsigned char* data, const size_t size, const size_t position = 0);
+
+        unsigned char byte();
+        u64 varint();
+        int64_t signedVarint();
+        std::string string();
+        std::vector<short> commands(const ChainCodeType& type);
+
+        /// <summary>
+        /// Skipping the given number of bytes.
+        /// </summary>
+        /// <param name="count">: number of bytes</param>
+        /// <returns>Pointer to the first skipped byte</returns>
+        const unsigned char* bytes(const size_t count);
+
+        size_t position() const;
+        bool atEnd() const;
+    };
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstring>
+
+#include "BorderTiles.hpp"
+
+
+size_t BorderTiles::cell(const Pixel& pixel) const {
+    return static_cast<size_t>(pixel.y / CELL_SIZE) * m_CellsX + pixel.x / CELL_SIZE;
+}
+
+BorderTiles::BorderTiles(const std::vector<std::vector<Pixel>>& coordinates, const uint maxXCoordinate, const uint maxYCoordinate, const uint padding) :
+    m_Width(maxXCoordinate + 2 * padding),
+    m_Height(maxYCoordinate + 2 * padding),
+    m_CellsX(m_Width / CELL_SIZE + 1),
+    m_CellsY(m_Height / CELL_SIZE + 1),
+    m_MaxYCoordinate(maxYCoordinate),
+    m_Padding(padding)
+{
+    // Sorting the pixels into cells (Y axis is flipped, so the view grows downwards).
+    m_Cells.resize(static_cast<size_t>(m_CellsX) * m_CellsY);
+    for (const std::vector<Pixel>& currentCoordinates : coordinates) {
+        for (const Pixel& coordinate : currentCoordinates) {
+            const Pixel pixel = toView(coordinate);
+            m_Cells[cell(pixel)].push_back(pixel);
+        }
+    }
+
+    // Pixels shared by chain codes (e.g. the closing pixel) are stored once, so a removal clears them.
+    for (std::vector<Pixel>& pixels : m_Cells) {
+        std::sort(pixels.begin(), pixels.end(), [](const Pixel& a, const Pixel& b) {
+            return a.y != b.y ? a.y < b.y : a.x < b.x;
+        });
+        pixels.erase(std::unique(pixels.begin(), pixels.end()), pixels.end());
+    }
+}
+
+uint BorderTiles::width() const {
+    return m_Width;
+}
+
+uint BorderTiles::height() const {
+    return m_Height;
+}
+
+Pixel BorderTiles::toView(const Pixel& coordinate) const {
+    return Pixel(coordinate.x + static_cast<int>(m_Padding), static_cast<int>(m_MaxYCoordinate) - coordinate.y + static_cast<int>(m_Padding));
+}
+
+bool BorderTiles::contains(const Pixel& pixel) const {
+    return pixel.x >= 0 && pixel.y >= 0 && static_cast<uint>(pixel.x) < m_Width && static_cast<uint>(pixel.y) < m_Height;
+}
+
+void BorderTiles::addPixel(const Pixel& coordinate) {
+    const Pixel pixel = toView(coordinate);
+    if (!contains(pixel)) {
+        return;
+    }
+
+    std::vector<Pixel>& pixels = m_Cells[cell(pixel)];
+    if (std::find(pixels.begin(), pixels.end(), pixel) == pixels.end()) {
+        pixels.push_back(pixel);
+    }
+}
+
+void BorderTiles::removePixel(const Pixel& coordinate) {
+    const Pixel pixel = toView(coordinate);
+    if (!contains(pixel)) {
+        return;
+    }
+
+    // Order of the pixels within a cell does not matter, so the last one fills the gap.
+    std::vector<Pixel>& pixels = m_Cells[cell(pixel)];
+    const auto found = std::find(pixels.begin(), pixels.end(), pixel);
+    if (found != pixels.end()) {
+        *found = pixels.back();
+        pixels.pop_back();
+    }
+}
+
+int64_t BorderTiles::tileSpan(const int level) {
+    return level >= 0 ? TILE_SIZE >> std::min(level, 8) : static_cast<int64_t>(TILE_SIZE) << -level;
+}
+
+uint BorderTiles::tileCount(const int level, const uint size) {
+    const u64 pixels = level >= 0 ? static_cast<u64>(size) << level : ((static_cast<u64>(size) + (u64(1) << -level) - 1) >> -level);
+    return static_cast<uint>((pixels + TILE_SIZE - 1) / TILE_SIZE);
+}
+
+bool BorderTiles::rasterizeTile(const int level, const int tileX, const int tileY, unsigned char* data, const size_t stride) const {
+    // Area of the tile in border pixels.
+    const int64_t span = tileSpan(level);
+    const int64_t left = tileX * span;
+    const int64_t top = tileY * span;
+    if (span == 0 || left >= m_Width || top >= m_Height || left + span <= 0 || top + span <= 0) {
+        return false;
+    }
+
+    const uint firstCellX = static_cast<uint>(std::max<int64_t>(left, 0) / CELL_SIZE);
+    const uint lastCellX = static_cast<uint>(std::min<int64_t>(left + span - 1, m_Width - 1) / CELL_SIZE);
+    const uint firstCellY = static_cast<uint>(std::max<int64_t>(top, 0) / CELL_SIZE);
+    const uint lastCellY = static_cast<uint>(std::min<int64_t>(top + span - 1, m_Height - 1) / CELL_SIZE);
+    const int blockSize = level >= 0 ? 1 << level : 1;
+
+    bool empty = true;
+    for (uint cellY = firstCellY; cellY <= lastCellY; cellY++) {
+        for (uint cellX = firstCellX; cellX <= lastCellX; cellX++) {
+            const size_t cell = static_cast<size_t>(cellY) * m_CellsX + cellX;
+            for (const Pixel& pixel : m_Cells[cell]) {
+                if (pixel.x < left || pixel.x >= left + span || pixel.y < top || pixel.y >= top + span) {
+                    continue;
+                }
+
+                // Background is filled once the tile is known to contain the border.
+                if (empty) {
+                    for (uint y = 0; y < TILE_SIZE; y++) {
+                        std::memset(data + y * stride, 255, TILE_SIZE);
+                    }
+                    empty = false;
+                }
+
+                const int x = level >= 0 ? static_cast<int>(pixel.x - left) << level : static_cast<int>(pixel.x - left) >> -level;
+                const int y = level >= 0 ? static_cast<int>(pixel.y - top) << level : static_cast<int>(pixel.y - top) >> -level;
+                unsigned char* row = data + static_cast<size_t>(y) * stride + x;
+                for (int j = 0; j < blockSize; j++, row += stride) {
+                    std::memset(row, 0, blockSize);
+                }
+            }
+        }
+    }
+
+    return !empty;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Level-of-detail tiles of a border, rasterized on demand from its pixels (no Qt dependency).
+///
+/// Pixels are stored in view coordinates (X to the right, Y downwards, padding included) and sorted
+/// into square cells, so a tile only visits the pixels of the cells it overlaps. At level L a border
+/// pixel covers 2^L x 2^L tile pixels (negative levels merge 2^-L x 2^-L border pixels into one).
+/// Pixels can be added and removed, so a running noise application is shown without rebuilding the index.
+/// </summary>
+class BorderTiles {
+public:
+    static constexpr uint TILE_SIZE = 256;  // Side of a tile in tile pixels.
+    static constexpr uint CELL_SIZE = 64;   // Side of a cell of the spatial index in border pixels.
+
+private:
+    uint m_Width = 0;                  // Width of the view in border pixels.
+    uint m_Height = 0;                 // Height of the view in border pixels.
+    uint m_CellsX = 0;                 // Number of cell columns.
+    uint m_CellsY = 0;                 // Number of cell rows.
+    uint m_MaxYCoordinate = 0;         // Maximal Y coordinate of the border.
+    uint m_Padding = 0;                // Padding around the border.
+    std::vector<std::vector<Pixel>> m_Cells;  // Pixels of each cell in view coordinates (row-major, without duplicates).
+
+    /// <summary>
+    /// Cell of the spatial index that contains a pixel.
+    /// </summary>
+    /// <param name="pixel">: pixel in view coordinates (inside the view)</param>
+    /// <returns>Index of the cell</returns>
+    size_t cell(const Pixel& pixel) const;
+
+public:
+    /// <summary>
+    /// Basic constructor of BorderTiles (empty border).
+    /// </summary>
+    BorderTiles() = default;
+
+    /// <summary>
+    /// Building the spatial index of a border.
+    /// </summary>
+    /// <param name="coordinates">: coordinates of each chain code (as in ChainCodeFunctions::calculateCoordinates)</param>
+    /// <param name="maxXCoordinate">: maximal X coordinate of the border</param>
+    /// <param name="maxYCoordinate">: maximal Y coordinate of the border</param>
+    /// <param name="padding">: padding around the border (in border pixels)</param>
+    BorderTiles(const std::vector<std::vector<Pixel>>& coordinates, const uint maxXCoordinate, const uint maxYCoordinate, const uint padding);
+
+    /// <summary>
+    /// Width of the view in border pixels (padding included).
+    /// </summary>
+    uint width() const;
+
+    /// <summary>
+    /// Height of the view in border pixels (padding included).
+    /// </summary>
+    uint height() const;
+
+    /// <summary>
+    /// Transforming border coordinates into view coordinates.
+    /// </summary>
+    /// <param name="coordinate">: border coordinates (as in ChainCodeFunctions::calculateCoordinates)</param>
+    /// <returns>View coordinates</returns>
+    Pixel toView(const Pixel& coordinate) const;
+
+    /// <summary>
+    /// Checking whether a pixel lies inside the view.
+    /// </summary>
+    /// <param name="pixel">: pixel in view coordinates</param>
+    /// <returns>True if the pixel is inside the view</returns>
+    bool contains(const Pixel& pixel) const;
+
+    /// <summary>
+    /// Adding a border pixel (pixels outside the view and pixels that are already present are ignored).
+    /// </summary>
+    /// <param name="coordinate">: border coordinates of the pixel</param>
+    void addPixel(const Pixel& coordinate);
+
+    /// <summary>
+    /// Removing a border pixel (pixels that are not present are ignored).
+    /// </summary>
+    /// <param name="coordinate">: border coordinates of the pixel</param>
+    void removePixel(const Pixel& coordinate);
+
+    /// <summary>
+    /// Side of a tile in border pixels at the given level (tiles of a level are nested in the tiles of coarser levels).
+    /// </summary>
+    /// <param name="level">: level of detail</param>
+    /// <returns>Side of the tile</returns>
+    static int64_t tileSpan(const int level);
+
+    /// <summary>
+    /// Number of tiles in a row or a column at the given level.
+    /// </summary>
+    /// <param name="level">: level of detail</param>
+    /// <param name="size">: width or height of the view in border pixels</param>
+    /// <returns>Number of tiles</returns>
+    static uint tileCount(const int level, const uint size);
+
+    /// <summary>
+    /// Rasterization of a tile into an 8-bit buffer (0 - border, 255 - background).
+    /// </summary>
+    /// <param name="level">: level of detail</param>
+    /// <param name="tileX">: column of the tile</param>
+    /// <param name="tileY">: row of the tile</param>
+    /// <param name="data">: first byte of a TILE_SIZE x TILE_SIZE buffer</param>
+    /// <param name="stride">: distance between the rows of the buffer in bytes</param>
+    /// <returns>False if the tile contains no border pixel (the buffer is not written)</returns>
+    bool rasterizeTile(const int level, const int tileX, const int tileY, unsigned char* data, const size_t stride) const;
+};
@@ -1,15 +1,20 @@
 #include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
 
 #include "ChainCode.hpp"
 #include "ChainCodeNoise.hpp"
+#include "ChainCodeTranscoder.hpp"
 #include "Constants.hpp"
 
 
-ChainCode::ChainCode(const std::string& chainCode, const ChainCodeType type, const int startX, const int startY) :
+ChainCode::ChainCode(const std::string& chainCode, const ChainCodeType type, const int startX, const int startY, const short initialDirection) :
 	type(type),
 	startX(startX),
-	startY(startY)
+	startY(startY),
+	initialDirection(initialDirection)
 {
 	// Reading the chain code character by character.
 	for (const char& ch : chainCode) {
@@ -19,6 +24,11 @@ ChainCode::ChainCode(const std::string& chainCode, const ChainCodeType type, con
 }
 
 std::vector<Pixel> ChainCode::toCoordinates() const {
+	// Relative chain codes are decoded to F4 first.
+	if (type == ChainCodeType::VCC || type == ChainCodeType::ThreeOT) {
+		return ChainCodeTranscoder::transcode(*this, ChainCodeType::F4).toCoordinates();
+	}
+
 	std::vector<Pixel> coordinates;
 	
 	// Setting the start point.
@@ -256,4 +266,134 @@ std::pair<Pixel, Pixel> ChainCodeFunctions::extremeCoordinates(const std::vector
 	}
 
 	return { Pixel(xMin, yMin), Pixel(xMax, yMax) };
+}
+
+uint ChainCodeFunctions::alphabetSize(const ChainCodeType& type) {
+	if (type == ChainCodeType::F8) {
+		return 8;
+	}
+	else if (type == ChainCodeType::F4 || type == ChainCodeType::VCC || type == ChainCodeType::ThreeOT) {
+		return 4;
+	}
+
+	throw std::logic_error("Invalid chain code type.");
+}
+
+std::string ChainCodeFunctions::typeToString(const ChainCodeType& type) {
+	if (type == ChainCodeType::F8) {
+		return "F8";
+	}
+	else if (type == ChainCodeType::F4) {
+		return "F4";
+	}
+	else if (type == ChainCodeType::VCC) {
+		return "VCC";
+	}
+	else if (type == ChainCodeType::ThreeOT) {
+		return "3OT";
+	}
+
+	throw std::logic_error("Invalid chain code type.");
+}
+
+ChainCodeType ChainCodeFunctions::stringToType(const std::string& name) {
+	if (name == "F8") {
+		return ChainCodeType::F8;
+	}
+	else if (name == "F4") {
+		return ChainCodeType::F4;
+	}
+	else if (name == "VCC") {
+		return ChainCodeType::VCC;
+	}
+	else if (name == "3OT") {
+		return ChainCodeType::ThreeOT;
+	}
+
+	throw std::logic_error("Unknown type of the chain code.");
+}
+
+std::vector<ChainCode> ChainCodeFunctions::readChainCodeFile(const std::string& file) {
+	std::vector<ChainCode> chainCodes;
+
+	// Opening a file.
+	std::ifstream in(file);
+
+	// If a file is not open, we do not panic but abort the process.
+	if (!in.is_open()) {
+		throw std::logic_error("File could not be found or opened.");
+	}
+
+	// Removing trailing carriage returns of files written on Windows.
+	auto trim = [](std::string& value) {
+		while (!value.empty() && (value.back() == '\r' || value.back() == '\n')) {
+			value.pop_back();
+		}
+	};
+
+	// Reading the header.
+	std::string firstLine;
+	std::getline(in, firstLine);
+	trim(firstLine);
+	if (firstLine != "CC Multi") {
+		throw std::logic_error("Invalid header of the chain code.");
+	}
+
+	// Reading the chain code.
+	std::string value;
+	while (std::getline(in, value, ';')) {
+		// Skipping empty lines between chain codes.
+		value.erase(0, value.find_first_not_of("\r\n"));
+		if (value.empty()) {
+			continue;
+		}
+		const ChainCodeType type = stringToType(value);
+
+		// Reading clockwise or anti-clockwise orientation.
+		std::string orientation;
+		std::getline(in, orientation, ';');
+
+		// Reading the starting point.
+		std::getline(in, value, ',');
+		const int startX = std::stoi(value);
+		std::getline(in, value, ';');
+		const int startY = -std::stoi(value);
+
+		// Reading the initial direction of relative chain codes (absolute ones keep the field to write it back).
+		std::getline(in, value, ';');
+		const bool relative = type == ChainCodeType::VCC || type == ChainCodeType::ThreeOT;
+		const short initialDirection = relative ? static_cast<short>(std::stoi(value)) : 0;
+		const int headerValue = relative ? 0 : static_cast<int>(std::strtol(value.c_str(), nullptr, 10));
+
+		// Reading the chain code.
+		std::getline(in, value);
+		trim(value);
+		chainCodes.push_back(ChainCode(value, type, startX, startY, initialDirection));
+		chainCodes.back().orientation = orientation;
+		chainCodes.back().headerValue = headerValue;
+	}
+
+	return chainCodes;
+}
+
+void ChainCodeFunctions::writeChainCodeFile(const std::string& file, const std::vector<ChainCode>& chainCodes) {
+	std::ofstream out(file, std::ios_base::binary | std::ios_base::trunc);
+	if (!out.is_open()) {
+		throw std::logic_error("File could not be created.");
+	}
+
+	out << "CC Multi\n";
+
+	std::string line;
+	for (const ChainCode& chainCode : chainCodes) {
+		const bool relative = chainCode.type == ChainCodeType::VCC || chainCode.type == ChainCodeType::ThreeOT;
+
+		// Header of the chain code (Y axis is flipped back, as the reader negates it).
+		out << typeToString(chainCode.type) << ";" << chainCode.orientation << ";" << chainCode.startX << "," << -chainCode.startY << ";" << (relative ? chainCode.initialDirection : chainCode.headerValue) << ";";
+
+		// Commands are converted to characters in one go.
+		line.resize(chainCode.code.size());
+		std::transform(chainCode.code.begin(), chainCode.code.end(), line.begin(), [](const short command) { return static_cast<char>('0' + command); });
+		out << line << "\n";
+	}
 }
\ No newline at end of file
@@ -14,7 +14,9 @@
 /// </summary>
 enum class ChainCodeType {
 	F8,
-	F4
+	F4,
+	VCC,     // Vertex chain code (1 - left turn, 2 - straight, 3 - right turn, 0 - reversal).
+	ThreeOT  // Three orthogonal chain code (0 - straight, 1 - turn to the reference direction, 2 - turn away from it, 3 - reversal).
 };
 
 
@@ -26,6 +28,9 @@ struct ChainCode {
 	ChainCodeType type;		  // Type of the chain code (F8, F4, VCC...).
 	int startX;				  // X start coordinate.
 	int startY;				  // Y start coordinate.
+	short initialDirection;	  // F4 direction preceding the first command (only relative codes - VCC, 3OT).
+	std::string orientation = "CW";  // Orientation of the contour in the file (CW or CCW).
+	int headerValue = 0;	  // Fourth header field of absolute codes in the file (relative codes store the initial direction there).
 
 	/// <summary>
 	/// Constructor of the structure.
@@ -34,7 +39,8 @@ struct ChainCode {
 	/// <param name="type">: type of the chain code (F8, F4, VCC...)</param>
 	/// <param name="startX">: X start coordinate</param>
 	/// <param name="startY">: Y start coordinate</param>
-	ChainCode(const std::string& chainCode, const ChainCodeType type, const int startX, const int startY);
+	/// <param name="initialDirection">: F4 direction preceding the first command (VCC and 3OT only)</param>
+	ChainCode(const std::string& chainCode, const ChainCodeType type, const int startX, const int startY, const short initialDirection = 0);
 
 	/// <summary>
 	/// Transforming the chain code to the vector of coordinates.
@@ -91,4 +97,40 @@ namespace ChainCodeFunctions {
 	/// <param name="coordinates">: vector of vectors of pixels (by each chain code)</param>
 	/// <returns>Pixel(xMin, yMin), Pixel(xMax, yMax)</returns>
 	std::pair<Pixel, Pixel> extremeCoordinates(const std::vector<std::vector<Pixel>>& coordinates);
+
+	/// <summary>
+	/// Number of different commands of the chain code type.
+	/// </summary>
+	/// <param name="type">: chain code type</param>
+	/// <returns>Size of the alphabet</returns>
+	uint alphabetSize(const ChainCodeType& type);
+
+	/// <summary>
+	/// Name of the chain code type, as used in chain code files.
+	/// </summary>
+	/// <param name="type">: chain code type</param>
+	/// <returns>Name of the type (F8, F4, VCC, 3OT)</returns>
+	std::string typeToString(const ChainCodeType& type);
+
+	/// <summary>
+	/// Parsing the name of the chain code type.
+	/// </summary>
+	/// <param name="name">: name of the type (F8, F4, VCC, 3OT)</param>
+	/// <returns>Chain code type</returns>
+	ChainCodeType stringToType(const std::string& name);
+
+	/// <summary>
+	/// Reading a file that contains chain codes (CC Multi format).
+	/// </summary>
+	/// <param name="file">: path to the file</param>
+	/// <returns>Vector of chain codes</returns>
+	std::vector<ChainCode> readChainCodeFile(const std::string& file);
+
+	/// <summary>
+	/// Writing chain codes to a file (CC Multi format), with the orientation and the fourth header field of each
+	/// chain code as they were read.
+	/// </summary>
+	/// <param name="file">: path to the file</param>
+	/// <param name="chainCodes">: vector of chain codes</param>
+	void writeChainCodeFile(const std::string& file, const std::vector<ChainCode>& chainCodes);
 }
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "ChainCodeApi.h"
+#include "ChainCodeNoise.hpp"
+
+
+/// <summary>
+/// Generator of the C interface.
+/// </summary>
+struct cc_rng {
+    std::mt19937 generator;
+};
+
+
+/// <summary>
+/// Engine of the C interface: noise algorithm, error message and the buffers reused by the calls.
+/// </summary>
+struct cc_engine {
+    ChainCodeNoise noise;
+    std::string error;
+    std::vector<ChainCode> chainCodes;       // Chain codes of the call (their vectors keep the capacity).
+    std::vector<Pixel> startPixels;
+    std::unordered_set<Pixel> borderPixels;  // Border of the call (rebuilt in the buckets of the previous call).
+
+    /// <summary>
+    /// Applying noise (arguments as in cc_noise).
+    /// </summary>
+    cc_status applyNoise(cc_rng* rng, const cc_chain_codes& input, const cc_noise_params& params, cc_output& output, cc_noise_metrics* metrics);
+};
+
+
+cc_status cc_engine::applyNoise(cc_rng* rng, const cc_chain_codes& input, const cc_noise_params& params, cc_output& output, cc_noise_metrics* metrics) {
+    const auto start = std::chrono::steady_clock::now();
+    if (input.type != CC_TYPE_F4 && input.type != CC_TYPE_F8) {
+        throw std::logic_error("Noise can only be applied to F4 and F8 chain codes.");
+    }
+    if (input.count > 0 && (input.lengths == nullptr || input.starts == nullptr)) {
+        throw std::logic_error("Lengths and starts of the chain codes are missing.");
+    }
+    // NaN fails both comparisons, so it is rejected as well.
+    if (!(params.probability >= 0.0 && params.probability <= 1.0)) {
+        throw std::logic_error("Noise probability must be within [0, 1].");
+    }
+    noise.setReplacementWindow(params.window);
+
+    // Copying the input into the chain codes of the engine and tracing the border.
+    const ChainCodeType type = input.type == CC_TYPE_F4 ? ChainCodeType::F4 : ChainCodeType::F8;
+    const uint8_t alphabet = input.type == CC_TYPE_F4 ? 4 : 8;
+    chainCodes.resize(input.count, ChainCode("", type, 0, 0));
+    startPixels.resize(input.count);
+    borderPixels.clear();
+    noise.m_RepeatedPixels.clear();
+    const uint8_t* commands = input.commands;
+    u64 inputCommands = 0;
+    for (size_t i = 0; i < input.count; i++) {
+        const size_t length = input.lengths[i];
+        if (length > 0 && commands == nullptr) {
+            throw std::logic_error("Commands of the chain codes are missing.");
+        }
+
+        ChainCode& chainCode = chainCodes[i];
+        chainCode.type = type;
+        chainCode.startX = input.starts[i].x;
+        chainCode.startY = input.starts[i].y;
+        chainCode.code.assign(commands, commands + length);
+        startPixels[i] = Pixel(input.starts[i].x, input.starts[i].y);
+
+        // Pixels visited more than once are counted, so the replacements keep them until their last visit is gone.
+        Pixel pixel = startPixels[i];
+        for (const short command : chainCode.code) {
+            if (command >= alphabet) {
+                throw std::logic_error("Invalid chain code command.");
+            }
+            pixel = ChainCodeFunctions::chainCodeMove(type, command, pixel);
+            noise.m_RepeatedPixels.insert(borderPixels, pixel);
+        }
+        if (!(pixel == startPixels[i])) {
+            noise.m_RepeatedPixels.insert(borderPixels, startPixels[i]);
+        }
+        commands += length;
+        inputCommands += length;
+    }
+
+    // The generator of the call is swapped into the noise algorithm for the iterations (and back, also on exceptions).
+    struct GeneratorSwap {
+        std::mt19937& engineGenerator;
+        cc_rng* rng;
+
+        GeneratorSwap(std::mt19937& engineGenerator, cc_rng* rng) : engineGenerator(engineGenerator), rng(rng) {
+            if (rng != nullptr) {
+                std::swap(engineGenerator, rng->generator);
+            }
+        }
+        ~GeneratorSwap() {
+            if (rng != nullptr) {
+                std::swap(engineGenerator, rng->generator);
+            }
+        }
+    } generatorSwap(noise.m_Generator, rng);
+
+    // The generator is restored if the output does not fit, so a retry gives the same chain codes.
+    const std::mt19937 initialGenerator = noise.m_Generator;
+    for (uint32_t iteration = 0; iteration < params.iterations; iteration++) {
+        noise.addNoiseIteration(chainCodes, startPixels, borderPixels, params.probability);
+    }
+
+    size_t required = 0;
+    for (const ChainCode& chainCode : chainCodes) {
+        required += chainCode.code.size();
+    }
+    output.written = required;
+    if (required > output.capacity || (required > 0 && output.commands == nullptr)) {
+        uint8_t* reserved = output.reserve != nullptr ? output.reserve(output.context, required) : nullptr;
+        if (reserved == nullptr) {
+            noise.m_Generator = initialGenerator;
+            return CC_ERROR_BUFFER_TOO_SMALL;
+        }
+        output.commands = reserved;
+        output.capacity = required;
+    }
+
+    uint8_t* outputCommands = output.commands;
+    for (size_t i = 0; i < chainCodes.size(); i++) {
+        outputCommands = std::copy(chainCodes[i].code.begin(), chainCodes[i].code.end(), outputCommands);
+        if (output.lengths != nullptr) {
+            output.lengths[i] = chainCodes[i].code.size();
+        }
+    }
+
+    if (metrics != nullptr) {
+        metrics->input_commands = inputCommands;
+        metrics->output_commands = required;
+        metrics->border_pixels = borderPixels.size();
+        metrics->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return CC_OK;
+}
+
+
+
+int cc_api_version(void) {
+    return CC_API_VERSION;
+}
+
+cc_engine* cc_engine_create(uint32_t seed) {
+    try {
+        cc_engine* engine = new cc_engine();
+        engine->noise.setConsoleProgress(false);
+        engine->noise.setSeed(seed);
+        return engine;
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void cc_engine_destroy(cc_engine* engine) {
+    delete engine;
+}
+
+void cc_engine_seed(cc_engine* engine, uint32_t seed) {
+    if (engine != nullptr) {
+        engine->noise.setSeed(seed);
+    }
+}
+
+const char* cc_engine_last_error(const cc_engine* engine) {
+    // A missing engine has nowhere to store its error, so the message of cc_noise without an engine is static.
+    if (engine == nullptr) {
+        return "Engine is required.";
+    }
+    return engine->error.c_str();
+}
+
+cc_rng* cc_rng_create(uint32_t seed) {
+    try {
+        return new cc_rng{ std::mt19937(seed) };
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void cc_rng_destroy(cc_rng* rng) {
+    delete rng;
+}
+
+void cc_rng_copy(cc_rng* destination, const cc_rng* source) {
+    if (destination != nullptr && source != nullptr) {
+        destination->generator = source->generator;
+    }
+}
+
+cc_status cc_noise(cc_engine* engine, cc_rng* rng, const cc_chain_codes* input, const cc_noise_params* params, cc_output* output, cc_noise_metrics* metrics) {
+    if (engine == nullptr) {
+        return CC_ERROR_ARGUMENT;
+    }
+    engine->error.clear();
+    if (input == nullptr || params == nullptr || output == nullptr) {
+        engine->error = "Input, parameters and output are required.";
+        return CC_ERROR_ARGUMENT;
+    }
+
+    // Exceptions do not cross the C interface.
+    try {
+        return engine->applyNoise(rng, *input, *params, *output, metrics);
+    }
+    catch (const std::logic_error& exception) {
+        engine->error = exception.what();
+        return CC_ERROR_ARGUMENT;
+    }
+    catch (const std::exception& exception) {
+        engine->error = exception.what();
+        return CC_ERROR_INTERNAL;
+    }
+}
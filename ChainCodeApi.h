@@ -0,0 +1,131 @@
+#pragma once
+
+/*
+ * C interface of the noise algorithm for embedding the library without C++ types or text files.
+ *
+ * Chain codes are passed as arrays: the commands of all chain codes one after another, the length and the first
+ * pixel of each chain code. The noisy commands are written into a buffer of the caller; if it is too small, the
+ * required size is returned and the generator is left as it was, so the same call with a larger buffer gives the
+ * same result. Instead of retrying, the caller can provide a reserve function that returns a buffer of the size
+ * that is needed.
+ *
+ * An engine keeps the replacement tables, its generator and the buffers of the previous call, so repeated calls
+ * do not allocate once the buffers are large enough. Separate generators (cc_rng) can be used with one engine.
+ * An engine or generator must not be used by several threads at the same time; different ones can.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#if defined(CHAINCODE_API_EXPORTS)
+#define CHAINCODE_API __declspec(dllexport)
+#elif defined(CHAINCODE_API_STATIC)
+#define CHAINCODE_API
+#else
+#define CHAINCODE_API __declspec(dllimport)
+#endif
+#else
+#define CHAINCODE_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CC_API_VERSION 1
+
+/* Result of a call. */
+typedef enum cc_status {
+    CC_OK = 0,
+    CC_ERROR_ARGUMENT = 1,          /* Invalid argument (see cc_engine_last_error). */
+    CC_ERROR_BUFFER_TOO_SMALL = 2,  /* Output buffer too small (the required size is in written). */
+    CC_ERROR_INTERNAL = 3           /* Unexpected failure (see cc_engine_last_error). */
+} cc_status;
+
+/* Types of the chain codes (values of cc_chain_codes.type). */
+typedef enum cc_type {
+    CC_TYPE_F4 = 0,
+    CC_TYPE_F8 = 1
+} cc_type;
+
+/* Pixel. */
+typedef struct cc_point {
+    int32_t x;
+    int32_t y;
+} cc_point;
+
+/* Chain codes (read only). */
+typedef struct cc_chain_codes {
+    uint32_t type;            /* CC_TYPE_F4 or CC_TYPE_F8 (fixed width, the size of an enum depends on the compiler). */
+    const uint8_t* commands;  /* Commands of all chain codes, one after another. */
+    const size_t* lengths;    /* Number of commands of each chain code. */
+    const cc_point* starts;   /* First pixel of each chain code. */
+    size_t count;             /* Number of chain codes. */
+} cc_chain_codes;
+
+/* Parameters of the noise. */
+typedef struct cc_noise_params {
+    double probability;   /* Probability of the noise [0-1]. */
+    uint32_t iterations;  /* Number of iterations. */
+    uint32_t window;      /* Number of commands replaced at once (2 - pair tables, 3 or 4 - k-gram tables). */
+} cc_noise_params;
+
+/* Buffer of the noisy chain codes (provided by the caller). */
+typedef struct cc_output {
+    uint8_t* commands;  /* Commands of all noisy chain codes, one after another. */
+    size_t capacity;    /* Number of commands that fit into commands. */
+    size_t* lengths;    /* Number of commands of each noisy chain code (count entries of the input). */
+    size_t written;     /* Number of commands written, or required if the buffer is too small (set by the call). */
+
+    /* Optional: called with the required number of commands if the capacity is too small; returns a buffer of at
+       least that size (or NULL to fail with CC_ERROR_BUFFER_TOO_SMALL). */
+    uint8_t* (*reserve)(void* context, size_t size);
+    void* context;
+} cc_output;
+
+/* Metrics of a call. */
+typedef struct cc_noise_metrics {
+    uint64_t input_commands;   /* Number of commands of the input. */
+    uint64_t output_commands;  /* Number of commands of the output. */
+    uint64_t border_pixels;    /* Number of border pixels after the noise. */
+    double seconds;            /* Duration of the call. */
+} cc_noise_metrics;
+
+typedef struct cc_engine cc_engine;
+typedef struct cc_rng cc_rng;
+
+/* Version of the interface (CC_API_VERSION of the library). */
+CHAINCODE_API int cc_api_version(void);
+
+/* Creating an engine with a seeded generator; returns NULL if it cannot be created. */
+CHAINCODE_API cc_engine* cc_engine_create(uint32_t seed);
+
+/* Destroying an engine (NULL is ignored). */
+CHAINCODE_API void cc_engine_destroy(cc_engine* engine);
+
+/* Seeding the generator of an engine (NULL is ignored). */
+CHAINCODE_API void cc_engine_seed(cc_engine* engine, uint32_t seed);
+
+/* Message of the last failed call of the engine (empty if none; valid until the next call). For a NULL engine, the
+   message of the calls that fail because the engine is missing. */
+CHAINCODE_API const char* cc_engine_last_error(const cc_engine* engine);
+
+/* Creating a generator that can be passed to cc_noise instead of the generator of the engine. */
+CHAINCODE_API cc_rng* cc_rng_create(uint32_t seed);
+
+/* Destroying a generator (NULL is ignored). */
+CHAINCODE_API void cc_rng_destroy(cc_rng* rng);
+
+/* Copying the state of a generator (nothing is copied if either is NULL). */
+CHAINCODE_API void cc_rng_copy(cc_rng* destination, const cc_rng* source);
+
+/*
+ * Applying noise to chain codes. The generator of the engine is used if rng is NULL; metrics may be NULL.
+ * The output has the same number of chain codes with the same first pixels.
+ */
+CHAINCODE_API cc_status cc_noise(cc_engine* engine, cc_rng* rng, const cc_chain_codes* input, const cc_noise_params* params, cc_output* output, cc_noise_metrics* metrics);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,467 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <memory>
+#include <unordered_set>
+
+#include "ArithmeticCoder.hpp"
+#include "BorderTiles.hpp"
+#include "ChainCodeApi.h"
+#include "ChainCodeBenchmark.hpp"
+#include "ChainCodeNoise.hpp"
+#include "ChainCodeProfiler.hpp"
+#include "ChainCodeRasterizer.hpp"
+#include "ChainCodeSmoother.hpp"
+#include "ChainCodeValidator.hpp"
+#include "NoiseBranch.hpp"
+#include "NoiseAnalyzer.hpp"
+#include "NoisePipeline.hpp"
+#include "RunLengthChainCode.hpp"
+#include "StreamingNoise.hpp"
+
+
+namespace {
+    // Runs compared by verify: enough iterations and replacements for a checkpoint in the middle of the run.
+    constexpr uint VERIFY_ITERATIONS = 6;
+    constexpr double VERIFY_PROBABILITY = 0.3;
+
+    // Candidate replacement of the self-touching check (as tested by the noise procedure).
+    struct SelfTouchCandidate {
+        ChainCodeType type;
+        Pixel currentPixel;
+        std::vector<short> replacement;
+        std::vector<Pixel> excludedPixels;
+    };
+
+    std::string typeName(const ChainCodeType type) {
+        return type == ChainCodeType::F4 ? "F4" : type == ChainCodeType::F8 ? "F8" : "other";
+    }
+
+    bool sameCommands(const std::vector<ChainCode>& a, const std::vector<ChainCode>& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const ChainCode& x, const ChainCode& y) { return x.code == y.code; });
+    }
+
+    std::string escapeJson(const std::string& text) {
+        std::string escaped;
+        for (const char character : text) {
+            if (character == '"' || character == '\\') {
+                escaped += '\\';
+            }
+            escaped += character;
+        }
+        return escaped;
+    }
+}
+
+
+
+double BenchmarkResult::nsPerSegment() const {
+    return segments > 0 ? medianNs / segments : 0.0;
+}
+
+double BenchmarkResult::segmentsPerSecond() const {
+    return medianNs > 0.0 ? segments * 1e9 / medianNs : 0.0;
+}
+
+void ChainCodeBenchmark::measure(const BenchmarkSettings& settings, const std::function<void()>& prepare, const std::function<void()>& run, BenchmarkResult& result) {
+    // Each run is timed on its own, so the untimed preparation can be interleaved with the runs.
+    auto timeRun = [&]() {
+        prepare();
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Warm-up run calibrates the number of runs per sample.
+    const double estimate = std::max(timeRun(), 1.0);
+    result.runsPerSample = std::max(1u, static_cast<uint>(std::ceil(settings.minSampleSeconds * 1e9 / estimate)));
+
+    std::vector<double> samples;
+    for (uint sample = 0; sample < std::max(settings.samples, 1u); sample++) {
+        double sum = 0.0;
+        for (uint i = 0; i < result.runsPerSample; i++) {
+            sum += timeRun();
+        }
+        samples.push_back(sum / result.runsPerSample);
+    }
+
+    std::sort(samples.begin(), samples.end());
+    result.medianNs = samples.size() % 2 == 1 ? samples[samples.size() / 2] : 0.5 * (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]);
+    result.minNs = samples.front();
+}
+
+std::vector<BenchmarkResult> ChainCodeBenchmark::run(const std::string& file, const BenchmarkSettings& settings) {
+    const std::vector<ChainCode> chainCodes = ChainCodeFunctions::readChainCodeFile(file);
+
+    BenchmarkResult base;
+    base.file = file;
+    base.type = chainCodes.empty() ? "" : typeName(chainCodes[0].type);
+    for (const ChainCode& chainCode : chainCodes) {
+        base.segments += chainCode.code.size();
+    }
+
+    std::vector<BenchmarkResult> results;
+    auto stage = [&](const std::string& name, const double parameter, const std::function<void()>& prepare, const std::function<void()>& run) {
+        BenchmarkResult result = base;
+        result.stage = name;
+        result.parameter = parameter;
+        measure(settings, prepare, run, result);
+        results.push_back(result);
+    };
+    const std::function<void()> nothing = []() {};
+
+    // Parsing and geometry.
+    stage("parse", 0.0, nothing, [&]() {
+        ChainCodeFunctions::readChainCodeFile(file);
+    });
+    stage("coordinates", 0.0, nothing, [&]() {
+        ChainCodeFunctions::calculateCoordinates(chainCodes);
+    });
+
+    // Decoding and bounding box of the plain and the run-length encoded chain codes, with their memory.
+    u64 plainBytes = 0;
+    for (const ChainCode& chainCode : chainCodes) {
+        plainBytes += sizeof(ChainCode) + chainCode.code.capacity() * sizeof(short);
+    }
+    std::vector<RunLengthChainCode> runLengthChainCodes;
+    stage("runLengthEncode", 0.0, nothing, [&]() {
+        runLengthChainCodes.clear();
+        for (const ChainCode& chainCode : chainCodes) {
+            runLengthChainCodes.emplace_back(chainCode);
+        }
+    });
+    u64 runLengthBytes = 0;
+    for (const RunLengthChainCode& chainCode : runLengthChainCodes) {
+        runLengthBytes += chainCode.memoryBytes();
+    }
+    results.back().bytes = runLengthBytes;
+    stage("decode", 0.0, nothing, [&]() {
+        for (const ChainCode& chainCode : chainCodes) {
+            chainCode.toCoordinates();
+        }
+    });
+    results.back().bytes = plainBytes;
+    stage("runLengthDecode", 0.0, nothing, [&]() {
+        for (const RunLengthChainCode& chainCode : runLengthChainCodes) {
+            chainCode.toCoordinates();
+        }
+    });
+    results.back().bytes = runLengthBytes;
+    stage("boundingBox", 0.0, nothing, [&]() {
+        for (const ChainCode& chainCode : chainCodes) {
+            ChainCodeFunctions::extremeCoordinates({ chainCode.toCoordinates() });
+        }
+    });
+    results.back().bytes = plainBytes;
+    stage("runLengthBoundingBox", 0.0, nothing, [&]() {
+        for (const RunLengthChainCode& chainCode : runLengthChainCodes) {
+            chainCode.boundingBox();
+        }
+    });
+    results.back().bytes = runLengthBytes;
+
+    // Symbol statistics of the parsed chain codes and of the file read through a memory mapping.
+    stage("profile", 0.0, nothing, [&]() {
+        ChainCodeProfiler::profile(chainCodes);
+    });
+    results.back().bytes = plainBytes;
+    stage("profileMapped", 0.0, nothing, [&]() {
+        ChainCodeProfiler::profileFile(file);
+    });
+    results.back().bytes = std::filesystem::file_size(file);
+
+    // Adaptive arithmetic coding of each chain code (the model restarts with each one, as in compressedSize).
+    ArithmeticCoder coder(chainCodes.empty() ? ChainCodeType::F4 : chainCodes[0].type);
+    std::vector<std::vector<unsigned char>> encoded(chainCodes.size());
+    stage("arithmeticEncode", 0.0, nothing, [&]() {
+        for (size_t i = 0; i < chainCodes.size(); i++) {
+            encoded[i] = coder.encode(chainCodes[i]);
+        }
+    });
+    u64 encodedBytes = 0;
+    for (const std::vector<unsigned char>& data : encoded) {
+        encodedBytes += data.size();
+    }
+    results.back().bytes = encodedBytes;
+    stage("arithmeticEstimate", 0.0, nothing, [&]() {
+        for (const ChainCode& chainCode : chainCodes) {
+            coder.estimateBits(chainCode);
+        }
+    });
+    results.back().bytes = encodedBytes;
+    stage("arithmeticDecode", 0.0, nothing, [&]() {
+        for (size_t i = 0; i < chainCodes.size(); i++) {
+            coder.decode(encoded[i], chainCodes[i].code.size());
+        }
+    });
+    results.back().bytes = encodedBytes;
+
+    const auto [coordinates, maxXCoordinate, maxYCoordinate] = ChainCodeFunctions::calculateCoordinates(chainCodes);
+    stage("borderSet", 0.0, nothing, [&]() {
+        ChainCodeFunctions::coordinatesToSet(coordinates, maxXCoordinate);
+    });
+
+    std::vector<Pixel> startPixels;
+    for (const std::vector<Pixel>& currentCoordinates : coordinates) {
+        startPixels.push_back(currentCoordinates[0]);
+    }
+    const std::unordered_set<Pixel> borderPixels = ChainCodeFunctions::coordinatesToSet(coordinates, maxXCoordinate);
+
+    // Noise iterations (each run starts from the input, which is copied outside of the measurement).
+    ChainCodeNoise noise(chainCodes);
+    noise.setSeed(settings.seed);
+    noise.setReplacementWindow(settings.replacementWindow);
+    std::vector<ChainCode> noisyChainCodes;
+    std::unordered_set<Pixel> noisyBorderPixels;
+    RepeatedPixels repeatedPixels;
+    repeatedPixels.count(chainCodes, startPixels);
+    auto copyInput = [&]() {
+        noisyChainCodes = chainCodes;
+        noisyBorderPixels = borderPixels;
+        noise.m_RepeatedPixels = repeatedPixels;
+    };
+    for (const double probability : settings.noiseProbabilities) {
+        stage("noiseIteration", probability, copyInput, [&]() {
+            noise.addNoiseIteration(noisyChainCodes, startPixels, noisyBorderPixels, probability);
+        });
+        results.back().bytes = plainBytes;
+    }
+
+    // Smoothing of the output of one noise iteration (made outside of the measurement), comparable to noiseIteration.
+    ChainCodeSmoother smoother;
+    for (const double probability : settings.noiseProbabilities) {
+        copyInput();
+        noise.addNoiseIteration(noisyChainCodes, startPixels, noisyBorderPixels, probability);
+        const std::vector<ChainCode> smoothingInput = noisyChainCodes;
+        const std::unordered_set<Pixel> smoothingBorderPixels = noisyBorderPixels;
+        std::vector<ChainCode> smoothedChainCodes;
+        stage("smoothing", probability, [&]() { noisyBorderPixels = smoothingBorderPixels; }, [&]() {
+            smoothedChainCodes = smoother.smooth(smoothingInput, startPixels, noisyBorderPixels);
+        });
+        results.back().bytes = plainBytes;
+    }
+
+    std::vector<RunLengthChainCode> noisyRunLengthChainCodes;
+    for (const double probability : settings.noiseProbabilities) {
+        stage("runLengthNoise", probability, [&]() { noisyBorderPixels = borderPixels; }, [&]() {
+            noisyRunLengthChainCodes = noise.applyRunLengthNoise(runLengthChainCodes, startPixels, noisyBorderPixels, probability);
+        });
+        results.back().bytes = runLengthBytes;
+    }
+
+    // The same iterations through the C interface, with the input as arrays and a preallocated output buffer (an
+    // iteration at most doubles the commands); the difference to noiseIteration is the cost of a call.
+    std::vector<uint8_t> apiCommands;
+    std::vector<size_t> apiLengths;
+    std::vector<cc_point> apiStarts;
+    for (uint i = 0; i < chainCodes.size(); i++) {
+        apiCommands.insert(apiCommands.end(), chainCodes[i].code.begin(), chainCodes[i].code.end());
+        apiLengths.push_back(chainCodes[i].code.size());
+        apiStarts.push_back({ startPixels[i].x, startPixels[i].y });
+    }
+    std::vector<uint8_t> apiOutput(2 * apiCommands.size());
+    std::vector<size_t> apiOutputLengths(chainCodes.size());
+    const cc_chain_codes apiInput = { !chainCodes.empty() && chainCodes[0].type == ChainCodeType::F8 ? CC_TYPE_F8 : CC_TYPE_F4, apiCommands.data(), apiLengths.data(), apiStarts.data(), apiLengths.size() };
+    const std::unique_ptr<cc_engine, decltype(&cc_engine_destroy)> engine(cc_engine_create(settings.seed), cc_engine_destroy);
+    for (const double probability : settings.noiseProbabilities) {
+        stage("apiNoiseIteration", probability, nothing, [&]() {
+            const cc_noise_params params = { probability, 1, settings.replacementWindow };
+            cc_output output = { apiOutput.data(), apiOutput.size(), apiOutputLengths.data(), 0, nullptr, nullptr };
+            cc_noise(engine.get(), nullptr, &apiInput, &params, &output, nullptr);
+        });
+        results.back().bytes = plainBytes;
+    }
+
+    // Runs of several iterations through the pipeline; depth 1 runs the same iterations one after another.
+    std::vector<u64> traversalStarts;
+    auto copyPipelineInput = [&]() {
+        copyInput();
+        traversalStarts.clear();
+    };
+    for (const uint depth : settings.pipelineDepths) {
+        stage("pipelinedNoise", depth, copyPipelineInput, [&]() {
+            for (uint iteration = 0; iteration < settings.pipelineIterations; iteration += std::max(depth, 1u)) {
+                std::vector<uint> seeds;
+                for (uint i = iteration; i < std::min(iteration + std::max(depth, 1u), settings.pipelineIterations); i++) {
+                    seeds.push_back(settings.seed + i);
+                }
+                NoisePipeline pipeline(noise, noisyChainCodes, startPixels, noisyBorderPixels, traversalStarts, settings.pipelineProbability, seeds);
+                pipeline.run();
+            }
+        });
+    }
+
+    // Self-touching checks of every replacement the pair tables offer for the input.
+    std::vector<SelfTouchCandidate> candidates;
+    for (uint i = 0; i < chainCodes.size(); i++) {
+        const ChainCode& chainCode = chainCodes[i];
+        Pixel currentPixel = startPixels[i];
+        for (size_t j = 0; j + 1 < chainCode.code.size(); j++) {
+            const Pixel nextPixel = ChainCodeFunctions::chainCodeMove(chainCode.type, chainCode.code[j], currentPixel);
+            std::vector<short> replacement = noise.m_LUT.findReplacement(chainCode.type, true, chainCode.code[j], chainCode.code[j + 1]);
+            if (!replacement.empty()) {
+                const Pixel lastPixel = ChainCodeFunctions::chainCodeMove(chainCode.type, chainCode.code[j + 1], nextPixel);
+                candidates.push_back({ chainCode.type, currentPixel, std::move(replacement), { currentPixel, nextPixel, lastPixel } });
+            }
+            currentPixel = nextPixel;
+        }
+    }
+    stage("selfTouchCheck", 0.0, nothing, [&]() {
+        for (const SelfTouchCandidate& candidate : candidates) {
+            noise.wouldNoiseCauseSelfTouchingArea(candidate.type, candidate.currentPixel, candidate.replacement, borderPixels, candidate.excludedPixels, 1);
+        }
+    });
+
+    // Validation of the whole input (bit-packed tiles scanned on all hardware threads).
+    ChainCodeValidator validator;
+    stage("validate", 0.0, nothing, [&]() {
+        validator.validate(chainCodes, startPixels);
+    });
+
+    // Rendering (rasterization into a preallocated image, spatial index of the view).
+    const auto [width, height] = ChainCodeRasterizer::imageSize(maxXCoordinate, maxYCoordinate, 2, 1);
+    std::vector<unsigned char> image(static_cast<size_t>(width) * height);
+    stage("rasterize", 0.0, nothing, [&]() {
+        ChainCodeRasterizer::rasterize(coordinates, maxYCoordinate, 2, 1, image.data(), width, height, width);
+    });
+    stage("tileIndex", 0.0, nothing, [&]() {
+        BorderTiles(coordinates, maxXCoordinate, maxYCoordinate, 50);
+    });
+
+    // Metrics of a noisy version of the input.
+    copyInput();
+    noise.addNoiseIteration(noisyChainCodes, startPixels, noisyBorderPixels, 0.05);
+    const NoiseAnalyzer analyzer(chainCodes);
+    if (base.segments <= settings.maxAnalyzerSegments) {
+        stage("manhattan", 0.0, nothing, [&]() {
+            analyzer.analyzeNoise(noisyChainCodes, NoiseAnalysisType::manhattan);
+        });
+        stage("euclidean", 0.0, nothing, [&]() {
+            analyzer.analyzeNoise(noisyChainCodes, NoiseAnalysisType::euclidean);
+        });
+    }
+    stage("fractalDimension", 0.0, nothing, [&]() {
+        analyzer.fractalDimension(noisyChainCodes);
+    });
+
+    return results;
+}
+
+std::vector<std::string> ChainCodeBenchmark::verify(const std::string& file, const BenchmarkSettings& settings) {
+    const std::vector<ChainCode> chainCodes = ChainCodeFunctions::readChainCodeFile(file);
+    const auto [coordinates, maxXCoordinate, maxYCoordinate] = ChainCodeFunctions::calculateCoordinates(chainCodes);
+    std::vector<Pixel> startPixels;
+    for (const std::vector<Pixel>& currentCoordinates : coordinates) {
+        startPixels.push_back(currentCoordinates[0]);
+    }
+    const std::unordered_set<Pixel> borderPixels = ChainCodeFunctions::coordinatesToSet(coordinates, maxXCoordinate);
+
+    std::vector<std::string> failures;
+    auto check = [&](const std::string& name, const bool passed) {
+        if (!passed) {
+            failures.push_back(name);
+        }
+    };
+    auto configure = [&](ChainCodeNoise& noise) {
+        noise.setSeed(settings.seed);
+        noise.setReplacementWindow(settings.replacementWindow);
+        noise.setConsoleProgress(false);
+    };
+
+    // Uninterrupted run, the reference of the others; its border pixels are those traced from its chain codes.
+    ChainCodeNoise linearNoise(chainCodes);
+    configure(linearNoise);
+    std::unordered_set<Pixel> linearBorderPixels = borderPixels;
+    const std::vector<ChainCode> linear = linearNoise.applyNoise(chainCodes, startPixels, linearBorderPixels, VERIFY_PROBABILITY, VERIFY_ITERATIONS);
+    std::unordered_set<Pixel> tracedBorderPixels;
+    linearNoise.traceBorderPixels(linear, startPixels, tracedBorderPixels);
+    check("border pixels equal the traced border", linearBorderPixels == tracedBorderPixels);
+
+    // Run cancelled after the checkpoint in its middle and resumed from it.
+    const std::string checkpointFile = (std::filesystem::temp_directory_path() / "ChainCodeBenchmark.checkpoint").string();
+    {
+        ChainCodeNoise interruptedNoise(chainCodes);
+        configure(interruptedNoise);
+        interruptedNoise.setCheckpointOutput(checkpointFile, VERIFY_ITERATIONS / 2);
+        NoiseMonitor monitor([&]() {
+            if (monitor.progress().iteration >= VERIFY_ITERATIONS / 2) {
+                monitor.cancel();
+            }
+        }, 0.0);
+        interruptedNoise.setMonitor(&monitor);
+        std::unordered_set<Pixel> interruptedBorderPixels = borderPixels;
+        interruptedNoise.applyNoise(chainCodes, startPixels, interruptedBorderPixels, VERIFY_PROBABILITY, VERIFY_ITERATIONS);
+    }
+    ChainCodeNoise resumedNoise;
+    resumedNoise.setConsoleProgress(false);
+    std::vector<Pixel> resumedStartPixels;
+    std::unordered_set<Pixel> resumedBorderPixels;
+    const std::vector<ChainCode> resumed = resumedNoise.resumeNoise(checkpointFile, resumedStartPixels, resumedBorderPixels);
+    std::filesystem::remove(checkpointFile);
+    check("resumed run equals the uninterrupted run", sameCommands(resumed, linear) && resumedBorderPixels == linearBorderPixels);
+
+    // Runs served by the result cache: the continuation of a cached prefix and the cached whole run.
+    const std::string cacheDirectory = (std::filesystem::temp_directory_path() / "ChainCodeBenchmark.cache").string();
+    std::filesystem::remove_all(cacheDirectory);
+    {
+        const auto cache = std::make_shared<NoiseResultCache>(cacheDirectory);
+        for (const uint iterations : { VERIFY_ITERATIONS / 2, VERIFY_ITERATIONS, VERIFY_ITERATIONS }) {
+            ChainCodeNoise cachedNoise(chainCodes);
+            configure(cachedNoise);
+            cachedNoise.setResultCache(cache);
+            std::unordered_set<Pixel> cachedBorderPixels = borderPixels;
+            const std::vector<ChainCode> cached = cachedNoise.applyNoise(chainCodes, startPixels, cachedBorderPixels, VERIFY_PROBABILITY, iterations);
+            if (iterations == VERIFY_ITERATIONS) {
+                check("cached run equals the uncached run", sameCommands(cached, linear) && cachedBorderPixels == linearBorderPixels);
+            }
+        }
+    }
+    std::filesystem::remove_all(cacheDirectory);
+
+    // Runs of streamNoise: over the file with paged border pixels and over the shared chunks of a branch.
+    const std::string streamedFile = (std::filesystem::temp_directory_path() / "ChainCodeBenchmark.streamed").string();
+    {
+        ChainCodeNoise streamedNoise(chainCodes);
+        configure(streamedNoise);
+        StreamingNoise(streamedNoise, 1 << 24, 1 << 16).run(file, streamedFile, VERIFY_PROBABILITY, VERIFY_ITERATIONS);
+    }
+    const std::vector<ChainCode> streamed = ChainCodeFunctions::readChainCodeFile(streamedFile);
+    std::filesystem::remove(streamedFile);
+    check("streamed run equals the plain run", sameCommands(streamed, linear));
+
+    const auto branchNoise = std::make_shared<ChainCodeNoise>(chainCodes);
+    configure(*branchNoise);
+    NoiseBranch root(branchNoise, chainCodes, startPixels, borderPixels, settings.seed);
+    root.run(VERIFY_PROBABILITY, VERIFY_ITERATIONS / 2);
+    NoiseBranch branch = root.fork();
+    branch.run(VERIFY_PROBABILITY, VERIFY_ITERATIONS - VERIFY_ITERATIONS / 2);
+    check("forked branch equals the plain run", sameCommands(branch.chainCodes(), linear));
+
+    return failures;
+}
+
+void ChainCodeBenchmark::writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+    out << "file,type,segments,stage,parameter,runsPerSample,medianNs,minNs,nsPerSegment,bytes,segmentsPerSecond\n";
+    for (const BenchmarkResult& result : results) {
+        out << "\"" << result.file << "\"," << result.type << "," << result.segments << "," << result.stage << "," << result.parameter << ","
+            << result.runsPerSample << "," << std::fixed << std::setprecision(1) << result.medianNs << "," << result.minNs << ","
+            << std::setprecision(3) << result.nsPerSegment() << std::defaultfloat << std::setprecision(6) << "," << result.bytes << ","
+            << std::fixed << std::setprecision(0) << result.segmentsPerSecond() << std::defaultfloat << std::setprecision(6) << "\n";
+    }
+}
+
+void ChainCodeBenchmark::writeJson(std::ostream& out, const BenchmarkSettings& settings, const std::vector<BenchmarkResult>& results) {
+    out << "{\n  \"settings\": { \"replacementWindow\": " << settings.replacementWindow << ", \"minSampleSeconds\": " << settings.minSampleSeconds
+        << ", \"samples\": " << settings.samples << ", \"seed\": " << settings.seed << " },\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    { \"file\": \"" << escapeJson(result.file) << "\", \"type\": \"" << result.type << "\", \"segments\": " << result.segments
+            << ", \"stage\": \"" << result.stage << "\", \"parameter\": " << result.parameter << ", \"runsPerSample\": " << result.runsPerSample
+            << std::fixed << std::setprecision(1) << ", \"medianNs\": " << result.medianNs << ", \"minNs\": " << result.minNs
+            << std::setprecision(3) << ", \"nsPerSegment\": " << result.nsPerSegment() << std::defaultfloat << std::setprecision(6) << ", \"bytes\": " << result.bytes
+            << std::fixed << std::setprecision(0) << ", \"segmentsPerSecond\": " << result.segmentsPerSecond() << std::defaultfloat << std::setprecision(6) << " }";
+    }
+    out << "\n  ]\n}\n";
+}
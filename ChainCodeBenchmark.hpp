@@ -0,0 +1,109 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+
+
+/// <summary>
+/// Settings of a benchmark run.
+/// </summary>
+struct BenchmarkSettings {
+    std::vector<double> noiseProbabilities = { 0.01, 0.05, 0.2 };  // Probabilities of the measured noise iterations.
+    uint replacementWindow = 2;           // Number of commands replaced at once.
+    std::vector<uint> pipelineDepths = { 1, 8 };  // Depths of the measured pipelined runs (1 - iterations one after another).
+    uint pipelineIterations = 16;         // Number of iterations of a pipelined run.
+    double pipelineProbability = 0.05;    // Probability of the noise of the pipelined runs.
+    double minSampleSeconds = 0.02;       // Minimal duration of a sample (the number of runs per sample is calibrated).
+    uint samples = 5;                     // Number of samples of each stage (the median is reported).
+    u64 maxAnalyzerSegments = 20000;      // Larger inputs skip the distance metrics (their cost is quadratic).
+    uint seed = 1;                        // Seed of the noise generator.
+};
+
+
+/// <summary>
+/// Measured stage of the pipeline on one input.
+/// </summary>
+struct BenchmarkResult {
+    std::string file;            // Path to the input file.
+    std::string type;            // Type of the chain codes (F4 or F8).
+    u64 segments = 0;            // Number of commands of the input.
+    std::string stage;           // Name of the stage.
+    double parameter = 0.0;      // Parameter of the stage (noise probability, pipeline depth, otherwise 0).
+    uint runsPerSample = 0;      // Number of runs in each sample.
+    double medianNs = 0.0;       // Median time of a run in nanoseconds.
+    double minNs = 0.0;          // Shortest time of a run in nanoseconds.
+    u64 bytes = 0;               // Memory of the chain code representation used by the stage (0 - not measured).
+
+    /// <summary>
+    /// Median time of a run per command.
+    /// </summary>
+    /// <returns>Nanoseconds per segment</returns>
+    double nsPerSegment() const;
+
+    /// <summary>
+    /// Throughput of the stage (commands processed per second of the median run).
+    /// </summary>
+    /// <returns>Segments per second</returns>
+    double segmentsPerSecond() const;
+};
+
+
+
+/// <summary>
+/// Benchmark of the stages of the pipeline (parsing, coordinates, profiling of the symbols in memory and from a
+/// mapped file, arithmetic coding, noise iterations, self-touching checks, rendering and metrics), with the
+/// run-length encoded counterparts of decoding and noise, the smoothing of a noise iteration and the noise through
+/// the C interface. Each stage is run repeatedly: the number of runs per sample is calibrated to the minimal sample
+/// duration, and the median of several samples is reported.
+/// </summary>
+class ChainCodeBenchmark {
+private:
+    /// <summary>
+    /// Measuring a stage. The preparation is run before each run and is not measured.
+    /// </summary>
+    /// <param name="settings">: settings of the benchmark</param>
+    /// <param name="prepare">: preparation of a run (e.g. copying the input that the run modifies)</param>
+    /// <param name="run">: measured run</param>
+    /// <param name="result">: result with the measured times (output)</param>
+    static void measure(const BenchmarkSettings& settings, const std::function<void()>& prepare, const std::function<void()>& run, BenchmarkResult& result);
+
+public:
+    /// <summary>
+    /// Measuring all stages on a chain code file.
+    /// </summary>
+    /// <param name="file">: path to the chain code file</param>
+    /// <param name="settings">: settings of the benchmark</param>
+    /// <returns>Result of each stage</returns>
+    static std::vector<BenchmarkResult> run(const std::string& file, const BenchmarkSettings& settings);
+
+    /// <summary>
+    /// Checking that the variants of a seeded run on a chain code file give the chain codes of the plain run: the
+    /// border pixels of the run must equal those traced from its result, and a run interrupted after a checkpoint
+    /// and resumed, a run continued from a cached prefix, a run served by the cache, a streamed run of the file and a
+    /// run of a forked branch must equal the plain one.
+    /// </summary>
+    /// <param name="file">: path to the chain code file</param>
+    /// <param name="settings">: settings of the benchmark (seed and replacement window)</param>
+    /// <returns>Descriptions of the failed checks (empty if all passed)</returns>
+    static std::vector<std::string> verify(const std::string& file, const BenchmarkSettings& settings);
+
+    /// <summary>
+    /// Writing the results as a CSV table.
+    /// </summary>
+    /// <param name="out">: output stream</param>
+    /// <param name="results">: benchmark results</param>
+    static void writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results);
+
+    /// <summary>
+    /// Writing the results as a JSON document (with the settings of the run).
+    /// </summary>
+    /// <param name="out">: output stream</param>
+    /// <param name="settings">: settings of the benchmark</param>
+    /// <param name="results">: benchmark results</param>
+    static void writeJson(std::ostream& out, const BenchmarkSettings& settings, const std::vector<BenchmarkResult>& results);
+};
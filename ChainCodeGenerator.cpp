@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "ChainCodeGenerator.hpp"
+
+
+namespace {
+    constexpr size_t WRITE_BLOCK = 1 << 20;  // Size of the blocks written into the file.
+    constexpr int CONTOUR_GAP = 4;           // Horizontal gap between neighbouring contours.
+    constexpr int HILBERT_PITCH = 4;         // Distance between the centres of neighbouring Hilbert cells.
+    constexpr int HILBERT_HALF_WIDTH = 1;    // Half width of the thickened Hilbert curve (gaps are 4 - 2 * 1 = 2 pixels).
+    constexpr int MINKOWSKI_SEGMENT = 2;     // Shortest segment of a Minkowski island.
+    constexpr int MONOTONE_COLUMN = 2;       // Width of a column of a monotone polygon.
+
+    // Moves of the F4 directions.
+    constexpr int DX[4] = { 1, 0, -1, 0 };
+    constexpr int DY[4] = { 0, 1, 0, -1 };
+
+    // Direction of a unit step between two pixels (F4 numbering).
+    short stepDirection(const Pixel& from, const Pixel& to) {
+        return to.x > from.x ? 0 : to.y > from.y ? 1 : to.x < from.x ? 2 : 3;
+    }
+
+    // Cell of the Hilbert curve of the given side at the given distance along the curve.
+    Pixel hilbertCell(const u64 side, u64 distance) {
+        u64 x = 0;
+        u64 y = 0;
+        for (u64 size = 1; size < side; size *= 2) {
+            const u64 rx = 1 & (distance / 2);
+            const u64 ry = 1 & (distance ^ rx);
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = size - 1 - x;
+                    y = size - 1 - y;
+                }
+                std::swap(x, y);
+            }
+            x += size * rx;
+            y += size * ry;
+            distance /= 4;
+        }
+        return Pixel(static_cast<int>(x), static_cast<int>(y));
+    }
+
+    // SplitMix64 hash (random heights are accessed in both directions, so they are hashed from their index).
+    u64 hash(u64 value) {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    // Drawing a side of a Minkowski island (F -> F+F-F-FF+F+F-F, '+' turns left).
+    void minkowskiSide(ContourWriter& writer, const uint level, const u64 segment, short& direction) {
+        if (level == 0) {
+            writer.move(direction, segment);
+            return;
+        }
+
+        static const char RULE[] = "F+F-F-FF+F+F-F";
+        for (const char* symbol = RULE; *symbol != '\0'; symbol++) {
+            if (*symbol == 'F') {
+                minkowskiSide(writer, level - 1, segment, direction);
+            }
+            else {
+                direction = (direction + (*symbol == '+' ? 1 : 3)) % 4;
+            }
+        }
+    }
+}
+
+
+
+void ContourWriter::write(const short command, const u64 count) {
+    m_Buffer.append(count, static_cast<char>('0' + command));
+    m_Commands += count;
+    if (m_Buffer.size() >= WRITE_BLOCK) {
+        flush();
+    }
+}
+
+void ContourWriter::flushRun(const short nextDirection) {
+    if (nextDirection == (m_Direction + 2) % 4) {
+        throw std::logic_error("Contour reverses its direction.");
+    }
+
+    if (m_Type == ChainCodeType::F4) {
+        write(m_Direction, m_Length);
+        return;
+    }
+
+    // Both ends of an F8 run are replaced by the diagonals of its corners.
+    if (m_Length < 2) {
+        throw std::logic_error("Runs of F8 contours must be at least 2 pixels long.");
+    }
+    write(2 * m_Direction, m_Length - 2);
+    write(nextDirection == (m_Direction + 1) % 4 ? 2 * m_Direction + 1 : (2 * m_Direction + 7) % 8, 1);
+}
+
+ContourWriter::ContourWriter(std::ofstream& out, const ChainCodeType type) :
+    m_Out(out),
+    m_Type(type)
+{
+    if (type != ChainCodeType::F4 && type != ChainCodeType::F8) {
+        throw std::logic_error("Only F4 and F8 contours can be generated.");
+    }
+    m_Buffer.reserve(WRITE_BLOCK + WRITE_BLOCK / 2);
+}
+
+void ContourWriter::begin(const Pixel& origin) {
+    m_Origin = origin;
+    m_Position = origin;
+    m_FirstDirection = -1;
+    m_Direction = -1;
+    m_Length = 0;
+}
+
+void ContourWriter::move(const short direction, const u64 length) {
+    if (length == 0) {
+        return;
+    }
+
+    if (direction == m_Direction) {
+        m_Length += length;
+    }
+    else {
+        if (m_Direction < 0) {
+            // F8 contour starts after the first move, which is cut by the diagonal of the closing corner.
+            m_FirstDirection = direction;
+            const Pixel start = m_Type == ChainCodeType::F8 ? Pixel(m_Origin.x + DX[direction], m_Origin.y + DY[direction]) : m_Origin;
+            m_Buffer += ChainCodeFunctions::typeToString(m_Type) + ";CW;" + std::to_string(start.x) + "," + std::to_string(-start.y) + ";0;";
+        }
+        else {
+            flushRun(direction);
+        }
+        m_Direction = direction;
+        m_Length = length;
+    }
+
+    m_Position.x += static_cast<int>(DX[direction] * static_cast<int64_t>(length));
+    m_Position.y += static_cast<int>(DY[direction] * static_cast<int64_t>(length));
+}
+
+void ContourWriter::end() {
+    if (!(m_Position == m_Origin) || m_Direction == m_FirstDirection) {
+        throw std::logic_error("Contour must be closed at a corner.");
+    }
+
+    flushRun(m_FirstDirection);
+    m_Buffer += '\n';
+    m_Direction = -1;
+}
+
+void ContourWriter::flush() {
+    m_Out.write(m_Buffer.data(), m_Buffer.size());
+    m_Buffer.clear();
+    if (!m_Out) {
+        throw std::logic_error("Chain code file cannot be written.");
+    }
+}
+
+ChainCodeType ContourWriter::type() const {
+    return m_Type;
+}
+
+Pixel ContourWriter::origin() const {
+    return m_Origin;
+}
+
+u64 ContourWriter::commandCount() const {
+    return m_Commands;
+}
+
+
+
+uint ChainCodeGenerator::hilbert(ContourWriter& writer, const Pixel& origin, const u64 symbols) {
+    // Each cell adds about two pitches of outline (one on each side of the curve), F8 loses about 1.6 commands to corners.
+    const double cellCommands = writer.type() == ChainCodeType::F8 ? 2 * HILBERT_PITCH - 1.6 : 2 * HILBERT_PITCH;
+    const u64 cells = std::max<u64>(2, static_cast<u64>(symbols / cellCommands));
+    u64 side = 1;
+    while (side * side < cells) {
+        side *= 2;
+    }
+
+    // Outline is the offset (to the right) of the closed walk along the curve and back, which turns around at both ends.
+    const u64 walkLength = 2 * (cells - 1);
+    auto walkCell = [&](const u64 index) {
+        const Pixel cell = hilbertCell(side, index < cells ? index : walkLength - index);
+        return Pixel(origin.x + HILBERT_HALF_WIDTH + HILBERT_PITCH * cell.x, origin.y + HILBERT_HALF_WIDTH + HILBERT_PITCH * cell.y);
+    };
+
+    Pixel position;
+    auto moveTo = [&](const Pixel& target) {
+        if (target.x != position.x) {
+            writer.move(target.x > position.x ? 0 : 2, std::abs(target.x - position.x));
+        }
+        else {
+            writer.move(target.y > position.y ? 1 : 3, std::abs(target.y - position.y));
+        }
+        position = target;
+    };
+
+    Pixel previous = walkCell(walkLength - 1);
+    Pixel current = walkCell(0);
+    for (u64 i = 0; i < walkLength; i++) {
+        const Pixel next = walkCell((i + 1) % walkLength);
+        const short in = stepDirection(previous, current);
+        const short out = stepDirection(current, next);
+        const short rightIn = (in + 3) % 4;
+        const short rightOut = (out + 3) % 4;
+
+        if (out == (in + 2) % 4) {
+            // Turning around: the outline goes around the end of the curve.
+            const Pixel first(current.x + HILBERT_HALF_WIDTH * (DX[rightIn] + DX[in]), current.y + HILBERT_HALF_WIDTH * (DY[rightIn] + DY[in]));
+            const Pixel second(current.x + HILBERT_HALF_WIDTH * (DX[in] + DX[rightOut]), current.y + HILBERT_HALF_WIDTH * (DY[in] + DY[rightOut]));
+            if (i == 0) {
+                writer.begin(first);
+                position = first;
+            }
+            else {
+                moveTo(first);
+            }
+            moveTo(second);
+        }
+        else if (out != in) {
+            moveTo(Pixel(current.x + HILBERT_HALF_WIDTH * (DX[rightIn] + DX[rightOut]), current.y + HILBERT_HALF_WIDTH * (DY[rightIn] + DY[rightOut])));
+        }
+
+        previous = current;
+        current = next;
+    }
+    moveTo(writer.origin());
+    writer.end();
+
+    return static_cast<uint>(HILBERT_PITCH * side);
+}
+
+uint ChainCodeGenerator::minkowski(ContourWriter& writer, const Pixel& origin, const u64 symbols, uint level) {
+    // Outline of level L consists of 4 * 8^L segments; almost every segment ends with a corner, which costs F8 a command.
+    const u64 cornerCommands = writer.type() == ChainCodeType::F8 ? 1 : 0;
+    if (level == 0) {
+        while (4 * (MINKOWSKI_SEGMENT - cornerCommands) * (u64(8) << (3 * level)) <= symbols && level < 20) {
+            level++;
+        }
+    }
+    const u64 segments = 4 * (u64(1) << (3 * level));
+    const u64 segment = std::max<u64>(MINKOWSKI_SEGMENT, symbols / segments + cornerCommands);
+
+    // Bumps reach at most a third of the side out of the base square.
+    const u64 side = segment << (2 * level);
+    const int margin = static_cast<int>(side / 3 + 1);
+    writer.begin(Pixel(origin.x + margin, origin.y + margin));
+
+    short direction = 0;
+    for (uint i = 0; i < 4; i++) {
+        minkowskiSide(writer, level, segment, direction);
+        direction = (direction + 1) % 4;
+    }
+    writer.end();
+
+    return static_cast<uint>(side + 2 * margin);
+}
+
+uint ChainCodeGenerator::monotone(ContourWriter& writer, const Pixel& origin, const u64 symbols, const uint levels, const u64 seed) {
+    // Top chain lies above and bottom chain below the middle, so the polygon is connected for any heights.
+    const uint heightLevels = std::max(levels, 1u);
+    const int middle = 2 * static_cast<int>(heightLevels) + 2;
+    auto top = [&](const u64 column) {
+        return origin.y + middle + 2 + 2 * static_cast<int>(hash(seed ^ (2 * column)) % heightLevels);
+    };
+    auto bottom = [&](const u64 column) {
+        return origin.y + middle - 2 - 2 * static_cast<int>(hash(seed ^ (2 * column + 1)) % heightLevels);
+    };
+
+    // Expected length of a column: two horizontal runs and two height changes (F8 cuts the two corners of each change).
+    const double meanSteps = 4.0 * (static_cast<double>(heightLevels) * heightLevels - 1) / (3.0 * heightLevels);
+    const double cutCorners = writer.type() == ChainCodeType::F8 ? 4.0 * (heightLevels - 1) / heightLevels : 0.0;
+    const u64 columns = std::max<u64>(2, static_cast<u64>(symbols / (2 * MONOTONE_COLUMN + meanSteps - cutCorners)));
+
+    // Bottom chain from the left to the right, top chain back.
+    writer.begin(Pixel(origin.x, bottom(0)));
+    int height = bottom(0);
+    for (u64 column = 0; column < columns; column++) {
+        const int nextHeight = column + 1 < columns ? bottom(column + 1) : top(column);
+        writer.move(0, MONOTONE_COLUMN);
+        writer.move(nextHeight > height ? 1 : 3, std::abs(nextHeight - height));
+        height = nextHeight;
+    }
+    for (u64 column = columns; column-- > 0;) {
+        const int nextHeight = column > 0 ? top(column - 1) : bottom(0);
+        writer.move(2, MONOTONE_COLUMN);
+        writer.move(nextHeight > height ? 1 : 3, std::abs(nextHeight - height));
+        height = nextHeight;
+    }
+    writer.end();
+
+    return static_cast<uint>(MONOTONE_COLUMN * columns + 1);
+}
+
+u64 ChainCodeGenerator::generate(const std::string& file, const GeneratorSettings& settings) {
+    std::ofstream out(file, std::ios_base::binary | std::ios_base::trunc);
+    if (!out.is_open()) {
+        throw std::logic_error("File could not be created.");
+    }
+    out << "CC Multi\n";
+
+    // Contours are placed side by side, each with an equal share of the commands.
+    ContourWriter writer(out, settings.type);
+    const uint contours = std::max(settings.contours, 1u);
+    const u64 symbols = settings.symbols / contours;
+    int x = 0;
+    for (uint i = 0; i < contours; i++) {
+        const Pixel origin(x, 0);
+        uint width = 0;
+        if (settings.family == ContourFamily::hilbert) {
+            width = hilbert(writer, origin, symbols);
+        }
+        else if (settings.family == ContourFamily::minkowski) {
+            width = minkowski(writer, origin, symbols, settings.complexity);
+        }
+        else {
+            width = monotone(writer, origin, symbols, settings.complexity == 0 ? 8 : settings.complexity, hash(settings.seed + i));
+        }
+        x += static_cast<int>(width) + CONTOUR_GAP;
+    }
+    writer.flush();
+
+    return writer.commandCount();
+}
+
+ContourFamily ChainCodeGenerator::stringToFamily(const std::string& name) {
+    if (name == "hilbert") {
+        return ContourFamily::hilbert;
+    }
+    else if (name == "minkowski") {
+        return ContourFamily::minkowski;
+    }
+    else if (name == "monotone") {
+        return ContourFamily::monotone;
+    }
+    throw std::logic_error("Unknown contour family.");
+}
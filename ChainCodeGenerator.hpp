@@ -0,0 +1,165 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Family of generated contours.
+/// </summary>
+enum class ContourFamily {
+    hilbert,    // Outline of a thickened Hilbert curve (space-filling, maximal curvature).
+    minkowski,  // Minkowski island (quadratic Koch fractal outline); complexity is the recursion level (0 - automatic).
+    monotone    // Random x-monotone polygon; complexity is the number of height levels of its top and bottom.
+};
+
+
+/// <summary>
+/// Settings of the generator.
+/// </summary>
+struct GeneratorSettings {
+    ContourFamily family = ContourFamily::hilbert;
+    ChainCodeType type = ChainCodeType::F8;  // F4 or F8.
+    u64 symbols = 1000000;                   // Requested total number of commands (approximate).
+    uint contours = 1;                       // Number of contours (placed side by side).
+    uint complexity = 0;                     // Family specific complexity (see ContourFamily).
+    uint seed = 1;                           // Seed of random families.
+};
+
+
+
+/// <summary>
+/// Writer of a closed contour, given as a sequence of axis-parallel runs, into a CC Multi file.
+/// F4 contours are written as they are; F8 contours have every corner cut by a diagonal command, so no two
+/// non-consecutive pixels touch. Commands are buffered and written in large blocks.
+/// </summary>
+class ContourWriter {
+private:
+    std::ofstream& m_Out;           // Output file.
+    ChainCodeType m_Type;           // Type of the written chain codes.
+    std::string m_Buffer;           // Commands that were not written yet.
+    Pixel m_Origin;                 // First corner of the contour.
+    Pixel m_Position;               // End of the current run.
+    short m_FirstDirection = -1;    // Direction of the first run (F4 numbering, -1 before the first run).
+    short m_Direction = -1;         // Direction of the current run.
+    u64 m_Length = 0;               // Length of the current run.
+    u64 m_Commands = 0;             // Number of commands written for all contours.
+
+    /// <summary>
+    /// Appending commands to the buffer (the buffer is written when it is full).
+    /// </summary>
+    /// <param name="command">: chain code command</param>
+    /// <param name="count">: number of repetitions</param>
+    void write(const short command, const u64 count);
+
+    /// <summary>
+    /// Writing the current run, which is followed by a run in the given direction.
+    /// </summary>
+    /// <param name="nextDirection">: direction of the following run</param>
+    void flushRun(const short nextDirection);
+
+public:
+    /// <summary>
+    /// Constructor of the contour writer (the file header is written by the generator).
+    /// </summary>
+    /// <param name="out">: output file</param>
+    /// <param name="type">: type of the written chain codes (F4 or F8)</param>
+    ContourWriter(std::ofstream& out, const ChainCodeType type);
+
+    /// <summary>
+    /// Starting a contour at a corner.
+    /// </summary>
+    /// <param name="origin">: first corner of the contour</param>
+    void begin(const Pixel& origin);
+
+    /// <summary>
+    /// Moving along the contour (moves in the same direction are merged into one run; runs must be at least 2 pixels long).
+    /// </summary>
+    /// <param name="direction">: direction of the move (F4 numbering)</param>
+    /// <param name="length">: number of pixels</param>
+    void move(const short direction, const u64 length);
+
+    /// <summary>
+    /// Closing the contour (the last run must end at the origin, in a different direction than the first run).
+    /// </summary>
+    void end();
+
+    /// <summary>
+    /// Writing the buffered commands.
+    /// </summary>
+    void flush();
+
+    /// <summary>
+    /// Type of the written chain codes.
+    /// </summary>
+    ChainCodeType type() const;
+
+    /// <summary>
+    /// First corner of the current contour.
+    /// </summary>
+    Pixel origin() const;
+
+    /// <summary>
+    /// Number of commands of all finished contours.
+    /// </summary>
+    u64 commandCount() const;
+};
+
+
+
+/// <summary>
+/// Generator of large, valid (closed, simple and non-self-touching) F4 and F8 chain codes for scalability tests.
+/// Contours are produced run by run and streamed into the file, so no contour is kept in memory.
+/// </summary>
+class ChainCodeGenerator {
+private:
+    /// <summary>
+    /// Writing the outline of a thickened prefix of the Hilbert curve.
+    /// </summary>
+    /// <param name="writer">: contour writer</param>
+    /// <param name="origin">: lower left cell of the curve</param>
+    /// <param name="symbols">: requested number of commands</param>
+    /// <returns>Width of the contour</returns>
+    static uint hilbert(ContourWriter& writer, const Pixel& origin, const u64 symbols);
+
+    /// <summary>
+    /// Writing a Minkowski island.
+    /// </summary>
+    /// <param name="writer">: contour writer</param>
+    /// <param name="origin">: lower left corner of the island's base square</param>
+    /// <param name="symbols">: requested number of commands</param>
+    /// <param name="level">: recursion level (0 - the highest level with segments of at least 2 pixels)</param>
+    /// <returns>Width of the contour</returns>
+    static uint minkowski(ContourWriter& writer, const Pixel& origin, const u64 symbols, uint level);
+
+    /// <summary>
+    /// Writing a random x-monotone polygon.
+    /// </summary>
+    /// <param name="writer">: contour writer</param>
+    /// <param name="origin">: lower left corner of the polygon's bounding box</param>
+    /// <param name="symbols">: requested number of commands</param>
+    /// <param name="levels">: number of height levels of the top and the bottom chain</param>
+    /// <param name="seed">: seed of the heights</param>
+    /// <returns>Width of the contour</returns>
+    static uint monotone(ContourWriter& writer, const Pixel& origin, const u64 symbols, const uint levels, const u64 seed);
+
+public:
+    /// <summary>
+    /// Generating a chain code file.
+    /// </summary>
+    /// <param name="file">: path to the output file (CC Multi format)</param>
+    /// <param name="settings">: settings of the generator</param>
+    /// <returns>Number of generated commands</returns>
+    static u64 generate(const std::string& file, const GeneratorSettings& settings);
+
+    /// <summary>
+    /// Parsing the name of a contour family (hilbert, minkowski, monotone).
+    /// </summary>
+    /// <param name="name">: name of the family</param>
+    /// <returns>Contour family</returns>
+    static ContourFamily stringToFamily(const std::string& name);
+};
@@ -1,17 +1,46 @@
+#include <algorithm>
 #include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <QPainter>
-#include <QImage>
-#include <QGraphicsScene>
-#include <QDir>
+#include <memory>
 #include <sstream>
 
+#include "ArithmeticCoder.hpp"
 #include "ChainCodeNoise.hpp"
+#include "ChainCodeRasterizer.hpp"
+#include "ChainCodeProfiler.hpp"
 #include "NoiseAnalyzer.hpp"
 
 
-ChainCode ChainCodeNoise::addNoiseToChainCode(const ChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const uint numberOfIterations) {
+namespace {
+    /// <summary>
+    /// Pointer member that refers to an object of a running noise application. It is reset when the run ends, also
+    /// by an exception, so the engine can be reused (daemon workers, API handles) without a dangling pointer.
+    /// </summary>
+    template<typename T>
+    class RunPointer {
+    private:
+        T*& m_Pointer;
+
+    public:
+        RunPointer(T*& pointer, T* value) :
+            m_Pointer(pointer)
+        {
+            m_Pointer = value;
+        }
+
+        ~RunPointer() {
+            m_Pointer = nullptr;
+        }
+
+        RunPointer(const RunPointer&) = delete;
+        RunPointer& operator=(const RunPointer&) = delete;
+    };
+}
+
+
+ChainCode ChainCodeNoise::addNoiseToChainCode(const ChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const uint numberOfIterations, const NoiseProbabilityField* field, const double weight) {
     ChainCode noisyChainCode = chainCode;
 
     Pixel previousPixel = startPixel;
@@ -21,72 +50,663 @@ ChainCode ChainCodeNoise::addNoiseToChainCode(const ChainCode& chainCode, const
         // Getting the sequence of chain code orders.
         const short first = noisyChainCode.code[i];
         const short second = noisyChainCode.code[i + 1];
+        NOISE_COUNT(commands);
 
-        // Calculation of a random number within the range [0, 1] (noise probability).
+        // Calculation of a random number within the range [0, 1] (noise probability, of the field at the current pixel if given).
+        NOISE_PHASE_BEGIN(sampling);
         const double randomNumber = m_Random(m_Generator);
+        const double probability = field == nullptr ? noiseProbability : weight * field->probability(currentPixel);
+        NOISE_PHASE_END(sampling);
 
         // If a random number is within noise probability range, we manipulate the chain code.
-        if (randomNumber < noiseProbability) {
+        if (randomNumber < probability) {
+            NOISE_COUNT(candidates);
+
             // Searching the replacement code in the lookup table.
+            NOISE_PHASE_BEGIN(lookup);
             const bool firstTable = m_Random(m_Generator) < 0.5 ? true : false;
             //const bool firstTable = false;
             const std::vector<short>& replacement = m_LUT.findReplacement(noisyChainCode.type, firstTable, first, second);
+            NOISE_PHASE_END(lookup);
                 
-            // If a combination should not exist, we don't touch shite and move on.
+            // If a combination should not exist, we don't touch shite and move on (past the command, as without noise).
             if (replacement.empty()) {
-                continue;
+                NOISE_COUNT(emptyReplacements);
             }
-                
-            // Creating a vector of excluded pixels in self-touching areas check procedure
-            // (replacement pixel should always touch previous, current and next pixel).
-            const Pixel excludedPixel1 = currentPixel;
-            const Pixel excludedPixel2 = ChainCodeFunctions::chainCodeMove(noisyChainCode.type, first, excludedPixel1);
-            const Pixel excludedPixel3 = ChainCodeFunctions::chainCodeMove(noisyChainCode.type, second, excludedPixel2);
-            const std::vector<Pixel> excludedPixels({ excludedPixel1, excludedPixel2, excludedPixel3 });
-
-            if (excludedPixel2 == startPixel) {
-                //continue;
+            else {
+                // Creating a vector of excluded pixels in self-touching areas check procedure
+                // (replacement pixel should always touch previous, current and next pixel).
+                NOISE_PHASE_BEGIN(selfTouchCheck);
+                const Pixel excludedPixel1 = currentPixel;
+                const Pixel excludedPixel2 = ChainCodeFunctions::chainCodeMove(noisyChainCode.type, first, excludedPixel1);
+                const Pixel excludedPixel3 = ChainCodeFunctions::chainCodeMove(noisyChainCode.type, second, excludedPixel2);
+                const std::vector<Pixel> excludedPixels({ excludedPixel1, excludedPixel2, excludedPixel3 });
+
+                if (excludedPixel2 == startPixel) {
+                    //continue;
+                }
+
+                // Checking whether replacement chain code segment would introduce any self-touching areas.
+                // If there would be no self-touching areas, we praise the Lord and make some NOISE!
+                const bool selfTouching = wouldNoiseCauseSelfTouchingArea(noisyChainCode.type, currentPixel, replacement, borderPixels, excludedPixels, 1);
+                NOISE_PHASE_END(selfTouchCheck);
+                if (!selfTouching) {
+                //if (!wouldNoiseCauseSelfTouchingArea(noisyChainCode.type, Pixel(3, 1), replacement, borderPixels, excludedPixels, 1)) {
+                    NOISE_COUNT(accepted);
+
+                    // Calculating previous and current pixel sequences from chain code segments.
+                    NOISE_PHASE_BEGIN(splice);
+                    const std::vector<Pixel> previousPixels = chainCodeSegmentToPixels(noisyChainCode.type, currentPixel, std::vector<short>({ noisyChainCode.code.begin() + i, noisyChainCode.code.begin() + i + 2 }));
+                    const std::vector<Pixel> newPixels = chainCodeSegmentToPixels(noisyChainCode.type, currentPixel, replacement);
+
+                    if (m_Journal != nullptr) {
+                        m_Journal->recordReplacement(i, firstTable, &noisyChainCode.code[i]);
+                    }
+
+                    // Replacing the original chain code segment with the noisy one.
+                    noisyChainCode.code.erase(noisyChainCode.code.begin() + i, noisyChainCode.code.begin() + i + 2);
+                    noisyChainCode.code.insert(noisyChainCode.code.begin() + i, replacement.begin(), replacement.end());
+                    NOISE_PHASE_END(splice);
+
+                    // Erasing obsolete pixels and introducing new pixels to the set of border pixels.
+                    NOISE_PHASE_BEGIN(borderUpdate);
+                    for (const Pixel& previousPixel : previousPixels) {
+                        removeBorderPixel(borderPixels, previousPixel);
+                    }
+                    for (const Pixel& newPixel : newPixels) {
+                        addBorderPixel(borderPixels, newPixel);
+                        i++;  // Moving past the introduced noise.
+                    }
+                    NOISE_PHASE_END(borderUpdate);
+
+                    //for (uint i = 0; i < noisyChainCode.code.size(); i++) {
+                    //    std::cout << noisyChainCode.code[i];
+                    //}
+                    //std::cout << std::endl;
+
+                    // Current pixel is set to the last value of the noisy chain code segment.
+                    currentPixel = newPixels.back();
+                }
+                else {
+                    NOISE_COUNT(selfTouchRejections);
+                }
             }
+        }
+
+        // Moving in the right direction.
+        previousPixel = currentPixel;
+        currentPixel = ChainCodeFunctions::chainCodeMove(noisyChainCode.type, noisyChainCode.code[i], currentPixel);
+    }
+
+    return noisyChainCode;
+}
+
+ChainCode ChainCodeNoise::addKGramNoiseToChainCode(const ChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const NoiseProbabilityField* field, const double weight) {
+    ChainCode noisyChainCode = chainCode;
+    const uint windowSize = m_ReplacementWindow;
+
+    Pixel currentPixel = startPixel;
+    std::vector<Pixel> windowPixels(windowSize + 1);
+    std::vector<Pixel> newPixels;
+    newPixels.reserve(KGRAM_MAX_REPLACEMENT - 1);
 
-            // Checking whether replacement chain code segment would introduce any self-touching areas.
-            // If there would be no self-touching areas, we praise the Lord and make some NOISE!
-            if (!wouldNoiseCauseSelfTouchingArea(noisyChainCode.type, currentPixel, replacement, borderPixels, excludedPixels,01)) {
-            //if (!wouldNoiseCauseSelfTouchingArea(noisyChainCode.type, Pixel(3, 1), replacement, borderPixels, excludedPixels, 1)) {
-                // Calculating previous and current pixel sequences from chain code segments.
-                const std::vector<Pixel> previousPixels = chainCodeSegmentToPixels(noisyChainCode.type, currentPixel, std::vector<short>({ noisyChainCode.code.begin() + i, noisyChainCode.code.begin() + i + 2 }));
-                const std::vector<Pixel> newPixels = chainCodeSegmentToPixels(noisyChainCode.type, currentPixel, replacement);
-
-                // Replacing the original chain code segment with the noisy one.
-                noisyChainCode.code.erase(noisyChainCode.code.begin() + i, noisyChainCode.code.begin() + i + 2);
-                noisyChainCode.code.insert(noisyChainCode.code.begin() + i, replacement.begin(), replacement.end());
-
-                // Erasing obsolete pixels and introducing new pixels to the set of border pixels.
-                for (const Pixel& previousPixel : previousPixels) {
-                    borderPixels.erase(previousPixel);
+    for (size_t i = 0; i + windowSize <= noisyChainCode.code.size(); i++) {
+        NOISE_COUNT(commands);
+        NOISE_PHASE_BEGIN(sampling);
+        const double randomNumber = m_Random(m_Generator);
+        const double probability = field == nullptr ? noiseProbability : weight * field->probability(currentPixel);
+        NOISE_PHASE_END(sampling);
+
+        // If a random number is within noise probability range, we replace the window starting at the current pixel.
+        if (randomNumber < probability) {
+            NOISE_COUNT(candidates);
+            NOISE_PHASE_BEGIN(lookup);
+            const bool firstTable = m_Random(m_Generator) < 0.5;
+            const KGramReplacement& replacement = m_LUT.findReplacement(noisyChainCode.type, firstTable, &noisyChainCode.code[i], windowSize);
+            NOISE_PHASE_END(lookup);
+
+            if (replacement.length == 0) {
+                NOISE_COUNT(emptyReplacements);
+            }
+            else {
+                // All pixels of the window are excluded from the self-touching check (the replacement always touches them).
+                NOISE_PHASE_BEGIN(selfTouchCheck);
+                windowPixels[0] = currentPixel;
+                for (uint j = 0; j < windowSize; j++) {
+                    windowPixels[j + 1] = ChainCodeFunctions::chainCodeMove(noisyChainCode.type, noisyChainCode.code[i + j], windowPixels[j]);
                 }
-                for (const Pixel& newPixel : newPixels) {
-                    borderPixels.insert(newPixel);
-                    i++;  // Moving past the introduced noise.
+
+                // New pixels are obtained from the precomputed footprint of the replacement.
+                newPixels.clear();
+                for (uint j = 0; j + 1 < replacement.length; j++) {
+                    newPixels.emplace_back(currentPixel.x + replacement.footprint[j][0], currentPixel.y + replacement.footprint[j][1]);
                 }
 
-                //for (uint i = 0; i < noisyChainCode.code.size(); i++) {
-                //    std::cout << noisyChainCode.code[i];
-                //}
-                //std::cout << std::endl;
+                const bool selfTouching = wouldPixelsCauseSelfTouchingArea(noisyChainCode.type, newPixels, borderPixels, windowPixels, 1);
+                NOISE_PHASE_END(selfTouchCheck);
 
-                // Current pixel is set to the last value of the noisy chain code segment.
-                currentPixel = newPixels.back();
+                if (selfTouching) {
+                    NOISE_COUNT(selfTouchRejections);
+                }
+                else {
+                    NOISE_COUNT(accepted);
+                    NOISE_PHASE_BEGIN(splice);
+                    if (m_Journal != nullptr) {
+                        m_Journal->recordReplacement(static_cast<uint>(i), firstTable, &noisyChainCode.code[i]);
+                    }
+
+                    // Replacing the original window with the noisy one.
+                    noisyChainCode.code.erase(noisyChainCode.code.begin() + i, noisyChainCode.code.begin() + i + windowSize);
+                    noisyChainCode.code.insert(noisyChainCode.code.begin() + i, replacement.code, replacement.code + replacement.length);
+                    NOISE_PHASE_END(splice);
+
+                    // Erasing inner pixels of the window and introducing new pixels to the set of border pixels.
+                    NOISE_PHASE_BEGIN(borderUpdate);
+                    for (uint j = 1; j < windowSize; j++) {
+                        removeBorderPixel(borderPixels, windowPixels[j]);
+                    }
+                    for (const Pixel& newPixel : newPixels) {
+                        addBorderPixel(borderPixels, newPixel);
+                    }
+                    NOISE_PHASE_END(borderUpdate);
+
+                    // Moving past the introduced noise (current pixel is the last new pixel).
+                    i += replacement.length - 1;
+                    currentPixel = newPixels.back();
+                }
             }
         }
 
         // Moving in the right direction.
-        previousPixel = currentPixel;
         currentPixel = ChainCodeFunctions::chainCodeMove(noisyChainCode.type, noisyChainCode.code[i], currentPixel);
     }
 
     return noisyChainCode;
 }
 
+RunLengthChainCode ChainCodeNoise::addNoiseToRunLengthChainCode(const RunLengthChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const NoiseProbabilityField* field, const double weight) {
+    RunLengthChainCode noisyChainCode = chainCode.emptyCopy();
+    const std::vector<ChainCodeRun>& runs = chainCode.runs();
+    const ChainCodeType type = chainCode.type();
+    const uint windowSize = m_ReplacementWindow;
+    const u64 size = chainCode.size();
+
+    // Read position in the original chain code: command offset of the run, its index and its pixel.
+    size_t run = 0;
+    u64 offset = 0;
+    u64 position = 0;
+    Pixel currentPixel = startPixel;
+
+    // Moving the read position by a number of commands (a run at a time), optionally copying them.
+    const auto advance = [&](u64 count, const bool copy) {
+        while (count > 0) {
+            const ChainCodeRun& current = runs[run];
+            const u64 taken = std::min<u64>(count, current.length - offset);
+            if (copy) {
+                noisyChainCode.append(current.command, taken);
+            }
+            currentPixel = RunLengthChainCode::moveRun(type, current.command, taken, currentPixel);
+            offset += taken;
+            position += taken;
+            count -= taken;
+            if (offset == current.length) {
+                run++;
+                offset = 0;
+            }
+        }
+    };
+
+    // Every command is a candidate if the probability is 1 (the distribution is defined for probabilities in (0, 1)).
+    const bool everyCommand = noiseProbability >= 1.0;
+    std::geometric_distribution<u64> skips(everyCommand || noiseProbability <= 0.0 ? 0.5 : noiseProbability);
+    short window[KGRAM_MAX_WINDOW];
+    std::vector<short> replacement;
+    std::vector<Pixel> windowPixels(windowSize + 1);
+    std::vector<Pixel> newPixels;
+
+    size_t boundRun = runs.size();  // Run of the bound of the field.
+    double bound = 0.0;
+
+    while (position + windowSize <= size) {
+        if (field == nullptr) {
+            // Commands before the next candidate are the failures of Bernoulli trials with the noise probability.
+            if (noiseProbability <= 0.0) {
+                break;
+            }
+            const u64 skip = everyCommand ? 0 : skips(m_Generator);
+            if (skip > size - windowSize - position) {
+                break;
+            }
+            advance(skip, true);
+        }
+        else {
+            // Trials in the rest of the run use the bound of the field along it, and a candidate is kept with the
+            // ratio of the probability at its pixel to the bound (thinning). Runs in zero blocks cost no draw.
+            const ChainCodeRun& current = runs[run];
+            const u64 remaining = std::min<u64>(current.length - offset, size - windowSize - position + 1);
+            if (boundRun != run) {
+                const Pixel step = RunLengthChainCode::moveRun(type, current.command, 1, Pixel(0, 0));
+                bound = weight > 0.0 ? weight * field->maxProbability(currentPixel, step.x, step.y, current.length - offset - 1) : 0.0;
+                boundRun = run;
+            }
+            const u64 skip = bound <= 0.0 ? remaining : bound >= 1.0 ? 0 : std::geometric_distribution<u64>(bound)(m_Generator);
+            if (skip >= remaining) {
+                advance(remaining, true);
+                continue;
+            }
+            advance(skip, true);
+            if (m_Random(m_Generator) * bound >= weight * field->probability(currentPixel)) {
+                advance(1, true);
+                continue;
+            }
+        }
+        NOISE_COUNT(candidates);
+
+        // Commands and pixels of the window (it spans at most windowSize runs).
+        windowPixels[0] = currentPixel;
+        size_t windowRun = run;
+        u64 windowOffset = offset;
+        for (uint j = 0; j < windowSize; j++) {
+            window[j] = runs[windowRun].command;
+            windowPixels[j + 1] = ChainCodeFunctions::chainCodeMove(type, window[j], windowPixels[j]);
+            if (++windowOffset == runs[windowRun].length) {
+                windowRun++;
+                windowOffset = 0;
+            }
+        }
+
+        // Searching the replacement and checking the self-touching areas as the procedures of ChainCode do.
+        NOISE_PHASE_BEGIN(lookup);
+        const bool firstTable = m_Random(m_Generator) < 0.5;
+        bool selfTouching = false;
+        if (windowSize == 2) {
+            replacement = m_LUT.findReplacement(type, firstTable, window[0], window[1]);
+            NOISE_PHASE_END(lookup);
+            if (!replacement.empty()) {
+                NOISE_PHASE_BEGIN(selfTouchCheck);
+                newPixels = chainCodeSegmentToPixels(type, currentPixel, replacement);
+                selfTouching = wouldNoiseCauseSelfTouchingArea(type, currentPixel, replacement, borderPixels, windowPixels, 1);
+                NOISE_PHASE_END(selfTouchCheck);
+            }
+        }
+        else {
+            const KGramReplacement& kGram = m_LUT.findReplacement(type, firstTable, window, windowSize);
+            NOISE_PHASE_END(lookup);
+            replacement.assign(kGram.code, kGram.code + kGram.length);
+            if (!replacement.empty()) {
+                NOISE_PHASE_BEGIN(selfTouchCheck);
+                newPixels.clear();
+                for (uint j = 0; j + 1 < kGram.length; j++) {
+                    newPixels.emplace_back(currentPixel.x + kGram.footprint[j][0], currentPixel.y + kGram.footprint[j][1]);
+                }
+                selfTouching = wouldPixelsCauseSelfTouchingArea(type, newPixels, borderPixels, windowPixels, 1);
+                NOISE_PHASE_END(selfTouchCheck);
+            }
+        }
+
+        if (replacement.empty() || selfTouching) {
+            if (replacement.empty()) {
+                NOISE_COUNT(emptyReplacements);
+            }
+            else {
+                NOISE_COUNT(selfTouchRejections);
+            }
+            advance(1, true);
+            continue;
+        }
+        NOISE_COUNT(accepted);
+
+        // The replacement splits the run it falls into; the window is skipped in the original chain code.
+        NOISE_PHASE_BEGIN(splice);
+        for (const short command : replacement) {
+            noisyChainCode.append(command);
+        }
+        advance(windowSize, false);
+        NOISE_PHASE_END(splice);
+
+        // Erasing inner pixels of the window and introducing new pixels to the set of border pixels.
+        NOISE_PHASE_BEGIN(borderUpdate);
+        for (uint j = 1; j < windowSize; j++) {
+            removeBorderPixel(borderPixels, windowPixels[j]);
+        }
+        for (const Pixel& newPixel : newPixels) {
+            addBorderPixel(borderPixels, newPixel);
+        }
+        NOISE_PHASE_END(borderUpdate);
+    }
+
+    // Copying the rest of the chain code.
+    advance(size - position, true);
+
+    return noisyChainCode;
+}
+
+bool ChainCodeNoise::addNoiseIteration(std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const NoiseProbabilityField* field, NoiseMonitor* monitor) {
+    bool complete = true;
+    for (uint i = 0; i < chainCodes.size(); i++) {
+        if (m_Statistics != nullptr) {
+            m_Statistics->setCurrentChain(i);
+        }
+        if (m_Journal != nullptr) {
+            m_Journal->beginChain(i);
+        }
+
+        NOISE_PHASE_BEGIN(chain);
+        const double weight = field != nullptr ? field->contourWeight(i) : 1.0;
+        if (m_ReplacementWindow == 2) {
+            chainCodes[i] = addNoiseToChainCode(chainCodes[i], startPixels[i], borderPixels, noiseProbability, 1, field, weight);
+        }
+        else {
+            chainCodes[i] = addKGramNoiseToChainCode(chainCodes[i], startPixels[i], borderPixels, noiseProbability, field, weight);
+        }
+        NOISE_PHASE_END(chain);
+
+        if (m_Instrumentation != nullptr) {
+            m_Instrumentation->recordChain(i);
+        }
+
+        // A cancelled iteration stops between chain codes, so the finished ones are complete in all outputs.
+        if (monitor != nullptr) {
+            monitor->publishChain(i + 1, static_cast<uint>(chainCodes.size()));
+            if (monitor->isCancelled() && i + 1 < chainCodes.size()) {
+                complete = false;
+                break;
+            }
+        }
+    }
+
+    if (m_Instrumentation != nullptr) {
+        m_Instrumentation->endIteration();
+    }
+
+    if (m_Journal != nullptr) {
+        m_Journal->endIteration(chainCodes);
+    }
+
+    return complete;
+}
+
+void ChainCodeNoise::addBorderPixel(std::unordered_set<Pixel>& borderPixels, const Pixel& pixel) {
+    if (m_RepeatedPixels.insert(borderPixels, pixel)) {
+        pixelAdded(pixel);
+    }
+}
+
+void ChainCodeNoise::removeBorderPixel(std::unordered_set<Pixel>& borderPixels, const Pixel& pixel) {
+    if (m_RepeatedPixels.erase(borderPixels, pixel)) {
+        pixelRemoved(pixel);
+    }
+}
+
+void ChainCodeNoise::pixelAdded(const Pixel& pixel) {
+    if (m_Statistics != nullptr) {
+        m_Statistics->addPixel(pixel);
+    }
+    if (m_Monitor != nullptr) {
+        m_Monitor->addPixel(pixel);
+    }
+}
+
+void ChainCodeNoise::pixelRemoved(const Pixel& pixel) {
+    if (m_Statistics != nullptr) {
+        m_Statistics->removePixel(pixel);
+    }
+    if (m_Monitor != nullptr) {
+        m_Monitor->removePixel(pixel);
+    }
+}
+
+void ChainCodeNoise::checkChainCodeTypes(const std::vector<ChainCode>& chainCodes) const {
+    // Replacement tables exist for absolute chain codes only.
+    for (const ChainCode& chainCode : chainCodes) {
+        if (chainCode.type != ChainCodeType::F4 && chainCode.type != ChainCodeType::F8) {
+            throw std::logic_error("Noise can only be applied to F4 and F8 chain codes.");
+        }
+    }
+}
+
+std::string ChainCodeNoise::generatorState() const {
+    std::ostringstream state;
+    state << m_Generator;
+    return state.str();
+}
+
+void ChainCodeNoise::setGeneratorState(const std::string& state) {
+    std::istringstream(state) >> m_Generator;
+    m_Random.reset();
+}
+
+void ChainCodeNoise::traceBorderPixels(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels) const {
+    borderPixels.clear();
+    for (size_t i = 0; i < chainCodes.size(); i++) {
+        Pixel pixel = startPixels[i];
+        borderPixels.insert(pixel);
+        for (const short direction : chainCodes[i].code) {
+            pixel = ChainCodeFunctions::chainCodeMove(chainCodes[i].type, direction, pixel);
+            borderPixels.insert(pixel);
+        }
+    }
+}
+
+std::vector<ChainCode> ChainCodeNoise::runNoise(NoiseCheckpoint& state, std::unordered_set<Pixel>& borderPixels, const bool resumed) {
+    std::vector<ChainCode>& noisyChainCodes = state.chainCodes;
+    const std::vector<Pixel>& startPixels = state.startPixels;
+
+    // Pixels visited more than once stay on the border until their last visit is replaced, so the border pixels
+    // remain those traced from the chain codes (a resumed or continued run traces them and goes on identically).
+    m_RepeatedPixels.count(noisyChainCodes, startPixels);
+
+    // Pipelined iterations only exist together, so there is no state to write after each of them.
+    if (m_PipelineDepth > 0 && (!m_ProfileFile.empty() || !m_CompressionFile.empty() || !m_ValidationFile.empty() || !m_JournalFile.empty() || !m_InstrumentationFile.empty())) {
+        throw std::logic_error("Per-iteration outputs are not available with the noise pipeline.");
+    }
+
+    // Outputs of a resumed run are cut at the checkpoint (rows of unfinished iterations are dropped) and continued.
+    auto openOutput = [resumed](std::ofstream& out, const std::string& file, const u64 size) {
+        if (resumed) {
+            std::filesystem::resize_file(file, size);
+            out.open(file, std::ios_base::app);
+        }
+        else {
+            out.open(file, std::ios_base::trunc);
+        }
+    };
+
+    // Symbol statistics are written once per iteration, starting with the input chain codes.
+    std::ofstream profileOut;
+    if (!m_ProfileFile.empty()) {
+        openOutput(profileOut, m_ProfileFile, state.profileSize);
+        if (!resumed) {
+            ChainCodeProfiler::writeHeader(profileOut);
+            ChainCodeProfiler::writeRow(profileOut, 0, ChainCodeProfiler::profile(noisyChainCodes));
+        }
+    }
+
+    // Compressed size is estimated in encode-only mode, so no bits are actually produced.
+    std::ofstream compressionOut;
+    ArithmeticCoder coder(noisyChainCodes.empty() ? ChainCodeType::F8 : noisyChainCodes[0].type, m_CompressionOrder);
+    auto writeCompressionRow = [&](const uint iteration) {
+        const CompressionReport report = coder.compressedSize(noisyChainCodes);
+        compressionOut << iteration << "," << static_cast<u64>(report.totalBits()) << "," << report.bitsPerSymbol() << "\n";
+    };
+    if (!m_CompressionFile.empty()) {
+        openOutput(compressionOut, m_CompressionFile, state.compressionSize);
+        if (!resumed) {
+            compressionOut << "iteration,bits,bitsPerSymbol\n";
+            writeCompressionRow(0);
+        }
+    }
+
+    // Validation counts the violations of the whole result, independently of the checks of the noise procedures.
+    std::ofstream validationOut;
+    ChainCodeValidator validator;
+    auto writeValidationRow = [&](const uint iteration) {
+        const ValidationReport report = validator.validate(noisyChainCodes, startPixels);
+        validationOut << iteration << "," << report.pixels << "," << report.invalidCommands << "," << report.openContours << ","
+                      << report.repeatedPixels << "," << report.selfTouches << "," << report.contourContacts << "\n";
+    };
+    if (!m_ValidationFile.empty()) {
+        openOutput(validationOut, m_ValidationFile, state.validationSize);
+        if (!resumed) {
+            validationOut << "iteration,pixels,invalidCommands,openContours,repeatedPixels,selfTouches,contourContacts\n";
+            writeValidationRow(0);
+        }
+    }
+
+    // Accepted replacements are journaled by the noise procedures.
+    std::unique_ptr<NoiseJournalWriter> journal;
+    if (!m_JournalFile.empty()) {
+        if (resumed) {
+            journal = std::make_unique<NoiseJournalWriter>(m_JournalFile, noisyChainCodes[0].type, m_ReplacementWindow, m_JournalInterval, state.iteration, state.journalSize);
+        }
+        else {
+            journal = std::make_unique<NoiseJournalWriter>(m_JournalFile, noisyChainCodes, m_ReplacementWindow, m_JournalInterval);
+        }
+    }
+    const RunPointer<NoiseJournalWriter> journalPointer(m_Journal, journal.get());
+
+    // Checkpoints are encoded and written in the background, the run only copies its state.
+    std::unique_ptr<NoiseCheckpointWriter> checkpointWriter;
+    uint checkpointIteration = state.iteration;  // Iteration of the last written checkpoint.
+    auto writeCheckpoint = [&]() {
+        // Outputs are flushed, so the stored sizes refer to data that is already written.
+        if (profileOut.is_open()) {
+            state.profileSize = static_cast<u64>(profileOut.flush().tellp());
+        }
+        if (compressionOut.is_open()) {
+            state.compressionSize = static_cast<u64>(compressionOut.flush().tellp());
+        }
+        if (validationOut.is_open()) {
+            state.validationSize = static_cast<u64>(validationOut.flush().tellp());
+        }
+        if (journal != nullptr) {
+            state.journalSize = journal->size();
+        }
+
+        NoiseCheckpoint checkpoint = state;
+        checkpoint.generatorState = generatorState();
+        checkpointWriter->submit(std::move(checkpoint));
+        checkpointIteration = state.iteration;
+    };
+    if (!m_CheckpointFile.empty()) {
+        checkpointWriter = std::make_unique<NoiseCheckpointWriter>(m_CheckpointFile);
+    }
+
+    // Counters of the noise procedures are recorded per chain code and written at the end of the run.
+    std::unique_ptr<NoiseInstrumentation> instrumentation;
+    if (!m_InstrumentationFile.empty()) {
+        instrumentation = std::make_unique<NoiseInstrumentation>(state.iteration);
+    }
+    const RunPointer<NoiseInstrumentation> instrumentationPointer(m_Instrumentation, instrumentation.get());
+
+    // Metrics are buffered by the store, which writes them in blocks; a resumed run starts a new run id.
+    const uint metricsRun = m_Metrics != nullptr ? m_Metrics->beginRun() : 0;
+    if (m_Metrics != nullptr && !resumed) {
+        analyzeNoise(noisyChainCodes, metricsRun, state, 0, 0.0);
+    }
+
+    // Frames are only copied by the run; a resumed run starts a new export on the canvas of its current state.
+    std::unique_ptr<NoiseFrameExporter> frameExporter;
+    m_FrameExportReport = FrameExportReport();
+    if (!m_FrameExport.output.empty()) {
+        frameExporter = std::make_unique<NoiseFrameExporter>(m_FrameExport, noisyChainCodes, startPixels);
+        frameExporter->submit(state.iteration, noisyChainCodes);
+    }
+
+    const uint numberOfIterations = state.numberOfIterations;
+    // Cancellation is checked after each chain code; an iteration that is cut short is recorded like a finished one,
+    // so a cancelled run ends in a consistent state (the pipeline only stops between its passes).
+    while (state.iteration < numberOfIterations && (m_Monitor == nullptr || !m_Monitor->isCancelled())) {
+        const uint iteration = state.iteration;
+        auto start = std::chrono::high_resolution_clock::now();
+
+        // Pipelined iterations are run in passes of the pipeline depth, each iteration with its own random stream.
+        const uint passIterations = m_PipelineDepth > 0 ? std::min(m_PipelineDepth, numberOfIterations - iteration) : 1;
+        std::vector<u64> passCommandCounts;
+        if (m_PipelineDepth > 0) {
+            std::vector<uint> seeds(passIterations);
+            for (uint& seed : seeds) {
+                seed = m_Generator();
+            }
+            NoisePipeline pipeline(*this, noisyChainCodes, startPixels, borderPixels, state.traversalStarts, state.noiseProbability, seeds);
+            passCommandCounts = pipeline.run();
+        }
+        else {
+            addNoiseIteration(noisyChainCodes, startPixels, borderPixels, state.noiseProbability, m_Field, m_Monitor);
+        }
+
+        uint segmentCount = 0;
+        for (const ChainCode& chainCode : noisyChainCodes) {
+            segmentCount += chainCode.code.size();
+        }
+
+        // Time is measured in seconds with full resolution, so iterations of small shapes do not round to zero.
+        const double iterationSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        if (m_ConsoleProgress) {
+            std::cout << "Progress: " << iteration + passIterations << "/" << numberOfIterations << ", Number of CC: " << segmentCount << " (" << iterationSeconds << " s), " << (iterationSeconds > 0.0 ? segmentCount / iterationSeconds : 0.0) << std::endl;
+        }
+
+        if (passCommandCounts.empty()) {
+            state.commandCounts.push_back(segmentCount);
+        }
+        else {
+            state.commandCounts.insert(state.commandCounts.end(), passCommandCounts.begin(), passCommandCounts.end());
+        }
+
+        if (profileOut.is_open()) {
+            ChainCodeProfiler::writeRow(profileOut, iteration + 1, ChainCodeProfiler::profile(noisyChainCodes));
+        }
+        if (compressionOut.is_open()) {
+            writeCompressionRow(iteration + 1);
+        }
+        if (validationOut.is_open()) {
+            writeValidationRow(iteration + 1);
+        }
+
+        if (frameExporter != nullptr) {
+            frameExporter->submit(iteration + passIterations, noisyChainCodes);
+        }
+        if (m_Metrics != nullptr) {
+            analyzeNoise(noisyChainCodes, metricsRun, state, iteration + passIterations, iterationSeconds);
+        }
+
+        state.iteration += passIterations;
+        const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        state.seconds += seconds;
+
+        if (m_Monitor != nullptr) {
+            NoiseProgress progress;
+            progress.iteration = state.iteration;
+            progress.numberOfIterations = numberOfIterations;
+            progress.chainCount = static_cast<uint>(noisyChainCodes.size());
+            progress.segmentCount = segmentCount;
+            progress.segmentsPerSecond = seconds > 0.0 ? segmentCount / seconds : 0.0;
+            m_Monitor->publish(progress);
+        }
+
+        if (checkpointWriter != nullptr && state.iteration / m_CheckpointInterval != iteration / m_CheckpointInterval) {
+            writeCheckpoint();
+        }
+    }
+
+    // The final state (also of a cancelled run) is always checkpointed, and a failed write is reported.
+    if (checkpointWriter != nullptr) {
+        if (checkpointIteration != state.iteration) {
+            writeCheckpoint();
+        }
+        checkpointWriter->finish();
+    }
+
+    if (instrumentation != nullptr) {
+        instrumentation->write(m_InstrumentationFile);
+    }
+    if (frameExporter != nullptr) {
+        m_FrameExportReport = frameExporter->finish();
+    }
+
+    return noisyChainCodes;
+}
+
 std::vector<Pixel> ChainCodeNoise::chainCodeSegmentToPixels(const ChainCodeType& type, const Pixel& startPixel, const std::vector<short>& sequence) {
     std::vector<Pixel> pixels;
     
@@ -112,15 +732,12 @@ std::vector<Pixel> ChainCodeNoise::chainCodeSegmentToPixels(const ChainCodeType&
 }
 
 bool ChainCodeNoise::wouldNoiseCauseSelfTouchingArea(const ChainCodeType& type, const Pixel& startPixel, const std::vector<short>& noiseSequence, const std::unordered_set<Pixel>& borderPixels, const std::vector<Pixel>& excludedPixels, const int vicinity) {
-    // Last order is pruned in order to prevent to check a pixel that is already a part of a chain code.
-    const std::vector<short> prunedNoiseSequence({ noiseSequence.begin(), noiseSequence.end() - 1 });
-
-    // Moving the pixel according to the order sequence.
-    Pixel currentPixel = startPixel;
-    for (const short direction : prunedNoiseSequence) {
-        // Movement of a pixel.
-        currentPixel = ChainCodeFunctions::chainCodeMove(type, direction, currentPixel);
+    // Last pixel of the sequence is already a part of the chain code, so it is pruned by chainCodeSegmentToPixels.
+    return wouldPixelsCauseSelfTouchingArea(type, chainCodeSegmentToPixels(type, startPixel, noiseSequence), borderPixels, excludedPixels, vicinity);
+}
 
+bool ChainCodeNoise::wouldPixelsCauseSelfTouchingArea(const ChainCodeType& type, const std::vector<Pixel>& newPixels, const std::unordered_set<Pixel>& borderPixels, const std::vector<Pixel>& excludedPixels, const int vicinity) {
+    for (const Pixel& currentPixel : newPixels) {
         // Checking the vicinity of the pixel.
         for (int y = -vicinity; y <= vicinity; y++) {
             for (int x = -vicinity; x <= vicinity; x++) {
@@ -132,12 +749,14 @@ bool ChainCodeNoise::wouldNoiseCauseSelfTouchingArea(const ChainCodeType& type,
                 const Pixel checkPixel(currentPixel.x + x, currentPixel.y + y);
 
                 // If the pixel is in the list of excluded pixels, we continue our journey.
-                if (checkPixel == excludedPixels[0] || checkPixel == excludedPixels[1] || checkPixel == excludedPixels[2]) {
+                if (std::find(excludedPixels.begin(), excludedPixels.end(), checkPixel) != excludedPixels.end()) {
                     continue;
                 }
+
                 // If a pixel in the vicinity is found, our journey is over, as we stumbled upon
                 // a self-touching area. According to some sources, self-touching is bad.
-                else if (borderPixels.find(checkPixel) != borderPixels.end()) {
+                NOISE_COUNT(selfTouchProbes);
+                if (borderPixels.find(checkPixel) != borderPixels.end()) {
                     return true;
                 }
             }
@@ -149,51 +768,33 @@ bool ChainCodeNoise::wouldNoiseCauseSelfTouchingArea(const ChainCodeType& type,
 }
 
 void ChainCodeNoise::saveChainCodeImage(const std::vector<ChainCode>& chainCodes, const uint iteration, const std::string name, const uint probability) {
-    // Transforming chain codes into coordinates.
-    const auto& [coordinates, maxXCoordinate, maxYCoordinate] = ChainCodeFunctions::calculateCoordinates(chainCodes);
-
-    // Drawing the coordinates on PixMap.
+    // Drawing the coordinates directly into an image buffer.
     const uint scale = 2;
     const uint padding = 1;
-    QPixmap pix(scale * (maxXCoordinate + 2 * padding), scale * (maxYCoordinate + 2 * padding));
-    pix.fill(QColor("white"));
-    QPainter paint(&pix);
-    paint.setPen(QColor(0, 0, 0, 255));
-    for (const std::vector<Pixel>& currentCoordinates : coordinates) {
-        for (const Pixel& coordinate : currentCoordinates) {
-            paint.drawRect(scale * (coordinate.x + padding), scale * (maxYCoordinate - (coordinate.y) + padding), 1, 1);
-        }
-    }
+    const RasterImage image = ChainCodeRasterizer::rasterize(chainCodes, scale, padding);
 
     std::stringstream ss;
-    ss << "./Test/";
-    QDir().mkdir(QString::fromUtf8(ss.str()));
-    ss << name << "/";
-    QDir().mkdir(QString::fromUtf8(ss.str()));
-    ss << probability << "/";
-    QDir().mkdir(QString::fromUtf8(ss.str()));
+    ss << "./Test/" << name << "/" << probability << "/";
+    std::filesystem::create_directories(ss.str());
     ss << name << iteration + 1 << ".png";
-    pix.toImage().save(QString::fromUtf8(ss.str()));
+    ChainCodeRasterizer::writePng(ss.str(), image);
 }
 
-void ChainCodeNoise::analyzeNoise(const std::vector<ChainCode>& noisyChainCodes, const uint iteration, const std::string& name, const uint probability) const {
-    // Noise analysis.
-    NoiseAnalyzer noiseAnalyzer(m_OriginalChainCodes);
-    //const double averageDistance = noiseAnalyzer.analyzeNoise(noisyChainCodes, NoiseAnalysisType::euclidean);
-    //std::cout << "Average distance after " << iteration + 1 << " iterations: " << averageDistance << std::endl;
-    const double fractalDimension = noiseAnalyzer.fractalDimension(noisyChainCodes);
-    std::cout << "Fractal dimension after " << iteration + 1 << " iterations: " << fractalDimension << std::endl;
-    
-    std::stringstream ss;
-    ss << "./Test/";
-    QDir().mkdir(QString::fromUtf8(ss.str()));
-    ss << name << "/";
-    QDir().mkdir(QString::fromUtf8(ss.str()));
-    ss << probability << "/" << name << ".csv";
+void ChainCodeNoise::analyzeNoise(const std::vector<ChainCode>& noisyChainCodes, const uint run, const NoiseCheckpoint& state, const uint iteration, const double seconds) {
+    // The analyzer keeps a copy of the original chain codes, so it is created once and shared by the copies of this object.
+    if (m_Analyzer == nullptr) {
+        m_Analyzer = std::make_shared<const NoiseAnalyzer>(m_OriginalChainCodes);
+    }
 
-    std::ofstream out(ss.str(), std::ios_base::app);
-    //out << averageDistance << ",";
-    out << fractalDimension << ",";
+    u64 commands = 0;
+    for (const ChainCode& chainCode : noisyChainCodes) {
+        commands += chainCode.code.size();
+    }
+    m_Metrics->append(run, state.name, state.noiseProbability, iteration, "commands", static_cast<double>(commands));
+    if (!noisyChainCodes.empty()) {
+        m_Metrics->append(run, state.name, state.noiseProbability, iteration, "fractalDimension", m_Analyzer->fractalDimension(noisyChainCodes));
+    }
+    m_Metrics->append(run, state.name, state.noiseProbability, iteration, "seconds", seconds);
 }
 
 
@@ -206,10 +807,137 @@ ChainCodeNoise::ChainCodeNoise(const std::vector<ChainCode>& originalChainCodes)
 
 ChainCodeNoise& ChainCodeNoise::operator=(const ChainCodeNoise& chainCodeNoise) {
     this->m_OriginalChainCodes = chainCodeNoise.m_OriginalChainCodes;
+    this->m_ProfileFile = chainCodeNoise.m_ProfileFile;
+    this->m_CompressionFile = chainCodeNoise.m_CompressionFile;
+    this->m_CompressionOrder = chainCodeNoise.m_CompressionOrder;
+    this->m_ValidationFile = chainCodeNoise.m_ValidationFile;
+    this->m_ReplacementWindow = chainCodeNoise.m_ReplacementWindow;
+    this->m_JournalFile = chainCodeNoise.m_JournalFile;
+    this->m_JournalInterval = chainCodeNoise.m_JournalInterval;
+    this->m_CheckpointFile = chainCodeNoise.m_CheckpointFile;
+    this->m_CheckpointInterval = chainCodeNoise.m_CheckpointInterval;
+    this->m_InstrumentationFile = chainCodeNoise.m_InstrumentationFile;
+    this->m_PipelineDepth = chainCodeNoise.m_PipelineDepth;
+    this->m_ConsoleProgress = chainCodeNoise.m_ConsoleProgress;
+    this->m_Cache = chainCodeNoise.m_Cache;
+    this->m_Metrics = chainCodeNoise.m_Metrics;
+    this->m_Analyzer = chainCodeNoise.m_Analyzer;
+    this->m_FrameExport = chainCodeNoise.m_FrameExport;
     return *this;
 }
 
+void ChainCodeNoise::setProfileOutput(const std::string& file) {
+    m_ProfileFile = file;
+}
+
+void ChainCodeNoise::setCompressionOutput(const std::string& file, const uint order) {
+    m_CompressionFile = file;
+    m_CompressionOrder = order;
+}
+
+void ChainCodeNoise::setValidationOutput(const std::string& file) {
+    m_ValidationFile = file;
+}
+
+void ChainCodeNoise::setReplacementWindow(const uint windowSize) {
+    if (windowSize < 2 || windowSize > KGRAM_MAX_WINDOW) {
+        throw std::logic_error("Replacement window must contain 2 to 4 commands.");
+    }
+    m_ReplacementWindow = windowSize;
+}
+
+void ChainCodeNoise::setCheckpointOutput(const std::string& file, const uint interval) {
+    m_CheckpointFile = file;
+    m_CheckpointInterval = std::max(interval, 1u);
+}
+
+void ChainCodeNoise::setInstrumentationOutput(const std::string& file) {
+    if (!file.empty() && !NoiseInstrumentation::enabled()) {
+        throw std::logic_error("Instrumentation is not compiled in (CHAINCODE_INSTRUMENTATION is not defined).");
+    }
+    m_InstrumentationFile = file;
+}
+
+void ChainCodeNoise::setPipelineDepth(const uint depth) {
+    m_PipelineDepth = depth;
+}
+
+void ChainCodeNoise::setConsoleProgress(const bool enabled) {
+    m_ConsoleProgress = enabled;
+}
+
+void ChainCodeNoise::setSeed(const uint seed) {
+    m_Generator.seed(seed);
+    m_Random.reset();
+    m_Seeded = true;
+}
+
+void ChainCodeNoise::setResultCache(const std::shared_ptr<NoiseResultCache>& cache) {
+    m_Cache = cache;
+}
+
+void ChainCodeNoise::setMetricsOutput(const std::shared_ptr<NoiseMetricsStore>& metrics) {
+    m_Metrics = metrics;
+}
+
+void ChainCodeNoise::setFrameOutput(const FrameExportSettings& settings) {
+    m_FrameExport = settings;
+}
+
+FrameExportReport ChainCodeNoise::frameExportReport() const {
+    return m_FrameExportReport;
+}
+
+void ChainCodeNoise::setMonitor(NoiseMonitor* monitor) {
+    m_Monitor = monitor;
+}
+
+void ChainCodeNoise::setJournalOutput(const std::string& file, const uint keyframeInterval) {
+    m_JournalFile = file;
+    m_JournalInterval = keyframeInterval;
+}
+
+std::vector<RunLengthChainCode> ChainCodeNoise::applyRunLengthNoise(const std::vector<RunLengthChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const uint numberOfIterations) {
+    return runRunLengthNoise(chainCodes, startPixels, borderPixels, noiseProbability, nullptr, numberOfIterations);
+}
+
+std::vector<RunLengthChainCode> ChainCodeNoise::applyRunLengthNoise(const std::vector<RunLengthChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const NoiseProbabilityField& field, const uint numberOfIterations) {
+    return runRunLengthNoise(chainCodes, startPixels, borderPixels, 0.0, &field, numberOfIterations);
+}
+
+std::vector<RunLengthChainCode> ChainCodeNoise::runRunLengthNoise(const std::vector<RunLengthChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const NoiseProbabilityField* field, const uint numberOfIterations) {
+    for (const RunLengthChainCode& chainCode : chainCodes) {
+        if (chainCode.type() != ChainCodeType::F4 && chainCode.type() != ChainCodeType::F8) {
+            throw std::logic_error("Noise can only be applied to F4 and F8 chain codes.");
+        }
+    }
+    if (startPixels.size() != chainCodes.size()) {
+        throw std::logic_error("Each chain code needs a starting pixel.");
+    }
+
+    std::vector<RunLengthChainCode> noisyChainCodes = chainCodes;
+    m_RepeatedPixels.count(noisyChainCodes, startPixels);
+    for (uint iteration = 0; iteration < numberOfIterations; iteration++) {
+        for (uint i = 0; i < noisyChainCodes.size(); i++) {
+            if (m_Statistics != nullptr) {
+                m_Statistics->setCurrentChain(i);
+            }
+            const double weight = field != nullptr ? field->contourWeight(i) : 1.0;
+            noisyChainCodes[i] = addNoiseToRunLengthChainCode(noisyChainCodes[i], startPixels[i], borderPixels, noiseProbability, field, weight);
+        }
+    }
+
+    return noisyChainCodes;
+}
+
+StreamingNoiseReport ChainCodeNoise::applyNoiseToFile(const std::string& inputFile, const std::string& outputFile, const double noiseProbability, const uint numberOfIterations, const size_t memoryBudget) {
+    StreamingNoise streamingNoise(*this, memoryBudget);
+    return streamingNoise.run(inputFile, outputFile, noiseProbability, numberOfIterations);
+}
+
 std::vector<ChainCode> ChainCodeNoise::applyNoise(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const uint numberOfIterations, const std::string& name) {
+    checkChainCodeTypes(chainCodes);
+
     std::vector<ChainCode> noisyChainCodes = chainCodes;
 
     //{
@@ -232,25 +960,153 @@ std::vector<ChainCode> ChainCodeNoise::applyNoise(const std::vector<ChainCode>&
 
     //saveChainCodeImage(noisyChainCodes, -1, name, 100 * noiseProbability);
 
+    NoiseCheckpoint state;
+    state.name = name;
+    state.numberOfIterations = numberOfIterations;
+    state.noiseProbability = noiseProbability;
+    state.replacementWindow = m_ReplacementWindow;
+    state.pipelineDepth = m_PipelineDepth;
+    state.chainCodes = noisyChainCodes;
+    state.startPixels = startPixels;
 
-    for (uint iteration = 0; iteration < numberOfIterations; iteration++) {
-        auto start = std::chrono::high_resolution_clock::now();
-        for (uint i = 0; i < chainCodes.size(); i++) {
-            noisyChainCodes[i] = addNoiseToChainCode(noisyChainCodes[i], startPixels[i], borderPixels, noiseProbability, numberOfIterations);
+    // Seeded runs of a single probability without per-iteration outputs are served from the result cache; the longest cached
+    // run of the same input and parameters is continued.
+    bool useCache = m_Cache != nullptr && m_Seeded && m_Field == nullptr && m_ProfileFile.empty() && m_CompressionFile.empty() && m_ValidationFile.empty() && m_JournalFile.empty() && m_InstrumentationFile.empty() && m_Metrics == nullptr && m_FrameExport.output.empty() && m_PipelineDepth == 0;
+
+    // Border pixels of a cached state are restored from its chain codes (the run keeps them equal to the traced
+    // ones) and the given pixels that are not on the input contours, which no replacement changes. This is only
+    // exact if the given border contains the traced input, so other runs are not cached.
+    std::unordered_set<Pixel> inputBorderPixels;
+    if (useCache) {
+        traceBorderPixels(chainCodes, startPixels, inputBorderPixels);
+        useCache = std::all_of(inputBorderPixels.begin(), inputBorderPixels.end(), [&](const Pixel& pixel) { return borderPixels.count(pixel) > 0; });
+    }
+
+    u64 cacheKey = 0;
+    bool resumed = false;
+    if (useCache) {
+        cacheKey = NoiseResultCache::key(chainCodes, startPixels, borderPixels, noiseProbability, m_ReplacementWindow, generatorState());
+
+        NoiseCheckpoint cachedState;
+        if (m_Cache->find(cacheKey, numberOfIterations, cachedState)) {
+            // Cached chain codes hold the commands only, their file header is that of the input.
+            state.chainCodes = std::move(cachedState.chainCodes);
+            for (size_t i = 0; i < state.chainCodes.size(); i++) {
+                state.chainCodes[i].orientation = chainCodes[i].orientation;
+                state.chainCodes[i].headerValue = chainCodes[i].headerValue;
+            }
+            state.iteration = cachedState.iteration;
+            state.commandCounts = std::move(cachedState.commandCounts);
+            state.seconds = cachedState.seconds;
+            setGeneratorState(cachedState.generatorState);
+
+            std::vector<Pixel> fixedPixels;
+            for (const Pixel& pixel : borderPixels) {
+                if (inputBorderPixels.count(pixel) == 0) {
+                    fixedPixels.push_back(pixel);
+                }
+            }
+            traceBorderPixels(state.chainCodes, state.startPixels, borderPixels);
+            borderPixels.insert(fixedPixels.begin(), fixedPixels.end());
+            resumed = true;
         }
+    }
 
-        uint segmentCount = 0;
-        for (const ChainCode& chainCode : noisyChainCodes) {
-            segmentCount += chainCode.code.size();
+    const uint cachedIterations = state.iteration;
+    noisyChainCodes = runNoise(state, borderPixels, resumed);
+
+    // A cancelled run may end with a partial iteration, which is not a state of an uninterrupted run.
+    if (useCache && state.iteration > cachedIterations && (m_Monitor == nullptr || !m_Monitor->isCancelled())) {
+        state.generatorState = generatorState();
+        m_Cache->store(cacheKey, state);
+    }
+
+    return noisyChainCodes;
+}
+
+std::vector<ChainCode> ChainCodeNoise::applyNoise(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const NoiseProbabilityField& field, const uint numberOfIterations, const std::string& name) {
+    // Checkpoints and the pipeline store and draw with a single probability, so the field could not be resumed or pipelined.
+    if (!m_CheckpointFile.empty() || m_PipelineDepth > 0) {
+        throw std::logic_error("Checkpoints and the noise pipeline are not available with a probability field.");
+    }
+
+    const RunPointer<const NoiseProbabilityField> fieldPointer(m_Field, &field);
+    return applyNoise(chainCodes, startPixels, borderPixels, 0.0, numberOfIterations, name);
+}
+
+std::vector<ChainCode> ChainCodeNoise::resumeNoise(const std::string& checkpointFile, std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels) {
+    NoiseCheckpoint state = NoiseCheckpoint::load(checkpointFile);
+    checkChainCodeTypes(state.chainCodes);
+    setReplacementWindow(state.replacementWindow);
+
+    // Random streams of pipelined runs do not depend on the depth, so only the mode of the run is restored.
+    if (state.pipelineDepth == 0 || m_PipelineDepth == 0) {
+        m_PipelineDepth = state.pipelineDepth;
+    }
+
+    // Generator continues from the stored state, so the run is identical to an uninterrupted one.
+    setGeneratorState(state.generatorState);
+
+    // Border pixels are traced from the stored chain codes.
+    startPixels = state.startPixels;
+    traceBorderPixels(state.chainCodes, startPixels, borderPixels);
+
+    return runNoise(state, borderPixels, true);
+}
+
+std::vector<ChainCode> ChainCodeNoise::applyNoiseUntil(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const NoiseTarget& target, NoiseRunReport& report) {
+    checkChainCodeTypes(chainCodes);
+
+    std::vector<ChainCode> noisyChainCodes = chainCodes;
+    report = NoiseRunReport();
+
+    m_RepeatedPixels.count(noisyChainCodes, startPixels);
+
+    // Statistics are updated by the noise procedures, so the metric is evaluated without rasterization.
+    NoiseStatistics statistics(target.metric, noisyChainCodes, startPixels, borderPixels, m_CompressionOrder);
+    const RunPointer<NoiseStatistics> statisticsPointer(m_Statistics, &statistics);
+
+    std::unique_ptr<NoiseJournalWriter> journal;
+    if (!m_JournalFile.empty()) {
+        journal = std::make_unique<NoiseJournalWriter>(m_JournalFile, noisyChainCodes, m_ReplacementWindow, m_JournalInterval);
+    }
+    const RunPointer<NoiseJournalWriter> journalPointer(m_Journal, journal.get());
+
+    std::unique_ptr<NoiseInstrumentation> instrumentation;
+    if (!m_InstrumentationFile.empty()) {
+        instrumentation = std::make_unique<NoiseInstrumentation>();
+    }
+    const RunPointer<NoiseInstrumentation> instrumentationPointer(m_Instrumentation, instrumentation.get());
+
+    const auto start = std::chrono::steady_clock::now();
+    double metric = statistics.value(noisyChainCodes);
+    double lastIterationSeconds = 0.0;
+    NoiseController controller(target, metric);
+    report.trajectory.push_back({ 0, 0.0, metric, 0.0 });
+
+    for (uint iteration = 0; iteration < target.maxIterations && metric < target.value; iteration++) {
+        // The run stops before an iteration that would (judging by the previous one) exceed the budget.
+        const double seconds = report.trajectory.back().seconds;
+        if (target.timeBudget > 0.0 && seconds + lastIterationSeconds > target.timeBudget) {
+            report.budgetExpired = true;
+            break;
         }
 
-        auto midtime = std::chrono::high_resolution_clock::now();
-        auto currrentTime = std::chrono::duration_cast<std::chrono::milliseconds>(midtime - start).count();
-        std::cout << "Progress: " << iteration + 1 << "/" << numberOfIterations << ", Number of CC: " << segmentCount << " (" << (currrentTime / 1000.0) << " s), " << (segmentCount/(currrentTime/1000.0)) << std::endl;
+        const double probability = controller.probability();
+        addNoiseIteration(noisyChainCodes, startPixels, borderPixels, probability);
+        metric = statistics.value(noisyChainCodes);
 
-        //saveChainCodeImage(noisyChainCodes, iteration, name, 100 * noiseProbability);
-        //analyzeNoise(noisyChainCodes, iteration, name, 100 * noiseProbability);
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        lastIterationSeconds = elapsed - seconds;
+        report.trajectory.push_back({ iteration + 1, probability, metric, elapsed });
+
+        controller.update(metric);
+    }
+
+    if (instrumentation != nullptr) {
+        instrumentation->write(m_InstrumentationFile);
     }
+    report.targetReached = metric >= target.value;
 
     return noisyChainCodes;
-}
\ No newline at end of file
+}
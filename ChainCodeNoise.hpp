@@ -1,21 +1,71 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <memory>
 #include <unordered_set>
 #include <random>
 
 #include "ChainCode.hpp"
 #include "ChainCodeReplacementLUT.hpp"
+#include "ChainCodeValidator.hpp"
 #include "Constants.hpp"
+#include "NoiseCheckpoint.hpp"
+#include "NoiseController.hpp"
+#include "NoiseFrameExporter.hpp"
+#include "NoiseInstrumentation.hpp"
+#include "NoiseJournal.hpp"
+#include "NoiseMetricsStore.hpp"
+#include "NoiseMonitor.hpp"
+#include "NoiseProbabilityField.hpp"
+#include "NoisePipeline.hpp"
+#include "NoiseResultCache.hpp"
+#include "NoiseStatistics.hpp"
+#include "RepeatedPixels.hpp"
+#include "RunLengthChainCode.hpp"
+#include "StreamingNoise.hpp"
 
 
 
+class NoiseAnalyzer;
+
+
 class ChainCodeNoise {
+    friend struct cc_engine;          // Runs the iterations of the C interface on its own buffers and generators.
+    friend class ChainCodeBenchmark;  // Measures the noise iterations and the self-touching checks separately.
+    friend class NoiseBranch;         // Runs the replacements on chain codes stored in shared chunks.
+    friend class NoisePipeline;       // Runs the replacements of several iterations as staggered wavefronts.
+    friend class StreamingNoise;      // Runs the replacements on chain codes streamed from a file.
+
 private:
     std::vector<ChainCode> m_OriginalChainCodes;
     std::mt19937 m_Generator;
     std::uniform_real_distribution<> m_Random;
     ChainCodeReplacementLUT m_LUT;
+    std::string m_ProfileFile;      // CSV file for per-iteration symbol statistics (disabled if empty).
+    std::string m_CompressionFile;  // CSV file for per-iteration compressed size (disabled if empty).
+    uint m_CompressionOrder = 2;    // Context order of the arithmetic coder.
+    std::string m_ValidationFile;   // CSV file for per-iteration validation of the noisy chain codes (disabled if empty).
+    uint m_ReplacementWindow = 2;   // Number of commands replaced at once (2 - pair tables, 3 or 4 - k-gram tables).
+    NoiseStatistics* m_Statistics = nullptr;  // Incremental statistics updated with each replacement (adaptive run only).
+    std::string m_JournalFile;      // Journal of accepted replacements (disabled if empty).
+    uint m_JournalInterval = 50;    // Number of iterations between journal keyframes.
+    NoiseJournalWriter* m_Journal = nullptr;  // Journal of the running noise application.
+    std::string m_CheckpointFile;   // Checkpoint of the running noise application (disabled if empty).
+    uint m_CheckpointInterval = 100;  // Number of iterations between checkpoints.
+    bool m_Seeded = false;          // True if the generator was seeded explicitly (run is reproducible).
+    std::shared_ptr<NoiseResultCache> m_Cache;  // Cache of the results of seeded runs (disabled if null).
+    NoiseMonitor* m_Monitor = nullptr;  // Progress, cancellation and border changes of the run (disabled if null).
+    const NoiseProbabilityField* m_Field = nullptr;  // Probability at each pixel of the running noise application (noiseProbability everywhere if null).
+    std::string m_InstrumentationFile;  // JSON or CSV file for hot-path counters and phase cycles (disabled if empty).
+    NoiseInstrumentation* m_Instrumentation = nullptr;  // Recorder of the counters of the running noise application.
+    uint m_PipelineDepth = 0;       // Number of iterations advanced together by NoisePipeline (0 - single random stream, no pipeline).
+    bool m_ConsoleProgress = true;  // Progress of each iteration is printed to the standard output.
+    std::shared_ptr<NoiseMetricsStore> m_Metrics;      // Sink of the per-iteration metrics (disabled if null).
+    std::shared_ptr<const NoiseAnalyzer> m_Analyzer;  // Analyzer of the original chain codes (created for the first metrics).
+    FrameExportSettings m_FrameExport;                // Frames of the noise evolution (disabled if the output is empty).
+    FrameExportReport m_FrameExportReport;            // Report of the frame export of the last run.
+    RepeatedPixels m_RepeatedPixels;                  // Border pixels visited more than once by the chain codes of the run.
 
 
     /// <summary>
@@ -24,10 +74,139 @@ private:
     /// <param name="chainCode">: the given chain code</param>
     /// <param name="startPixel">: first pixel</param>
     /// <param name="borderPixels">: hash table of border pixels</param>
-    /// <param name="noiseProbability">: probability of the noise</param>
+    /// <param name="noiseProbability">: probability of the noise (if there is no field)</param>
     /// <param name="numberOfIterations">: number of algorithm iterations</param>
+    /// <param name="field">: spatially varying probability of the noise (nullptr - noiseProbability everywhere)</param>
+    /// <param name="weight">: weight of the chain code in the field</param>
+    /// <returns>Noisy chain code</returns>
+    ChainCode addNoiseToChainCode(const ChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels, const double noiseProbability = 0.02, const uint numberOfIterations = 1, const NoiseProbabilityField* field = nullptr, const double weight = 1.0);
+
+    /// <summary>
+    /// Adding noise to a chain code by replacing windows of 3 or 4 commands (k-gram tables).
+    /// </summary>
+    /// <param name="chainCode">: the given chain code</param>
+    /// <param name="startPixel">: first pixel</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="noiseProbability">: probability of the noise (if there is no field)</param>
+    /// <param name="field">: spatially varying probability of the noise (nullptr - noiseProbability everywhere)</param>
+    /// <param name="weight">: weight of the chain code in the field</param>
     /// <returns>Noisy chain code</returns>
-    ChainCode addNoiseToChainCode(const ChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels, const double noiseProbability = 0.02, const uint numberOfIterations = 1);
+    ChainCode addKGramNoiseToChainCode(const ChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const NoiseProbabilityField* field = nullptr, const double weight = 1.0);
+
+    /// <summary>
+    /// Adding noise to a run-length encoded chain code. Candidates are sampled by geometric skips and the commands
+    /// between them are copied run by run, so straight runs are crossed in O(1).
+    /// </summary>
+    /// <param name="chainCode">: the given chain code</param>
+    /// <param name="startPixel">: first pixel</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="noiseProbability">: probability of the noise (if there is no field)</param>
+    /// <param name="field">: spatially varying probability of the noise (nullptr - noiseProbability everywhere)</param>
+    /// <param name="weight">: weight of the chain code in the field</param>
+    /// <returns>Noisy chain code</returns>
+    RunLengthChainCode addNoiseToRunLengthChainCode(const RunLengthChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const NoiseProbabilityField* field = nullptr, const double weight = 1.0);
+
+    /// <summary>
+    /// Running iterations of addNoiseToRunLengthChainCode over all chain codes.
+    /// </summary>
+    /// <param name="chainCodes">: run-length encoded chain codes (F4 or F8)</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="noiseProbability">: probability of the noise (if there is no field)</param>
+    /// <param name="field">: spatially varying probability of the noise (nullptr - noiseProbability everywhere)</param>
+    /// <param name="numberOfIterations">: number of algorithm iterations</param>
+    /// <returns>Vector of noisified chain codes</returns>
+    std::vector<RunLengthChainCode> runRunLengthNoise(const std::vector<RunLengthChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const NoiseProbabilityField* field, const uint numberOfIterations);
+
+    /// <summary>
+    /// Adding noise to a chain code read command by command, with the decisions of addNoiseToChainCode (pairs) and
+    /// addKGramNoiseToChainCode (k-grams): the same generator draws give the same replacements. Used where the chain
+    /// code is not a vector (streamed files, shared chunks) or the border pixels are not a hash table.
+    /// </summary>
+    /// <param name="type">: type of the chain code (F4 or F8)</param>
+    /// <param name="startPixel">: first pixel</param>
+    /// <param name="source">: function returning the next command, -1 at the end of the chain code</param>
+    /// <param name="sink">: function receiving each output command and the input index of the window it comes from</param>
+    /// <param name="occupancy">: border pixels (contains, insert and erase of a pixel)</param>
+    /// <param name="repeatedPixels">: visits of the border pixels by more than one position of the contours</param>
+    /// <param name="generator">: random number generator</param>
+    /// <param name="noiseProbability">: probability of the noise</param>
+    /// <returns>Number of output commands</returns>
+    template<typename Source, typename Sink, typename Occupancy>
+    u64 streamNoise(const ChainCodeType type, const Pixel& startPixel, Source& source, Sink& sink, Occupancy& occupancy, RepeatedPixels& repeatedPixels, std::mt19937& generator, const double noiseProbability);
+
+    /// <summary>
+    /// Adding noise to each chain code once (one iteration).
+    /// </summary>
+    /// <param name="chainCodes">: chain codes that are modified</param>
+    /// <param name="startPixels">: starting pixels of each given chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="noiseProbability">: probability of the noise (if there is no field)</param>
+    /// <param name="field">: spatially varying probability of the noise with its contour weights (nullptr - noiseProbability everywhere)</param>
+    /// <param name="monitor">: monitor published after each chain code, the iteration stops once it is cancelled (none if null)</param>
+    /// <returns>True if all chain codes were noised, false if the iteration was cancelled</returns>
+    bool addNoiseIteration(std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const NoiseProbabilityField* field = nullptr, NoiseMonitor* monitor = nullptr);
+
+    /// <summary>
+    /// Adding a visit of a new pixel of a replacement to the border pixels (reported if the pixel is new).
+    /// </summary>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="pixel">: new pixel</param>
+    void addBorderPixel(std::unordered_set<Pixel>& borderPixels, const Pixel& pixel);
+
+    /// <summary>
+    /// Removing a visit of a pixel left by a replacement from the border pixels (reported if no visit is left).
+    /// </summary>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="pixel">: pixel that is left</param>
+    void removeBorderPixel(std::unordered_set<Pixel>& borderPixels, const Pixel& pixel);
+
+    /// <summary>
+    /// Reporting a pixel added to the border pixels by a replacement (statistics and monitor).
+    /// </summary>
+    /// <param name="pixel">: added pixel</param>
+    void pixelAdded(const Pixel& pixel);
+
+    /// <summary>
+    /// Reporting a pixel removed from the border pixels by a replacement (statistics and monitor).
+    /// </summary>
+    /// <param name="pixel">: removed pixel</param>
+    void pixelRemoved(const Pixel& pixel);
+
+    /// <summary>
+    /// Checking whether the chain codes can be noisified (replacement tables exist for F4 and F8 only).
+    /// </summary>
+    /// <param name="chainCodes">: given chain codes</param>
+    void checkChainCodeTypes(const std::vector<ChainCode>& chainCodes) const;
+
+    /// <summary>
+    /// Running the noise iterations from the given state, writing the per-iteration outputs and checkpoints.
+    /// </summary>
+    /// <param name="state">: state of the run (chain codes, starting pixels, finished iterations)</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="resumed">: true if the run continues from a checkpoint (outputs are appended)</param>
+    /// <returns>Vector of noisified chain codes</returns>
+    std::vector<ChainCode> runNoise(NoiseCheckpoint& state, std::unordered_set<Pixel>& borderPixels, const bool resumed);
+
+    /// <summary>
+    /// Serialized state of the random number generator.
+    /// </summary>
+    /// <returns>Generator state</returns>
+    std::string generatorState() const;
+
+    /// <summary>
+    /// Restoring the random number generator from its serialized state.
+    /// </summary>
+    /// <param name="state">: generator state</param>
+    void setGeneratorState(const std::string& state);
+
+    /// <summary>
+    /// Tracing the border pixels of the chain codes.
+    /// </summary>
+    /// <param name="chainCodes">: chain codes</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels (output)</param>
+    void traceBorderPixels(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels) const;
 
     /// <summary>
     /// Transforming chain code into a sequence of pixels.
@@ -49,6 +228,17 @@ private:
     /// <returns>True if self-touching area occurs, false otherwise</returns>
     bool wouldNoiseCauseSelfTouchingArea(const ChainCodeType& type, const Pixel& startPixel, const std::vector<short>& noiseSequence, const std::unordered_set<Pixel>& borderPixels, const std::vector<Pixel>& excludedPixels, const int vicinity = 1);
 
+    /// <summary>
+    /// Check whether new pixels would cause self-touching areas within the given vicinity in the chain code.
+    /// </summary>
+    /// <param name="type">: type of the chain code (F4 or F8)</param>
+    /// <param name="newPixels">: pixels introduced by the noise</param>
+    /// <param name="borderPixels">: pixels that lie on the shape border</param>
+    /// <param name="excludedPixels">: pixels that are not included in the check</param>
+    /// <param name="vicinity">: vicinity of the check</param>
+    /// <returns>True if self-touching area occurs, false otherwise</returns>
+    bool wouldPixelsCauseSelfTouchingArea(const ChainCodeType& type, const std::vector<Pixel>& newPixels, const std::unordered_set<Pixel>& borderPixels, const std::vector<Pixel>& excludedPixels, const int vicinity = 1);
+
     /// <summary>
     /// Saving the chain code image to a JPG file.
     /// </summary>
@@ -58,7 +248,15 @@ private:
     /// <param name="probability">: probability of the mutation</param>
     void saveChainCodeImage(const std::vector<ChainCode>& chainCodes, const uint iteration, const std::string name, const uint probability);
 
-    void analyzeNoise(const std::vector<ChainCode>& noisyChainCodes, const uint iteration, const std::string& name, const uint probability) const;
+    /// <summary>
+    /// Appending the metrics of an iteration (commands, fractal dimension and duration) to the metrics store.
+    /// </summary>
+    /// <param name="noisyChainCodes">: noisy chain codes after the iteration</param>
+    /// <param name="run">: id of the run in the metrics store</param>
+    /// <param name="state">: state of the run (name and probability)</param>
+    /// <param name="iteration">: number of finished iterations</param>
+    /// <param name="seconds">: duration of the iteration</param>
+    void analyzeNoise(const std::vector<ChainCode>& noisyChainCodes, const uint run, const NoiseCheckpoint& state, const uint iteration, const double seconds);
 
 public:
     /// <summary>
@@ -79,6 +277,114 @@ public:
     /// <returns>Copied object</returns>
     ChainCodeNoise& operator=(const ChainCodeNoise& chainCodeNoise);
 
+    /// <summary>
+    /// Enabling per-iteration profiling of symbol statistics (entropy, curvature, runs).
+    /// </summary>
+    /// <param name="file">: path to the output CSV file (empty string disables profiling)</param>
+    void setProfileOutput(const std::string& file);
+
+    /// <summary>
+    /// Enabling per-iteration measurement of the compressed size with the adaptive arithmetic coder.
+    /// </summary>
+    /// <param name="file">: path to the output CSV file (empty string disables the measurement)</param>
+    /// <param name="order">: context order of the coder</param>
+    void setCompressionOutput(const std::string& file, const uint order = 2);
+
+    /// <summary>
+    /// Enabling per-iteration validation of the noisy chain codes by ChainCodeValidator (continuity, closure,
+    /// repeated pixels, self-touching areas and contacts of contours).
+    /// </summary>
+    /// <param name="file">: path to the output CSV file (empty string disables the validation)</param>
+    void setValidationOutput(const std::string& file);
+
+    /// <summary>
+    /// Setting the number of commands replaced at once. Windows of 3 or 4 commands use the k-gram tables,
+    /// which make larger perturbations per pass; the default (2) uses the pair tables.
+    /// </summary>
+    /// <param name="windowSize">: number of commands in the replaced window (2, 3 or 4)</param>
+    void setReplacementWindow(const uint windowSize);
+
+    /// <summary>
+    /// Enabling the journal of accepted replacements, from which NoiseJournal reconstructs any iteration.
+    /// </summary>
+    /// <param name="file">: path to the journal file (empty string disables the journal)</param>
+    /// <param name="keyframeInterval">: number of iterations between keyframes (full chain codes)</param>
+    void setJournalOutput(const std::string& file, const uint keyframeInterval = 50);
+
+    /// <summary>
+    /// Enabling periodic checkpoints of applyNoise, from which an interrupted run is continued by resumeNoise.
+    /// The state at the end of the run (also of a cancelled one) is checkpointed as well.
+    /// </summary>
+    /// <param name="file">: path to the checkpoint file (empty string disables checkpoints)</param>
+    /// <param name="interval">: number of iterations between checkpoints</param>
+    void setCheckpointOutput(const std::string& file, const uint interval = 100);
+
+    /// <summary>
+    /// Enabling the hot-path counters and phase timers of the noise procedures (rejections, probes and cycles of
+    /// sampling, lookup, self-touching check, splice and border update), recorded per iteration and chain code.
+    /// Requires a build with CHAINCODE_INSTRUMENTATION defined.
+    /// </summary>
+    /// <param name="file">: path to the output file, .json for JSON, otherwise CSV (empty string disables the counters)</param>
+    void setInstrumentationOutput(const std::string& file);
+
+    /// <summary>
+    /// Running applyNoise with iterations advanced together as staggered wavefronts along the contours
+    /// (NoisePipeline), which keeps the chain codes and border pixels around them in the cache. Each iteration
+    /// uses its own random stream and starts its traversal of a contour a fixed distance after the previous one,
+    /// so the results differ from those of the default single stream, but not between depths: depth 1 runs the
+    /// same iterations one after another. Per-iteration outputs (profile, compression, validation, journal and
+    /// instrumentation) are not available with the pipeline.
+    /// </summary>
+    /// <param name="depth">: number of iterations in flight (0 - single random stream without the pipeline)</param>
+    void setPipelineDepth(const uint depth);
+
+    /// <summary>
+    /// Enabling the progress line printed to the standard output after each iteration.
+    /// </summary>
+    /// <param name="enabled">: true - progress is printed (default)</param>
+    void setConsoleProgress(const bool enabled);
+
+    /// <summary>
+    /// Seeding the random number generator (runs with the same seed and settings are identical).
+    /// </summary>
+    /// <param name="seed">: seed</param>
+    void setSeed(const uint seed);
+
+    /// <summary>
+    /// Setting the result cache of applyNoise. Seeded runs without per-iteration outputs (profile, compression,
+    /// journal) are looked up in the cache, and runs longer than a cached one continue from it.
+    /// </summary>
+    /// <param name="cache">: result cache (null disables caching)</param>
+    void setResultCache(const std::shared_ptr<NoiseResultCache>& cache);
+
+    /// <summary>
+    /// Setting the metrics store of applyNoise and resumeNoise, which receives the number of commands, the fractal
+    /// dimension and the duration of each iteration. A store can be shared by the runs of a sweep, which then
+    /// write into one file.
+    /// </summary>
+    /// <param name="metrics">: metrics store (null disables the metrics)</param>
+    void setMetricsOutput(const std::shared_ptr<NoiseMetricsStore>& metrics);
+
+    /// <summary>
+    /// Enabling the export of frames of applyNoise and resumeNoise (the input and every interval-th iteration) as
+    /// numbered PNG files or one YUV4MPEG2 stream, rasterized and encoded by NoiseFrameExporter in the background.
+    /// </summary>
+    /// <param name="settings">: settings of the export (empty output disables the export)</param>
+    void setFrameOutput(const FrameExportSettings& settings);
+
+    /// <summary>
+    /// Report of the frame export of the last applyNoise or resumeNoise (empty if it exported no frames).
+    /// </summary>
+    /// <returns>Written and clipped frames, time the run waited for the encoders</returns>
+    FrameExportReport frameExportReport() const;
+
+    /// <summary>
+    /// Setting the monitor of applyNoise and resumeNoise, which receives the progress and the border changes
+    /// after each iteration and can cancel the run (the monitor must outlive the run).
+    /// </summary>
+    /// <param name="monitor">: monitor of the run (null disables monitoring)</param>
+    void setMonitor(NoiseMonitor* monitor);
+
     /// <summary>
     /// Method for noise application to a vector of chain codes.
     /// </summary>
@@ -90,4 +396,205 @@ public:
     /// <param name="name">: name of chain code group</param>
     /// <returns>Vector of noisified chain codes</returns>
     std::vector<ChainCode> applyNoise(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const double noiseProbability = 0.02, const uint numberOfIterations = 1, const std::string& name = "Name");
-};
\ No newline at end of file
+
+    /// <summary>
+    /// Method for noise application with a spatially varying probability to a vector of chain codes. Each command is
+    /// a candidate with the probability of the field at its pixel times the weight of its chain code, drawn with the
+    /// same random numbers as applyNoise (a uniform field of weight 1 gives the result of applyNoise with its
+    /// probability). Per-iteration outputs, journal, metrics, frames and the monitor are used as in applyNoise;
+    /// checkpoints and the pipeline only know a single probability and are not available, and the run is not cached.
+    /// </summary>
+    /// <param name="chainCodes">: given chain codes</param>
+    /// <param name="startPixels">: starting pixels of each given chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="field">: probability of the noise at each pixel</param>
+    /// <param name="numberOfIterations">: number of algorithm iterations</param>
+    /// <param name="name">: name of chain code group</param>
+    /// <returns>Vector of noisified chain codes</returns>
+    std::vector<ChainCode> applyNoise(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const NoiseProbabilityField& field, const uint numberOfIterations = 1, const std::string& name = "Name");
+
+    /// <summary>
+    /// Applying noise to run-length encoded chain codes. The number of commands before the next candidate is drawn
+    /// from the geometric distribution instead of drawing a random number for each command, so an iteration costs
+    /// O(runs + candidates) and replacements split the runs they fall into. Replacements are chosen with the same
+    /// probabilities as in applyNoise, but the random stream differs. Per-iteration outputs, journal, checkpoints
+    /// and the cache are not used.
+    /// </summary>
+    /// <param name="chainCodes">: run-length encoded chain codes (F4 or F8)</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="noiseProbability">: probability of the noise</param>
+    /// <param name="numberOfIterations">: number of algorithm iterations</param>
+    /// <returns>Vector of noisified chain codes</returns>
+    std::vector<RunLengthChainCode> applyRunLengthNoise(const std::vector<RunLengthChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const double noiseProbability = 0.02, const uint numberOfIterations = 1);
+
+    /// <summary>
+    /// Applying noise with a spatially varying probability to run-length encoded chain codes. Along each run, the
+    /// candidates are drawn with the bound of the field over the run (geometric skips) and kept with the ratio of
+    /// the probability at their pixel to the bound, so an iteration costs O(runs + candidates) and runs in protected
+    /// zones are crossed without a draw. Bounds are taken from the positions of the current iteration, so they
+    /// follow the contour as replacements move it. Contour weights of the field scale the bound and the probability
+    /// of each chain code; a chain code of weight 0 is copied without a draw.
+    /// </summary>
+    /// <param name="chainCodes">: run-length encoded chain codes (F4 or F8)</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="field">: probability of the noise at each pixel</param>
+    /// <param name="numberOfIterations">: number of algorithm iterations</param>
+    /// <returns>Vector of noisified chain codes</returns>
+    std::vector<RunLengthChainCode> applyRunLengthNoise(const std::vector<RunLengthChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const NoiseProbabilityField& field, const uint numberOfIterations = 1);
+
+    /// <summary>
+    /// Applying noise to a chain code file that does not have to fit into memory (StreamingNoise). The chain codes
+    /// are read and written in chunks and the border pixels are paged in tiles under the memory budget. A seeded
+    /// run produces the same chain codes as applyNoise with the start pixels of the file; per-iteration outputs,
+    /// journal, checkpoints, cache, monitor, statistics and the pipeline are not used.
+    /// </summary>
+    /// <param name="inputFile">: chain code file (F4 or F8)</param>
+    /// <param name="outputFile">: file of the noisy chain codes</param>
+    /// <param name="noiseProbability">: probability of the noise</param>
+    /// <param name="numberOfIterations">: number of algorithm iterations</param>
+    /// <param name="memoryBudget">: memory for the border pixels and the file buffers in bytes</param>
+    /// <returns>Summary of the run</returns>
+    StreamingNoiseReport applyNoiseToFile(const std::string& inputFile, const std::string& outputFile, const double noiseProbability = 0.02, const uint numberOfIterations = 1, const size_t memoryBudget = 256 << 20);
+
+    /// <summary>
+    /// Continuing an interrupted applyNoise run from its checkpoint. The run continues exactly as it would
+    /// without the interruption; output settings (profile, compression, journal) must match the original run.
+    /// </summary>
+    /// <param name="checkpointFile">: path to the checkpoint file</param>
+    /// <param name="startPixels">: starting pixels of each chain code (output)</param>
+    /// <param name="borderPixels">: hash table of border pixels (output)</param>
+    /// <returns>Vector of noisified chain codes</returns>
+    std::vector<ChainCode> resumeNoise(const std::string& checkpointFile, std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels);
+
+    /// <summary>
+    /// Method for noise application until the metric reaches the target value or the time budget expires.
+    /// The noise probability is adapted after each iteration by NoiseController.
+    /// </summary>
+    /// <param name="chainCodes">: given chain codes</param>
+    /// <param name="startPixels">: starting pixels of each given chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="target">: target metric, its value and limits of the run</param>
+    /// <param name="report">: trajectory of the run (output)</param>
+    /// <returns>Vector of noisified chain codes</returns>
+    std::vector<ChainCode> applyNoiseUntil(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, const NoiseTarget& target, NoiseRunReport& report);
+};
+
+
+
+template<typename Source, typename Sink, typename Occupancy>
+u64 ChainCodeNoise::streamNoise(const ChainCodeType type, const Pixel& startPixel, Source& source, Sink& sink, Occupancy& occupancy, RepeatedPixels& repeatedPixels, std::mt19937& generator, const double noiseProbability) {
+    std::uniform_real_distribution<> random(0.0, 1.0);
+    const uint windowSize = m_ReplacementWindow;
+    short window[KGRAM_MAX_WINDOW];
+    std::vector<short> replacement;
+    std::vector<Pixel> windowPixels(windowSize + 1);
+    std::vector<Pixel> newPixels;
+    u64 index = 0;     // Input index of the first command of the window.
+    u64 commands = 0;
+
+    // The window holds the next commands of the input (replacements never change the commands ahead of them).
+    uint ahead = 0;
+    bool ended = false;
+    const auto fill = [&]() {
+        while (ahead < windowSize && !ended) {
+            const int command = source();
+            if (command == -1) {
+                ended = true;
+            }
+            else {
+                window[ahead++] = static_cast<short>(command);
+            }
+        }
+    };
+    const auto consume = [&](const uint count) {
+        std::copy(window + count, window + ahead, window);
+        ahead -= count;
+        index += count;
+        fill();
+    };
+    const auto emit = [&](const short command) {
+        sink(command, index);
+        commands++;
+    };
+
+    // New pixels must not touch border pixels other than those of the window (as in wouldPixelsCauseSelfTouchingArea).
+    const auto selfTouching = [&]() {
+        for (const Pixel& newPixel : newPixels) {
+            for (int y = -1; y <= 1; y++) {
+                for (int x = -1; x <= 1; x++) {
+                    if (type == ChainCodeType::F4 && (x + y) % 2 == 0 && std::abs(x) + std::abs(y) != 0) {
+                        continue;
+                    }
+                    const Pixel checkPixel(newPixel.x + x, newPixel.y + y);
+                    if (std::find(windowPixels.begin(), windowPixels.end(), checkPixel) == windowPixels.end() && occupancy.contains(checkPixel)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    };
+
+    Pixel currentPixel = startPixel;
+    fill();
+    while (ahead == windowSize) {
+        if (random(generator) < noiseProbability) {
+            const bool firstTable = random(generator) < 0.5;
+            windowPixels[0] = currentPixel;
+            for (uint j = 0; j < windowSize; j++) {
+                windowPixels[j + 1] = ChainCodeFunctions::chainCodeMove(type, window[j], windowPixels[j]);
+            }
+
+            bool found = false;
+            if (windowSize == 2) {
+                // As in addNoiseToChainCode, a pair without a replacement is passed over like any other command.
+                replacement = m_LUT.findReplacement(type, firstTable, window[0], window[1]);
+                if (!replacement.empty()) {
+                    newPixels = chainCodeSegmentToPixels(type, currentPixel, replacement);
+                    found = true;
+                }
+            }
+            else {
+                const KGramReplacement& kGram = m_LUT.findReplacement(type, firstTable, window, windowSize);
+                if (kGram.length > 0) {
+                    replacement.assign(kGram.code, kGram.code + kGram.length);
+                    newPixels.clear();
+                    for (uint j = 0; j + 1 < kGram.length; j++) {
+                        newPixels.emplace_back(currentPixel.x + kGram.footprint[j][0], currentPixel.y + kGram.footprint[j][1]);
+                    }
+                    found = true;
+                }
+            }
+
+            if (found && !selfTouching()) {
+                for (uint j = 1; j < windowSize; j++) {
+                    repeatedPixels.erase(occupancy, windowPixels[j]);
+                }
+                for (const Pixel& newPixel : newPixels) {
+                    repeatedPixels.insert(occupancy, newPixel);
+                }
+                for (const short command : replacement) {
+                    emit(command);
+                }
+                currentPixel = windowPixels[windowSize];
+                consume(windowSize);
+                continue;
+            }
+        }
+
+        // Moving in the right direction.
+        emit(window[0]);
+        currentPixel = ChainCodeFunctions::chainCodeMove(type, window[0], currentPixel);
+        consume(1);
+    }
+
+    // Commands after the last window.
+    for (uint j = 0; j < ahead; j++) {
+        sink(window[j], index + j);
+        commands++;
+    }
+
+    return commands;
+}
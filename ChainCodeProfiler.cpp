@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "ChainCodeProfiler.hpp"
+#include "MappedFile.hpp"
+
+
+double ChainCodeProfile::entropy0() const {
+    if (symbolCount == 0) {
+        return 0.0;
+    }
+
+    double entropy = 0.0;
+    for (const u64 count : symbolHistogram) {
+        if (count > 0) {
+            const double probability = static_cast<double>(count) / symbolCount;
+            entropy -= probability * std::log2(probability);
+        }
+    }
+
+    return entropy;
+}
+
+double ChainCodeProfile::entropy1() const {
+    u64 pairCount = 0;
+    for (const std::array<u64, PROFILE_ALPHABET>& row : transitionHistogram) {
+        for (const u64 count : row) {
+            pairCount += count;
+        }
+    }
+    if (pairCount == 0) {
+        return 0.0;
+    }
+
+    // Conditional entropy H(current | previous), weighted by the frequency of each context.
+    double entropy = 0.0;
+    for (const std::array<u64, PROFILE_ALPHABET>& row : transitionHistogram) {
+        u64 contextCount = 0;
+        for (const u64 count : row) {
+            contextCount += count;
+        }
+
+        for (const u64 count : row) {
+            if (count > 0) {
+                const double probability = static_cast<double>(count) / contextCount;
+                entropy -= static_cast<double>(count) / pairCount * std::log2(probability);
+            }
+        }
+    }
+
+    return entropy;
+}
+
+double ChainCodeProfile::meanRunLength() const {
+    return runCount == 0 ? 0.0 : static_cast<double>(symbolCount) / runCount;
+}
+
+
+
+template<typename T>
+void ChainCodeProfiler::processBlock(const T* symbols, const size_t count, const T offset) {
+    constexpr uint mask = PROFILE_ALPHABET - 1;
+    constexpr uint blockSize = 1024;
+
+    // Indices of commands that start a new run (one extra slot for the branch-free store).
+    uint boundaries[blockSize + 1];
+
+    uint previous = static_cast<uint>(m_Previous);
+    size_t done = 0;
+    while (done < count) {
+        const uint size = static_cast<uint>(std::min<size_t>(blockSize, count - done));
+        const T* block = symbols + done;
+        uint boundaryCount = 0;
+        uint i = 0;
+
+        // Main loop, unrolled by the number of lanes. Each lane owns a separate pair histogram, so
+        // repeated increments of the same bin (long straight runs) do not serialize on one counter.
+        // Run boundaries are compacted branch-free, as they are unpredictable in noisy chain codes.
+        for (; i + LANES <= size; i += LANES) {
+            const uint s0 = static_cast<uint>(block[i] - offset) & mask;
+            const uint s1 = static_cast<uint>(block[i + 1] - offset) & mask;
+            const uint s2 = static_cast<uint>(block[i + 2] - offset) & mask;
+            const uint s3 = static_cast<uint>(block[i + 3] - offset) & mask;
+
+            m_Pairs[0][previous * PROFILE_ALPHABET + s0]++;
+            m_Pairs[1][s0 * PROFILE_ALPHABET + s1]++;
+            m_Pairs[2][s1 * PROFILE_ALPHABET + s2]++;
+            m_Pairs[3][s2 * PROFILE_ALPHABET + s3]++;
+
+            boundaries[boundaryCount] = i;
+            boundaryCount += s0 != previous;
+            boundaries[boundaryCount] = i + 1;
+            boundaryCount += s1 != s0;
+            boundaries[boundaryCount] = i + 2;
+            boundaryCount += s2 != s1;
+            boundaries[boundaryCount] = i + 3;
+            boundaryCount += s3 != s2;
+
+            previous = s3;
+        }
+
+        // Remaining commands.
+        for (; i < size; i++) {
+            const uint current = static_cast<uint>(block[i] - offset) & mask;
+            m_Pairs[0][previous * PROFILE_ALPHABET + current]++;
+
+            boundaries[boundaryCount] = i;
+            boundaryCount += current != previous;
+
+            previous = current;
+        }
+
+        // Closed runs are added to the run length histogram.
+        u64 runStart = 0;
+        u64 runLength = m_RunLength;
+        for (uint j = 0; j < boundaryCount; j++) {
+            runLength += boundaries[j] - runStart;
+            m_Runs[std::min<u64>(runLength, PROFILE_MAX_RUN - 1)]++;
+            runStart = boundaries[j];
+            runLength = 0;
+        }
+        m_RunLength = runLength + size - runStart;
+
+        done += size;
+    }
+
+    m_Previous = static_cast<short>(previous);
+    m_Pending += count;
+
+    // Lane counters are 32-bit, so they are flushed long before they could overflow.
+    if (m_Pending > (1u << 30)) {
+        flushLanes();
+    }
+}
+
+void ChainCodeProfiler::flushLanes() {
+    for (std::array<uint, PAIRS>& lane : m_Pairs) {
+        for (uint i = 0; i < PAIRS; i++) {
+            m_PairTotals[i] += lane[i];
+        }
+        lane.fill(0);
+    }
+    m_Pending = 0;
+}
+
+
+ChainCodeProfiler::ChainCodeProfiler(const ChainCodeType type) :
+    m_Alphabet(ChainCodeFunctions::alphabetSize(type))
+{}
+
+void ChainCodeProfiler::beginChain() {
+    // Closing the run of the previous chain code.
+    if (m_RunLength > 0) {
+        m_Runs[std::min<u64>(m_RunLength, PROFILE_MAX_RUN - 1)]++;
+    }
+
+    m_Previous = -1;
+    m_RunLength = 0;
+}
+
+void ChainCodeProfiler::update(const short* symbols, const size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    // The first command of a chain code has no predecessor.
+    size_t start = 0;
+    if (m_Previous < 0) {
+        m_Previous = symbols[0] & (PROFILE_ALPHABET - 1);
+        m_FirstSymbols[m_Previous]++;
+        m_RunLength = 1;
+        start = 1;
+    }
+
+    processBlock<short>(symbols + start, count - start, 0);
+}
+
+void ChainCodeProfiler::update(const unsigned char* symbols, const size_t count, const unsigned char offset) {
+    if (count == 0) {
+        return;
+    }
+
+    // The first command of a chain code has no predecessor.
+    size_t start = 0;
+    if (m_Previous < 0) {
+        m_Previous = (symbols[0] - offset) & (PROFILE_ALPHABET - 1);
+        m_FirstSymbols[m_Previous]++;
+        m_RunLength = 1;
+        start = 1;
+    }
+
+    processBlock<unsigned char>(symbols + start, count - start, offset);
+}
+
+void ChainCodeProfiler::updatePacked(const unsigned char* data, const size_t count, const uint bitsPerSymbol) {
+    if (bitsPerSymbol != 1 && bitsPerSymbol != 2 && bitsPerSymbol != 4) {
+        throw std::logic_error("Unsupported number of bits per symbol.");
+    }
+
+    // Unpacking into a small buffer that stays in L1 cache and profiling block by block.
+    const uint symbolsPerByte = 8 / bitsPerSymbol;
+    const unsigned char mask = static_cast<unsigned char>((1u << bitsPerSymbol) - 1);
+    unsigned char buffer[1024];
+
+    size_t done = 0;
+    while (done < count) {
+        const size_t blockSize = std::min<size_t>(sizeof(buffer), count - done);
+        for (size_t i = 0; i < blockSize; i++) {
+            const size_t index = done + i;
+            buffer[i] = (data[index / symbolsPerByte] >> ((index % symbolsPerByte) * bitsPerSymbol)) & mask;
+        }
+        update(buffer, blockSize);
+        done += blockSize;
+    }
+}
+
+ChainCodeProfile ChainCodeProfiler::finish() {
+    beginChain();
+    flushLanes();
+
+    ChainCodeProfile profile;
+    profile.alphabet = m_Alphabet;
+
+    // Symbol, transition and curvature histograms are all derived from the pair histogram.
+    for (uint previous = 0; previous < PROFILE_ALPHABET; previous++) {
+        for (uint current = 0; current < PROFILE_ALPHABET; current++) {
+            const u64 count = m_PairTotals[previous * PROFILE_ALPHABET + current];
+            profile.transitionHistogram[previous][current] = count;
+            profile.symbolHistogram[current] += count;
+            profile.curvatureHistogram[(current + m_Alphabet - previous % m_Alphabet) % m_Alphabet] += count;
+        }
+    }
+    for (uint symbol = 0; symbol < PROFILE_ALPHABET; symbol++) {
+        profile.symbolHistogram[symbol] += m_FirstSymbols[symbol];
+        profile.symbolCount += profile.symbolHistogram[symbol];
+    }
+
+    for (uint length = 1; length < PROFILE_MAX_RUN; length++) {
+        profile.runLengthHistogram[length] = m_Runs[length];
+        profile.runCount += m_Runs[length];
+    }
+
+    return profile;
+}
+
+ChainCodeProfile ChainCodeProfiler::profile(const std::vector<ChainCode>& chainCodes) {
+    ChainCodeProfiler profiler(chainCodes.empty() ? ChainCodeType::F8 : chainCodes[0].type);
+    for (const ChainCode& chainCode : chainCodes) {
+        profiler.beginChain();
+        profiler.update(chainCode.code.data(), chainCode.code.size());
+    }
+
+    return profiler.finish();
+}
+
+ChainCodeProfile ChainCodeProfiler::profileFile(const std::string& file) {
+    const MappedFile mappedFile(file);
+    const unsigned char* data = mappedFile.data();
+    const unsigned char* end = data + mappedFile.size();
+
+    // Skipping the header line.
+    const unsigned char* position = std::find(data, end, '\n');
+    if (position != end) {
+        position++;
+    }
+
+    // The type of the first chain code determines the alphabet of the profiler.
+    const ChainCodeType type = (end - position >= 2 && position[1] == '4') ? ChainCodeType::F4 : ChainCodeType::F8;
+    ChainCodeProfiler profiler(type);
+
+    // Each line is formed as TYPE;ORIENTATION;X,Y;N;CODE.
+    while (position < end) {
+        const unsigned char* lineEnd = std::find(position, end, '\n');
+
+        uint separators = 0;
+        const unsigned char* code = position;
+        while (code < lineEnd && separators < 4) {
+            if (*code++ == ';') {
+                separators++;
+            }
+        }
+
+        const unsigned char* codeEnd = lineEnd;
+        while (codeEnd > code && (codeEnd[-1] < '0' || codeEnd[-1] > '9')) {
+            codeEnd--;
+        }
+
+        if (separators == 4 && codeEnd > code) {
+            profiler.beginChain();
+            profiler.update(code, codeEnd - code, '0');
+        }
+
+        position = lineEnd == end ? end : lineEnd + 1;
+    }
+
+    return profiler.finish();
+}
+
+void ChainCodeProfiler::writeHeader(std::ostream& out) {
+    out << "iteration,symbols,runs,entropy0,entropy1,meanRunLength";
+    for (uint i = 0; i < PROFILE_ALPHABET; i++) {
+        out << ",curvature" << i;
+    }
+    out << "\n";
+}
+
+void ChainCodeProfiler::writeRow(std::ostream& out, const uint iteration, const ChainCodeProfile& profile) {
+    out << iteration << "," << profile.symbolCount << "," << profile.runCount << "," << profile.entropy0() << "," << profile.entropy1() << "," << profile.meanRunLength();
+    for (const u64 count : profile.curvatureHistogram) {
+        out << "," << count;
+    }
+    out << "\n";
+}
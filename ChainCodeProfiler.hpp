@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+
+
+// CONSTANTS
+constexpr uint PROFILE_ALPHABET = 8;     // Largest supported chain code alphabet (F8).
+constexpr uint PROFILE_MAX_RUN = 64;     // Runs of this length or longer share the last bin of the histogram.
+
+
+/// <summary>
+/// Symbol statistics of one or more chain codes.
+/// </summary>
+struct ChainCodeProfile {
+    uint alphabet = PROFILE_ALPHABET;                                                         // Size of the chain code alphabet.
+    u64 symbolCount = 0;                                                                      // Number of chain code commands.
+    u64 runCount = 0;                                                                         // Number of runs of equal commands.
+    std::array<u64, PROFILE_ALPHABET> symbolHistogram{};                                      // Occurrences of each command.
+    std::array<std::array<u64, PROFILE_ALPHABET>, PROFILE_ALPHABET> transitionHistogram{};    // Occurrences of each (previous, current) pair.
+    std::array<u64, PROFILE_ALPHABET> curvatureHistogram{};                                   // Occurrences of each direction change (current - previous).
+    std::array<u64, PROFILE_MAX_RUN> runLengthHistogram{};                                    // Occurrences of each run length.
+
+    /// <summary>
+    /// Empirical 0-th order entropy of the commands.
+    /// </summary>
+    /// <returns>Entropy in bits per symbol</returns>
+    double entropy0() const;
+
+    /// <summary>
+    /// Empirical 1st order (conditional) entropy of the commands.
+    /// </summary>
+    /// <returns>Entropy in bits per symbol</returns>
+    double entropy1() const;
+
+    /// <summary>
+    /// Average length of a run of equal commands.
+    /// </summary>
+    /// <returns>Mean run length</returns>
+    double meanRunLength() const;
+};
+
+
+/// <summary>
+/// Single-pass streaming profiler of chain code commands.
+/// </summary>
+class ChainCodeProfiler {
+private:
+    static constexpr uint LANES = 4;                                   // Number of interleaved histograms.
+    static constexpr uint PAIRS = PROFILE_ALPHABET * PROFILE_ALPHABET;  // Number of (previous, current) pairs.
+
+    uint m_Alphabet;                                           // Size of the chain code alphabet.
+    std::array<std::array<uint, PAIRS>, LANES> m_Pairs{};      // Interleaved pair histograms (flushed before they overflow).
+    std::array<u64, PAIRS> m_PairTotals{};                     // Accumulated pair histogram.
+    std::array<u64, PROFILE_MAX_RUN> m_Runs{};                 // Run length histogram.
+    std::array<u64, PROFILE_ALPHABET> m_FirstSymbols{};        // First commands of the chain codes (they have no predecessor).
+    u64 m_Pending = 0;                                         // Number of pairs in the interleaved histograms.
+    short m_Previous = -1;                                     // Last command of the current chain code (-1 at the start).
+    u64 m_RunLength = 0;                                       // Length of the current run.
+
+    /// <summary>
+    /// Core loop of the profiler over a block of commands with a known predecessor.
+    /// </summary>
+    /// <param name="symbols">: pointer to the commands</param>
+    /// <param name="count">: number of commands</param>
+    /// <param name="offset">: value subtracted from each command</param>
+    template<typename T>
+    void processBlock(const T* symbols, const size_t count, const T offset);
+
+    /// <summary>
+    /// Moving the interleaved histograms into the accumulated histogram.
+    /// </summary>
+    void flushLanes();
+
+public:
+    /// <summary>
+    /// Constructor of the profiler.
+    /// </summary>
+    /// <param name="type">: type of the profiled chain codes</param>
+    ChainCodeProfiler(const ChainCodeType type);
+
+    /// <summary>
+    /// Starting a new chain code (the next command has no predecessor).
+    /// </summary>
+    void beginChain();
+
+    /// <summary>
+    /// Feeding a block of commands of the current chain code.
+    /// </summary>
+    /// <param name="symbols">: pointer to the commands</param>
+    /// <param name="count">: number of commands</param>
+    void update(const short* symbols, const size_t count);
+
+    /// <summary>
+    /// Feeding a block of byte commands of the current chain code (e.g. text of a memory-mapped file).
+    /// </summary>
+    /// <param name="symbols">: pointer to the commands</param>
+    /// <param name="count">: number of commands</param>
+    /// <param name="offset">: value subtracted from each byte ('0' for text)</param>
+    void update(const unsigned char* symbols, const size_t count, const unsigned char offset = 0);
+
+    /// <summary>
+    /// Feeding a block of bit-packed commands (least significant bits first).
+    /// </summary>
+    /// <param name="data">: pointer to the packed commands</param>
+    /// <param name="count">: number of commands</param>
+    /// <param name="bitsPerSymbol">: number of bits per command (1, 2 or 4)</param>
+    void updatePacked(const unsigned char* data, const size_t count, const uint bitsPerSymbol);
+
+    /// <summary>
+    /// Obtaining the statistics of all commands fed so far.
+    /// </summary>
+    /// <returns>Profile of the commands</returns>
+    ChainCodeProfile finish();
+
+    /// <summary>
+    /// Profiling a vector of chain codes.
+    /// </summary>
+    /// <param name="chainCodes">: vector of chain codes</param>
+    /// <returns>Profile of all chain codes</returns>
+    static ChainCodeProfile profile(const std::vector<ChainCode>& chainCodes);
+
+    /// <summary>
+    /// Profiling a chain code file (CC Multi) directly from a memory mapping.
+    /// </summary>
+    /// <param name="file">: path to the file</param>
+    /// <returns>Profile of all chain codes in the file</returns>
+    static ChainCodeProfile profileFile(const std::string& file);
+
+    /// <summary>
+    /// Writing the header of the per-iteration CSV table.
+    /// </summary>
+    /// <param name="out">: output stream</param>
+    static void writeHeader(std::ostream& out);
+
+    /// <summary>
+    /// Writing a row of the per-iteration CSV table.
+    /// </summary>
+    /// <param name="out">: output stream</param>
+    /// <param name="iteration">: index of the iteration</param>
+    /// <param name="profile">: statistics of the iteration</param>
+    static void writeRow(std::ostream& out, const uint iteration, const ChainCodeProfile& profile);
+};
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "ChainCodeRasterizer.hpp"
+
+
+namespace {
+    constexpr unsigned char BORDER = 0;
+    constexpr unsigned char BACKGROUND = 255;
+    constexpr size_t STORED_BLOCK = 65535;  // Maximum size of an uncompressed deflate block.
+
+    // CRC-32 tables for slicing by 8 bytes (table k advances the CRC over k + 1 bytes).
+    constexpr std::array<std::array<uint, 256>, 8> crcTables() {
+        std::array<std::array<uint, 256>, 8> tables = {};
+        for (uint i = 0; i < 256; i++) {
+            uint crc = i;
+            for (uint bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+            }
+            tables[0][i] = crc;
+        }
+        for (uint k = 1; k < 8; k++) {
+            for (uint i = 0; i < 256; i++) {
+                tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+            }
+        }
+        return tables;
+    }
+
+    constexpr std::array<std::array<uint, 256>, 8> CRC_TABLES = crcTables();
+
+    uint crc32(const unsigned char* data, const size_t size, uint crc = 0) {
+        crc = ~crc;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            const uint low = crc ^ (data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) | (static_cast<uint>(data[i + 3]) << 24));
+            crc = CRC_TABLES[7][low & 0xFF] ^ CRC_TABLES[6][(low >> 8) & 0xFF] ^ CRC_TABLES[5][(low >> 16) & 0xFF] ^ CRC_TABLES[4][low >> 24] ^
+                CRC_TABLES[3][data[i + 4]] ^ CRC_TABLES[2][data[i + 5]] ^ CRC_TABLES[1][data[i + 6]] ^ CRC_TABLES[0][data[i + 7]];
+        }
+        for (; i < size; i++) {
+            crc = CRC_TABLES[0][(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    void appendBigEndian(std::vector<unsigned char>& out, const uint value) {
+        out.push_back(static_cast<unsigned char>(value >> 24));
+        out.push_back(static_cast<unsigned char>(value >> 16));
+        out.push_back(static_cast<unsigned char>(value >> 8));
+        out.push_back(static_cast<unsigned char>(value));
+    }
+
+    void writeChunk(std::ofstream& out, const char* type, const std::vector<unsigned char>& data) {
+        std::vector<unsigned char> header;
+        appendBigEndian(header, static_cast<uint>(data.size()));
+        header.insert(header.end(), type, type + 4);
+
+        const uint crc = crc32(data.data(), data.size(), crc32(header.data() + 4, 4));
+        std::vector<unsigned char> footer;
+        appendBigEndian(footer, crc);
+
+        out.write(reinterpret_cast<const char*>(header.data()), header.size());
+        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+        out.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+    }
+}
+
+
+
+std::pair<uint, uint> ChainCodeRasterizer::imageSize(const uint maxXCoordinate, const uint maxYCoordinate, const uint scale, const uint padding) {
+    // Coordinates run from 0 to the maximal coordinate, both included.
+    return { scale * (maxXCoordinate + 1 + 2 * padding), scale * (maxYCoordinate + 1 + 2 * padding) };
+}
+
+void ChainCodeRasterizer::rasterize(const std::vector<std::vector<Pixel>>& coordinates, const uint maxYCoordinate, const uint scale, const uint padding, unsigned char* data, const uint width, const uint height, const size_t stride) {
+    for (uint y = 0; y < height; y++) {
+        std::memset(data + y * stride, BACKGROUND, width);
+    }
+
+    // Each border pixel is a block of scale x scale image pixels (clipped at the image edges).
+    for (const std::vector<Pixel>& currentCoordinates : coordinates) {
+        for (const Pixel& coordinate : currentCoordinates) {
+            const int64_t x = static_cast<int64_t>(scale) * (coordinate.x + static_cast<int64_t>(padding));
+            const int64_t y = static_cast<int64_t>(scale) * (static_cast<int64_t>(maxYCoordinate) - coordinate.y + padding);
+            if (x < 0 || y < 0 || x >= width || y >= height) {
+                continue;
+            }
+
+            const size_t blockWidth = std::min<size_t>(scale, width - x);
+            const uint blockHeight = std::min<uint>(scale, height - static_cast<uint>(y));
+            unsigned char* row = data + static_cast<size_t>(y) * stride + x;
+            for (uint i = 0; i < blockHeight; i++, row += stride) {
+                std::memset(row, BORDER, blockWidth);
+            }
+        }
+    }
+}
+
+RasterImage ChainCodeRasterizer::rasterize(const std::vector<ChainCode>& chainCodes, const uint scale, const uint padding) {
+    const auto& [coordinates, maxXCoordinate, maxYCoordinate] = ChainCodeFunctions::calculateCoordinates(chainCodes);
+
+    RasterImage image;
+    std::tie(image.width, image.height) = imageSize(maxXCoordinate, maxYCoordinate, scale, padding);
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height);
+    rasterize(coordinates, maxYCoordinate, scale, padding, image.pixels.data(), image.width, image.height, image.width);
+
+    return image;
+}
+
+void ChainCodeRasterizer::writePgm(const std::string& file, const RasterImage& image) {
+    std::ofstream out(file, std::ios_base::binary | std::ios_base::trunc);
+    out << "P5\n" << image.width << " " << image.height << "\n255\n";
+    out.write(reinterpret_cast<const char*>(image.pixels.data()), image.pixels.size());
+    if (!out) {
+        throw std::logic_error("Image cannot be written.");
+    }
+}
+
+void ChainCodeRasterizer::writePng(const std::string& file, const RasterImage& image) {
+    std::ofstream out(file, std::ios_base::binary | std::ios_base::trunc);
+    static const unsigned char SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.write(reinterpret_cast<const char*>(SIGNATURE), sizeof(SIGNATURE));
+
+    // Header: 8-bit grayscale, no interlacing.
+    std::vector<unsigned char> header;
+    appendBigEndian(header, image.width);
+    appendBigEndian(header, image.height);
+    header.insert(header.end(), { 8, 0, 0, 0, 0 });
+    writeChunk(out, "IHDR", header);
+
+    // Image data: zlib stream of stored deflate blocks over the rows (each preceded by filter type 0).
+    // Size of the stream is known in advance, so blocks are written as they are produced.
+    const size_t rowSize = static_cast<size_t>(image.width) + 1;
+    const size_t rawSize = rowSize * image.height;
+    const size_t blockCount = std::max<size_t>(1, (rawSize + STORED_BLOCK - 1) / STORED_BLOCK);
+    const size_t streamSize = 2 + 5 * blockCount + rawSize + 4;
+    if (streamSize > 0x7FFFFFFF) {
+        throw std::logic_error("Image is too large for a single PNG chunk.");
+    }
+
+    std::vector<unsigned char> buffer;
+    appendBigEndian(buffer, static_cast<uint>(streamSize));
+    buffer.insert(buffer.end(), { 'I', 'D', 'A', 'T', 0x78, 0x01 });
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    uint crc = crc32(buffer.data() + 4, buffer.size() - 4);
+
+    // Adler-32 checksum of the raw data (sums are reduced once per 5552 bytes, before they can overflow).
+    uint a = 1;
+    uint b = 0;
+    size_t position = 0;
+    size_t row = 0;
+    size_t column = 0;
+    std::vector<unsigned char> block;
+    block.reserve(STORED_BLOCK + 5);
+    do {
+        const size_t length = std::min(STORED_BLOCK, rawSize - position);
+        block.assign({ static_cast<unsigned char>(position + length == rawSize ? 1 : 0),
+            static_cast<unsigned char>(length), static_cast<unsigned char>(length >> 8),
+            static_cast<unsigned char>(~length), static_cast<unsigned char>(~length >> 8) });
+
+        // Copying the rows (with their filter bytes) into the block.
+        for (size_t remaining = length; remaining > 0;) {
+            if (column == 0) {
+                block.push_back(0);
+                column = 1;
+                remaining--;
+                continue;
+            }
+            const size_t count = std::min(remaining, rowSize - column);
+            const unsigned char* pixels = &image.pixels[row * image.width + column - 1];
+            block.insert(block.end(), pixels, pixels + count);
+            remaining -= count;
+            column += count;
+            if (column == rowSize) {
+                column = 0;
+                row++;
+            }
+        }
+
+        for (size_t i = 5; i < block.size();) {
+            const size_t end = std::min(block.size(), i + 5552);
+            for (; i < end; i++) {
+                a += block[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+
+        crc = crc32(block.data(), block.size(), crc);
+        out.write(reinterpret_cast<const char*>(block.data()), block.size());
+        position += length;
+    } while (position < rawSize);
+
+    buffer.clear();
+    appendBigEndian(buffer, (b << 16) | a);
+    crc = crc32(buffer.data(), buffer.size(), crc);
+    appendBigEndian(buffer, crc);
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    writeChunk(out, "IEND", {});
+    if (!out) {
+        throw std::logic_error("Image cannot be written.");
+    }
+}
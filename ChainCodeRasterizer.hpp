@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// 8-bit grayscale image (rows are stored from the top, 0 - border pixel, 255 - background).
+/// </summary>
+struct RasterImage {
+    uint width = 0;
+    uint height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+
+
+/// <summary>
+/// Rasterizer of chain code borders that writes pixels directly into an 8-bit buffer (no Qt dependency).
+/// Each border pixel becomes a scale x scale block; the border is surrounded by padding (in border pixels)
+/// and the Y axis points upwards, as in the rendered images of the application.
+/// </summary>
+class ChainCodeRasterizer {
+public:
+    /// <summary>
+    /// Size of the image of a border whose coordinates lie within [0, maxXCoordinate] x [0, maxYCoordinate].
+    /// </summary>
+    /// <param name="maxXCoordinate">: maximal X coordinate of the border</param>
+    /// <param name="maxYCoordinate">: maximal Y coordinate of the border</param>
+    /// <param name="scale">: size of a border pixel in image pixels</param>
+    /// <param name="padding">: padding around the border (in border pixels)</param>
+    /// <returns>(width, height)</returns>
+    static std::pair<uint, uint> imageSize(const uint maxXCoordinate, const uint maxYCoordinate, const uint scale, const uint padding);
+
+    /// <summary>
+    /// Rasterization of border coordinates into a buffer (e.g. scanlines of a QImage).
+    /// </summary>
+    /// <param name="coordinates">: coordinates of each chain code (as in ChainCodeFunctions::calculateCoordinates)</param>
+    /// <param name="maxYCoordinate">: maximal Y coordinate of the border</param>
+    /// <param name="scale">: size of a border pixel in image pixels</param>
+    /// <param name="padding">: padding around the border (in border pixels)</param>
+    /// <param name="data">: first byte of the buffer</param>
+    /// <param name="width">: width of the buffer in pixels</param>
+    /// <param name="height">: height of the buffer in pixels</param>
+    /// <param name="stride">: distance between the rows of the buffer in bytes</param>
+    static void rasterize(const std::vector<std::vector<Pixel>>& coordinates, const uint maxYCoordinate, const uint scale, const uint padding, unsigned char* data, const uint width, const uint height, const size_t stride);
+
+    /// <summary>
+    /// Rasterization of chain codes into an image.
+    /// </summary>
+    /// <param name="chainCodes">: chain codes</param>
+    /// <param name="scale">: size of a border pixel in image pixels</param>
+    /// <param name="padding">: padding around the border (in border pixels)</param>
+    /// <returns>Image</returns>
+    static RasterImage rasterize(const std::vector<ChainCode>& chainCodes, const uint scale = 2, const uint padding = 1);
+
+    /// <summary>
+    /// Writing an image into a binary PGM file.
+    /// </summary>
+    /// <param name="file">: path to the output file</param>
+    /// <param name="image">: image</param>
+    static void writePgm(const std::string& file, const RasterImage& image);
+
+    /// <summary>
+    /// Writing an image into a grayscale PNG file (uncompressed deflate blocks, so writing is as fast as PGM).
+    /// </summary>
+    /// <param name="file">: path to the output file</param>
+    /// <param name="image">: image</param>
+    static void writePng(const std::string& file, const RasterImage& image);
+};
@@ -1,5 +1,329 @@
+#include <stdexcept>
+
 #include "ChainCodeReplacementLUT.hpp"
 
+
+namespace {
+    // Replacement pixels lie within window + 1 pixels from the window start; the extra pixel of the grid
+    // keeps their neighbours inside it.
+    constexpr int GRID_RADIUS = KGRAM_MAX_WINDOW + 2;
+    constexpr int GRID_SIZE = 2 * GRID_RADIUS + 1;
+    constexpr int GRID_CELLS = GRID_SIZE * GRID_SIZE;
+
+    static_assert(GRID_CELLS <= 192, "Pixel mask is too small for the longest window.");
+
+    // Offsets of grid cells for F4 and F8 commands.
+    constexpr int F4_STEPS[4] = { 1, GRID_SIZE, -1, -GRID_SIZE };
+    constexpr int F8_STEPS[8] = { 1, GRID_SIZE + 1, GRID_SIZE, GRID_SIZE - 1, -1, -GRID_SIZE - 1, -GRID_SIZE, -GRID_SIZE + 1 };
+
+    constexpr int START_CELL = GRID_RADIUS * GRID_SIZE + GRID_RADIUS;
+
+    constexpr int absolute(const int value) {
+        return value < 0 ? -value : value;
+    }
+
+    constexpr uint power(const uint base, const uint exponent) {
+        return exponent == 0 ? 1 : base * power(base, exponent - 1);
+    }
+
+
+    /// <summary>
+    /// Set of grid cells around the window start, stored as a bit mask.
+    /// </summary>
+    struct PixelMask {
+        u64 bits[3] = { 0, 0, 0 };
+
+        constexpr bool contains(const int cell) const {
+            return (bits[cell >> 6] >> (cell & 63)) & 1;
+        }
+
+        constexpr void insert(const int cell) {
+            bits[cell >> 6] |= u64(1) << (cell & 63);
+        }
+
+        constexpr void insert(const PixelMask& mask) {
+            for (uint i = 0; i < 3; i++) {
+                bits[i] |= mask.bits[i];
+            }
+        }
+
+        constexpr void remove(const int cell) {
+            bits[cell >> 6] &= ~(u64(1) << (cell & 63));
+        }
+
+        constexpr void remove(const PixelMask& mask) {
+            for (uint i = 0; i < 3; i++) {
+                bits[i] &= ~mask.bits[i];
+            }
+        }
+    };
+
+
+    /// <summary>
+    /// Vicinity of each grid cell (the cell and its 4 neighbours in F4 or 8 neighbours in F8).
+    /// </summary>
+    struct VicinityMasks {
+        PixelMask masks[2][GRID_CELLS];  // [F4, F8][cell]
+    };
+
+    constexpr VicinityMasks makeVicinityMasks() {
+        VicinityMasks vicinity{};
+        for (int y = 1; y < GRID_SIZE - 1; y++) {
+            for (int x = 1; x < GRID_SIZE - 1; x++) {
+                const int cell = y * GRID_SIZE + x;
+                vicinity.masks[0][cell].insert(cell);
+                vicinity.masks[1][cell].insert(cell);
+                for (uint command = 0; command < 8; command++) {
+                    if (command < 4) {
+                        vicinity.masks[0][cell].insert(cell + F4_STEPS[command]);
+                    }
+                    vicinity.masks[1][cell].insert(cell + F8_STEPS[command]);
+                }
+            }
+        }
+        return vicinity;
+    }
+
+    constexpr VicinityMasks VICINITY = makeVicinityMasks();
+
+
+    /// <summary>
+    /// State of the depth-first search of replacement paths for one window.
+    /// </summary>
+    struct KGramSearch {
+        uint alphabet = 0;
+        const int* steps = nullptr;
+        uint window = 0;                                   // Number of commands in the window.
+        uint maxLength = 0;                                // Longest allowed replacement.
+        int end = 0;                                       // Last cell of the window.
+        short windowCode[KGRAM_MAX_WINDOW] = {};           // Commands of the original path.
+        PixelMask windowInterior;                          // Inner cells of the original path.
+        PixelMask local;                                   // Cells within one pixel from the original path.
+        int path[KGRAM_MAX_REPLACEMENT + 1] = {};          // Cells of the current replacement path.
+        signed char code[KGRAM_MAX_REPLACEMENT] = {};      // Commands of the current replacement path.
+        KGramReplacement best = {};                        // Best replacement found so far.
+        int bestScore = -1;
+    };
+
+    /// <summary>
+    /// Scoring a complete replacement path. Paths that move more pixels off the original path are preferred,
+    /// then longer paths; among equal scores, the first path found is kept.
+    /// </summary>
+    constexpr void recordCandidate(KGramSearch& search, const uint length) {
+        bool unchanged = length == search.window;
+        for (uint i = 0; i < length && unchanged; i++) {
+            unchanged = search.code[i] == search.windowCode[i];
+        }
+        if (unchanged) {
+            return;
+        }
+
+        int displaced = 0;
+        for (uint i = 1; i < length; i++) {
+            displaced += search.windowInterior.contains(search.path[i]) ? 0 : 1;
+        }
+
+        const int score = 16 * displaced + static_cast<int>(length);
+        if (score <= search.bestScore) {
+            return;
+        }
+
+        search.bestScore = score;
+        search.best = KGramReplacement{};
+        search.best.length = static_cast<unsigned char>(length);
+        for (uint i = 0; i < length; i++) {
+            search.best.code[i] = search.code[i];
+        }
+        for (uint i = 1; i < length; i++) {
+            search.best.footprint[i - 1][0] = static_cast<signed char>(search.path[i] % GRID_SIZE - GRID_RADIUS);
+            search.best.footprint[i - 1][1] = static_cast<signed char>(search.path[i] / GRID_SIZE - GRID_RADIUS);
+        }
+    }
+
+    /// <summary>
+    /// Extending the replacement path by one command. Available cells are the local cells without the cells
+    /// of the path and without the vicinity of the cells that are too far back along the path to be touched.
+    /// </summary>
+    constexpr void extendPath(KGramSearch& search, const uint depth, const PixelMask& available, const int displaced) {
+        const uint gap = search.alphabet == 4 ? 2 : 3;
+        const int remaining = static_cast<int>(search.maxLength - depth - 1);
+
+        // Branches that cannot beat the best replacement even if all of their new pixels were displaced are skipped.
+        if (16 * (displaced + remaining) + static_cast<int>(search.maxLength) <= search.bestScore) {
+            return;
+        }
+
+        for (uint command = 0; command < search.alphabet; command++) {
+            const int cell = search.path[depth] + search.steps[command];
+            if (!available.contains(cell)) {
+                continue;
+            }
+
+            // The end of the window has to remain reachable with the remaining commands
+            // (Manhattan distance in F4, chessboard distance in F8).
+            const int dx = absolute(cell % GRID_SIZE - search.end % GRID_SIZE);
+            const int dy = absolute(cell / GRID_SIZE - search.end / GRID_SIZE);
+            if ((search.alphabet == 4 ? dx + dy : (dx > dy ? dx : dy)) > remaining) {
+                continue;
+            }
+
+            search.path[depth + 1] = cell;
+            search.code[depth] = static_cast<signed char>(command);
+
+            if (cell == search.end) {
+                if (depth + 1 >= search.window) {
+                    recordCandidate(search, depth + 1);
+                }
+                continue;
+            }
+
+            PixelMask next = available;
+            next.remove(cell);
+            if (depth + 2 >= gap) {
+                next.remove(VICINITY.masks[search.alphabet == 4 ? 0 : 1][search.path[depth + 2 - gap]]);
+            }
+            extendPath(search, depth + 1, next, displaced + (search.windowInterior.contains(cell) ? 0 : 1));
+        }
+    }
+
+    /// <summary>
+    /// Searching the replacement of a window of commands.
+    /// </summary>
+    constexpr KGramReplacement searchReplacement(const uint alphabet, const short* window, const uint windowSize) {
+        KGramSearch search{};
+        search.alphabet = alphabet;
+        search.steps = alphabet == 4 ? F4_STEPS : F8_STEPS;
+        search.window = windowSize;
+        search.maxLength = windowSize + (alphabet == 4 ? 2 : 1);
+
+        int windowCells[KGRAM_MAX_WINDOW + 1] = { START_CELL };
+        search.local.insert(VICINITY.masks[1][START_CELL]);
+        for (uint i = 0; i < windowSize; i++) {
+            search.windowCode[i] = window[i];
+            windowCells[i + 1] = windowCells[i] + search.steps[window[i]];
+
+            // Windows that revisit a pixel (spikes) are left without a replacement.
+            for (uint j = 0; j <= i; j++) {
+                if (windowCells[j] == windowCells[i + 1]) {
+                    return KGramReplacement{};
+                }
+            }
+
+            search.local.insert(VICINITY.masks[1][windowCells[i + 1]]);
+            if (i + 1 < windowSize) {
+                search.windowInterior.insert(windowCells[i + 1]);
+            }
+        }
+        search.end = windowCells[windowSize];
+
+        PixelMask available = search.local;
+        available.remove(START_CELL);
+        search.path[0] = START_CELL;
+        extendPath(search, 0, available, 0);
+
+        return search.best;
+    }
+
+    /// <summary>
+    /// Rotating a replacement by multiples of 90 degrees and optionally mirroring it over the x axis.
+    /// </summary>
+    constexpr KGramReplacement transformReplacement(const KGramReplacement& replacement, const uint alphabet, const uint rotation, const bool mirror) {
+        KGramReplacement result = replacement;
+        for (uint i = 0; i < replacement.length; i++) {
+            uint command = (static_cast<uint>(replacement.code[i]) + rotation * alphabet / 4) % alphabet;
+            command = mirror ? (alphabet - command) % alphabet : command;
+            result.code[i] = static_cast<signed char>(command);
+        }
+        for (uint i = 0; i + 1 < replacement.length; i++) {
+            int x = replacement.footprint[i][0];
+            int y = replacement.footprint[i][1];
+            for (uint r = 0; r < rotation; r++) {
+                const int rotatedX = -y;
+                y = x;
+                x = rotatedX;
+            }
+            result.footprint[i][0] = static_cast<signed char>(x);
+            result.footprint[i][1] = static_cast<signed char>(mirror ? -y : y);
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Index of the transformed window (see transformReplacement).
+    /// </summary>
+    constexpr uint transformIndex(uint index, const uint alphabet, const uint windowSize, const uint rotation, const bool mirror) {
+        uint result = 0;
+        uint weight = 1;
+        for (uint i = 0; i < windowSize; i++) {
+            uint command = (index % alphabet + rotation * alphabet / 4) % alphabet;
+            command = mirror ? (alphabet - command) % alphabet : command;
+            result += weight * command;
+            weight *= alphabet;
+            index /= alphabet;
+        }
+        return result;
+    }
+
+
+    /// <summary>
+    /// Replacements of all windows of the given size, indexed by the window commands (first command is the most
+    /// significant digit). The second table holds the mirrored replacements of the first one.
+    /// </summary>
+    template<uint Alphabet, uint Window>
+    struct KGramTable {
+        static constexpr uint SIZE = power(Alphabet, Window);
+        KGramReplacement entries[2][SIZE];
+    };
+
+    template<uint Alphabet, uint Window>
+    constexpr KGramTable<Alphabet, Window> makeKGramTable() {
+        KGramTable<Alphabet, Window> table{};
+
+        // The rules are symmetric under rotation, so only windows starting in the first quadrant are searched.
+        constexpr uint SEARCHED = KGramTable<Alphabet, Window>::SIZE / 4;
+        for (uint index = 0; index < SEARCHED; index++) {
+            short window[KGRAM_MAX_WINDOW] = {};
+            uint value = index;
+            for (uint i = Window; i-- > 0;) {
+                window[i] = static_cast<short>(value % Alphabet);
+                value /= Alphabet;
+            }
+
+            const KGramReplacement replacement = searchReplacement(Alphabet, window, Window);
+            for (uint rotation = 0; rotation < 4; rotation++) {
+                table.entries[0][transformIndex(index, Alphabet, Window, rotation, false)] = transformReplacement(replacement, Alphabet, rotation, false);
+            }
+        }
+
+        for (uint index = 0; index < KGramTable<Alphabet, Window>::SIZE; index++) {
+            const uint mirrored = transformIndex(index, Alphabet, Window, 0, true);
+            table.entries[1][index] = transformReplacement(table.entries[0][mirrored], Alphabet, 0, true);
+        }
+
+        return table;
+    }
+
+    // Generating the tables takes more evaluation steps than the default constexpr limit of the compiler
+    // (raised with /constexpr:steps in the project settings).
+    constexpr KGramTable<4, 3> F4_KGRAM3 = makeKGramTable<4, 3>();
+    constexpr KGramTable<4, 4> F4_KGRAM4 = makeKGramTable<4, 4>();
+    constexpr KGramTable<8, 3> F8_KGRAM3 = makeKGramTable<8, 3>();
+    constexpr KGramTable<8, 4> F8_KGRAM4 = makeKGramTable<8, 4>();
+
+    /// <summary>
+    /// Index of a window in the k-gram table.
+    /// </summary>
+    uint windowIndex(const short* window, const uint windowSize, const uint alphabet) {
+        uint index = 0;
+        for (uint i = 0; i < windowSize; i++) {
+            index = index * alphabet + static_cast<uint>(window[i]);
+        }
+        return index;
+    }
+}
+
+
+
 ChainCodeReplacementLUT::ChainCodeReplacementLUT() {
     m_Tables[ChainCodeType::F8] = std::vector({ m_F8_LUT1, m_F8_LUT2 });
     m_Tables[ChainCodeType::F4] = std::vector({ m_F4_LUT1, m_F4_LUT2 });
@@ -8,4 +332,23 @@ ChainCodeReplacementLUT::ChainCodeReplacementLUT() {
 std::vector<short> ChainCodeReplacementLUT::findReplacement(const ChainCodeType& type, const bool firstTable, const short connectionIn, const short connectionOut) {
     const short first = firstTable ? 0 : 1;
     return m_Tables[type][first][connectionIn][connectionOut];
-}
\ No newline at end of file
+}
+
+const KGramReplacement& ChainCodeReplacementLUT::findReplacement(const ChainCodeType& type, const bool firstTable, const short* window, const uint windowSize) const {
+    const uint table = firstTable ? 0 : 1;
+
+    if (type == ChainCodeType::F4 && windowSize == 3) {
+        return F4_KGRAM3.entries[table][windowIndex(window, windowSize, 4)];
+    }
+    else if (type == ChainCodeType::F4 && windowSize == 4) {
+        return F4_KGRAM4.entries[table][windowIndex(window, windowSize, 4)];
+    }
+    else if (type == ChainCodeType::F8 && windowSize == 3) {
+        return F8_KGRAM3.entries[table][windowIndex(window, windowSize, 8)];
+    }
+    else if (type == ChainCodeType::F8 && windowSize == 4) {
+        return F8_KGRAM4.entries[table][windowIndex(window, windowSize, 8)];
+    }
+
+    throw std::logic_error("No k-gram replacement table for the chain code type and window size.");
+}
@@ -6,6 +6,23 @@
 #include "Constants.hpp"
 
 
+// CONSTANTS
+constexpr uint KGRAM_MIN_WINDOW = 3;                          // Shortest window of the k-gram tables.
+constexpr uint KGRAM_MAX_WINDOW = 4;                          // Longest window of the k-gram tables.
+constexpr uint KGRAM_MAX_REPLACEMENT = KGRAM_MAX_WINDOW + 2;  // Longest replacement of a window.
+
+
+/// <summary>
+/// Replacement of a window of chain code commands. The replacement path connects the same endpoints
+/// as the window without revisiting or touching its own pixels, and stays within one pixel of the window.
+/// </summary>
+struct KGramReplacement {
+    unsigned char length;                                 // Number of replacement commands (0 if the window has no replacement).
+    signed char code[KGRAM_MAX_REPLACEMENT];              // Replacement commands.
+    signed char footprint[KGRAM_MAX_REPLACEMENT - 1][2];  // Offsets (x, y) of the new pixels from the first pixel of the window.
+};
+
+
 class ChainCodeReplacementLUT {
 private:
     // Lookup table for chain code noise.
@@ -65,5 +82,15 @@ public:
     /// <param name="connectionOut">: pixel outward chain code direction</param>
     /// <returns>Replacement sequence of chain code orders.</returns>
     std::vector<short> findReplacement(const ChainCodeType& type, const bool firstTable, const short connectionIn, const short connectionOut);
+
+    /// <summary>
+    /// Finding a replacement of a window of commands in the k-gram tables (generated at compile time).
+    /// </summary>
+    /// <param name="type">: chain code type (F4 or F8)</param>
+    /// <param name="firstTable">: choosing replacement from first table if true (second table holds mirrored replacements)</param>
+    /// <param name="window">: pointer to the first command of the window</param>
+    /// <param name="windowSize">: number of commands in the window (3 or 4)</param>
+    /// <returns>Replacement of the window (with zero length if the window cannot be replaced)</returns>
+    const KGramReplacement& findReplacement(const ChainCodeType& type, const bool firstTable, const short* window, const uint windowSize) const;
 };
 
@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CHAINCODE_SMOOTHER_SSE2
+#endif
+
+#include "ChainCodeReplacementLUT.hpp"
+#include "ChainCodeSmoother.hpp"
+
+
+namespace {
+    // Vicinity of the pixel of a collapsed pair (the pixel and its neighbours, as in the self-touching check of the noise).
+    constexpr int F4_VICINITY[5][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+    constexpr int F8_VICINITY[9][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+}
+
+
+ChainCodeSmoother::ChainCodeSmoother() : m_F4(createPatterns(ChainCodeType::F4)), m_F8(createPatterns(ChainCodeType::F8)) {
+}
+
+ChainCodeSmoother::PatternSet ChainCodeSmoother::createPatterns(const ChainCodeType type) {
+    PatternSet set;
+    set.alphabet = type == ChainCodeType::F4 ? 4 : 8;
+    for (uint command = 0; command < set.alphabet; command++) {
+        const Pixel pixel = ChainCodeFunctions::chainCodeMove(type, command, Pixel(0, 0));
+        set.steps[command][0] = pixel.x;
+        set.steps[command][1] = pixel.y;
+    }
+
+    ChainCodeReplacementLUT lut;
+    std::vector<Pattern> ambiguous;
+    for (const bool firstTable : { true, false }) {
+        for (short first = 0; first < static_cast<short>(set.alphabet); first++) {
+            for (short second = 0; second < static_cast<short>(set.alphabet); second++) {
+                const std::vector<short> replacement = lut.findReplacement(type, firstTable, first, second);
+                if (replacement.size() <= 2) {
+                    continue;
+                }
+                if (replacement.size() > SMOOTHING_MAX_PATTERN) {
+                    throw std::logic_error("Replacement is too long to be smoothed.");
+                }
+
+                Pattern pattern = {};
+                pattern.length = static_cast<uint>(replacement.size());
+                pattern.pair[0] = first;
+                pattern.pair[1] = second;
+                for (uint i = 0; i < pattern.length; i++) {
+                    pattern.code[i] = replacement[i];
+                    pattern.key |= static_cast<uint>(replacement[i]) << (3 * i);
+                }
+                pattern.mask = (1u << (3 * pattern.length)) - 1;
+
+                // The same replacement in both tables is kept once; a replacement of different pairs is dropped.
+                auto same = [&](const Pattern& other) { return other.key == pattern.key && other.length == pattern.length; };
+                const auto existing = std::find_if(set.patterns.begin(), set.patterns.end(), same);
+                if (existing == set.patterns.end()) {
+                    set.patterns.push_back(pattern);
+                }
+                else if (existing->pair[0] != first || existing->pair[1] != second) {
+                    ambiguous.push_back(pattern);
+                }
+            }
+        }
+    }
+    for (const Pattern& pattern : ambiguous) {
+        set.patterns.erase(std::remove_if(set.patterns.begin(), set.patterns.end(), [&](const Pattern& other) {
+            return other.key == pattern.key && other.length == pattern.length;
+        }), set.patterns.end());
+    }
+
+    if (set.patterns.size() > SMOOTHING_MAX_PATTERNS) {
+        throw std::logic_error("Too many replacement patterns to be smoothed.");
+    }
+
+    // Longer patterns are preferred where a window matches several.
+    std::stable_sort(set.patterns.begin(), set.patterns.end(), [](const Pattern& a, const Pattern& b) {
+        return a.length > b.length;
+    });
+    set.lookup.fill(-1);
+    for (uint key = 0; key < set.lookup.size(); key++) {
+        for (uint i = 0; i < set.patterns.size() && set.lookup[key] < 0; i++) {
+            if ((key & set.patterns[i].mask) == set.patterns[i].key) {
+                set.lookup[key] = static_cast<int>(i);
+            }
+        }
+    }
+
+    return set;
+}
+
+void ChainCodeSmoother::findCandidates(const PatternSet& patterns, const std::vector<short>& code) {
+    m_Candidates.clear();
+    const size_t size = code.size();
+    size_t i = 0;
+
+#ifdef CHAINCODE_SMOOTHER_SSE2
+    // Windows of 8 positions: the commands at the position and the 3 following ones are packed into 12 bits of a
+    // lane and compared with the masked key of each pattern.
+    if (!patterns.patterns.empty()) {
+        const size_t count = patterns.patterns.size();
+        __m128i keys[SMOOTHING_MAX_PATTERNS];
+        __m128i masks[SMOOTHING_MAX_PATTERNS];
+        for (size_t p = 0; p < count; p++) {
+            keys[p] = _mm_set1_epi16(static_cast<short>(patterns.patterns[p].key));
+            masks[p] = _mm_set1_epi16(static_cast<short>(patterns.patterns[p].mask));
+        }
+
+        const short* data = code.data();
+        for (; i + 8 + SMOOTHING_MAX_PATTERN - 1 <= size; i += 8) {
+            const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+            const __m128i c2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2));
+            const __m128i c3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 3));
+            const __m128i key = _mm_or_si128(_mm_or_si128(c0, _mm_slli_epi16(c1, 3)), _mm_or_si128(_mm_slli_epi16(c2, 6), _mm_slli_epi16(c3, 9)));
+
+            __m128i found = _mm_setzero_si128();
+            for (size_t p = 0; p < count; p++) {
+                found = _mm_or_si128(found, _mm_cmpeq_epi16(_mm_and_si128(key, masks[p]), keys[p]));
+            }
+
+            const int bits = _mm_movemask_epi8(found);
+            if (bits != 0) {
+                for (uint lane = 0; lane < 8; lane++) {
+                    if ((bits >> (2 * lane)) & 1) {
+                        m_Candidates.push_back(static_cast<uint>(i + lane));
+                    }
+                }
+            }
+        }
+    }
+#endif
+
+    for (; i < size; i++) {
+        if (patternAt(patterns, code, i) != nullptr) {
+            m_Candidates.push_back(static_cast<uint>(i));
+        }
+    }
+}
+
+const ChainCodeSmoother::Pattern* ChainCodeSmoother::patternAt(const PatternSet& patterns, const std::vector<short>& code, const size_t position) {
+    const size_t size = code.size();
+
+    // Near the end, the patterns that do not fit are skipped.
+    if (position + SMOOTHING_MAX_PATTERN > size) {
+        for (const Pattern& pattern : patterns.patterns) {
+            if (position + pattern.length <= size && std::equal(pattern.code, pattern.code + pattern.length, code.begin() + position)) {
+                return &pattern;
+            }
+        }
+        return nullptr;
+    }
+
+    uint key = 0;
+    for (uint j = 0; j < SMOOTHING_MAX_PATTERN; j++) {
+        key |= static_cast<uint>(code[position + j] & 7) << (3 * j);
+    }
+    const int index = patterns.lookup[key];
+    return index < 0 ? nullptr : &patterns.patterns[index];
+}
+
+ChainCode ChainCodeSmoother::collapsePatterns(const ChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels) {
+    if (chainCode.type != ChainCodeType::F4 && chainCode.type != ChainCodeType::F8) {
+        throw std::logic_error("Smoothing can only be applied to F4 and F8 chain codes.");
+    }
+    const PatternSet& patterns = chainCode.type == ChainCodeType::F4 ? m_F4 : m_F8;
+    const std::vector<short>& code = chainCode.code;
+
+    findCandidates(patterns, code);
+    m_Statistics.commands += code.size();
+    m_Statistics.candidates += m_Candidates.size();
+
+    ChainCode smoothedChainCode("", chainCode.type, chainCode.startX, chainCode.startY, chainCode.initialDirection);
+    smoothedChainCode.orientation = chainCode.orientation;
+    smoothedChainCode.headerValue = chainCode.headerValue;
+    smoothedChainCode.code.reserve(code.size());
+
+    const int(*vicinity)[2] = chainCode.type == ChainCodeType::F4 ? F4_VICINITY : F8_VICINITY;
+    const uint vicinitySize = chainCode.type == ChainCodeType::F4 ? 5 : 9;
+
+    Pixel currentPixel = startPixel;
+    size_t walked = 0;  // Input position of the current pixel.
+    size_t copied = 0;  // Input commands before this position are in the output.
+    Pixel patternPixels[SMOOTHING_MAX_PATTERN + 1];
+
+    for (const uint position : m_Candidates) {
+        if (position < copied) {
+            m_Statistics.overlaps++;
+            continue;
+        }
+        const Pattern* pattern = patternAt(patterns, code, position);
+        if (pattern == nullptr) {
+            continue;
+        }
+
+        for (; walked < position; walked++) {
+            currentPixel.x += patterns.steps[code[walked]][0];
+            currentPixel.y += patterns.steps[code[walked]][1];
+        }
+
+        // Pixels of the pattern (all of them are excluded from the check of the new pixel) and the pixel of the pair.
+        patternPixels[0] = currentPixel;
+        for (uint j = 0; j < pattern->length; j++) {
+            patternPixels[j + 1] = Pixel(patternPixels[j].x + patterns.steps[pattern->code[j]][0], patternPixels[j].y + patterns.steps[pattern->code[j]][1]);
+        }
+        const Pixel pairPixel(currentPixel.x + patterns.steps[pattern->pair[0]][0], currentPixel.y + patterns.steps[pattern->pair[0]][1]);
+
+        bool touching = false;
+        for (uint v = 0; v < vicinitySize && !touching; v++) {
+            const Pixel checkPixel(pairPixel.x + vicinity[v][0], pairPixel.y + vicinity[v][1]);
+            if (std::find(patternPixels, patternPixels + pattern->length + 1, checkPixel) != patternPixels + pattern->length + 1) {
+                continue;
+            }
+            touching = borderPixels.find(checkPixel) != borderPixels.end();
+        }
+        if (touching) {
+            m_Statistics.rejections++;
+            continue;
+        }
+
+        for (uint j = 1; j < pattern->length; j++) {
+            m_RepeatedPixels.erase(borderPixels, patternPixels[j]);
+        }
+        m_RepeatedPixels.insert(borderPixels, pairPixel);
+
+        smoothedChainCode.code.insert(smoothedChainCode.code.end(), code.begin() + copied, code.begin() + position);
+        smoothedChainCode.code.push_back(pattern->pair[0]);
+        smoothedChainCode.code.push_back(pattern->pair[1]);
+        copied = position + pattern->length;
+        walked = copied;
+        currentPixel = patternPixels[pattern->length];
+        m_Statistics.collapses++;
+    }
+    smoothedChainCode.code.insert(smoothedChainCode.code.end(), code.begin() + copied, code.end());
+
+    return smoothedChainCode;
+}
+
+ChainCode ChainCodeSmoother::smoothChainCode(const ChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels) {
+    m_RepeatedPixels.count(std::vector<ChainCode>{ chainCode }, { startPixel });
+    return collapsePatterns(chainCode, startPixel, borderPixels);
+}
+
+std::vector<ChainCode> ChainCodeSmoother::smooth(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels) {
+    if (chainCodes.size() != startPixels.size()) {
+        throw std::logic_error("Each chain code needs a starting pixel.");
+    }
+
+    m_RepeatedPixels.count(chainCodes, startPixels);
+    std::vector<ChainCode> smoothedChainCodes;
+    smoothedChainCodes.reserve(chainCodes.size());
+    for (size_t i = 0; i < chainCodes.size(); i++) {
+        smoothedChainCodes.push_back(collapsePatterns(chainCodes[i], startPixels[i], borderPixels));
+    }
+    return smoothedChainCodes;
+}
+
+const SmoothingStatistics& ChainCodeSmoother::statistics() const {
+    return m_Statistics;
+}
+
+void ChainCodeSmoother::resetStatistics() {
+    m_Statistics = SmoothingStatistics();
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <unordered_set>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+#include "RepeatedPixels.hpp"
+
+
+// CONSTANTS
+constexpr uint SMOOTHING_MAX_PATTERN = 4;    // Longest replacement of a pair that is collapsed (F4 bumps).
+constexpr uint SMOOTHING_MAX_PATTERNS = 32;  // Number of patterns of a chain code type compared at once.
+
+
+/// <summary>
+/// Counters of the smoothing.
+/// </summary>
+struct SmoothingStatistics {
+    u64 commands = 0;    // Number of input commands scanned.
+    u64 candidates = 0;  // Number of positions where a replacement pattern was found.
+    u64 collapses = 0;   // Number of patterns collapsed into their pair.
+    u64 overlaps = 0;    // Number of candidates skipped because they overlap an earlier collapse.
+    u64 rejections = 0;  // Number of candidates rejected because the collapse would touch the border.
+};
+
+
+/// <summary>
+/// Inverse of the pair noise: replacement sequences of ChainCodeReplacementLUT that are longer than their pair
+/// (e.g. {0, 1, 2} for {1, 1} in F8) are collapsed back into the pair. Candidates are found for all patterns at
+/// once by comparing packed windows of 8 positions (SSE2, scalar on other targets), then the collapses are
+/// committed in one pass from the start of the chain code: a candidate is skipped if it overlaps an earlier
+/// collapse or if the pixel of the pair would touch the border (the same check as the noise). The ends of a
+/// pattern are the ends of its pair, so the pixels after a collapse stay where they were.
+/// </summary>
+class ChainCodeSmoother {
+private:
+    // Replacement sequence and the pair it is collapsed into.
+    struct Pattern {
+        short code[SMOOTHING_MAX_PATTERN];
+        uint length;
+        short pair[2];
+        uint key;   // Commands packed by 3 bits, the first command in the lowest bits.
+        uint mask;  // Bits of the key that belong to the pattern.
+    };
+
+    // Patterns of a chain code type.
+    struct PatternSet {
+        std::vector<Pattern> patterns;
+        std::array<int, 1 << (3 * SMOOTHING_MAX_PATTERN)> lookup;  // Packed window to the index of its pattern (-1 if none).
+        int steps[8][2];                                           // Pixel offsets (x, y) of the commands.
+        uint alphabet;
+    };
+
+    PatternSet m_F4;
+    PatternSet m_F8;
+    std::vector<uint> m_Candidates;  // Candidate positions of the current chain code (reused).
+    RepeatedPixels m_RepeatedPixels;  // Border pixels visited more than once by the smoothed chain codes.
+    SmoothingStatistics m_Statistics;
+
+    /// <summary>
+    /// Collecting the patterns of a chain code type from both pair tables. Replacements that are not longer than
+    /// their pair, and replacements that stand for more than one pair, cannot be told apart from the original
+    /// commands and are left out.
+    /// </summary>
+    /// <param name="type">: type of the chain code (F4 or F8)</param>
+    /// <returns>Patterns</returns>
+    static PatternSet createPatterns(const ChainCodeType type);
+
+    /// <summary>
+    /// Finding the positions where a pattern starts.
+    /// </summary>
+    /// <param name="patterns">: patterns of the chain code type</param>
+    /// <param name="code">: commands of the chain code</param>
+    void findCandidates(const PatternSet& patterns, const std::vector<short>& code);
+
+    /// <summary>
+    /// Pattern starting at a position.
+    /// </summary>
+    /// <param name="patterns">: patterns of the chain code type</param>
+    /// <param name="code">: commands of the chain code</param>
+    /// <param name="position">: index of the first command</param>
+    /// <returns>Pattern, nullptr if there is none</returns>
+    static const Pattern* patternAt(const PatternSet& patterns, const std::vector<short>& code, const size_t position);
+
+    /// <summary>
+    /// Collapsing the replacement patterns of a chain code whose visits are counted in m_RepeatedPixels.
+    /// </summary>
+    /// <param name="chainCode">: the given chain code (F4 or F8)</param>
+    /// <param name="startPixel">: first pixel</param>
+    /// <param name="borderPixels">: hash table of border pixels (updated with the collapses)</param>
+    /// <returns>Smoothed chain code</returns>
+    ChainCode collapsePatterns(const ChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels);
+
+public:
+    /// <summary>
+    /// Constructor that inverts the pair replacement tables.
+    /// </summary>
+    ChainCodeSmoother();
+
+    /// <summary>
+    /// Collapsing the replacement patterns of a chain code. A pixel that the chain code visits more than once stays
+    /// on the border until its last visit is collapsed.
+    /// </summary>
+    /// <param name="chainCode">: the given chain code (F4 or F8)</param>
+    /// <param name="startPixel">: first pixel</param>
+    /// <param name="borderPixels">: hash table of border pixels (updated with the collapses)</param>
+    /// <returns>Smoothed chain code</returns>
+    ChainCode smoothChainCode(const ChainCode& chainCode, const Pixel& startPixel, std::unordered_set<Pixel>& borderPixels);
+
+    /// <summary>
+    /// Collapsing the replacement patterns of all chain codes (one pass each). Pixels shared by several positions of
+    /// the chain codes stay on the border until their last visit is collapsed, so the border pixels remain those
+    /// traced from the smoothed chain codes.
+    /// </summary>
+    /// <param name="chainCodes">: the given chain codes (F4 or F8)</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels (updated with the collapses)</param>
+    /// <returns>Vector of smoothed chain codes</returns>
+    std::vector<ChainCode> smooth(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels);
+
+    /// <summary>
+    /// Counters of the smoothing since the construction or the last reset.
+    /// </summary>
+    const SmoothingStatistics& statistics() const;
+
+    /// <summary>
+    /// Resetting the counters.
+    /// </summary>
+    void resetStatistics();
+};
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+#include "ChainCodeTranscoder.hpp"
+
+
+namespace {
+    constexpr size_t BLOCK_SIZE = 4096;      // Number of commands converted at once.
+
+    // F4 direction -> F8 direction.
+    constexpr short F4_TO_F8[4] = { 0, 2, 4, 6 };
+
+    // F8 direction -> one or two F4 directions (horizontal move first, -1 if unused).
+    // Even F8 directions are F4 directions multiplied by two.
+    constexpr short F8_TO_F4[8][2] = { {0, -1}, {0, 1}, {1, -1}, {2, 1}, {2, -1}, {2, 3}, {3, -1}, {0, 3} };
+
+    /// <summary>
+    /// Order of the moves that replace an F8 diagonal, chosen so that the F4 path does not reverse
+    /// its direction. Indexed by [previous F4 direction + 1][diagonal][next F8 command + 1].
+    /// </summary>
+    struct DiagonalOrderTable {
+        bool verticalFirst[5][4][9];
+    };
+
+    constexpr DiagonalOrderTable makeDiagonalOrderTable() {
+        DiagonalOrderTable table{};
+
+        for (int previous = -1; previous < 4; previous++) {
+            for (uint diagonal = 0; diagonal < 4; diagonal++) {
+                const short horizontal = F8_TO_F4[2 * diagonal + 1][0];
+                const short vertical = F8_TO_F4[2 * diagonal + 1][1];
+
+                for (int next = -1; next < 8; next++) {
+                    // Vertical move goes first if the horizontal one would reverse the previous direction
+                    // or if the last (vertical) move would be reversed by the next command.
+                    bool nextReversesVertical = false;
+                    if (next >= 0) {
+                        nextReversesVertical = F8_TO_F4[next][0] == (vertical + 2) % 4 || F8_TO_F4[next][1] == (vertical + 2) % 4;
+                    }
+                    table.verticalFirst[previous + 1][diagonal][next + 1] = previous == (horizontal + 2) % 4 || nextReversesVertical;
+                }
+            }
+        }
+
+        return table;
+    }
+
+    constexpr DiagonalOrderTable DIAGONAL_ORDER = makeDiagonalOrderTable();
+
+    // Turn (difference of consecutive F4 directions) -> VCC command and back.
+    constexpr unsigned char TURN_TO_VCC[4] = { 2, 1, 0, 3 };
+    constexpr unsigned char VCC_TO_TURN[4] = { 2, 1, 0, 3 };
+
+
+    /// <summary>
+    /// State-transition tables of 3OT. The state is (reference direction, support direction),
+    /// encoded as 4 * reference + support; each entry holds the output in the lowest two bits
+    /// and the next state above them.
+    /// </summary>
+    struct ThreeOTTables {
+        unsigned char encode[16][4];  // [state][F4 direction] -> 3OT command, next state.
+        unsigned char decode[16][4];  // [state][3OT command] -> F4 direction, next state.
+    };
+
+    constexpr ThreeOTTables makeThreeOTTables() {
+        ThreeOTTables tables{};
+
+        for (uint reference = 0; reference < 4; reference++) {
+            for (uint support = 0; support < 4; support++) {
+                const uint state = 4 * reference + support;
+                const uint opposite = (reference + 2) % 4;
+                const uint backwards = (support + 2) % 4;
+
+                // Encoding: no change (0), change to the reference direction (1), change away from it (2),
+                // reversal (3). Reversal keeps the reference direction.
+                for (uint direction = 0; direction < 4; direction++) {
+                    if (direction == support) {
+                        tables.encode[state][direction] = static_cast<unsigned char>(0 | (state << 2));
+                    }
+                    else if (direction == reference) {
+                        tables.encode[state][direction] = static_cast<unsigned char>(1 | ((4 * support + direction) << 2));
+                    }
+                    else if (direction == opposite) {
+                        tables.encode[state][direction] = static_cast<unsigned char>(2 | ((4 * support + direction) << 2));
+                    }
+                    else {
+                        tables.encode[state][direction] = static_cast<unsigned char>(3 | ((4 * reference + direction) << 2));
+                    }
+                }
+
+                // Decoding is the inverse mapping.
+                tables.decode[state][0] = static_cast<unsigned char>(support | (state << 2));
+                tables.decode[state][1] = static_cast<unsigned char>(reference | ((4 * support + reference) << 2));
+                tables.decode[state][2] = static_cast<unsigned char>(opposite | ((4 * support + opposite) << 2));
+                tables.decode[state][3] = static_cast<unsigned char>(backwards | ((4 * reference + backwards) << 2));
+            }
+        }
+
+        return tables;
+    }
+
+    constexpr ThreeOTTables THREE_OT = makeThreeOTTables();
+
+    /// <summary>
+    /// Initial 3OT state: the reference direction lies to the left of the initial direction.
+    /// </summary>
+    constexpr uint initialThreeOTState(const short initialDirection) {
+        return 4 * ((initialDirection + 1) % 4) + initialDirection;
+    }
+
+    /// <summary>
+    /// Checking whether a command is valid for the chain code type.
+    /// </summary>
+    void validateCommand(const short command, const uint alphabet) {
+        if (command < 0 || static_cast<uint>(command) >= alphabet) {
+            throw std::logic_error("Invalid chain code command.");
+        }
+    }
+
+
+    /// <summary>
+    /// Conversion of a block of commands of any type into F4 directions.
+    /// </summary>
+    class F4Decoder {
+    private:
+        ChainCodeType m_Type;
+        short m_Previous;  // Previous F4 direction (VCC, F8).
+        uint m_State;      // Current 3OT state.
+
+    public:
+        F4Decoder(const ChainCode& chainCode) :
+            m_Type(chainCode.type),
+            m_Previous(chainCode.type == ChainCodeType::F8 ? -1 : chainCode.initialDirection),
+            m_State(initialThreeOTState(chainCode.initialDirection))
+        {}
+
+        void process(const short* commands, const size_t count, const short nextCommand, std::vector<short>& out) {
+            if (m_Type == ChainCodeType::F4) {
+                for (size_t i = 0; i < count; i++) {
+                    validateCommand(commands[i], 4);
+                }
+                out.insert(out.end(), commands, commands + count);
+            }
+            else if (m_Type == ChainCodeType::F8) {
+                short previous = m_Previous;
+                for (size_t i = 0; i < count; i++) {
+                    validateCommand(commands[i], 8);
+                    const short* moves = F8_TO_F4[commands[i]];
+
+                    // Straight moves map directly, diagonals are split into two moves.
+                    if (moves[1] < 0) {
+                        out.push_back(moves[0]);
+                        previous = moves[0];
+                        continue;
+                    }
+
+                    const short next = i + 1 < count ? commands[i + 1] : nextCommand;
+                    const bool verticalFirst = DIAGONAL_ORDER.verticalFirst[previous + 1][commands[i] / 2][next + 1];
+                    const short first = verticalFirst ? moves[1] : moves[0];
+                    const short second = verticalFirst ? moves[0] : moves[1];
+
+                    out.push_back(first);
+                    out.push_back(second);
+                    previous = second;
+                }
+                m_Previous = previous;
+            }
+            else if (m_Type == ChainCodeType::VCC) {
+                short previous = m_Previous;
+                for (size_t i = 0; i < count; i++) {
+                    validateCommand(commands[i], 4);
+                    const unsigned char turn = VCC_TO_TURN[commands[i]];
+                    previous = static_cast<short>((previous + turn) % 4);
+                    out.push_back(previous);
+                }
+                m_Previous = previous;
+            }
+            else if (m_Type == ChainCodeType::ThreeOT) {
+                uint state = m_State;
+                for (size_t i = 0; i < count; i++) {
+                    validateCommand(commands[i], 4);
+                    const unsigned char entry = THREE_OT.decode[state][commands[i]];
+                    out.push_back(static_cast<short>(entry & 3));
+                    state = entry >> 2;
+                }
+                m_State = state;
+            }
+            else {
+                throw std::logic_error("Invalid chain code type.");
+            }
+        }
+    };
+
+
+    /// <summary>
+    /// Conversion of a block of F4 directions into commands of any type.
+    /// </summary>
+    class F4Encoder {
+    private:
+        ChainCodeType m_Type;
+        short m_Previous;  // Previous F4 direction (VCC).
+        uint m_State;      // Current 3OT state.
+
+    public:
+        F4Encoder(const ChainCodeType type, const short initialDirection) :
+            m_Type(type),
+            m_Previous(initialDirection),
+            m_State(initialThreeOTState(initialDirection))
+        {}
+
+        void process(const short* directions, const size_t count, std::vector<short>& out) {
+            if (m_Type == ChainCodeType::F4) {
+                out.insert(out.end(), directions, directions + count);
+            }
+            else if (m_Type == ChainCodeType::F8) {
+                for (size_t i = 0; i < count; i++) {
+                    out.push_back(F4_TO_F8[directions[i]]);
+                }
+            }
+            else if (m_Type == ChainCodeType::VCC) {
+                short previous = m_Previous;
+                for (size_t i = 0; i < count; i++) {
+                    out.push_back(TURN_TO_VCC[(directions[i] - previous + 4) % 4]);
+                    previous = directions[i];
+                }
+                m_Previous = previous;
+            }
+            else if (m_Type == ChainCodeType::ThreeOT) {
+                uint state = m_State;
+                for (size_t i = 0; i < count; i++) {
+                    const unsigned char entry = THREE_OT.encode[state][directions[i]];
+                    out.push_back(static_cast<short>(entry & 3));
+                    state = entry >> 2;
+                }
+                m_State = state;
+            }
+            else {
+                throw std::logic_error("Invalid chain code type.");
+            }
+        }
+    };
+}
+
+
+
+ChainCode ChainCodeTranscoder::transcode(const ChainCode& chainCode, const ChainCodeType targetType) {
+    ChainCode result("", targetType, chainCode.startX, chainCode.startY, 0);
+    result.orientation = chainCode.orientation;
+    result.headerValue = chainCode.headerValue;
+    if (chainCode.type == targetType) {
+        result.code = chainCode.code;
+        result.initialDirection = chainCode.initialDirection;
+        return result;
+    }
+
+    result.code.reserve(chainCode.type == ChainCodeType::F8 ? 3 * chainCode.code.size() / 2 : chainCode.code.size());
+
+    F4Decoder decoder(chainCode);
+    std::vector<short> directions;
+    directions.reserve(2 * BLOCK_SIZE);
+
+    // The initial direction of relative codes is the first F4 direction, so the first command is always straight.
+    std::unique_ptr<F4Encoder> encoder;
+
+    for (size_t start = 0; start < chainCode.code.size(); start += BLOCK_SIZE) {
+        const size_t count = std::min(BLOCK_SIZE, chainCode.code.size() - start);
+
+        const short next = start + count < chainCode.code.size() ? chainCode.code[start + count] : -1;
+
+        directions.clear();
+        decoder.process(chainCode.code.data() + start, count, next, directions);
+
+        if (!encoder) {
+            result.initialDirection = directions.empty() ? 0 : directions[0];
+            encoder = std::make_unique<F4Encoder>(targetType, result.initialDirection);
+        }
+        encoder->process(directions.data(), directions.size(), result.code);
+    }
+
+    return result;
+}
+
+std::vector<ChainCode> ChainCodeTranscoder::transcode(const std::vector<ChainCode>& chainCodes, const ChainCodeType targetType) {
+    std::vector<ChainCode> results;
+    results.reserve(chainCodes.size());
+
+    for (const ChainCode& chainCode : chainCodes) {
+        results.push_back(transcode(chainCode, targetType));
+    }
+
+    return results;
+}
+
+void ChainCodeTranscoder::transcodeFile(const std::string& inputFile, const std::string& outputFile, const ChainCodeType targetType) {
+    const std::vector<ChainCode> chainCodes = ChainCodeFunctions::readChainCodeFile(inputFile);
+    ChainCodeFunctions::writeChainCodeFile(outputFile, transcode(chainCodes, targetType));
+}
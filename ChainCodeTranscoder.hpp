@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+
+
+/// <summary>
+/// Table-driven conversion between F4, F8, VCC and 3OT chain codes. Commands are converted
+/// block by block with small state-transition tables, without computing pixel coordinates.
+///
+/// F4, VCC and 3OT describe the same 4-connected paths, so conversions between them (and
+/// from them to F8) are lossless. One-pixel spikes, present in some of the datasets, are
+/// coded with the extra reversal command (0 in VCC, 3 in 3OT). F8 diagonal moves are
+/// expanded into a horizontal and a vertical F4 move, so F8 codes with diagonals return
+/// as the equivalent 4-connected path.
+/// </summary>
+namespace ChainCodeTranscoder {
+    /// <summary>
+    /// Converting a chain code to another type.
+    /// </summary>
+    /// <param name="chainCode">: input chain code</param>
+    /// <param name="targetType">: type of the output chain code</param>
+    /// <returns>Converted chain code</returns>
+    ChainCode transcode(const ChainCode& chainCode, const ChainCodeType targetType);
+
+    /// <summary>
+    /// Converting a vector of chain codes to another type.
+    /// </summary>
+    /// <param name="chainCodes">: input chain codes</param>
+    /// <param name="targetType">: type of the output chain codes</param>
+    /// <returns>Converted chain codes</returns>
+    std::vector<ChainCode> transcode(const std::vector<ChainCode>& chainCodes, const ChainCodeType targetType);
+
+    /// <summary>
+    /// Converting a chain code file to another type.
+    /// </summary>
+    /// <param name="inputFile">: path to the input file (CC Multi)</param>
+    /// <param name="outputFile">: path to the output file (CC Multi)</param>
+    /// <param name="targetType">: type of the output chain codes</param>
+    void transcodeFile(const std::string& inputFile, const std::string& outputFile, const ChainCodeType targetType);
+}
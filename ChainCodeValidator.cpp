@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "ChainCodeValidator.hpp"
+
+
+namespace {
+    // Number of pixels walked by one task of the resolution (contours are split into walks of this length).
+    constexpr u64 WALK_LENGTH = 1 << 16;
+
+    // Moves of the F8 and F4 commands.
+    constexpr int F8_DX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+    constexpr int F8_DY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+    constexpr int F4_DX[4] = { 1, 0, -1, 0 };
+    constexpr int F4_DY[4] = { 0, 1, 0, -1 };
+
+    // Vicinity of a pixel (the first 4 offsets form the 4-neighbourhood).
+    constexpr int VICINITY_DX[8] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+    constexpr int VICINITY_DY[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+
+    bool isValidCommand(const ChainCodeType type, const short command) {
+        return command >= 0 && command < (type == ChainCodeType::F8 ? 8 : 4);
+    }
+
+    // Moving the pixel by a command in place (invalid commands do not move, false is returned).
+    bool move(const ChainCodeType type, const short command, Pixel& pixel, const int sign = 1) {
+        if (!isValidCommand(type, command)) {
+            return false;
+        }
+        pixel.x += sign * (type == ChainCodeType::F8 ? F8_DX[command] : F4_DX[command]);
+        pixel.y += sign * (type == ChainCodeType::F8 ? F8_DY[command] : F4_DY[command]);
+        return true;
+    }
+
+    u64 tileKey(const int x, const int y) {
+        return (static_cast<u64>(static_cast<uint>(x)) << 32) | static_cast<uint>(y);
+    }
+
+    // Bit-sliced addition of 64 one-bit values to 64 four-bit counters.
+    void addBits(const u64 bits, u64& s0, u64& s1, u64& s2, u64& s3) {
+        const u64 carry0 = s0 & bits;
+        s0 ^= bits;
+        const u64 carry1 = s1 & carry0;
+        s1 ^= carry0;
+        const u64 carry2 = s2 & carry1;
+        s2 ^= carry1;
+        s3 |= carry2;
+    }
+
+    bool precedes(const Pixel& first, const Pixel& second) {
+        return first.y < second.y || (first.y == second.y && first.x < second.x);
+    }
+}
+
+
+
+bool ValidationReport::valid() const {
+    return invalidCommands == 0 && openContours == 0 && repeatedPixels == 0 && selfTouches == 0 && contourContacts == 0;
+}
+
+int ChainCodeValidator::tileIndex(const Pixel& pixel) const {
+    const auto tile = m_TileIndices.find(tileKey(pixel.x >> 6, pixel.y >> 6));
+    return tile != m_TileIndices.end() ? tile->second : -1;
+}
+
+bool ChainCodeValidator::test(const Pixel& pixel, const bool candidates) const {
+    const int index = tileIndex(pixel);
+    if (index < 0) {
+        return false;
+    }
+    const Tile& tile = m_Tiles[index];
+    return (((candidates ? tile.candidates : tile.rows)[pixel.y & 63] >> (pixel.x & 63)) & 1) != 0;
+}
+
+void ChainCodeValidator::rasterize(const std::vector<Pixel>& startPixels, ValidationReport& report) {
+    const std::vector<ChainCode>& chainCodes = *m_ChainCodes;
+    m_Tiles.clear();
+    m_TileIndices.clear();
+    m_WalkStarts.clear();
+    m_PixelCounts.assign(chainCodes.size(), 0);
+    m_Closed.assign(chainCodes.size(), true);
+
+    // Consecutive pixels mostly lie in the same tile, so the tile is only looked up when it changes.
+    int tileX = 0;
+    int tileY = 0;
+    Tile* tile = nullptr;
+    auto setPixel = [&](const uint chain, const u64 index, const Pixel& pixel) {
+        if (tile == nullptr || (pixel.x >> 6) != tileX || (pixel.y >> 6) != tileY) {
+            tileX = pixel.x >> 6;
+            tileY = pixel.y >> 6;
+            const auto [entry, inserted] = m_TileIndices.emplace(tileKey(tileX, tileY), static_cast<int>(m_Tiles.size()));
+            if (inserted) {
+                m_Tiles.emplace_back();
+                m_Tiles.back().x = tileX;
+                m_Tiles.back().y = tileY;
+            }
+            tile = &m_Tiles[entry->second];
+        }
+
+        u64& row = tile->rows[pixel.y & 63];
+        const u64 bit = u64(1) << (pixel.x & 63);
+        if ((row & bit) != 0) {
+            report.repeatedPixels++;
+            report.issues.push_back({ ValidationIssueType::repeatedPixel, chain, index, pixel, pixel });
+        }
+        row |= bit;
+        report.pixels++;
+    };
+
+    for (uint i = 0; i < chainCodes.size(); i++) {
+        const ChainCode& chainCode = chainCodes[i];
+        if (chainCode.code.empty()) {
+            continue;
+        }
+
+        Pixel pixel = startPixels[i];
+        bool moved = true;
+        for (u64 j = 0; j < chainCode.code.size(); j++) {
+            if (j % WALK_LENGTH == 0) {
+                m_WalkStarts.push_back({ i, j, pixel });
+            }
+            // Pixel of an invalid command is the same as the previous one, it is not reported as repeated.
+            if (moved) {
+                setPixel(i, j, pixel);
+            }
+
+            moved = move(chainCode.type, chainCode.code[j], pixel);
+            if (!moved) {
+                report.invalidCommands++;
+                report.issues.push_back({ ValidationIssueType::invalidCommand, i, j, pixel, pixel });
+            }
+        }
+
+        // Last pixel of a closed contour is its first pixel.
+        m_PixelCounts[i] = chainCode.code.size();
+        if (!(pixel == startPixels[i])) {
+            m_Closed[i] = false;
+            m_PixelCounts[i]++;
+            report.openContours++;
+            report.issues.push_back({ ValidationIssueType::openContour, i, chainCode.code.size(), pixel, startPixels[i] });
+            if (moved) {
+                setPixel(i, chainCode.code.size(), pixel);
+            }
+        }
+    }
+
+    // Surrounding tiles are linked once, so the scan does not look them up.
+    for (Tile& currentTile : m_Tiles) {
+        for (int y = -1; y <= 1; y++) {
+            for (int x = -1; x <= 1; x++) {
+                const auto neighbour = m_TileIndices.find(tileKey(currentTile.x + x, currentTile.y + y));
+                currentTile.neighbours[3 * (y + 1) + x + 1] = neighbour != m_TileIndices.end() ? neighbour->second : -1;
+            }
+        }
+    }
+}
+
+void ChainCodeValidator::scan(const ChainCodeType type, const size_t index) {
+    Tile& tile = m_Tiles[index];
+    auto row = [&](const int x, const int y, const int r) -> u64 {
+        const int neighbour = tile.neighbours[3 * (y + 1) + x + 1];
+        return neighbour >= 0 ? m_Tiles[neighbour].rows[r] : 0;
+    };
+
+    for (int r = 0; r < 64; r++) {
+        const u64 center = tile.rows[r];
+        if (center == 0) {
+            continue;
+        }
+
+        // Rows below, at and above the current one; pixels to the left and to the right are shifted in from the
+        // neighbouring tiles.
+        u64 s0 = 0;
+        u64 s1 = 0;
+        u64 s2 = 0;
+        u64 s3 = 0;
+        for (int y = -1; y <= 1; y++) {
+            const int tileY = r + y < 0 ? -1 : r + y > 63 ? 1 : 0;
+            const int rowY = (r + y) & 63;
+            const u64 middle = row(0, tileY, rowY);
+            const u64 left = (middle << 1) | (row(-1, tileY, rowY) >> 63);
+            const u64 right = (middle >> 1) | (row(1, tileY, rowY) << 63);
+
+            if (y == 0) {
+                addBits(left, s0, s1, s2, s3);
+                addBits(right, s0, s1, s2, s3);
+            }
+            else {
+                addBits(middle, s0, s1, s2, s3);
+                if (type == ChainCodeType::F8) {
+                    addBits(left, s0, s1, s2, s3);
+                    addBits(right, s0, s1, s2, s3);
+                }
+            }
+        }
+
+        // Pixels with exactly two neighbours only touch their predecessor and successor.
+        const u64 twoNeighbours = s1 & ~s0 & ~s2 & ~s3;
+        tile.candidates[r] = center & ~twoNeighbours;
+    }
+}
+
+void ChainCodeValidator::resolve(const WalkStart& start, const u64 length, std::vector<ValidationIssue>& issues) const {
+    const ChainCode& chainCode = (*m_ChainCodes)[start.chain];
+    const std::vector<short>& code = chainCode.code;
+    const u64 size = code.size();
+    const bool closed = m_Closed[start.chain];
+
+    // Pixels of the 4-neighbourhood (F4) are at least 3 commands apart, F8 corners bring pixels 2 commands apart together.
+    const int allowedDistance = chainCode.type == ChainCodeType::F8 ? 2 : 1;
+    const int vicinitySize = chainCode.type == ChainCodeType::F8 ? 8 : 4;
+
+    int tileX = 0;
+    int tileY = 0;
+    const Tile* tile = nullptr;
+    std::vector<Pixel> allowedPixels;
+
+    walk(start, length, [&](const u64 index, const Pixel& pixel) {
+        if (tile == nullptr || (pixel.x >> 6) != tileX || (pixel.y >> 6) != tileY) {
+            tileX = pixel.x >> 6;
+            tileY = pixel.y >> 6;
+            tile = &m_Tiles[tileIndex(pixel)];
+        }
+        if (((tile->candidates[pixel.y & 63] >> (pixel.x & 63)) & 1) == 0) {
+            return;
+        }
+
+        // Pixels within the allowed distance along the contour (wrapping around closed contours).
+        allowedPixels.clear();
+        Pixel next = pixel;
+        Pixel previous = pixel;
+        for (int i = 0; i < allowedDistance; i++) {
+            const u64 nextIndex = index + i;
+            if (closed || nextIndex < size) {
+                move(chainCode.type, code[nextIndex % size], next);
+                allowedPixels.push_back(next);
+            }
+            if (closed || index >= static_cast<u64>(i) + 1) {
+                const u64 previousIndex = (index + size - i - 1) % size;
+                move(chainCode.type, code[previousIndex], previous, -1);
+                allowedPixels.push_back(previous);
+            }
+        }
+
+        for (int i = 0; i < vicinitySize; i++) {
+            const Pixel checkPixel(pixel.x + VICINITY_DX[i], pixel.y + VICINITY_DY[i]);
+            if (!test(checkPixel, false) || std::find(allowedPixels.begin(), allowedPixels.end(), checkPixel) != allowedPixels.end()) {
+                continue;
+            }
+            // Each touching pair is reported once, by its first pixel (or by the only candidate of the pair).
+            if (precedes(pixel, checkPixel) || !test(checkPixel, true)) {
+                issues.push_back({ ValidationIssueType::selfTouch, start.chain, index, pixel, checkPixel });
+            }
+        }
+    });
+}
+
+template<typename Function>
+void ChainCodeValidator::walk(const WalkStart& start, const u64 length, const Function& function) const {
+    const ChainCode& chainCode = (*m_ChainCodes)[start.chain];
+    Pixel pixel = start.pixel;
+    bool moved = true;
+    for (u64 i = start.index; i < start.index + length; i++) {
+        if (moved) {
+            function(i, pixel);
+        }
+        if (i < chainCode.code.size()) {
+            moved = move(chainCode.type, chainCode.code[i], pixel);
+        }
+    }
+}
+
+u64 ChainCodeValidator::walkLength(const size_t index) const {
+    const WalkStart& start = m_WalkStarts[index];
+    if (index + 1 < m_WalkStarts.size() && m_WalkStarts[index + 1].chain == start.chain) {
+        return m_WalkStarts[index + 1].index - start.index;
+    }
+    return m_PixelCounts[start.chain] - start.index;
+}
+
+template<typename Function>
+void ChainCodeValidator::parallelFor(const size_t count, const Function& function) const {
+    const uint threadCount = static_cast<uint>(std::min<size_t>(m_Threads, count));
+    if (threadCount <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            function(i, 0);
+        }
+        return;
+    }
+
+    // Items are taken one by one, so threads with cheap items (empty tiles, valid walks) take more of them.
+    std::atomic<size_t> next = 0;
+    auto work = [&](const uint thread) {
+        for (size_t i = next++; i < count; i = next++) {
+            function(i, thread);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint thread = 1; thread < threadCount; thread++) {
+        threads.emplace_back(work, thread);
+    }
+    work(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+
+
+ChainCodeValidator::ChainCodeValidator(const uint threads, const size_t maxIssues) : m_MaxIssues(maxIssues) {
+    m_Threads = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+ValidationReport ChainCodeValidator::validate(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels) {
+    for (const ChainCode& chainCode : chainCodes) {
+        if (chainCode.type != ChainCodeType::F4 && chainCode.type != ChainCodeType::F8) {
+            throw std::logic_error("Only F4 and F8 chain codes can be validated.");
+        }
+    }
+
+    m_ChainCodes = &chainCodes;
+    ValidationReport report;
+    rasterize(startPixels, report);
+
+    const ChainCodeType type = chainCodes.empty() ? ChainCodeType::F8 : chainCodes[0].type;
+    parallelFor(m_Tiles.size(), [&](const size_t index, const uint) {
+        scan(type, index);
+    });
+
+    // Candidates are resolved on the walks, which keeps the touching pairs in the order of the contours.
+    std::vector<std::vector<ValidationIssue>> touches(m_WalkStarts.size());
+    parallelFor(m_WalkStarts.size(), [&](const size_t index, const uint) {
+        resolve(m_WalkStarts[index], walkLength(index), touches[index]);
+    });
+
+    // Touched pixels are marked in the (no longer needed) candidates and their contours are found by another walk.
+    std::unordered_map<Pixel, uint> owners;
+    const bool anyTouch = std::any_of(touches.begin(), touches.end(), [](const std::vector<ValidationIssue>& issues) { return !issues.empty(); });
+    if (anyTouch && chainCodes.size() > 1) {
+        for (Tile& tile : m_Tiles) {
+            tile.candidates.fill(0);
+        }
+        for (const std::vector<ValidationIssue>& issues : touches) {
+            for (const ValidationIssue& issue : issues) {
+                m_Tiles[tileIndex(issue.other)].candidates[issue.other.y & 63] |= u64(1) << (issue.other.x & 63);
+            }
+        }
+
+        std::vector<std::vector<std::pair<Pixel, uint>>> found(m_WalkStarts.size());
+        parallelFor(m_WalkStarts.size(), [&](const size_t index, const uint) {
+            const WalkStart& start = m_WalkStarts[index];
+            walk(start, walkLength(index), [&](const u64, const Pixel& pixel) {
+                if (test(pixel, true)) {
+                    found[index].emplace_back(pixel, start.chain);
+                }
+            });
+        });
+        for (const std::vector<std::pair<Pixel, uint>>& pixels : found) {
+            for (const auto& [pixel, chain] : pixels) {
+                owners.emplace(pixel, chain);
+            }
+        }
+    }
+
+    for (std::vector<ValidationIssue>& issues : touches) {
+        for (ValidationIssue& issue : issues) {
+            const auto owner = owners.find(issue.other);
+            if (owner != owners.end() && owner->second != issue.chain) {
+                issue.type = ValidationIssueType::contourContact;
+                report.contourContacts++;
+            }
+            else {
+                report.selfTouches++;
+            }
+            report.issues.push_back(issue);
+        }
+    }
+
+    std::stable_sort(report.issues.begin(), report.issues.end(), [](const ValidationIssue& first, const ValidationIssue& second) {
+        return first.type != second.type ? first.type < second.type : first.chain != second.chain ? first.chain < second.chain : first.index < second.index;
+    });
+    if (report.issues.size() > m_MaxIssues) {
+        report.issues.resize(m_MaxIssues);
+    }
+
+    m_ChainCodes = nullptr;
+    return report;
+}
+
+std::string ChainCodeValidator::typeToString(const ValidationIssueType type) {
+    switch (type) {
+        case ValidationIssueType::invalidCommand:
+            return "invalidCommand";
+        case ValidationIssueType::openContour:
+            return "openContour";
+        case ValidationIssueType::repeatedPixel:
+            return "repeatedPixel";
+        case ValidationIssueType::selfTouch:
+            return "selfTouch";
+        default:
+            return "contourContact";
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Type of a violation found by the validator.
+/// </summary>
+enum class ValidationIssueType {
+    invalidCommand,   // Command outside of the range of the chain code type (the contour is not continuous).
+    openContour,      // Contour does not return to its starting pixel.
+    repeatedPixel,    // Pixel visited more than once (by the same or by another contour).
+    selfTouch,        // Pixels of a contour touch within the vicinity, although they are not neighbours along it.
+    contourContact    // Pixels of two contours touch within the vicinity.
+};
+
+
+/// <summary>
+/// Violation found by the validator.
+/// </summary>
+struct ValidationIssue {
+    ValidationIssueType type;
+    uint chain = 0;      // Index of the chain code.
+    u64 index = 0;       // Index of the command that leads from the pixel.
+    Pixel pixel;         // Pixel of the violation.
+    Pixel other;         // Touched pixel (self-touches and contacts only).
+};
+
+
+/// <summary>
+/// Result of a validation.
+/// </summary>
+struct ValidationReport {
+    u64 pixels = 0;                       // Number of rasterized pixels.
+    u64 invalidCommands = 0;
+    u64 openContours = 0;
+    u64 repeatedPixels = 0;
+    u64 selfTouches = 0;                  // Number of touching pixel pairs within contours.
+    u64 contourContacts = 0;              // Number of touching pixel pairs of different contours.
+    std::vector<ValidationIssue> issues;  // First issues (ordered by type, chain code and index).
+
+    /// <summary>
+    /// True if no violation was found.
+    /// </summary>
+    bool valid() const;
+};
+
+
+
+/// <summary>
+/// Independent validator of noisy chain codes: continuity, closure, repeated pixels, self-touching areas and
+/// contacts of contours. Border pixels are rasterized into bit-packed tiles of 64x64 pixels; the tiles are scanned
+/// in parallel, counting the neighbours of 64 pixels at once. Only pixels with more than their two neighbours
+/// along the contour are resolved exactly, so a valid input is verified at the cost of its rasterization.
+/// Neighbours are the 4-neighbourhood (F4) or the 8-neighbourhood (F8), the vicinity of the noise procedures.
+/// </summary>
+class ChainCodeValidator {
+private:
+    // Tile of the border raster (row 0 is the lowest, bit 0 the leftmost pixel).
+    struct Tile {
+        int x;                                 // Tile coordinates (pixel coordinates divided by 64).
+        int y;
+        std::array<u64, 64> rows{};            // Border pixels.
+        std::array<u64, 64> candidates{};      // Border pixels with more than two neighbours (filled by the scan).
+        std::array<int, 9> neighbours{};       // Indices of the 3x3 surrounding tiles (-1 if empty), 4 - the tile itself.
+    };
+
+    // Position on a contour where the parallel walks start.
+    struct WalkStart {
+        uint chain;
+        u64 index;
+        Pixel pixel;
+    };
+
+    const std::vector<ChainCode>* m_ChainCodes = nullptr;
+    std::vector<Tile> m_Tiles;
+    std::unordered_map<u64, int> m_TileIndices;  // Tile coordinates -> index of the tile.
+    std::vector<WalkStart> m_WalkStarts;
+    std::vector<u64> m_PixelCounts;              // Number of pixels of each contour (without the closing pixel).
+    std::vector<bool> m_Closed;                  // True if the contour returns to its starting pixel.
+    uint m_Threads;
+    size_t m_MaxIssues;
+
+    /// <summary>
+    /// Index of the tile that contains the pixel.
+    /// </summary>
+    /// <param name="pixel">: pixel</param>
+    /// <returns>Index of the tile, -1 if there is none</returns>
+    int tileIndex(const Pixel& pixel) const;
+
+    /// <summary>
+    /// Testing a bit of the border raster or of the candidates.
+    /// </summary>
+    /// <param name="pixel">: pixel</param>
+    /// <param name="candidates">: true - candidates, false - border pixels</param>
+    /// <returns>True if the bit is set</returns>
+    bool test(const Pixel& pixel, const bool candidates) const;
+
+    /// <summary>
+    /// Walking the contours, checking the commands and the closure, and rasterizing the pixels (repeated
+    /// pixels are found when their bit is already set).
+    /// </summary>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    /// <param name="report">: validation report (output)</param>
+    void rasterize(const std::vector<Pixel>& startPixels, ValidationReport& report);
+
+    /// <summary>
+    /// Marking border pixels of a tile with more than two neighbours (64 pixels of a row at once).
+    /// </summary>
+    /// <param name="type">: type of the chain codes (neighbourhood)</param>
+    /// <param name="index">: index of the tile</param>
+    void scan(const ChainCodeType type, const size_t index);
+
+    /// <summary>
+    /// Resolving the candidates on a part of a contour: touching pixels that are not within the allowed distance
+    /// along the contour are returned as self-touches (their owner is determined later).
+    /// </summary>
+    /// <param name="start">: start of the walk</param>
+    /// <param name="length">: number of walked pixels</param>
+    /// <param name="issues">: touching pixel pairs (output)</param>
+    void resolve(const WalkStart& start, const u64 length, std::vector<ValidationIssue>& issues) const;
+
+    /// <summary>
+    /// Walking a part of a contour.
+    /// </summary>
+    /// <param name="start">: start of the walk</param>
+    /// <param name="length">: number of walked pixels</param>
+    /// <param name="function">: function called with the index and the position of each pixel</param>
+    template<typename Function>
+    void walk(const WalkStart& start, const u64 length, const Function& function) const;
+
+    /// <summary>
+    /// Number of pixels walked from a walk start (up to the next start on the same contour).
+    /// </summary>
+    /// <param name="index">: index of the walk start</param>
+    /// <returns>Number of pixels</returns>
+    u64 walkLength(const size_t index) const;
+
+    /// <summary>
+    /// Running a function over a range of items on the threads of the validator.
+    /// </summary>
+    /// <param name="count">: number of items</param>
+    /// <param name="function">: function called with the index of the item and the index of the thread</param>
+    template<typename Function>
+    void parallelFor(const size_t count, const Function& function) const;
+
+public:
+    /// <summary>
+    /// Constructor of ChainCodeValidator.
+    /// </summary>
+    /// <param name="threads">: number of threads (0 - number of hardware threads)</param>
+    /// <param name="maxIssues">: maximal number of issues listed in the report (all issues are counted)</param>
+    ChainCodeValidator(const uint threads = 0, const size_t maxIssues = 100);
+
+    /// <summary>
+    /// Validating chain codes.
+    /// </summary>
+    /// <param name="chainCodes">: chain codes (F4 or F8)</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    /// <returns>Validation report</returns>
+    ValidationReport validate(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels);
+
+    /// <summary>
+    /// Name of an issue type.
+    /// </summary>
+    /// <param name="type">: issue type</param>
+    /// <returns>Name of the type</returns>
+    static std::string typeToString(const ValidationIssueType type);
+};
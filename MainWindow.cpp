@@ -4,8 +4,10 @@
 #include <QMessageBox>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 #include "ChainCodeNoise.hpp"
+#include "ChainCodeTranscoder.hpp"
 #include "MainWindow.hpp"
 
 
@@ -21,7 +23,13 @@ MainWindow::MainWindow(QWidget* parent) :
 }
 
 MainWindow::~MainWindow()
-{}
+{
+    // Running noise application is stopped, it uses the noise object of the window.
+    if (m_NoiseWorker != nullptr) {
+        m_NoiseWorker->cancel();
+        m_NoiseWorker->wait();
+    }
+}
 
 
 
@@ -46,66 +54,72 @@ void MainWindow::loadChainCode() {
 }
 
 void MainWindow::applyNoiseToChainCodes() {
+    // Button cancels the running application.
+    if (m_NoiseWorker != nullptr) {
+        m_NoiseWorker->cancel();
+        m_Ui.btnAddNoise->setEnabled(false);
+        return;
+    }
+
     // Reading input parameters.
     const double noiseProbability = m_Ui.sbxNoiseProbability->value() / 100.0;
     const uint numberOfIterations = m_Ui.sbxNumberOfIterations->value();
     std::string name = m_Ui.tbxChainCodeFile->text().toStdString();
     name = name.substr(0, name.rfind('.'));
 
-    // Adding noise to each chain code.
-    m_ChainCodes = m_ChainCodeNoise.applyNoise(m_ChainCodes, m_StartPixels, m_BorderPixels, noiseProbability, numberOfIterations, name);
+    // Adding noise to each chain code in a worker thread (border pixels are recomputed when it finishes).
+    m_NoiseWorker = new NoiseWorker(m_ChainCodeNoise, m_ChainCodes, m_StartPixels, std::move(m_BorderPixels), noiseProbability, numberOfIterations, name, this);
+    QObject::connect(m_NoiseWorker, &NoiseWorker::progressed, this, &MainWindow::showNoiseProgress);  // Progress and live preview.
+    QObject::connect(m_NoiseWorker, &QThread::finished, this, &MainWindow::finishNoise);              // Result.
 
-    // Rerendering of noisy chain codes.
-    renderChainCodes(m_ChainCodes);
+    setNoiseRunning(true);
+    m_NoiseWorker->start();
 }
 
+void MainWindow::showNoiseProgress() {
+    if (m_NoiseWorker == nullptr) {
+        return;
+    }
 
+    const NoiseProgress progress = m_NoiseWorker->monitor().progress();
+    m_Ui.statusBar->showMessage(QString("Iteration %1/%2, chain code %3/%4, segments: %5 (%6 segments/s)")
+        .arg(progress.iteration).arg(progress.numberOfIterations).arg(progress.chain).arg(progress.chainCount)
+        .arg(progress.segmentCount).arg(progress.segmentsPerSecond, 0, 'f', 0));
 
-std::vector<ChainCode> MainWindow::readChainCodeFile(const std::string& file) {
-    std::vector<ChainCode> chainCodes;
-
-    // Opening a file.
-    std::ifstream in(file);
+    // Only the tiles around the replacements since the previous update are redrawn.
+    m_Ui.imgChainCode->updateBorder(m_NoiseWorker->monitor().takeChanges());
+}
 
-    // If a file is not open, we do not panic but abort the process.
-    if (!in.is_open()) {
-        throw std::logic_error("File could not be found or opened.");
+void MainWindow::finishNoise() {
+    NoiseWorker* worker = m_NoiseWorker;
+    m_NoiseWorker = nullptr;
+    worker->deleteLater();
+    setNoiseRunning(false);
+
+    // Failed run leaves the chain codes untouched; a cancelled one keeps the chain codes it has noised.
+    if (!worker->error().empty()) {
+        m_Ui.statusBar->clearMessage();
+        renderChainCodes(m_ChainCodes);
+        QMessageBox::critical(this, "Noise", QString::fromStdString(worker->error()));
+        return;
     }
+    m_Ui.statusBar->showMessage(worker->isCancelled() ? "Noise application cancelled." : "Noise application finished.");
 
-    // Reading the header.
-    std::string firstLine;
-    std::getline(in, firstLine);
-    if (firstLine != "CC Multi") {
-        throw std::logic_error("Invalid header of the chain code.");
-    }
+    // Rerendering of noisy chain codes.
+    m_ChainCodes = worker->result();
+    renderChainCodes(m_ChainCodes);
+}
 
-    // Reading the chain code.
-    std::string value;
-    while (std::getline(in, value, ';')) {
-        ChainCodeType type;
-        if (value == "F8") {
-            type = ChainCodeType::F8;
-        }
-        else if (value == "F4") {
-            type = ChainCodeType::F4;
-        }
-        else {
-            throw std::logic_error("Unknown type of the chain code.");
-        }
 
-        // Reading clockwise or anti-clockwise orientation.
-        std::getline(in, value, ';');
 
-        // Reading the starting point.
-        std::getline(in, value, ',');
-        const int startX = std::stoi(value);
-        std::getline(in, value, ';');
-        const int startY = -std::stoi(value);
-        std::getline(in, value, ';');
+std::vector<ChainCode> MainWindow::readChainCodeFile(const std::string& file) {
+    std::vector<ChainCode> chainCodes = ChainCodeFunctions::readChainCodeFile(file);
 
-        // Reading the chain code.
-        std::getline(in, value);
-        chainCodes.push_back(ChainCode(value, type, startX, startY));
+    // Noise is applied to absolute chain codes, so relative ones (VCC, 3OT) are converted to F4.
+    for (ChainCode& chainCode : chainCodes) {
+        if (chainCode.type == ChainCodeType::VCC || chainCode.type == ChainCodeType::ThreeOT) {
+            chainCode = ChainCodeTranscoder::transcode(chainCode, ChainCodeType::F4);
+        }
     }
 
     // Number of segments calculation.
@@ -131,29 +145,15 @@ void MainWindow::renderChainCodes(const std::vector<ChainCode>& chainCodes) {
     // Transforming border pixels into a hash table.
     m_BorderPixels = ChainCodeFunctions::coordinatesToSet(coordinates, maxXCoordinate);
 
-    // Drawing the coordinates on PixMap.
-    const uint scale = 2;
-    const uint padding = 50;
-    QPixmap pix(scale * (maxXCoordinate + 2 * padding), scale * (maxYCoordinate + 2 * padding));
-    pix.fill(QColor("white"));
-    QPainter paint(&pix);
-    paint.setPen(QColor(0, 0, 0, 255));
-    for (const std::vector<Pixel>& currentCoordinates : coordinates) {
-        for (const Pixel& coordinate : currentCoordinates) {
-            paint.drawRect(scale * (coordinate.x + padding), scale * (maxYCoordinate - (coordinate.y) + padding), 1, 1);
-        }
-    }
-
-    // Drawing the bounding box of the object.
-    //paint.setPen(QPen(Qt::black, 3));
-    //paint.drawLine(scale * padding, scale * padding, scale * maxXCoordinate + scale * padding, scale * padding);
-    //paint.drawLine(scale * maxXCoordinate + scale * padding, scale * padding, scale * maxXCoordinate + scale * padding, scale * maxYCoordinate + scale * padding);
-    //paint.drawLine(scale * maxXCoordinate + scale * padding, scale * maxYCoordinate + scale * padding, scale * padding, scale * maxYCoordinate + scale * padding);
-    //paint.drawLine(scale * padding, scale * maxYCoordinate + scale * padding, scale * padding, scale * padding);
-
-    // Displaying the PixMap.
-    QGraphicsScene* scene = new QGraphicsScene;
-    scene->addPixmap(pix);
-    m_Ui.imgChainCode->setScene(scene);
+    // Displaying the border (tiles are rasterized by the view on demand).
+    m_Ui.imgChainCode->setBorder(coordinates, maxXCoordinate, maxYCoordinate);
     m_Ui.imgChainCode->show();
+}
+
+void MainWindow::setNoiseRunning(const bool running) {
+    m_Ui.btn_LoadChainCode->setEnabled(!running);
+    m_Ui.sbxNoiseProbability->setEnabled(!running);
+    m_Ui.sbxNumberOfIterations->setEnabled(!running);
+    m_Ui.btnAddNoise->setEnabled(true);
+    m_Ui.btnAddNoise->setText(running ? "Cancel" : "Apply");
 }
\ No newline at end of file
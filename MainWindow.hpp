@@ -5,6 +5,7 @@
 
 #include "ChainCode.hpp"
 #include "ChainCodeNoise.hpp"
+#include "NoiseWorker.hpp"
 #include "ui_MainWindow.h"
 
 
@@ -19,6 +20,7 @@ private:
     std::unordered_set<Pixel> m_BorderPixels;  // Hash table of border pixels.
     std::vector<Pixel> m_StartPixels;          // Vector of starting pixels of chain codes.
     ChainCodeNoise m_ChainCodeNoise;           // Chain code algorithm object.
+    NoiseWorker* m_NoiseWorker = nullptr;      // Running noise application (null if none).
 
 // SLOTS
 private slots:
@@ -28,10 +30,20 @@ private slots:
     void loadChainCode();
 
     /// <summary>
-    /// Applying noise to chain codes, stored in the object.
+    /// Applying noise to chain codes, stored in the object, in the background (or cancelling the running application).
     /// </summary>
     void applyNoiseToChainCodes();
 
+    /// <summary>
+    /// Showing the progress of the running noise application and redrawing the changed parts of the border.
+    /// </summary>
+    void showNoiseProgress();
+
+    /// <summary>
+    /// Taking the result of the finished noise application.
+    /// </summary>
+    void finishNoise();
+
 // PRIVATE METHODS
 private:
     /// <summary>
@@ -47,6 +59,12 @@ private:
     /// <param name="chainCodes">: vector of chain codes</param>
     void renderChainCodes(const std::vector<ChainCode>& chainCodes);
 
+    /// <summary>
+    /// Enabling or disabling the inputs that must not change while noise is applied.
+    /// </summary>
+    /// <param name="running">: true if noise is being applied</param>
+    void setNoiseRunning(const bool running);
+
 // PUBLIC METHODS
 public:
     /// <summary>
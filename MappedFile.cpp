@@ -0,0 +1,103 @@
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.hpp"
+
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (m_Data != nullptr) {
+        UnmapViewOfFile(m_Data);
+    }
+    if (m_Mapping != nullptr) {
+        CloseHandle(m_Mapping);
+    }
+    if (m_File != nullptr && m_File != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_File);
+    }
+    m_Mapping = nullptr;
+    m_File = nullptr;
+#else
+    if (m_Data != nullptr) {
+        munmap(const_cast<unsigned char*>(m_Data), m_Size);
+    }
+    if (m_File >= 0) {
+        ::close(m_File);
+    }
+    m_File = -1;
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+
+MappedFile::MappedFile(const std::string& file) {
+#ifdef _WIN32
+    m_File = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_File == INVALID_HANDLE_VALUE) {
+        throw std::logic_error("File could not be found or opened.");
+    }
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_File, &size);
+    m_Size = static_cast<size_t>(size.QuadPart);
+
+    // Empty files cannot be mapped, so an empty view is kept instead.
+    if (m_Size == 0) {
+        return;
+    }
+
+    m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping == nullptr) {
+        close();
+        throw std::logic_error("File could not be mapped into memory.");
+    }
+    m_Data = static_cast<const unsigned char*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+    m_File = open(file.c_str(), O_RDONLY);
+    if (m_File < 0) {
+        throw std::logic_error("File could not be found or opened.");
+    }
+
+    struct stat status;
+    fstat(m_File, &status);
+    m_Size = static_cast<size_t>(status.st_size);
+
+    // Empty files cannot be mapped, so an empty view is kept instead.
+    if (m_Size == 0) {
+        return;
+    }
+
+    void* view = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_File, 0);
+    m_Data = view == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(view);
+    if (m_Data != nullptr) {
+        madvise(view, m_Size, MADV_SEQUENTIAL);
+    }
+#endif
+
+    if (m_Data == nullptr) {
+        close();
+        throw std::logic_error("File could not be mapped into memory.");
+    }
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+const unsigned char* MappedFile::data() const {
+    return m_Data;
+}
+
+size_t MappedFile::size() const {
+    return m_Size;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+
+#include "Constants.hpp"
+
+
+/// <summary>
+/// Read-only memory mapping of a whole file.
+/// </summary>
+class MappedFile {
+private:
+    const unsigned char* m_Data = nullptr;  // Start of the mapped view.
+    size_t m_Size = 0;                      // Size of the mapped view in bytes.
+#ifdef _WIN32
+    void* m_File = nullptr;                 // Windows file handle.
+    void* m_Mapping = nullptr;              // Windows file mapping handle.
+#else
+    int m_File = -1;                        // POSIX file descriptor.
+#endif
+
+    /// <summary>
+    /// Releasing the mapping and the file handles.
+    /// </summary>
+    void close();
+
+public:
+    /// <summary>
+    /// Mapping a file into memory.
+    /// </summary>
+    /// <param name="file">: path to the file</param>
+    MappedFile(const std::string& file);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// <summary>
+    /// Destructor that unmaps the file.
+    /// </summary>
+    ~MappedFile();
+
+    /// <summary>
+    /// Pointer to the first byte of the file.
+    /// </summary>
+    /// <returns>Pointer to the mapped data</returns>
+    const unsigned char* data() const;
+
+    /// <summary>
+    /// Size of the mapped file.
+    /// </summary>
+    /// <returns>Number of bytes</returns>
+    size_t size() const;
+};
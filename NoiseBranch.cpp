@@ -0,0 +1,133 @@
+#include <stdexcept>
+
+#include "ChainCodeNoise.hpp"
+#include "NoiseBranch.hpp"
+
+
+NoiseBranch::NoiseBranch(const std::shared_ptr<ChainCodeNoise>& noise, const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, const std::unordered_set<Pixel>& borderPixels, const uint seed, const uint chunkSize) :
+    m_Noise(noise),
+    m_StartPixels(std::make_shared<const std::vector<Pixel>>(startPixels)),
+    m_Occupancy(borderPixels),
+    m_Generator(seed),
+    m_ChunkSize(chunkSize)
+{
+    if (chainCodes.size() != startPixels.size()) {
+        throw std::logic_error("Each chain code needs a starting pixel.");
+    }
+
+    auto shared = std::make_shared<std::vector<SharedChainCode>>();
+    shared->reserve(chainCodes.size());
+    for (const ChainCode& chainCode : chainCodes) {
+        if (chainCode.type != ChainCodeType::F4 && chainCode.type != ChainCodeType::F8) {
+            throw std::logic_error("Noise can only be applied to F4 and F8 chain codes.");
+        }
+        shared->emplace_back(chainCode, chunkSize);
+    }
+    m_ChainCodes = shared;
+    m_RepeatedPixels.count(chainCodes, startPixels);
+}
+
+NoiseBranch NoiseBranch::fork() const {
+    return *this;
+}
+
+NoiseBranch NoiseBranch::fork(const uint seed) const {
+    NoiseBranch branch(*this);
+    branch.m_Generator.seed(seed);
+    return branch;
+}
+
+void NoiseBranch::run(const double noiseProbability, const uint numberOfIterations) {
+    std::vector<short> group;
+    std::vector<u64> starts;
+
+    for (uint iteration = 0; iteration < numberOfIterations; iteration++) {
+        auto next = std::make_shared<std::vector<SharedChainCode>>();
+        next->reserve(m_ChainCodes->size());
+
+        for (size_t i = 0; i < m_ChainCodes->size(); i++) {
+            const SharedChainCode& input = (*m_ChainCodes)[i];
+            const auto& chunks = input.chunks();
+            next->push_back(input.emptyCopy());
+            SharedChainCode& output = next->back();
+
+            // Input index of the first command of each chunk.
+            starts.assign(1, 0);
+            for (const auto& chunk : chunks) {
+                starts.push_back(starts.back() + chunk->size());
+            }
+
+            size_t readChunk = 0;
+            size_t readOffset = 0;
+            const auto source = [&]() -> int {
+                while (readChunk < chunks.size() && readOffset == chunks[readChunk]->size()) {
+                    readChunk++;
+                    readOffset = 0;
+                }
+                return readChunk == chunks.size() ? -1 : (*chunks[readChunk])[readOffset++];
+            };
+
+            // Output commands are grouped by the input chunk their window started in. A group equal to its input
+            // chunk (no replacement in it) keeps the shared chunk; long groups are split to keep chunks small.
+            size_t current = 0;
+            group.clear();
+            const auto finish = [&]() {
+                if (current < chunks.size() && group == *chunks[current]) {
+                    output.appendChunk(chunks[current]);
+                }
+                else {
+                    size_t begin = 0;
+                    while (begin < group.size()) {
+                        const size_t end = group.size() - begin < 2 * static_cast<size_t>(m_ChunkSize) ? group.size() : begin + m_ChunkSize;
+                        output.appendChunk(std::make_shared<const SharedChainCode::Chunk>(group.begin() + begin, group.begin() + end));
+                        begin = end;
+                    }
+                }
+                group.clear();
+            };
+            const auto sink = [&](const short command, const u64 index) {
+                while (current + 1 < chunks.size() && index >= starts[current + 1]) {
+                    finish();
+                    current++;
+                }
+                group.push_back(command);
+            };
+
+            m_Noise->streamNoise(input.type(), (*m_StartPixels)[i], source, sink, m_Occupancy, m_RepeatedPixels, m_Generator, noiseProbability);
+            finish();
+        }
+
+        m_ChainCodes = next;
+        m_Iteration++;
+    }
+}
+
+std::vector<ChainCode> NoiseBranch::chainCodes() const {
+    std::vector<ChainCode> chainCodes;
+    chainCodes.reserve(m_ChainCodes->size());
+    for (const SharedChainCode& chainCode : *m_ChainCodes) {
+        chainCodes.push_back(chainCode.toChainCode());
+    }
+
+    return chainCodes;
+}
+
+uint NoiseBranch::iteration() const {
+    return m_Iteration;
+}
+
+size_t NoiseBranch::memoryBytes(const std::vector<NoiseBranch>& branches) {
+    std::unordered_set<const void*> counted;
+    size_t bytes = 0;
+    for (const NoiseBranch& branch : branches) {
+        bytes += sizeof(NoiseBranch);
+        if (counted.insert(branch.m_ChainCodes.get()).second) {
+            for (const SharedChainCode& chainCode : *branch.m_ChainCodes) {
+                bytes += chainCode.memoryBytes(counted);
+            }
+        }
+        bytes += branch.m_Occupancy.memoryBytes(counted);
+    }
+
+    return bytes;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+#include "RepeatedPixels.hpp"
+#include "SharedChainCode.hpp"
+#include "SharedOccupancy.hpp"
+
+
+class ChainCodeNoise;
+
+
+/// <summary>
+/// Snapshot of a noise run (chain codes, border pixels, generator and iteration) that can be forked. A fork costs
+/// O(1): the chain codes and the border pixels are shared with the parent, and each branch copies only the chunks
+/// and occupancy tiles its own iterations change. Branches forked at iteration k from a common prefix therefore
+/// explore different noise continuations without re-running the prefix or copying the whole state.
+/// </summary>
+class NoiseBranch {
+private:
+    std::shared_ptr<ChainCodeNoise> m_Noise;                          // Replacement tables and window (shared by all branches).
+    std::shared_ptr<const std::vector<SharedChainCode>> m_ChainCodes;
+    std::shared_ptr<const std::vector<Pixel>> m_StartPixels;
+    SharedOccupancy m_Occupancy;
+    RepeatedPixels m_RepeatedPixels;                                  // Copied on fork (usually empty or small).
+    std::mt19937 m_Generator;
+    uint m_Iteration = 0;
+    uint m_ChunkSize;
+
+public:
+    /// <summary>
+    /// Constructor of the root branch.
+    /// </summary>
+    /// <param name="noise">: noise engine (replacement tables and window)</param>
+    /// <param name="chainCodes">: chain codes (F4 or F8)</param>
+    /// <param name="startPixels">: first pixel of each chain code</param>
+    /// <param name="borderPixels">: border pixels of all chain codes</param>
+    /// <param name="seed">: seed of the generator</param>
+    /// <param name="chunkSize">: number of commands per shared chunk</param>
+    NoiseBranch(const std::shared_ptr<ChainCodeNoise>& noise, const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, const std::unordered_set<Pixel>& borderPixels, const uint seed, const uint chunkSize = 256);
+
+    /// <summary>
+    /// Branch continuing with the same generator state (it runs exactly as this branch would).
+    /// </summary>
+    /// <returns>New branch</returns>
+    NoiseBranch fork() const;
+
+    /// <summary>
+    /// Branch continuing with a reseeded generator.
+    /// </summary>
+    /// <param name="seed">: seed of the generator of the new branch</param>
+    /// <returns>New branch</returns>
+    NoiseBranch fork(const uint seed) const;
+
+    /// <summary>
+    /// Running iterations on this branch. With the same seed and state, the chain codes are the same as from applyNoise.
+    /// </summary>
+    /// <param name="noiseProbability">: probability of the noise</param>
+    /// <param name="numberOfIterations">: number of algorithm iterations</param>
+    void run(const double noiseProbability, const uint numberOfIterations = 1);
+
+    /// <summary>
+    /// Chain codes of the branch.
+    /// </summary>
+    /// <returns>Vector of chain codes</returns>
+    std::vector<ChainCode> chainCodes() const;
+
+    /// <summary>
+    /// Number of iterations applied since the root branch.
+    /// </summary>
+    uint iteration() const;
+
+    /// <summary>
+    /// Memory of a set of branches, with the chunks and tiles they share counted once.
+    /// </summary>
+    /// <param name="branches">: branches</param>
+    /// <returns>Number of bytes</returns>
+    static size_t memoryBytes(const std::vector<NoiseBranch>& branches);
+};
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include "BinaryFormat.hpp"
+#include "MappedFile.hpp"
+#include "NoiseCheckpoint.hpp"
+
+
+namespace {
+    constexpr char MAGIC[4] = { 'C', 'C', 'N', 'C' };
+    constexpr unsigned char VERSION = 4;
+
+    void writeDouble(std::vector<unsigned char>& out, const double value) {
+        u64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (uint i = 0; i < 8; i++) {
+            out.push_back(static_cast<unsigned char>(bits >> (8 * i)));
+        }
+    }
+
+    double readDouble(BinaryFormat::ByteReader& reader) {
+        const unsigned char* data = reader.bytes(8);
+        u64 bits = 0;
+        for (uint i = 0; i < 8; i++) {
+            bits |= static_cast<u64>(data[i]) << (8 * i);
+        }
+
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+
+
+std::vector<unsigned char> NoiseCheckpoint::encode() const {
+    std::vector<unsigned char> data(MAGIC, MAGIC + 4);
+    data.push_back(VERSION);
+    BinaryFormat::writeString(data, name);
+    BinaryFormat::writeVarint(data, iteration);
+    BinaryFormat::writeVarint(data, numberOfIterations);
+    writeDouble(data, noiseProbability);
+    BinaryFormat::writeVarint(data, replacementWindow);
+    writeDouble(data, seconds);
+    BinaryFormat::writeVarint(data, profileSize);
+    BinaryFormat::writeVarint(data, compressionSize);
+    BinaryFormat::writeVarint(data, validationSize);
+    BinaryFormat::writeVarint(data, journalSize);
+    BinaryFormat::writeVarint(data, pipelineDepth);
+    BinaryFormat::writeVarint(data, traversalStarts.size());
+    for (const u64 start : traversalStarts) {
+        BinaryFormat::writeVarint(data, start);
+    }
+
+    // Command counts change slowly, so differences are stored.
+    BinaryFormat::writeVarint(data, commandCounts.size());
+    for (size_t i = 0; i < commandCounts.size(); i++) {
+        BinaryFormat::writeSignedVarint(data, static_cast<int64_t>(commandCounts[i] - (i > 0 ? commandCounts[i - 1] : 0)));
+    }
+
+    // Generator state is a sequence of integers (stored as varints instead of the text form).
+    std::vector<u64> generatorWords;
+    std::istringstream generatorIn(generatorState);
+    for (u64 word; generatorIn >> word;) {
+        generatorWords.push_back(word);
+    }
+    BinaryFormat::writeVarint(data, generatorWords.size());
+    for (const u64 word : generatorWords) {
+        BinaryFormat::writeVarint(data, word);
+    }
+
+    BinaryFormat::writeVarint(data, chainCodes.size());
+    for (size_t i = 0; i < chainCodes.size(); i++) {
+        const ChainCode& chainCode = chainCodes[i];
+        data.push_back(static_cast<unsigned char>(chainCode.type));
+        BinaryFormat::writeSignedVarint(data, chainCode.startX);
+        BinaryFormat::writeSignedVarint(data, chainCode.startY);
+        BinaryFormat::writeSignedVarint(data, chainCode.initialDirection);
+        BinaryFormat::writeSignedVarint(data, startPixels[i].x);
+        BinaryFormat::writeSignedVarint(data, startPixels[i].y);
+        BinaryFormat::writeCommands(data, chainCode.type, chainCode.code);
+    }
+
+    return data;
+}
+
+NoiseCheckpoint NoiseCheckpoint::decode(const unsigned char* data, const size_t size) {
+    BinaryFormat::ByteReader reader(data, size);
+
+    const unsigned char* magic = reader.bytes(4);
+    if (!std::equal(magic, magic + 4, MAGIC) || reader.byte() != VERSION) {
+        throw std::logic_error("Data is not a noise checkpoint.");
+    }
+
+    NoiseCheckpoint checkpoint;
+    checkpoint.name = reader.string();
+    checkpoint.iteration = static_cast<uint>(reader.varint());
+    checkpoint.numberOfIterations = static_cast<uint>(reader.varint());
+    checkpoint.noiseProbability = readDouble(reader);
+    checkpoint.replacementWindow = static_cast<uint>(reader.varint());
+    checkpoint.seconds = readDouble(reader);
+    checkpoint.profileSize = reader.varint();
+    checkpoint.compressionSize = reader.varint();
+    checkpoint.validationSize = reader.varint();
+    checkpoint.journalSize = reader.varint();
+    checkpoint.pipelineDepth = static_cast<uint>(reader.varint());
+    const u64 traversalStartCount = reader.varint();
+    for (u64 i = 0; i < traversalStartCount; i++) {
+        checkpoint.traversalStarts.push_back(reader.varint());
+    }
+
+    const u64 iterationCount = reader.varint();
+    for (u64 i = 0; i < iterationCount; i++) {
+        checkpoint.commandCounts.push_back((i > 0 ? checkpoint.commandCounts.back() : 0) + reader.signedVarint());
+    }
+
+    std::ostringstream generatorOut;
+    const u64 generatorWordCount = reader.varint();
+    for (u64 i = 0; i < generatorWordCount; i++) {
+        generatorOut << (i > 0 ? " " : "") << reader.varint();
+    }
+    checkpoint.generatorState = generatorOut.str();
+
+    const u64 chainCount = reader.varint();
+    for (u64 i = 0; i < chainCount; i++) {
+        const ChainCodeType type = static_cast<ChainCodeType>(reader.byte());
+        const int startX = static_cast<int>(reader.signedVarint());
+        const int startY = static_cast<int>(reader.signedVarint());
+        const short initialDirection = static_cast<short>(reader.signedVarint());
+        checkpoint.chainCodes.emplace_back("", type, startX, startY, initialDirection);
+
+        const int x = static_cast<int>(reader.signedVarint());
+        const int y = static_cast<int>(reader.signedVarint());
+        checkpoint.startPixels.emplace_back(x, y);
+
+        checkpoint.chainCodes.back().code = reader.commands(type);
+    }
+
+    return checkpoint;
+}
+
+void NoiseCheckpoint::save(const std::string& file) const {
+    BinaryFormat::writeFileAtomically(file, encode());
+}
+
+NoiseCheckpoint NoiseCheckpoint::load(const std::string& file) {
+    const MappedFile mappedFile(file);
+    return decode(mappedFile.data(), mappedFile.size());
+}
+
+
+
+NoiseCheckpointWriter::NoiseCheckpointWriter(const std::string& file) :
+    m_File(file)
+{}
+
+NoiseCheckpointWriter::~NoiseCheckpointWriter() {
+    try {
+        finish();
+    }
+    catch (const std::exception&) {
+    }
+}
+
+void NoiseCheckpointWriter::submit(NoiseCheckpoint&& checkpoint) {
+    // Previous checkpoint is completed first (its failure ends the run instead of being lost).
+    finish();
+
+    m_Pending = std::async(std::launch::async, [file = m_File, checkpoint = std::move(checkpoint)]() {
+        checkpoint.save(file);
+    });
+}
+
+void NoiseCheckpointWriter::finish() {
+    if (m_Pending.valid()) {
+        m_Pending.get();
+    }
+}
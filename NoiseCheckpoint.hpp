@@ -0,0 +1,102 @@
+#pragma once
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// State of a noise run after a finished iteration, from which the run continues bit-identically.
+/// Border pixels are not stored, they are traced from the chain codes and their starting pixels.
+/// </summary>
+struct NoiseCheckpoint {
+    std::string name;                    // Name of the chain code group.
+    uint iteration = 0;                  // Number of finished iterations.
+    uint numberOfIterations = 0;         // Number of iterations of the whole run.
+    double noiseProbability = 0.0;       // Probability of the noise.
+    uint replacementWindow = 2;          // Number of commands replaced at once.
+    std::vector<ChainCode> chainCodes;   // Noisy chain codes.
+    std::vector<Pixel> startPixels;      // Starting pixels of each chain code.
+    std::string generatorState;          // Serialized state of the random number generator.
+    double seconds = 0.0;                // Accumulated time spent adding noise.
+    std::vector<u64> commandCounts;      // Number of commands of all chain codes after each iteration.
+    uint pipelineDepth = 0;              // Iterations in flight of NoisePipeline (0 - single random stream).
+    std::vector<u64> traversalStarts;    // Command where the next pipelined iteration starts on each contour.
+
+    // Sizes of the per-iteration outputs (rows written after the checkpoint are discarded on resume).
+    u64 profileSize = 0;
+    u64 compressionSize = 0;
+    u64 validationSize = 0;
+    u64 journalSize = 0;
+
+    /// <summary>
+    /// Encoding the checkpoint into the binary form.
+    /// </summary>
+    /// <returns>Encoded checkpoint</returns>
+    std::vector<unsigned char> encode() const;
+
+    /// <summary>
+    /// Decoding a checkpoint from the binary form.
+    /// </summary>
+    /// <param name="data">: encoded checkpoint</param>
+    /// <param name="size">: size of the encoded checkpoint</param>
+    /// <returns>Checkpoint</returns>
+    static NoiseCheckpoint decode(const unsigned char* data, const size_t size);
+
+    /// <summary>
+    /// Writing the checkpoint into a temporary file that replaces the given one once it is complete,
+    /// so an interrupted write never damages the previous checkpoint.
+    /// </summary>
+    /// <param name="file">: path to the checkpoint file</param>
+    void save(const std::string& file) const;
+
+    /// <summary>
+    /// Reading a checkpoint.
+    /// </summary>
+    /// <param name="file">: path to the checkpoint file</param>
+    /// <returns>Checkpoint</returns>
+    static NoiseCheckpoint load(const std::string& file);
+};
+
+
+
+/// <summary>
+/// Writer of checkpoints in a background thread, so the noise run is not stalled by encoding and I/O.
+/// A checkpoint is written while the run continues; the next one waits until it is complete, so no checkpoint
+/// is dropped, and a failed write is reported by the next submit or by finish.
+/// </summary>
+class NoiseCheckpointWriter {
+private:
+    std::string m_File;          // Path to the checkpoint file.
+    std::future<void> m_Pending; // Checkpoint that is being written.
+
+public:
+    /// <summary>
+    /// Constructor of the writer.
+    /// </summary>
+    /// <param name="file">: path to the checkpoint file</param>
+    NoiseCheckpointWriter(const std::string& file);
+
+    NoiseCheckpointWriter(const NoiseCheckpointWriter&) = delete;
+    NoiseCheckpointWriter& operator=(const NoiseCheckpointWriter&) = delete;
+
+    /// <summary>
+    /// Waiting for the last checkpoint to be written (failures are not reported; call finish to get them).
+    /// </summary>
+    ~NoiseCheckpointWriter();
+
+    /// <summary>
+    /// Starting to write a checkpoint. If the previous one is still being written, the call waits for it.
+    /// </summary>
+    /// <param name="checkpoint">: checkpoint (moved to the writing thread)</param>
+    void submit(NoiseCheckpoint&& checkpoint);
+
+    /// <summary>
+    /// Waiting for the last checkpoint to be written, rethrowing the failure of the write.
+    /// </summary>
+    void finish();
+};
@@ -0,0 +1,44 @@
+#include <algorithm>
+#include <fstream>
+
+#include "NoiseController.hpp"
+
+
+void NoiseRunReport::writeCsv(const std::string& file) const {
+    std::ofstream out(file, std::ios_base::trunc);
+    out << "iteration,probability,metric,seconds\n";
+    for (const NoiseRunStep& step : trajectory) {
+        out << step.iteration << "," << step.probability << "," << step.metric << "," << step.seconds << "\n";
+    }
+}
+
+
+
+NoiseController::NoiseController(const NoiseTarget& target, const double initialMetric) :
+    m_Target(target),
+    m_Probability(std::clamp(target.initialProbability, target.minProbability, target.maxProbability)),
+    m_LastMetric(initialMetric)
+{}
+
+double NoiseController::probability() const {
+    return m_Probability;
+}
+
+double NoiseController::update(const double metric) {
+    // Observed change per unit probability, smoothed over iterations.
+    const double observedGain = (metric - m_LastMetric) / m_Probability;
+    m_Gain = m_Gain == 0.0 ? observedGain : (1.0 - SMOOTHING) * m_Gain + SMOOTHING * observedGain;
+    m_LastMetric = metric;
+
+    const double error = m_Target.value - metric;
+    if (m_Gain <= 0.0) {
+        // The metric does not respond (yet), so the probability grows.
+        m_Probability *= GROWTH;
+    }
+    else {
+        m_Probability = error / m_Gain;
+    }
+
+    m_Probability = std::clamp(m_Probability, m_Target.minProbability, m_Target.maxProbability);
+    return m_Probability;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Constants.hpp"
+#include "NoiseStatistics.hpp"
+
+
+/// <summary>
+/// Target of the adaptive noise run.
+/// </summary>
+struct NoiseTarget {
+    NoiseTargetMetric metric = NoiseTargetMetric::fractalDimension;  // Metric that is driven towards the target.
+    double value = 1.5;                // Target value of the metric (the run stops once the metric reaches it).
+    double timeBudget = 0.0;           // Wall-clock budget in seconds (0 - unlimited).
+    uint maxIterations = 10000;        // Maximum number of iterations.
+    double initialProbability = 0.05;  // Noise probability of the first iteration.
+    double minProbability = 0.001;     // Lower limit of the noise probability.
+    double maxProbability = 0.5;       // Upper limit of the noise probability.
+};
+
+
+/// <summary>
+/// State after one iteration of the adaptive noise run.
+/// </summary>
+struct NoiseRunStep {
+    uint iteration;      // Number of finished iterations.
+    double probability;  // Noise probability used in the iteration.
+    double metric;       // Metric value after the iteration.
+    double seconds;      // Elapsed wall-clock time.
+};
+
+
+/// <summary>
+/// Result of the adaptive noise run.
+/// </summary>
+struct NoiseRunReport {
+    std::vector<NoiseRunStep> trajectory;  // Metric and probability after each iteration (starting with iteration 0).
+    bool targetReached = false;            // True if the metric reached the target value.
+    bool budgetExpired = false;            // True if the run was stopped by the time budget.
+
+    /// <summary>
+    /// Writing the trajectory into a CSV file.
+    /// </summary>
+    /// <param name="file">: path to the output file</param>
+    void writeCsv(const std::string& file) const;
+};
+
+
+
+/// <summary>
+/// Controller of the noise probability. The metric change per iteration is modelled as proportional
+/// to the probability; the gain is estimated from the observed changes, and the next probability is
+/// the one that would close the remaining gap in a single iteration (within the probability limits).
+/// </summary>
+class NoiseController {
+private:
+    static constexpr double SMOOTHING = 0.5;  // Weight of the latest gain observation.
+    static constexpr double GROWTH = 2.0;     // Probability increase while the metric does not respond.
+
+    NoiseTarget m_Target;      // Target of the run.
+    double m_Probability;      // Probability for the next iteration.
+    double m_Gain = 0.0;       // Estimated metric change per iteration and unit probability.
+    double m_LastMetric;       // Metric value before the last iteration.
+
+public:
+    /// <summary>
+    /// Constructor of the controller.
+    /// </summary>
+    /// <param name="target">: target of the run</param>
+    /// <param name="initialMetric">: metric value before the first iteration</param>
+    NoiseController(const NoiseTarget& target, const double initialMetric);
+
+    /// <summary>
+    /// Noise probability for the next iteration.
+    /// </summary>
+    /// <returns>Probability</returns>
+    double probability() const;
+
+    /// <summary>
+    /// Updating the gain estimate with the metric after an iteration and choosing the next probability.
+    /// </summary>
+    /// <param name="metric">: metric value after the iteration</param>
+    /// <returns>Probability for the next iteration</returns>
+    double update(const double metric);
+};
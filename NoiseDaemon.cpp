@@ -0,0 +1,522 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <WinSock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "ChainCodeNoise.hpp"
+#include "ChainCodeRasterizer.hpp"
+#include "ChainCodeTranscoder.hpp"
+#include "NoiseAnalyzer.hpp"
+#include "NoiseDaemon.hpp"
+
+
+namespace {
+    // Limits of a single job, so one request cannot hold a worker for minutes or exhaust the memory.
+    constexpr u64 MAX_DISTANCE_SEGMENTS = 20000;   // Euclidean distance is quadratic (maxAnalyzerSegments of the benchmark).
+    constexpr uint MAX_RENDER_SCALE = 64;          // Image pixels per side of a border pixel.
+    constexpr uint MAX_RENDER_PADDING = 4096;      // Border pixels around the shape.
+    constexpr u64 MAX_RENDER_PIXELS = 1ull << 28;  // Pixels of a rendered image (one byte each).
+
+#ifdef _WIN32
+    const SOCKET NO_SOCKET = INVALID_SOCKET;
+    const int SHUTDOWN_READ = SD_RECEIVE;
+    const int SEND_FLAGS = 0;
+
+    void closeSocket(const SOCKET socket) {
+        closesocket(socket);
+    }
+#else
+    const int NO_SOCKET = -1;
+    const int SHUTDOWN_READ = SHUT_RD;
+    const int SEND_FLAGS = MSG_NOSIGNAL;  // A client that went away must not stop the daemon with SIGPIPE.
+
+    void closeSocket(const int socket) {
+        ::close(socket);
+    }
+#endif
+}
+
+
+
+NoiseDaemon::Connection::Connection(const Socket socket) :
+    socket(socket)
+{}
+
+NoiseDaemon::Connection::~Connection() {
+    closeSocket(socket);
+}
+
+
+NoiseDaemon::NoiseDaemon(const std::string& socketPath, const uint threads, const size_t queueCapacity, const size_t maxDatasets) :
+    m_SocketPath(socketPath),
+    m_Threads(threads > 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u)),
+    m_QueueCapacity(queueCapacity > 0 ? queueCapacity : 4 * static_cast<size_t>(m_Threads)),
+    m_MaxDatasets(std::max<size_t>(maxDatasets, 1)),
+    m_Listener(NO_SOCKET)
+{
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+        throw std::logic_error("Windows sockets could not be initialized.");
+    }
+#endif
+}
+
+NoiseDaemon::~NoiseDaemon() {
+    if (m_Listener != NO_SOCKET) {
+        closeSocket(m_Listener);
+        std::error_code error;
+        std::filesystem::remove(m_SocketPath, error);
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+std::vector<std::string> NoiseDaemon::tokenize(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::string token;
+    bool inToken = false;
+    bool quoted = false;
+    for (const char character : line) {
+        if (character == '"') {
+            quoted = !quoted;
+            inToken = true;
+        }
+        else if (!quoted && (character == ' ' || character == '\t')) {
+            if (inToken) {
+                tokens.push_back(token);
+                token.clear();
+                inToken = false;
+            }
+        }
+        else {
+            token += character;
+            inToken = true;
+        }
+    }
+    if (inToken) {
+        tokens.push_back(token);
+    }
+
+    return tokens;
+}
+
+void NoiseDaemon::reply(Connection& connection, const std::string& line) {
+    const std::string message = line + "\n";
+    std::lock_guard<std::mutex> lock(connection.writeMutex);
+    size_t sent = 0;
+    while (sent < message.size()) {
+        const auto count = send(connection.socket, message.data() + sent, static_cast<int>(message.size() - sent), SEND_FLAGS);
+        if (count <= 0) {
+            return;  // The client went away, the reply is dropped.
+        }
+        sent += static_cast<size_t>(count);
+    }
+}
+
+std::shared_ptr<DaemonDataset> NoiseDaemon::loadDataset(const std::string& file) {
+    auto dataset = std::make_shared<DaemonDataset>();
+    dataset->chainCodes = ChainCodeFunctions::readChainCodeFile(file);
+    if (dataset->chainCodes.empty()) {
+        throw std::logic_error("File contains no chain codes.");
+    }
+
+    // Prepared as by the application: relative chain codes are converted to F4 and the border is moved to the origin.
+    for (ChainCode& chainCode : dataset->chainCodes) {
+        if (chainCode.type == ChainCodeType::VCC || chainCode.type == ChainCodeType::ThreeOT) {
+            chainCode = ChainCodeTranscoder::transcode(chainCode, ChainCodeType::F4);
+        }
+    }
+    const auto [coordinates, maxXCoordinate, maxYCoordinate] = ChainCodeFunctions::calculateCoordinates(dataset->chainCodes);
+    for (const std::vector<Pixel>& chainCodeCoordinates : coordinates) {
+        dataset->startPixels.push_back(chainCodeCoordinates[0]);
+    }
+    dataset->borderPixels = ChainCodeFunctions::coordinatesToSet(coordinates, maxXCoordinate);
+
+    return dataset;
+}
+
+std::shared_ptr<const DaemonDataset> NoiseDaemon::dataset(const std::string& file) {
+    const std::filesystem::file_time_type modified = std::filesystem::last_write_time(file);
+    {
+        std::lock_guard<std::mutex> lock(m_DatasetMutex);
+        const auto found = m_Datasets.find(file);
+        if (found != m_Datasets.end() && found->second->modified == modified) {
+            found->second->lastUse = ++m_DatasetUses;
+            return found->second;
+        }
+    }
+
+    // The file is read outside of the lock, so jobs on cached files are not blocked by a large one.
+    std::shared_ptr<DaemonDataset> loaded = loadDataset(file);
+    loaded->modified = modified;
+    m_DatasetLoads++;
+
+    std::lock_guard<std::mutex> lock(m_DatasetMutex);
+    if (m_Datasets.size() >= m_MaxDatasets && m_Datasets.count(file) == 0) {
+        const auto leastRecent = std::min_element(m_Datasets.begin(), m_Datasets.end(), [](const auto& a, const auto& b) {
+            return a.second->lastUse < b.second->lastUse;
+        });
+        m_Datasets.erase(leastRecent);
+    }
+    loaded->lastUse = ++m_DatasetUses;
+    m_Datasets[file] = loaded;
+
+    return loaded;
+}
+
+std::string NoiseDaemon::execute(const Job& job, ChainCodeNoise& noise, std::unordered_set<Pixel>& borderPixels, std::mt19937& seeds) {
+    if (job.tokens.size() < 3) {
+        throw std::logic_error("Missing chain code file.");
+    }
+    const std::string& command = job.tokens[1];
+
+    // The whole request is checked before its chain code file is loaded, so an invalid job costs no parsing.
+    std::vector<std::string> known;
+    if (command == "NOISE") {
+        known = { "p", "iterations", "window", "seed", "output" };
+    }
+    else if (command == "ANALYZE") {
+        known = { "noisy" };
+    }
+    else if (command == "RENDER") {
+        known = { "output", "scale", "padding" };
+    }
+    else {
+        throw std::logic_error("Unknown command " + command + ".");
+    }
+
+    std::unordered_map<std::string, std::string> options;
+    for (size_t i = 3; i < job.tokens.size(); i++) {
+        const size_t separator = job.tokens[i].find('=');
+        if (separator == std::string::npos) {
+            throw std::logic_error("Invalid option " + job.tokens[i] + ".");
+        }
+        const std::string key = job.tokens[i].substr(0, separator);
+        if (std::find(known.begin(), known.end(), key) == known.end()) {
+            throw std::logic_error("Unknown option " + key + " of " + command + ".");
+        }
+        options[key] = job.tokens[i].substr(separator + 1);
+    }
+    const auto option = [&options](const std::string& key, const std::string& fallback) {
+        const auto found = options.find(key);
+        return found == options.end() ? fallback : found->second;
+    };
+    // Only digits are accepted, so a negative or partial number is not wrapped or cut off by stoul.
+    const auto number = [&option](const std::string& key, const std::string& fallback) {
+        const std::string value = option(key, fallback);
+        if (value.empty() || value.size() > 10 || value.find_first_not_of("0123456789") != std::string::npos || std::stoull(value) > std::numeric_limits<uint>::max()) {
+            throw std::logic_error("Invalid value of " + key + ".");
+        }
+        return static_cast<uint>(std::stoull(value));
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::ostringstream result;
+    result << "OK";
+
+    if (command == "NOISE") {
+        const std::string probabilityValue = option("p", "0.02");
+        char* end = nullptr;
+        const double probability = std::strtod(probabilityValue.c_str(), &end);
+        if (probabilityValue.empty() || *end != '\0') {
+            throw std::logic_error("Invalid value of p.");
+        }
+        if (!(probability >= 0.0 && probability <= 1.0)) {
+            throw std::logic_error("Noise probability must be within [0, 1].");
+        }
+        const uint iterations = number("iterations", "1");
+        noise.setReplacementWindow(number("window", "2"));
+        noise.setSeed(options.count("seed") > 0 ? number("seed", "") : seeds());
+
+        const std::shared_ptr<const DaemonDataset> input = dataset(job.tokens[2]);
+        borderPixels = input->borderPixels;
+        const std::vector<ChainCode> noisyChainCodes = noise.applyNoise(input->chainCodes, input->startPixels, borderPixels, probability, iterations, job.tokens[2]);
+
+        u64 commands = 0;
+        for (const ChainCode& chainCode : noisyChainCodes) {
+            commands += chainCode.code.size();
+        }
+        if (options.count("output") > 0) {
+            ChainCodeFunctions::writeChainCodeFile(options["output"], noisyChainCodes);
+        }
+        result << " chainCodes=" << noisyChainCodes.size() << " commands=" << commands;
+    }
+    else if (command == "ANALYZE") {
+        const std::shared_ptr<const DaemonDataset> input = dataset(job.tokens[2]);
+        const NoiseAnalyzer analyzer(input->chainCodes);
+        if (options.count("noisy") > 0) {
+            const std::shared_ptr<const DaemonDataset> noisy = dataset(options["noisy"]);
+
+            // The distance compares the contours pairwise, so the noisy file must be a noisy version of the input.
+            if (noisy->chainCodes.size() != input->chainCodes.size()) {
+                throw std::logic_error("Noisy file has " + std::to_string(noisy->chainCodes.size()) + " chain codes, the input has " + std::to_string(input->chainCodes.size()) + ".");
+            }
+            u64 inputSegments = 0;
+            u64 noisySegments = 0;
+            for (size_t i = 0; i < input->chainCodes.size(); i++) {
+                if (noisy->chainCodes[i].type != input->chainCodes[i].type) {
+                    throw std::logic_error("Chain code " + std::to_string(i) + " of the noisy file has a different type.");
+                }
+                inputSegments += input->chainCodes[i].code.size();
+                noisySegments += noisy->chainCodes[i].code.size();
+            }
+            if (std::max(inputSegments, noisySegments) > MAX_DISTANCE_SEGMENTS) {
+                throw std::logic_error("Chain codes are too long for the distance (more than " + std::to_string(MAX_DISTANCE_SEGMENTS) + " commands).");
+            }
+            result << " distance=" << analyzer.analyzeNoise(noisy->chainCodes, NoiseAnalysisType::euclidean);
+            result << " fractalDimension=" << analyzer.fractalDimension(noisy->chainCodes);
+        }
+        else {
+            result << " fractalDimension=" << analyzer.fractalDimension(input->chainCodes);
+        }
+    }
+    else {
+        if (options.count("output") == 0) {
+            throw std::logic_error("Missing output file.");
+        }
+        const uint scale = number("scale", "2");
+        const uint padding = number("padding", "1");
+        if (scale == 0 || scale > MAX_RENDER_SCALE) {
+            throw std::logic_error("Scale must be within [1, " + std::to_string(MAX_RENDER_SCALE) + "].");
+        }
+        if (padding > MAX_RENDER_PADDING) {
+            throw std::logic_error("Padding must be at most " + std::to_string(MAX_RENDER_PADDING) + ".");
+        }
+
+        // Border pixels of a dataset start at the origin, so their maxima give the size of the image.
+        const std::shared_ptr<const DaemonDataset> input = dataset(job.tokens[2]);
+        u64 maxX = 0;
+        u64 maxY = 0;
+        for (const Pixel& pixel : input->borderPixels) {
+            maxX = std::max<u64>(maxX, std::max(pixel.x, 0));
+            maxY = std::max<u64>(maxY, std::max(pixel.y, 0));
+        }
+        if (scale * (maxX + 1 + 2 * padding) * scale * (maxY + 1 + 2 * padding) > MAX_RENDER_PIXELS) {
+            throw std::logic_error("Image would have more than " + std::to_string(MAX_RENDER_PIXELS) + " pixels.");
+        }
+        const RasterImage image = ChainCodeRasterizer::rasterize(input->chainCodes, scale, padding);
+        if (std::filesystem::path(options["output"]).extension() == ".png") {
+            ChainCodeRasterizer::writePng(options["output"], image);
+        }
+        else {
+            ChainCodeRasterizer::writePgm(options["output"], image);
+        }
+        result << " width=" << image.width << " height=" << image.height;
+    }
+
+    result << " micros=" << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return result.str();
+}
+
+bool NoiseDaemon::submit(Job&& job) {
+    {
+        std::unique_lock<std::mutex> lock(m_QueueMutex);
+        m_QueueNotFull.wait(lock, [this]() { return m_Queue.size() < m_QueueCapacity || m_Stopping; });
+        if (m_Stopping) {
+            return false;
+        }
+        m_Queue.push_back(std::move(job));
+    }
+    m_QueueNotEmpty.notify_one();
+    return true;
+}
+
+void NoiseDaemon::runWorker() {
+    // Each worker keeps its noise engine (replacement tables and settings) and border hash table for all of its jobs.
+    ChainCodeNoise noise;
+    noise.setConsoleProgress(false);
+    std::unordered_set<Pixel> borderPixels;
+    std::mt19937 seeds(std::random_device{}());
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_QueueMutex);
+            m_QueueNotEmpty.wait(lock, [this]() { return !m_Queue.empty() || m_Stopping; });
+            if (m_Queue.empty()) {
+                return;  // Stopping and all queued jobs are done.
+            }
+            job = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+        m_QueueNotFull.notify_one();
+
+        std::string result;
+        try {
+            result = execute(job, noise, borderPixels, seeds);
+            m_CompletedJobs++;
+        }
+        catch (const std::exception& exception) {
+            result = std::string("ERROR ") + exception.what();
+            std::replace(result.begin(), result.end(), '\n', ' ');
+            m_FailedJobs++;
+        }
+        reply(*job.connection, job.tokens[0] + " " + result);
+    }
+}
+
+void NoiseDaemon::serveConnection(const std::shared_ptr<Connection>& connection) {
+    std::string buffer;
+    char chunk[4096];
+    bool open = true;
+    while (open) {
+        const auto received = recv(connection->socket, chunk, static_cast<int>(sizeof(chunk)), 0);
+        if (received <= 0) {
+            break;
+        }
+        buffer.append(chunk, static_cast<size_t>(received));
+
+        size_t begin = 0;
+        for (size_t end = buffer.find('\n'); open && end != std::string::npos; end = buffer.find('\n', begin)) {
+            std::string line = buffer.substr(begin, end - begin);
+            begin = end + 1;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+
+            std::vector<std::string> tokens = tokenize(line);
+            if (tokens.empty()) {
+                continue;
+            }
+            if (tokens.size() < 2) {
+                reply(*connection, tokens[0] + " ERROR Missing command.");
+                continue;
+            }
+
+            // Statistics and shutdown are answered by the reader, so they are not queued behind other jobs.
+            if (tokens[1] == "STATS") {
+                size_t queued;
+                size_t datasets;
+                {
+                    std::lock_guard<std::mutex> lock(m_QueueMutex);
+                    queued = m_Queue.size();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_DatasetMutex);
+                    datasets = m_Datasets.size();
+                }
+                reply(*connection, tokens[0] + " OK threads=" + std::to_string(m_Threads) + " queued=" + std::to_string(queued) + " completed=" + std::to_string(m_CompletedJobs) + " failed=" + std::to_string(m_FailedJobs) + " datasets=" + std::to_string(datasets) + " loads=" + std::to_string(m_DatasetLoads));
+            }
+            else if (tokens[1] == "SHUTDOWN") {
+                reply(*connection, tokens[0] + " OK");
+                stop();
+                open = false;
+            }
+            else {
+                const std::string id = tokens[0];
+                if (!submit(Job{ connection, std::move(tokens) })) {
+                    reply(*connection, id + " ERROR Daemon is stopping.");
+                    open = false;
+                }
+            }
+        }
+        buffer.erase(0, begin);
+    }
+
+    std::lock_guard<std::mutex> lock(m_ConnectionMutex);
+    m_ActiveReaders--;
+    m_ReadersFinished.notify_all();
+}
+
+void NoiseDaemon::stop() {
+    if (m_Stopping.exchange(true)) {
+        return;
+    }
+
+    // Waking the accept loop, the readers waiting for data or for space in the queue, and the idle workers.
+#ifdef _WIN32
+    closesocket(m_Listener);
+#else
+    shutdown(m_Listener, SHUT_RDWR);
+#endif
+    {
+        std::lock_guard<std::mutex> lock(m_ConnectionMutex);
+        for (const std::weak_ptr<Connection>& weakConnection : m_Connections) {
+            if (const std::shared_ptr<Connection> connection = weakConnection.lock()) {
+                shutdown(connection->socket, SHUTDOWN_READ);
+            }
+        }
+    }
+    {
+        // Taking the queue lock, so a thread between its check of the flag and its wait does not miss the notification.
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+    }
+    m_QueueNotFull.notify_all();
+    m_QueueNotEmpty.notify_all();
+}
+
+void NoiseDaemon::run() {
+    m_Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_Listener == NO_SOCKET) {
+        throw std::logic_error("Socket could not be created.");
+    }
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (m_SocketPath.size() >= sizeof(address.sun_path)) {
+        throw std::logic_error("Socket path is too long.");
+    }
+    std::copy(m_SocketPath.begin(), m_SocketPath.end(), address.sun_path);
+
+    // A socket file left by a previous daemon would make the bind fail.
+    std::error_code error;
+    std::filesystem::remove(m_SocketPath, error);
+    if (bind(m_Listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(m_Listener, SOMAXCONN) != 0) {
+        throw std::logic_error("Socket could not be bound to " + m_SocketPath + ".");
+    }
+
+    std::vector<std::thread> workers;
+    for (uint i = 0; i < m_Threads; i++) {
+        workers.emplace_back(&NoiseDaemon::runWorker, this);
+    }
+
+    while (!m_Stopping) {
+        const Socket client = accept(m_Listener, nullptr, nullptr);
+        if (client == NO_SOCKET) {
+            continue;
+        }
+
+        const auto connection = std::make_shared<Connection>(client);
+        {
+            std::lock_guard<std::mutex> lock(m_ConnectionMutex);
+            m_Connections.erase(std::remove_if(m_Connections.begin(), m_Connections.end(), [](const std::weak_ptr<Connection>& weakConnection) {
+                return weakConnection.expired();
+            }), m_Connections.end());
+            m_Connections.push_back(connection);
+            m_ActiveReaders++;
+        }
+        if (m_Stopping) {
+            shutdown(client, SHUTDOWN_READ);
+        }
+        std::thread(&NoiseDaemon::serveConnection, this, connection).detach();
+    }
+
+    // Queued jobs are finished before the workers return; replies still reach the open connections.
+    {
+        std::unique_lock<std::mutex> lock(m_ConnectionMutex);
+        m_ReadersFinished.wait(lock, [this]() { return m_ActiveReaders == 0; });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+#ifdef _WIN32
+    m_Listener = NO_SOCKET;  // Closed by stop.
+#endif
+    std::filesystem::remove(m_SocketPath, error);
+}
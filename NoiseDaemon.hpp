@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+class ChainCodeNoise;
+
+
+/// <summary>
+/// Chain code file prepared for jobs (as loaded by the application: relative codes converted to F4, border moved
+/// to the origin) and kept in memory by the daemon.
+/// </summary>
+struct DaemonDataset {
+    std::vector<ChainCode> chainCodes;
+    std::vector<Pixel> startPixels;            // Starting pixels of the chain codes.
+    std::unordered_set<Pixel> borderPixels;    // Hash table of border pixels.
+    std::filesystem::file_time_type modified;  // Modification time of the file when it was read.
+    u64 lastUse = 0;                           // Job counter at the last use (least recently used is evicted).
+};
+
+
+
+/// <summary>
+/// Long-lived job server on a Unix domain socket. Clients send one job per line and receive one reply line per
+/// job, prefixed with the id chosen by the client; jobs of a connection may complete out of order. Parsed chain
+/// code files are cached (reloaded when the file changes) and each worker keeps its own noise engine, so a job
+/// on a small shape costs only the noise, analysis or rendering itself.
+///
+/// Jobs (tokens are separated by spaces, paths with spaces are written in double quotes):
+///     id NOISE file [p=0.02] [iterations=1] [window=2] [seed=n] [output=file]
+///     id ANALYZE file [noisy=file]
+///     id RENDER file output=file.png|file.pgm [scale=2] [padding=1]
+///     id STATS
+///     id SHUTDOWN
+/// Replies: "id OK key=value ..." or "id ERROR message". Unknown commands and options and invalid values (e.g. p
+/// outside of [0, 1]) are reported before the chain code file is loaded. ANALYZE with a noisy file needs the same
+/// number and types of chain codes as the input and at most 20000 commands in each file (the distance is
+/// quadratic); RENDER takes a scale up to 64 and a padding up to 4096, and images up to 2^28 pixels.
+///
+/// Jobs are queued for a fixed pool of workers. When the queue is full, the connection stops reading until a
+/// worker takes a job, so a client that sends faster than the jobs complete is slowed down by the socket.
+/// </summary>
+class NoiseDaemon {
+private:
+#ifdef _WIN32
+    using Socket = unsigned long long;  // Windows SOCKET.
+#else
+    using Socket = int;                 // POSIX socket descriptor.
+#endif
+
+    // Client connection (closed when its reader and all of its jobs are finished).
+    struct Connection {
+        Socket socket;
+        std::mutex writeMutex;  // Replies of concurrent jobs are written whole.
+
+        Connection(const Socket socket);
+        ~Connection();
+    };
+
+    // Queued job.
+    struct Job {
+        std::shared_ptr<Connection> connection;
+        std::vector<std::string> tokens;  // Id, command and arguments.
+    };
+
+    std::string m_SocketPath;
+    uint m_Threads;
+    size_t m_QueueCapacity;
+    size_t m_MaxDatasets;
+    Socket m_Listener;
+
+    std::deque<Job> m_Queue;
+    std::mutex m_QueueMutex;
+    std::condition_variable m_QueueNotEmpty;
+    std::condition_variable m_QueueNotFull;
+    std::atomic<bool> m_Stopping = false;
+
+    std::vector<std::weak_ptr<Connection>> m_Connections;  // Open connections (their readers are woken by stop).
+    size_t m_ActiveReaders = 0;
+    std::mutex m_ConnectionMutex;
+    std::condition_variable m_ReadersFinished;
+
+    std::unordered_map<std::string, std::shared_ptr<DaemonDataset>> m_Datasets;
+    u64 m_DatasetUses = 0;
+    std::mutex m_DatasetMutex;
+
+    std::atomic<u64> m_CompletedJobs = 0;
+    std::atomic<u64> m_FailedJobs = 0;
+    std::atomic<u64> m_DatasetLoads = 0;
+
+    /// <summary>
+    /// Reading jobs from a connection until it is closed.
+    /// </summary>
+    /// <param name="connection">: client connection</param>
+    void serveConnection(const std::shared_ptr<Connection>& connection);
+
+    /// <summary>
+    /// Taking jobs from the queue until the daemon stops.
+    /// </summary>
+    void runWorker();
+
+    /// <summary>
+    /// Adding a job to the queue, waiting while the queue is full.
+    /// </summary>
+    /// <param name="job">: job</param>
+    /// <returns>False if the daemon is stopping</returns>
+    bool submit(Job&& job);
+
+    /// <summary>
+    /// Running a job.
+    /// </summary>
+    /// <param name="job">: job</param>
+    /// <param name="noise">: noise engine of the worker</param>
+    /// <param name="borderPixels">: border pixels of the worker (assigned for each job, which reuses the hash nodes)</param>
+    /// <param name="seeds">: generator of the seeds of jobs without a seed</param>
+    /// <returns>Reply without the id</returns>
+    std::string execute(const Job& job, ChainCodeNoise& noise, std::unordered_set<Pixel>& borderPixels, std::mt19937& seeds);
+
+    /// <summary>
+    /// Cached dataset of a file, read again if the file was modified.
+    /// </summary>
+    /// <param name="file">: chain code file</param>
+    /// <returns>Dataset</returns>
+    std::shared_ptr<const DaemonDataset> dataset(const std::string& file);
+
+    /// <summary>
+    /// Stopping the daemon: the listener is closed, queued jobs are finished and run returns.
+    /// </summary>
+    void stop();
+
+    /// <summary>
+    /// Writing a reply line to a connection.
+    /// </summary>
+    /// <param name="connection">: client connection</param>
+    /// <param name="line">: reply without the line ending</param>
+    static void reply(Connection& connection, const std::string& line);
+
+    /// <summary>
+    /// Splitting a job line into tokens (double quotes group a token with spaces).
+    /// </summary>
+    /// <param name="line">: job line</param>
+    /// <returns>Tokens</returns>
+    static std::vector<std::string> tokenize(const std::string& line);
+
+    /// <summary>
+    /// Reading a chain code file and preparing it for jobs.
+    /// </summary>
+    /// <param name="file">: chain code file</param>
+    /// <returns>Dataset</returns>
+    static std::shared_ptr<DaemonDataset> loadDataset(const std::string& file);
+
+public:
+    /// <summary>
+    /// Constructor of the daemon (the socket is created by run).
+    /// </summary>
+    /// <param name="socketPath">: path of the Unix domain socket</param>
+    /// <param name="threads">: number of workers (0 - number of hardware threads)</param>
+    /// <param name="queueCapacity">: number of queued jobs before the connections are throttled (0 - 4 per worker)</param>
+    /// <param name="maxDatasets">: number of cached chain code files</param>
+    NoiseDaemon(const std::string& socketPath, const uint threads = 0, const size_t queueCapacity = 0, const size_t maxDatasets = 256);
+
+    NoiseDaemon(const NoiseDaemon&) = delete;
+    NoiseDaemon& operator=(const NoiseDaemon&) = delete;
+
+    /// <summary>
+    /// Destructor that removes the socket file.
+    /// </summary>
+    ~NoiseDaemon();
+
+    /// <summary>
+    /// Listening for connections and serving jobs until a SHUTDOWN job is received.
+    /// </summary>
+    void run();
+};
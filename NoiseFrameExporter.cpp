@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "ChainCodeRasterizer.hpp"
+#include "NoiseFrameExporter.hpp"
+
+
+NoiseFrameExporter::NoiseFrameExporter(const FrameExportSettings& settings, const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels) :
+    m_Settings(settings),
+    m_Video(std::filesystem::path(settings.output).extension() == ".y4m"),
+    m_StartPixels(startPixels)
+{
+    if (chainCodes.empty() || chainCodes.size() != startPixels.size()) {
+        throw std::logic_error("Frames need chain codes with a starting pixel each.");
+    }
+    m_Settings.interval = std::max(m_Settings.interval, 1u);
+    m_Settings.scale = std::max(m_Settings.scale, 1u);
+    m_Settings.framesPerSecond = std::max(m_Settings.framesPerSecond, 1u);
+
+    // Canvas of all frames: bounds of the first frame extended by the margin.
+    int minX = startPixels[0].x;
+    int maxX = minX;
+    int minY = startPixels[0].y;
+    int maxY = minY;
+    for (const std::vector<Pixel>& currentCoordinates : coordinates(chainCodes)) {
+        for (const Pixel& pixel : currentCoordinates) {
+            minX = std::min(minX, pixel.x);
+            maxX = std::max(maxX, pixel.x);
+            minY = std::min(minY, pixel.y);
+            maxY = std::max(maxY, pixel.y);
+        }
+    }
+    const int margin = static_cast<int>(m_Settings.margin);
+    m_MinX = minX - margin;
+    m_MinY = minY - margin;
+    m_MaxY = maxY + margin;
+    m_Width = m_Settings.scale * static_cast<uint>(maxX + margin - m_MinX + 1);
+    m_Height = m_Settings.scale * static_cast<uint>(m_MaxY - m_MinY + 1);
+
+    if (m_Video) {
+        m_Stream.open(m_Settings.output, std::ios_base::binary | std::ios_base::trunc);
+        m_Stream << "YUV4MPEG2 W" << m_Width << " H" << m_Height << " F" << m_Settings.framesPerSecond << ":1 Ip A1:1 Cmono\n";
+        if (!m_Stream) {
+            throw std::logic_error("Video file " + m_Settings.output + " cannot be written.");
+        }
+    }
+    else {
+        std::filesystem::create_directories(m_Settings.output);
+    }
+
+    const uint threads = m_Settings.threads > 0 ? m_Settings.threads : std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    m_QueueCapacity = m_Settings.queueCapacity > 0 ? m_Settings.queueCapacity : 2 * static_cast<size_t>(threads);
+    for (uint i = 0; i < threads; i++) {
+        m_Workers.emplace_back(&NoiseFrameExporter::runWorker, this);
+    }
+}
+
+NoiseFrameExporter::~NoiseFrameExporter() {
+    try {
+        finish();
+    }
+    catch (const std::exception&) {
+    }
+}
+
+std::vector<std::vector<Pixel>> NoiseFrameExporter::coordinates(const std::vector<ChainCode>& chainCodes) const {
+    std::vector<std::vector<Pixel>> coordinates(chainCodes.size());
+    for (size_t i = 0; i < chainCodes.size(); i++) {
+        Pixel pixel = m_StartPixels[i];
+        coordinates[i].reserve(chainCodes[i].code.size() + 1);
+        coordinates[i].push_back(pixel);
+        for (const short command : chainCodes[i].code) {
+            pixel = ChainCodeFunctions::chainCodeMove(chainCodes[i].type, command, pixel);
+            coordinates[i].push_back(pixel);
+        }
+    }
+    return coordinates;
+}
+
+bool NoiseFrameExporter::rasterize(const std::vector<ChainCode>& chainCodes, std::vector<unsigned char>& pixels) const {
+    // Coordinates are moved to the canvas origin; the rasterizer clips the pixels outside of the canvas.
+    std::vector<std::vector<Pixel>> canvasCoordinates = coordinates(chainCodes);
+    const int maxX = m_MinX + static_cast<int>(m_Width / m_Settings.scale) - 1;
+    bool clipped = false;
+    for (std::vector<Pixel>& currentCoordinates : canvasCoordinates) {
+        for (Pixel& pixel : currentCoordinates) {
+            clipped = clipped || pixel.x < m_MinX || pixel.x > maxX || pixel.y < m_MinY || pixel.y > m_MaxY;
+            pixel.x -= m_MinX;
+            pixel.y -= m_MinY;
+        }
+    }
+
+    pixels.resize(static_cast<size_t>(m_Width) * m_Height);
+    ChainCodeRasterizer::rasterize(canvasCoordinates, static_cast<uint>(m_MaxY - m_MinY), m_Settings.scale, 0, pixels.data(), m_Width, m_Height, m_Width);
+    return clipped;
+}
+
+void NoiseFrameExporter::runWorker() {
+    while (true) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(m_QueueMutex);
+            m_QueueNotEmpty.wait(lock, [this]() { return !m_Queue.empty() || m_Stopping; });
+            if (m_Queue.empty()) {
+                return;  // Finished and all queued frames are done.
+            }
+            frame = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+        m_QueueNotFull.notify_one();
+
+        try {
+            std::vector<unsigned char> pixels;
+            const bool clipped = rasterize(frame.chainCodes, pixels);
+
+            if (m_Video) {
+                // Frames are written by whichever thread completes the next one in the order of the stream.
+                std::lock_guard<std::mutex> lock(m_OutputMutex);
+                m_ReadyFrames.emplace(frame.index, std::move(pixels));
+                for (auto next = m_ReadyFrames.find(m_NextFrame); next != m_ReadyFrames.end(); next = m_ReadyFrames.find(m_NextFrame)) {
+                    m_Stream << "FRAME\n";
+                    m_Stream.write(reinterpret_cast<const char*>(next->second.data()), next->second.size());
+                    m_ReadyFrames.erase(next);
+                    m_NextFrame++;
+                    m_Report.frames++;
+                }
+                if (!m_Stream) {
+                    throw std::logic_error("Video file " + m_Settings.output + " cannot be written.");
+                }
+            }
+            else {
+                std::stringstream name;
+                name << "frame_" << std::setw(6) << std::setfill('0') << frame.iteration << ".png";
+                RasterImage image;
+                image.width = m_Width;
+                image.height = m_Height;
+                image.pixels = std::move(pixels);
+                ChainCodeRasterizer::writePng((std::filesystem::path(m_Settings.output) / name.str()).string(), image);
+
+                std::lock_guard<std::mutex> lock(m_OutputMutex);
+                m_Report.frames++;
+            }
+
+            if (clipped) {
+                std::lock_guard<std::mutex> lock(m_OutputMutex);
+                m_Report.clippedFrames++;
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(m_OutputMutex);
+            if (!m_Error) {
+                m_Error = std::current_exception();
+            }
+        }
+    }
+}
+
+void NoiseFrameExporter::submit(const uint iteration, const std::vector<ChainCode>& chainCodes) {
+    if (m_Finished) {
+        throw std::logic_error("Frame export is already finished.");
+    }
+    if (iteration % m_Settings.interval != 0) {
+        return;
+    }
+
+    // A failed export ends the run instead of losing the rest of the frames.
+    {
+        std::lock_guard<std::mutex> lock(m_OutputMutex);
+        if (m_Error) {
+            std::rethrow_exception(m_Error);
+        }
+    }
+
+    Frame frame = { 0, iteration, chainCodes };
+    {
+        std::unique_lock<std::mutex> lock(m_QueueMutex);
+        if (m_Queue.size() >= m_QueueCapacity) {
+            const auto start = std::chrono::steady_clock::now();
+            m_QueueNotFull.wait(lock, [this]() { return m_Queue.size() < m_QueueCapacity; });
+            m_Report.stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        frame.index = m_Submitted++;
+        m_Queue.push_back(std::move(frame));
+    }
+    m_QueueNotEmpty.notify_one();
+}
+
+FrameExportReport NoiseFrameExporter::finish() {
+    if (!m_Finished) {
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            m_Stopping = true;
+        }
+        m_QueueNotEmpty.notify_all();
+        for (std::thread& worker : m_Workers) {
+            worker.join();
+        }
+        m_Finished = true;
+
+        if (m_Video) {
+            m_Stream.close();
+        }
+    }
+
+    if (m_Error) {
+        std::rethrow_exception(m_Error);
+    }
+    return m_Report;
+}
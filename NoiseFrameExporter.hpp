@@ -0,0 +1,136 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Settings of the frame export of a noise run.
+/// </summary>
+struct FrameExportSettings {
+    std::string output;        // Directory of numbered PNG files, or a .y4m file (empty string disables the export).
+    uint interval = 1;         // Number of iterations between frames.
+    uint scale = 2;            // Size of a border pixel in image pixels.
+    uint margin = 16;          // Border pixels around the bounds of the first frame (the noise grows the shape).
+    uint framesPerSecond = 25; // Frame rate of the video stream.
+    uint threads = 0;          // Number of encoding threads (0 - hardware threads without the noise thread).
+    size_t queueCapacity = 0;  // Number of frames waiting for the encoders (0 - 2 per thread).
+};
+
+
+/// <summary>
+/// Summary of a frame export.
+/// </summary>
+struct FrameExportReport {
+    u64 frames = 0;             // Number of written frames.
+    u64 clippedFrames = 0;      // Number of frames with pixels outside of the canvas.
+    double stallSeconds = 0.0;  // Time the noise run waited for a free place in the queue.
+};
+
+
+
+/// <summary>
+/// Export of the evolution of a shape under noise as a sequence of frames. The noise run only copies the chain
+/// codes of a frame into a bounded queue; the encoding threads trace and rasterize them (ChainCodeRasterizer) and
+/// write either a numbered PNG file per frame (frame_000042.png for iteration 42) or one uncompressed YUV4MPEG2
+/// stream with a grayscale plane per frame, which the frames enter in the order of the iterations.
+/// All frames share the canvas of the first frame extended by the margin, so they can be played as a video;
+/// pixels that the noise moves outside of the canvas are clipped. When the queue is full, the run waits.
+/// </summary>
+class NoiseFrameExporter {
+private:
+    // Chain codes of a frame waiting for an encoder.
+    struct Frame {
+        u64 index;                         // Position of the frame in the stream.
+        uint iteration;                    // Number of finished iterations.
+        std::vector<ChainCode> chainCodes;
+    };
+
+    FrameExportSettings m_Settings;
+    bool m_Video;                      // True if the frames are written into one YUV4MPEG2 stream.
+    std::vector<Pixel> m_StartPixels;  // Starting pixels of the chain codes.
+    int m_MinX = 0;                    // Canvas origin (lowest coordinates of the first frame minus the margin).
+    int m_MinY = 0;
+    int m_MaxY = 0;                    // Highest Y coordinate of the canvas (rows are stored from the top).
+    uint m_Width = 0;
+    uint m_Height = 0;
+
+    std::deque<Frame> m_Queue;
+    size_t m_QueueCapacity;
+    std::mutex m_QueueMutex;
+    std::condition_variable m_QueueNotEmpty;
+    std::condition_variable m_QueueNotFull;
+    bool m_Stopping = false;
+    u64 m_Submitted = 0;
+    std::vector<std::thread> m_Workers;
+
+    std::ofstream m_Stream;                                   // YUV4MPEG2 stream (video only).
+    std::map<u64, std::vector<unsigned char>> m_ReadyFrames;  // Encoded frames waiting for their predecessors (video only).
+    u64 m_NextFrame = 0;                                      // Index of the next frame of the stream.
+    std::mutex m_OutputMutex;
+
+    FrameExportReport m_Report;
+    std::exception_ptr m_Error;  // First failure of an encoding thread (rethrown by finish).
+    bool m_Finished = false;
+
+    /// <summary>
+    /// Taking frames from the queue until the export is finished.
+    /// </summary>
+    void runWorker();
+
+    /// <summary>
+    /// Rasterizing a frame on the canvas.
+    /// </summary>
+    /// <param name="chainCodes">: chain codes of the frame</param>
+    /// <param name="pixels">: image buffer of the canvas (output)</param>
+    /// <returns>True if pixels were clipped</returns>
+    bool rasterize(const std::vector<ChainCode>& chainCodes, std::vector<unsigned char>& pixels) const;
+
+    /// <summary>
+    /// Border coordinates of chain codes.
+    /// </summary>
+    /// <param name="chainCodes">: chain codes</param>
+    /// <returns>Coordinates of each chain code</returns>
+    std::vector<std::vector<Pixel>> coordinates(const std::vector<ChainCode>& chainCodes) const;
+
+public:
+    /// <summary>
+    /// Starting an export. The canvas is fixed by the given chain codes, which are not submitted as a frame.
+    /// </summary>
+    /// <param name="settings">: settings of the export</param>
+    /// <param name="chainCodes">: chain codes of the first frame</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    NoiseFrameExporter(const FrameExportSettings& settings, const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels);
+
+    NoiseFrameExporter(const NoiseFrameExporter&) = delete;
+    NoiseFrameExporter& operator=(const NoiseFrameExporter&) = delete;
+
+    /// <summary>
+    /// Destructor that finishes the export (failures are not reported; call finish to get them).
+    /// </summary>
+    ~NoiseFrameExporter();
+
+    /// <summary>
+    /// Adding a frame to the queue, waiting while the queue is full.
+    /// </summary>
+    /// <param name="iteration">: number of finished iterations</param>
+    /// <param name="chainCodes">: chain codes of the frame (copied)</param>
+    void submit(const uint iteration, const std::vector<ChainCode>& chainCodes);
+
+    /// <summary>
+    /// Waiting for the queued frames to be written.
+    /// </summary>
+    /// <returns>Summary of the export</returns>
+    FrameExportReport finish();
+};
@@ -0,0 +1,131 @@
+#include <fstream>
+#include <iomanip>
+
+#include "NoiseInstrumentation.hpp"
+
+
+namespace {
+    const char* const COUNTER_NAMES[] = { "commands", "candidates", "emptyReplacements", "selfTouchRejections", "accepted", "selfTouchProbes" };
+    const char* const PHASE_NAMES[] = { "samplingCycles", "lookupCycles", "selfTouchCheckCycles", "spliceCycles", "borderUpdateCycles", "chainCycles" };
+
+    void writeCsvRow(std::ofstream& out, const uint iteration, const std::string& chain, const NoiseCounters& counters) {
+        out << iteration << "," << chain;
+        for (const u64 count : counters.counts) {
+            out << "," << count;
+        }
+        for (const u64 cycles : counters.cycles) {
+            out << "," << cycles;
+        }
+        out << "\n";
+    }
+
+    void writeJsonCounters(std::ofstream& out, const NoiseCounters& counters) {
+        out << "{";
+        for (size_t i = 0; i < counters.counts.size(); i++) {
+            out << (i == 0 ? " \"" : ", \"") << COUNTER_NAMES[i] << "\": " << counters.counts[i];
+        }
+        for (size_t i = 0; i < counters.cycles.size(); i++) {
+            out << ", \"" << PHASE_NAMES[i] << "\": " << counters.cycles[i];
+        }
+        out << " }";
+    }
+}
+
+
+
+void NoiseCounters::add(const NoiseCounters& counters) {
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i] += counters.counts[i];
+    }
+    for (size_t i = 0; i < cycles.size(); i++) {
+        cycles[i] += counters.cycles[i];
+    }
+}
+
+double NoiseInstrumentation::cyclesPerSecond() const {
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+    return seconds > 0.0 ? (cycles() - m_StartCycles) / seconds : 0.0;
+}
+
+void NoiseInstrumentation::writeCsv(const std::string& file) const {
+    std::ofstream out(file, std::ios_base::trunc);
+    out << "iteration,chain";
+    for (const char* name : COUNTER_NAMES) {
+        out << "," << name;
+    }
+    for (const char* name : PHASE_NAMES) {
+        out << "," << name;
+    }
+    out << "\n";
+
+    // Rows of an iteration are followed by their total.
+    for (size_t i = 0; i < m_Rows.size();) {
+        const uint iteration = m_Rows[i].iteration;
+        NoiseCounters total;
+        for (; i < m_Rows.size() && m_Rows[i].iteration == iteration; i++) {
+            writeCsvRow(out, iteration, std::to_string(m_Rows[i].chain), m_Rows[i].counters);
+            total.add(m_Rows[i].counters);
+        }
+        writeCsvRow(out, iteration, "all", total);
+    }
+}
+
+void NoiseInstrumentation::writeJson(const std::string& file) const {
+    std::ofstream out(file, std::ios_base::trunc);
+    out << "{\n  \"enabled\": " << (enabled() ? "true" : "false") << ",\n  \"cyclesPerSecond\": " << std::fixed << std::setprecision(0) << cyclesPerSecond()
+        << std::defaultfloat << ",\n  \"iterations\": [";
+
+    for (size_t i = 0; i < m_Rows.size();) {
+        const uint iteration = m_Rows[i].iteration;
+        const size_t first = i;
+        NoiseCounters total;
+        for (; i < m_Rows.size() && m_Rows[i].iteration == iteration; i++) {
+            total.add(m_Rows[i].counters);
+        }
+
+        out << (first == 0 ? "\n" : ",\n") << "    { \"iteration\": " << iteration << ", \"total\": ";
+        writeJsonCounters(out, total);
+        out << ",\n      \"chains\": [";
+        for (size_t j = first; j < i; j++) {
+            out << (j == first ? "\n" : ",\n") << "        { \"chain\": " << m_Rows[j].chain << ", \"counters\": ";
+            writeJsonCounters(out, m_Rows[j].counters);
+            out << " }";
+        }
+        out << "\n      ] }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+
+
+NoiseInstrumentation::NoiseInstrumentation(const uint firstIteration) : m_Iteration(firstIteration + 1), m_StartCycles(cycles()), m_Start(std::chrono::steady_clock::now()) {
+    // Counters of previous runs (or of the benchmark) on this thread are discarded.
+    local() = NoiseCounters();
+}
+
+void NoiseInstrumentation::recordChain(const uint chain) {
+    m_Rows.push_back({ m_Iteration, chain, local() });
+    local() = NoiseCounters();
+}
+
+void NoiseInstrumentation::endIteration() {
+    m_Iteration++;
+}
+
+void NoiseInstrumentation::write(const std::string& file) const {
+    const std::string extension = ".json";
+    if (file.size() >= extension.size() && file.compare(file.size() - extension.size(), extension.size(), extension) == 0) {
+        writeJson(file);
+    }
+    else {
+        writeCsv(file);
+    }
+}
+
+bool NoiseInstrumentation::enabled() {
+#ifdef CHAINCODE_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
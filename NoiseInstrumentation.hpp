@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Constants.hpp"
+
+
+// Hot-path instrumentation of the noise procedures. The counters and phase timers are only compiled in when
+// CHAINCODE_INSTRUMENTATION is defined (e.g. in the preprocessor definitions of the project); otherwise the
+// macros expand to nothing and the noise procedures are unchanged.
+#ifdef CHAINCODE_INSTRUMENTATION
+#define NOISE_COUNT(counter) (NoiseInstrumentation::local().counts[static_cast<size_t>(NoiseCounter::counter)]++)
+#define NOISE_PHASE_BEGIN(phase) const u64 noisePhaseStart_##phase = NoiseInstrumentation::cycles()
+#define NOISE_PHASE_END(phase) (NoiseInstrumentation::local().cycles[static_cast<size_t>(NoisePhase::phase)] += NoiseInstrumentation::cycles() - noisePhaseStart_##phase)
+#else
+#define NOISE_COUNT(counter) ((void)0)
+#define NOISE_PHASE_BEGIN(phase) ((void)0)
+#define NOISE_PHASE_END(phase) ((void)0)
+#endif
+
+
+/// <summary>
+/// Events counted by the noise procedures.
+/// </summary>
+enum class NoiseCounter {
+    commands,             // Commands visited.
+    candidates,           // Commands sampled for a replacement.
+    emptyReplacements,    // Candidates without a replacement in the table.
+    selfTouchRejections,  // Replacements rejected by the self-touching check.
+    accepted,             // Replacements applied.
+    selfTouchProbes,      // Lookups of the border pixels made by the self-touching checks.
+    count
+};
+
+
+/// <summary>
+/// Timed phases of the noise procedures (chain is the whole procedure, including the untimed remainder).
+/// </summary>
+enum class NoisePhase {
+    sampling,        // Random number compared with the noise probability.
+    lookup,          // Choice of the table and lookup of the replacement.
+    selfTouchCheck,  // Self-touching check of the replacement.
+    splice,          // Replacement of the commands in the chain code (with the journal record).
+    borderUpdate,    // Update of the border pixels (with the statistics and the monitor).
+    chain,           // Noise procedure of the whole chain code.
+    count
+};
+
+
+/// <summary>
+/// Counters and phase cycles of a thread (or of a chain code, once they are recorded).
+/// </summary>
+struct NoiseCounters {
+    std::array<u64, static_cast<size_t>(NoiseCounter::count)> counts{};
+    std::array<u64, static_cast<size_t>(NoisePhase::count)> cycles{};
+
+    /// <summary>
+    /// Adding the counters of another chain code.
+    /// </summary>
+    /// <param name="counters">: added counters</param>
+    void add(const NoiseCounters& counters);
+};
+
+
+/// <summary>
+/// Counters of a chain code in an iteration.
+/// </summary>
+struct NoiseInstrumentationRow {
+    uint iteration = 0;       // Index of the iteration (1 - first iteration).
+    uint chain = 0;           // Index of the chain code.
+    NoiseCounters counters;   // Counters of the chain code.
+};
+
+
+
+/// <summary>
+/// Recorder of the counters of a noise run. The noise procedures update the counters of their thread, which are
+/// moved into the recorder after each chain code, so threads never share counters. The rows are aggregated per
+/// iteration when they are written.
+/// </summary>
+class NoiseInstrumentation {
+private:
+    std::vector<NoiseInstrumentationRow> m_Rows;   // Counters of each chain code in each iteration.
+    uint m_Iteration;                              // Index of the current iteration.
+    u64 m_StartCycles;                             // Timestamp counter at the start of the run.
+    std::chrono::steady_clock::time_point m_Start; // Time at the start of the run (calibration of the cycles).
+
+    /// <summary>
+    /// Estimated frequency of the timestamp counter, measured over the run.
+    /// </summary>
+    /// <returns>Cycles per second</returns>
+    double cyclesPerSecond() const;
+
+    /// <summary>
+    /// Writing the rows as a CSV table (iteration totals have the chain "all").
+    /// </summary>
+    /// <param name="file">: path to the output file</param>
+    void writeCsv(const std::string& file) const;
+
+    /// <summary>
+    /// Writing the rows as a JSON document (iterations with their totals and chain codes).
+    /// </summary>
+    /// <param name="file">: path to the output file</param>
+    void writeJson(const std::string& file) const;
+
+public:
+    /// <summary>
+    /// Constructor of NoiseInstrumentation (counters of the current thread are reset).
+    /// </summary>
+    /// <param name="firstIteration">: index of the first recorded iteration (0 - start of the run)</param>
+    NoiseInstrumentation(const uint firstIteration = 0);
+
+    /// <summary>
+    /// Moving the counters of the current thread into the row of a chain code.
+    /// </summary>
+    /// <param name="chain">: index of the chain code</param>
+    void recordChain(const uint chain);
+
+    /// <summary>
+    /// Finishing the current iteration.
+    /// </summary>
+    void endIteration();
+
+    /// <summary>
+    /// Writing the recorded counters. Files ending with .json are written as JSON, other files as CSV.
+    /// </summary>
+    /// <param name="file">: path to the output file</param>
+    void write(const std::string& file) const;
+
+    /// <summary>
+    /// Counters of the current thread.
+    /// </summary>
+    /// <returns>Counters</returns>
+    static NoiseCounters& local();
+
+    /// <summary>
+    /// Current value of the timestamp counter (steady clock in nanoseconds where it is not available).
+    /// </summary>
+    /// <returns>Cycles</returns>
+    static u64 cycles();
+
+    /// <summary>
+    /// True if the counters are compiled in (CHAINCODE_INSTRUMENTATION is defined).
+    /// </summary>
+    static bool enabled();
+};
+
+
+
+inline NoiseCounters& NoiseInstrumentation::local() {
+    thread_local NoiseCounters counters;
+    return counters;
+}
+
+inline u64 NoiseInstrumentation::cycles() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
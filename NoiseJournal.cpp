@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#include "BinaryFormat.hpp"
+#include "NoiseJournal.hpp"
+
+
+namespace {
+    constexpr char MAGIC[4] = { 'C', 'C', 'N', 'J' };
+    constexpr unsigned char VERSION = 1;
+    constexpr unsigned char KEYFRAME = 'K';
+    constexpr unsigned char ITERATION = 'I';
+
+    /// <summary>
+    /// Index of a window of commands (first command is the most significant digit).
+    /// </summary>
+    uint windowIndex(const short* window, const uint windowSize, const uint alphabet) {
+        uint index = 0;
+        for (uint i = 0; i < windowSize; i++) {
+            index = index * alphabet + static_cast<uint>(window[i]);
+        }
+        return index;
+    }
+}
+
+
+
+NoiseJournalWriter::NoiseJournalWriter(const std::string& file, const std::vector<ChainCode>& chainCodes, const uint windowSize, const uint keyframeInterval) :
+    m_Out(file, std::ios_base::binary | std::ios_base::trunc),
+    m_Type(chainCodes.empty() ? ChainCodeType::F8 : chainCodes[0].type),
+    m_WindowSize(windowSize),
+    m_KeyframeInterval(std::max(keyframeInterval, 1u))
+{
+    if (!m_Out) {
+        throw std::logic_error("Noise journal cannot be created.");
+    }
+
+    // Header.
+    std::vector<unsigned char> header(MAGIC, MAGIC + 4);
+    header.push_back(VERSION);
+    header.push_back(static_cast<unsigned char>(m_Type));
+    header.push_back(static_cast<unsigned char>(m_WindowSize));
+    BinaryFormat::writeVarint(header, m_KeyframeInterval);
+    BinaryFormat::writeVarint(header, chainCodes.size());
+    for (const ChainCode& chainCode : chainCodes) {
+        BinaryFormat::writeSignedVarint(header, chainCode.startX);
+        BinaryFormat::writeSignedVarint(header, chainCode.startY);
+        BinaryFormat::writeSignedVarint(header, chainCode.initialDirection);
+    }
+    m_Out.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    writeKeyframe(chainCodes);
+    m_Out.flush();
+}
+
+NoiseJournalWriter::NoiseJournalWriter(const std::string& file, const ChainCodeType& type, const uint windowSize, const uint keyframeInterval, const uint iteration, const u64 size) :
+    m_Type(type),
+    m_WindowSize(windowSize),
+    m_KeyframeInterval(std::max(keyframeInterval, 1u)),
+    m_Iteration(iteration)
+{
+    std::filesystem::resize_file(file, size);
+    m_Out.open(file, std::ios_base::binary | std::ios_base::app);
+    if (!m_Out) {
+        throw std::logic_error("Noise journal cannot be opened.");
+    }
+}
+
+void NoiseJournalWriter::flushChain() {
+    if (m_EventCount == 0) {
+        return;
+    }
+
+    // Chain codes are processed in order, so the gap from the previous one is stored.
+    BinaryFormat::writeVarint(m_Record, static_cast<u64>(m_Chain - m_LastChain - 1));
+    BinaryFormat::writeVarint(m_Record, m_EventCount);
+    m_Record.insert(m_Record.end(), m_Events.begin(), m_Events.end());
+
+    m_LastChain = m_Chain;
+    m_Events.clear();
+    m_EventCount = 0;
+}
+
+void NoiseJournalWriter::writeKeyframe(const std::vector<ChainCode>& chainCodes) {
+    std::vector<unsigned char> payload;
+    for (const ChainCode& chainCode : chainCodes) {
+        BinaryFormat::writeCommands(payload, m_Type, chainCode.code);
+    }
+
+    std::vector<unsigned char> header({ KEYFRAME });
+    BinaryFormat::writeVarint(header, m_Iteration);
+    BinaryFormat::writeVarint(header, payload.size());
+    m_Out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    m_Out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+}
+
+void NoiseJournalWriter::beginChain(const uint index) {
+    flushChain();
+    m_Chain = static_cast<int>(index);
+    m_LastPosition = 0;
+}
+
+void NoiseJournalWriter::recordReplacement(const uint position, const bool firstTable, const short* window) {
+    // Positions grow within a pass over the chain code, so only the difference is stored.
+    BinaryFormat::writeVarint(m_Events, (static_cast<u64>(position - m_LastPosition) << 1) | (firstTable ? 0 : 1));
+    BinaryFormat::writeVarint(m_Events, windowIndex(window, m_WindowSize, ChainCodeFunctions::alphabetSize(m_Type)));
+
+    m_LastPosition = position;
+    m_EventCount++;
+}
+
+void NoiseJournalWriter::endIteration(const std::vector<ChainCode>& chainCodes) {
+    flushChain();
+    m_Iteration++;
+
+    std::vector<unsigned char> header({ ITERATION });
+    BinaryFormat::writeVarint(header, m_Iteration);
+    BinaryFormat::writeVarint(header, m_Record.size());
+    m_Out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    m_Out.write(reinterpret_cast<const char*>(m_Record.data()), m_Record.size());
+
+    if (m_Iteration % m_KeyframeInterval == 0) {
+        writeKeyframe(chainCodes);
+    }
+    m_Out.flush();
+
+    m_Record.clear();
+    m_Chain = -1;
+    m_LastChain = -1;
+}
+
+u64 NoiseJournalWriter::size() {
+    return static_cast<u64>(m_Out.tellp());
+}
+
+
+
+std::vector<ChainCode> NoiseJournal::readKeyframe(const size_t offset) const {
+    BinaryFormat::ByteReader reader(m_File->data(), m_File->size(), offset);
+
+    std::vector<ChainCode> chainCodes = m_Chains;
+    for (ChainCode& chainCode : chainCodes) {
+        chainCode.code = reader.commands(m_Type);
+    }
+
+    return chainCodes;
+}
+
+void NoiseJournal::replayIteration(const uint iteration, std::vector<ChainCode>& chainCodes) const {
+    const auto [begin, end] = m_Iterations[iteration];
+    BinaryFormat::ByteReader reader(m_File->data(), end, begin);
+    const uint alphabet = ChainCodeFunctions::alphabetSize(m_Type);
+
+    int chain = -1;
+    std::vector<short> output;
+    while (!reader.atEnd()) {
+        chain += static_cast<int>(reader.varint()) + 1;
+        const u64 eventCount = reader.varint();
+        if (chain >= static_cast<int>(chainCodes.size())) {
+            throw std::logic_error("Invalid chain code index in the noise journal.");
+        }
+
+        // Replacements are applied in a single pass: positions refer to the chain code that already
+        // contains the preceding replacements, which is the output followed by the rest of the input.
+        const std::vector<short>& input = chainCodes[chain].code;
+        output.clear();
+        output.reserve(input.size() + input.size() / 4);
+        size_t source = 0;
+        size_t position = 0;
+
+        for (u64 event = 0; event < eventCount; event++) {
+            const u64 value = reader.varint();
+            const uint window = static_cast<uint>(reader.varint());
+            const bool firstTable = (value & 1) == 0;
+            position += value >> 1;
+
+            if (position < output.size() || position - output.size() + m_WindowSize > input.size() - source) {
+                throw std::logic_error("Invalid replacement position in the noise journal.");
+            }
+            const size_t copied = position - output.size();
+            output.insert(output.end(), input.begin() + source, input.begin() + source + copied);
+            source += copied;
+
+            const short* replaced = &input[source];
+            if (windowIndex(replaced, m_WindowSize, alphabet) != window) {
+                throw std::logic_error("Noise journal does not match the chain code.");
+            }
+
+            if (m_WindowSize == 2) {
+                const std::vector<short> replacement = m_LUT.findReplacement(m_Type, firstTable, replaced[0], replaced[1]);
+                output.insert(output.end(), replacement.begin(), replacement.end());
+            }
+            else {
+                const KGramReplacement& replacement = m_LUT.findReplacement(m_Type, firstTable, replaced, m_WindowSize);
+                output.insert(output.end(), replacement.code, replacement.code + replacement.length);
+            }
+            source += m_WindowSize;
+        }
+
+        output.insert(output.end(), input.begin() + source, input.end());
+        chainCodes[chain].code.swap(output);
+    }
+}
+
+
+
+NoiseJournal::NoiseJournal(const std::string& file) :
+    m_File(std::make_unique<MappedFile>(file))
+{
+    BinaryFormat::ByteReader reader(m_File->data(), m_File->size());
+
+    // Header.
+    const unsigned char* magic = reader.bytes(4);
+    if (!std::equal(magic, magic + 4, MAGIC) || reader.byte() != VERSION) {
+        throw std::logic_error("File is not a noise journal.");
+    }
+    m_Type = static_cast<ChainCodeType>(reader.byte());
+    m_WindowSize = reader.byte();
+    reader.varint();  // Keyframe interval (informative).
+
+    const u64 chainCount = reader.varint();
+    for (u64 i = 0; i < chainCount; i++) {
+        const int startX = static_cast<int>(reader.signedVarint());
+        const int startY = static_cast<int>(reader.signedVarint());
+        const short initialDirection = static_cast<short>(reader.signedVarint());
+        m_Chains.emplace_back("", m_Type, startX, startY, initialDirection);
+    }
+
+    // Indexing the records. An incomplete record at the end (interrupted run) is ignored.
+    m_Iterations.push_back({ 0, 0 });
+    while (!reader.atEnd()) {
+        try {
+            const unsigned char tag = reader.byte();
+            const uint iteration = static_cast<uint>(reader.varint());
+            const size_t size = reader.varint();
+            const size_t begin = reader.position();
+            reader.bytes(size);
+
+            if (tag == KEYFRAME) {
+                m_Keyframes.push_back({ iteration, begin });
+            }
+            else if (tag == ITERATION && iteration == m_Iterations.size()) {
+                m_Iterations.push_back({ begin, begin + size });
+            }
+            else {
+                throw std::logic_error("Invalid record in the noise journal.");
+            }
+        }
+        catch (const std::logic_error&) {
+            if (m_Keyframes.empty()) {
+                throw;
+            }
+            break;
+        }
+    }
+
+    if (m_Keyframes.empty() || m_Keyframes[0].first != 0) {
+        throw std::logic_error("Noise journal does not contain the initial keyframe.");
+    }
+}
+
+uint NoiseJournal::iterationCount() const {
+    return static_cast<uint>(m_Iterations.size() - 1);
+}
+
+std::vector<ChainCode> NoiseJournal::reconstruct(const uint iteration) const {
+    if (iteration > iterationCount()) {
+        throw std::logic_error("Iteration is not stored in the noise journal.");
+    }
+
+    // Nearest keyframe at or before the iteration.
+    const auto keyframe = std::prev(std::upper_bound(m_Keyframes.begin(), m_Keyframes.end(), iteration, [](const uint value, const std::pair<uint, size_t>& entry) {
+        return value < entry.first;
+    }));
+
+    std::vector<ChainCode> chainCodes = readKeyframe(keyframe->second);
+    for (uint i = keyframe->first + 1; i <= iteration; i++) {
+        replayIteration(i, chainCodes);
+    }
+
+    return chainCodes;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "ChainCodeReplacementLUT.hpp"
+#include "Constants.hpp"
+#include "MappedFile.hpp"
+
+
+/// <summary>
+/// Append-only binary journal of the accepted replacements of a noise run.
+///
+/// The file starts with a header (chain code type, replacement window size, keyframe interval,
+/// start coordinates of each chain code), followed by records:
+///  - keyframe ('K'): full chain codes after the given iteration (commands packed into bits),
+///  - iteration ('I'): replacements of one iteration, grouped by chain code; each replacement is
+///    stored as varints of the position delta with the table choice and of the replaced window.
+/// Every record stores its payload size, so the reader indexes the file without decoding it.
+/// </summary>
+class NoiseJournalWriter {
+private:
+    std::ofstream m_Out;                     // Output file.
+    ChainCodeType m_Type;                    // Type of the chain codes.
+    uint m_WindowSize;                       // Number of commands replaced at once.
+    uint m_KeyframeInterval;                 // Number of iterations between keyframes.
+    uint m_Iteration = 0;                    // Number of finished iterations.
+    std::vector<unsigned char> m_Record;     // Payload of the current iteration record.
+    std::vector<unsigned char> m_Events;     // Encoded replacements of the current chain code.
+    uint m_EventCount = 0;                   // Number of replacements of the current chain code.
+    int m_Chain = -1;                        // Index of the current chain code.
+    int m_LastChain = -1;                    // Index of the last chain code written to the record.
+    uint m_LastPosition = 0;                 // Position of the last replacement in the current chain code.
+
+    /// <summary>
+    /// Moving the replacements of the current chain code into the iteration record.
+    /// </summary>
+    void flushChain();
+
+    /// <summary>
+    /// Writing a keyframe with the given chain codes.
+    /// </summary>
+    /// <param name="chainCodes">: chain codes after the current iteration</param>
+    void writeKeyframe(const std::vector<ChainCode>& chainCodes);
+
+public:
+    /// <summary>
+    /// Creating the journal and writing its header and the initial keyframe.
+    /// </summary>
+    /// <param name="file">: path to the journal file</param>
+    /// <param name="chainCodes">: chain codes before the first iteration</param>
+    /// <param name="windowSize">: number of commands replaced at once (2 - pair tables, 3 or 4 - k-gram tables)</param>
+    /// <param name="keyframeInterval">: number of iterations between keyframes</param>
+    NoiseJournalWriter(const std::string& file, const std::vector<ChainCode>& chainCodes, const uint windowSize, const uint keyframeInterval = 50);
+
+    /// <summary>
+    /// Reopening the journal of an interrupted run (records written after the given size are discarded).
+    /// </summary>
+    /// <param name="file">: path to the journal file</param>
+    /// <param name="type">: type of the chain codes</param>
+    /// <param name="windowSize">: number of commands replaced at once</param>
+    /// <param name="keyframeInterval">: number of iterations between keyframes</param>
+    /// <param name="iteration">: number of finished iterations</param>
+    /// <param name="size">: size of the journal after the last finished iteration</param>
+    NoiseJournalWriter(const std::string& file, const ChainCodeType& type, const uint windowSize, const uint keyframeInterval, const uint iteration, const u64 size);
+
+    /// <summary>
+    /// Setting the chain code that receives the following replacements.
+    /// </summary>
+    /// <param name="index">: index of the chain code</param>
+    void beginChain(const uint index);
+
+    /// <summary>
+    /// Recording an accepted replacement (before it is applied to the chain code).
+    /// </summary>
+    /// <param name="position">: index of the first replaced command</param>
+    /// <param name="firstTable">: true if the replacement comes from the first table</param>
+    /// <param name="window">: pointer to the replaced commands</param>
+    void recordReplacement(const uint position, const bool firstTable, const short* window);
+
+    /// <summary>
+    /// Finishing an iteration (the record is written and flushed, followed by a keyframe if it is due).
+    /// </summary>
+    /// <param name="chainCodes">: chain codes after the iteration</param>
+    void endIteration(const std::vector<ChainCode>& chainCodes);
+
+    /// <summary>
+    /// Size of the written journal.
+    /// </summary>
+    /// <returns>Size in bytes</returns>
+    u64 size();
+};
+
+
+
+/// <summary>
+/// Reader of a noise journal that reconstructs the chain codes after any iteration.
+/// </summary>
+class NoiseJournal {
+private:
+    std::unique_ptr<MappedFile> m_File;         // Mapped journal file.
+    ChainCodeType m_Type;                       // Type of the chain codes.
+    uint m_WindowSize;                          // Number of commands replaced at once.
+    std::vector<ChainCode> m_Chains;            // Chain codes without commands (start coordinates).
+    std::vector<std::pair<size_t, size_t>> m_Iterations;  // Payload range of each iteration record (index 0 is unused).
+    std::vector<std::pair<uint, size_t>> m_Keyframes;  // Iteration and payload offset of each keyframe.
+    mutable ChainCodeReplacementLUT m_LUT;      // Replacement tables.
+
+    /// <summary>
+    /// Decoding the chain codes stored in a keyframe.
+    /// </summary>
+    /// <param name="offset">: payload offset of the keyframe</param>
+    /// <returns>Chain codes</returns>
+    std::vector<ChainCode> readKeyframe(const size_t offset) const;
+
+    /// <summary>
+    /// Applying the replacements of an iteration to the chain codes.
+    /// </summary>
+    /// <param name="iteration">: index of the iteration</param>
+    /// <param name="chainCodes">: chain codes before the iteration</param>
+    void replayIteration(const uint iteration, std::vector<ChainCode>& chainCodes) const;
+
+public:
+    /// <summary>
+    /// Opening the journal and indexing its records.
+    /// </summary>
+    /// <param name="file">: path to the journal file</param>
+    NoiseJournal(const std::string& file);
+
+    /// <summary>
+    /// Number of iterations stored in the journal.
+    /// </summary>
+    /// <returns>Number of iterations</returns>
+    uint iterationCount() const;
+
+    /// <summary>
+    /// Reconstruction of the chain codes after the given iteration (from the nearest preceding keyframe).
+    /// </summary>
+    /// <param name="iteration">: index of the iteration (0 - original chain codes)</param>
+    /// <returns>Chain codes</returns>
+    std::vector<ChainCode> reconstruct(const uint iteration) const;
+};
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "MappedFile.hpp"
+#include "NoiseMetricsStore.hpp"
+
+
+namespace {
+    constexpr char MAGIC[4] = { 'C', 'C', 'M', 'T' };
+    constexpr unsigned char VERSION = 1;
+    constexpr size_t HEADER_SIZE = 8;        // Magic, version, padding.
+    constexpr size_t BLOCK_HEADER_SIZE = 16;  // Rows, new shape names, new metric names, zero.
+
+    template <typename T>
+    void writeColumn(std::ofstream& out, const std::vector<T>& column) {
+        out.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+    }
+
+    void writeNames(std::ofstream& out, const std::vector<std::string>& names) {
+        for (const std::string& name : names) {
+            const uint32_t length = static_cast<uint32_t>(name.size());
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(name.data(), name.size());
+        }
+    }
+
+
+    /// <summary>
+    /// Reader of the mapped metrics file.
+    /// </summary>
+    struct BlockReader {
+        const unsigned char* data;
+        size_t size;
+        size_t position;
+
+        void require(const size_t bytes) const {
+            if (bytes > size - position) {
+                throw std::logic_error("Metrics file is truncated.");
+            }
+        }
+
+        uint32_t readUint() {
+            uint32_t value;
+            require(sizeof(value));
+            std::memcpy(&value, data + position, sizeof(value));
+            position += sizeof(value);
+            return value;
+        }
+
+        void readNames(std::vector<std::string>& names, const uint32_t count) {
+            for (uint32_t i = 0; i < count; i++) {
+                const uint32_t length = readUint();
+                require(length);
+                names.emplace_back(reinterpret_cast<const char*>(data + position), length);
+                position += length;
+            }
+        }
+
+        template <typename T>
+        void readColumn(std::vector<T>& column, const size_t rows) {
+            require(rows * sizeof(T));
+            const size_t offset = column.size();
+            column.resize(offset + rows);
+            std::memcpy(column.data() + offset, data + position, rows * sizeof(T));
+            position += rows * sizeof(T);
+        }
+    };
+}
+
+
+
+size_t NoiseMetricsTable::size() const {
+    return runs.size();
+}
+
+void NoiseMetricsTable::clearRows() {
+    runs.clear();
+    shapes.clear();
+    probabilities.clear();
+    iterations.clear();
+    metrics.clear();
+    values.clear();
+}
+
+
+
+uint NoiseMetricsStore::nameIndex(std::unordered_map<std::string, uint>& indices, std::vector<std::string>& blockNames, const std::string& name) {
+    const auto found = indices.find(name);
+    if (found != indices.end()) {
+        return found->second;
+    }
+
+    const uint index = static_cast<uint>(indices.size());
+    indices.emplace(name, index);
+    blockNames.push_back(name);
+    return index;
+}
+
+void NoiseMetricsStore::writeBlock() {
+    if (m_Block.size() == 0 && m_Block.shapeNames.empty() && m_Block.metricNames.empty()) {
+        return;
+    }
+
+    const uint32_t header[4] = { static_cast<uint32_t>(m_Block.size()), static_cast<uint32_t>(m_Block.shapeNames.size()), static_cast<uint32_t>(m_Block.metricNames.size()), 0 };
+    m_Out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    writeNames(m_Out, m_Block.shapeNames);
+    writeNames(m_Out, m_Block.metricNames);
+    writeColumn(m_Out, m_Block.runs);
+    writeColumn(m_Out, m_Block.shapes);
+    writeColumn(m_Out, m_Block.probabilities);
+    writeColumn(m_Out, m_Block.iterations);
+    writeColumn(m_Out, m_Block.metrics);
+    writeColumn(m_Out, m_Block.values);
+    m_Out.flush();
+    if (!m_Out) {
+        throw std::logic_error("Metrics file " + m_File + " could not be written.");
+    }
+
+    m_Block.clearRows();
+    m_Block.shapeNames.clear();
+    m_Block.metricNames.clear();
+}
+
+NoiseMetricsStore::NoiseMetricsStore(const std::string& file, const size_t blockRows) :
+    m_File(file),
+    m_BlockRows(std::max<size_t>(blockRows, 1)),
+    m_Out(file, std::ios::binary | std::ios::trunc)
+{
+    if (!m_Out) {
+        throw std::logic_error("Metrics file " + file + " could not be created.");
+    }
+
+    const unsigned char header[HEADER_SIZE] = { MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3], VERSION, 0, 0, 0 };
+    m_Out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    m_Block.runs.reserve(m_BlockRows);
+    m_Block.shapes.reserve(m_BlockRows);
+    m_Block.probabilities.reserve(m_BlockRows);
+    m_Block.iterations.reserve(m_BlockRows);
+    m_Block.metrics.reserve(m_BlockRows);
+    m_Block.values.reserve(m_BlockRows);
+}
+
+NoiseMetricsStore::~NoiseMetricsStore() {
+    // Destructors do not throw; rows that cannot be written are lost (flush reports the failure).
+    try {
+        writeBlock();
+    }
+    catch (const std::exception&) {
+    }
+}
+
+uint NoiseMetricsStore::beginRun() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Runs++;
+}
+
+void NoiseMetricsStore::append(const uint run, const std::string& shape, const double probability, const uint iteration, const std::string& metric, const double value) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Block.runs.push_back(run);
+    m_Block.shapes.push_back(nameIndex(m_Shapes, m_Block.shapeNames, shape));
+    m_Block.probabilities.push_back(probability);
+    m_Block.iterations.push_back(iteration);
+    m_Block.metrics.push_back(nameIndex(m_Metrics, m_Block.metricNames, metric));
+    m_Block.values.push_back(value);
+    m_Rows++;
+
+    if (m_Block.size() >= m_BlockRows) {
+        writeBlock();
+    }
+}
+
+void NoiseMetricsStore::flush() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    writeBlock();
+}
+
+u64 NoiseMetricsStore::rowCount() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Rows;
+}
+
+NoiseMetricsTable NoiseMetricsStore::load(const std::string& file) {
+    const MappedFile mapped(file);
+    if (mapped.size() < HEADER_SIZE || !std::equal(mapped.data(), mapped.data() + 4, MAGIC) || mapped.data()[4] != VERSION) {
+        throw std::logic_error("File is not a noise metrics file.");
+    }
+
+    NoiseMetricsTable table;
+    BlockReader reader = { mapped.data(), mapped.size(), HEADER_SIZE };
+    while (reader.position < reader.size) {
+        reader.require(BLOCK_HEADER_SIZE);
+        const uint32_t rows = reader.readUint();
+        const uint32_t shapeNames = reader.readUint();
+        const uint32_t metricNames = reader.readUint();
+        reader.readUint();
+
+        reader.readNames(table.shapeNames, shapeNames);
+        reader.readNames(table.metricNames, metricNames);
+        reader.readColumn(table.runs, rows);
+        reader.readColumn(table.shapes, rows);
+        reader.readColumn(table.probabilities, rows);
+        reader.readColumn(table.iterations, rows);
+        reader.readColumn(table.metrics, rows);
+        reader.readColumn(table.values, rows);
+    }
+
+    return table;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Constants.hpp"
+
+
+/// <summary>
+/// Columns of metric rows (one entry per row in each column). Shapes and metrics are indices of their names.
+/// </summary>
+struct NoiseMetricsTable {
+    std::vector<uint> runs;              // Id of the run within the file.
+    std::vector<uint> shapes;            // Index of the shape name.
+    std::vector<double> probabilities;   // Probability of the noise of the run.
+    std::vector<uint> iterations;        // Number of finished iterations.
+    std::vector<uint> metrics;           // Index of the metric name.
+    std::vector<double> values;          // Value of the metric.
+    std::vector<std::string> shapeNames;
+    std::vector<std::string> metricNames;
+
+    /// <summary>
+    /// Number of rows.
+    /// </summary>
+    size_t size() const;
+
+    /// <summary>
+    /// Removing all rows (the names are kept).
+    /// </summary>
+    void clearRows();
+};
+
+
+
+/// <summary>
+/// Buffered sink of per-iteration metrics shared by the runs of a sweep. Rows are kept in memory as columns and
+/// written in blocks into one binary file, which replaces a CSV file per shape and probability that was reopened
+/// for every value.
+///
+/// File: magic "CCMT", version (1 byte), 3 bytes of padding, then blocks until the end of the file. A block is
+/// a header of 4 uint32 (rows, new shape names, new metric names, zero), the new names (uint32 length and the
+/// bytes each; indices continue those of the previous blocks) and the columns in the order of NoiseMetricsTable:
+/// uint32 runs, uint32 shapes, float64 probabilities, uint32 iterations, uint32 metrics and float64 values, each
+/// a contiguous little-endian array of all rows of the block. A reader copies every column of a block at once.
+/// </summary>
+class NoiseMetricsStore {
+private:
+    std::string m_File;
+    size_t m_BlockRows;                                // Number of buffered rows written as one block.
+    std::ofstream m_Out;
+    NoiseMetricsTable m_Block;                         // Rows and names that were not written yet.
+    std::unordered_map<std::string, uint> m_Shapes;    // Indices of all shape names.
+    std::unordered_map<std::string, uint> m_Metrics;   // Indices of all metric names.
+    uint m_Runs = 0;
+    u64 m_Rows = 0;
+    std::mutex m_Mutex;                                // Runs of a sweep may append from several threads.
+
+    /// <summary>
+    /// Index of a name, added to the names of the block if it is new.
+    /// </summary>
+    /// <param name="indices">: indices of all names</param>
+    /// <param name="blockNames">: new names of the block</param>
+    /// <param name="name">: name</param>
+    /// <returns>Index of the name</returns>
+    static uint nameIndex(std::unordered_map<std::string, uint>& indices, std::vector<std::string>& blockNames, const std::string& name);
+
+    /// <summary>
+    /// Writing the buffered rows as one block (without locking).
+    /// </summary>
+    void writeBlock();
+
+public:
+    /// <summary>
+    /// Creating the metrics file (an existing file is replaced).
+    /// </summary>
+    /// <param name="file">: path to the metrics file</param>
+    /// <param name="blockRows">: number of rows buffered before a block is written</param>
+    NoiseMetricsStore(const std::string& file, const size_t blockRows = 65536);
+
+    NoiseMetricsStore(const NoiseMetricsStore&) = delete;
+    NoiseMetricsStore& operator=(const NoiseMetricsStore&) = delete;
+
+    /// <summary>
+    /// Destructor that writes the buffered rows.
+    /// </summary>
+    ~NoiseMetricsStore();
+
+    /// <summary>
+    /// Starting a run.
+    /// </summary>
+    /// <returns>Id of the run</returns>
+    uint beginRun();
+
+    /// <summary>
+    /// Adding a row (written with the next block).
+    /// </summary>
+    /// <param name="run">: id of the run</param>
+    /// <param name="shape">: name of the shape</param>
+    /// <param name="probability">: probability of the noise</param>
+    /// <param name="iteration">: number of finished iterations</param>
+    /// <param name="metric">: name of the metric</param>
+    /// <param name="value">: value of the metric</param>
+    void append(const uint run, const std::string& shape, const double probability, const uint iteration, const std::string& metric, const double value);
+
+    /// <summary>
+    /// Writing the buffered rows.
+    /// </summary>
+    void flush();
+
+    /// <summary>
+    /// Number of rows appended so far.
+    /// </summary>
+    u64 rowCount();
+
+    /// <summary>
+    /// Reading a metrics file.
+    /// </summary>
+    /// <param name="file">: path to the metrics file</param>
+    /// <returns>All rows and names</returns>
+    static NoiseMetricsTable load(const std::string& file);
+};
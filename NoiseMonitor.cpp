@@ -0,0 +1,70 @@
+#include "NoiseMonitor.hpp"
+
+
+NoiseMonitor::NoiseMonitor(const std::function<void()>& listener, const double notificationInterval, const bool recordChanges) :
+    m_Listener(listener),
+    m_Interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(notificationInterval))),
+    m_RecordChanges(recordChanges)
+{}
+
+void NoiseMonitor::cancel() {
+    m_Cancelled = true;
+}
+
+bool NoiseMonitor::isCancelled() const {
+    return m_Cancelled;
+}
+
+void NoiseMonitor::addPixel(const Pixel& pixel) {
+    if (m_RecordChanges) {
+        m_Pending.push_back({ pixel, true });
+    }
+}
+
+void NoiseMonitor::removePixel(const Pixel& pixel) {
+    if (m_RecordChanges) {
+        m_Pending.push_back({ pixel, false });
+    }
+}
+
+void NoiseMonitor::publish(const NoiseProgress& progress) {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Progress = progress;
+        if (m_Published.empty()) {
+            m_Published.swap(m_Pending);
+        }
+        else {
+            m_Published.insert(m_Published.end(), m_Pending.begin(), m_Pending.end());
+        }
+    }
+    m_Pending.clear();
+
+    // Listener is throttled, the changes of skipped notifications are taken with the next one.
+    const auto now = std::chrono::steady_clock::now();
+    const bool last = progress.iteration >= progress.numberOfIterations;
+    if (m_Listener && (last || now - m_LastNotification >= m_Interval)) {
+        m_LastNotification = now;
+        m_Listener();
+    }
+}
+
+void NoiseMonitor::publishChain(const uint chain, const uint chainCount) {
+    // Published progress is only written by the thread of the run, so it is read here without the lock.
+    NoiseProgress progress = m_Progress;
+    progress.chain = chain;
+    progress.chainCount = chainCount;
+    publish(progress);
+}
+
+NoiseProgress NoiseMonitor::progress() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Progress;
+}
+
+std::vector<NoisePixelChange> NoiseMonitor::takeChanges() {
+    std::vector<NoisePixelChange> changes;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    changes.swap(m_Published);
+    return changes;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Progress of a running noise application (after a finished chain code or iteration).
+/// </summary>
+struct NoiseProgress {
+    uint iteration = 0;               // Number of finished iterations.
+    uint numberOfIterations = 0;      // Number of requested iterations.
+    uint chain = 0;                   // Number of finished chain codes of the current iteration.
+    uint chainCount = 0;              // Number of chain codes.
+    u64 segmentCount = 0;             // Number of commands of all chain codes.
+    double segmentsPerSecond = 0.0;   // Commands processed per second in the last iteration.
+};
+
+
+/// <summary>
+/// Change of the set of border pixels caused by a replacement.
+/// </summary>
+struct NoisePixelChange {
+    Pixel pixel;   // Border pixel (coordinates as in ChainCodeFunctions::calculateCoordinates).
+    bool added;    // True if the pixel was added, false if it was removed.
+};
+
+
+
+/// <summary>
+/// Link between a noise run on a worker thread and its observer. The run records the border pixel changes,
+/// publishes them with its progress after each chain code and each iteration, and stops after the chain code
+/// during which it is cancelled. The listener is called from the thread of the run, at most once per notification
+/// interval (and after the last iteration); the observer then takes the progress and the changes published since
+/// its previous call.
+/// </summary>
+class NoiseMonitor {
+private:
+    std::atomic<bool> m_Cancelled = false;          // Cancellation token.
+    std::function<void()> m_Listener;                // Called when new progress is published.
+    std::chrono::steady_clock::duration m_Interval;  // Minimal time between two calls of the listener.
+    std::chrono::steady_clock::time_point m_LastNotification;
+    bool m_RecordChanges = false;                    // True if border pixel changes are recorded.
+    std::vector<NoisePixelChange> m_Pending;         // Changes of the current chain code (thread of the run only).
+
+    std::mutex m_Mutex;                              // Guards the published state.
+    NoiseProgress m_Progress;                        // Last published progress.
+    std::vector<NoisePixelChange> m_Published;       // Changes that were not taken by the observer yet.
+
+public:
+    /// <summary>
+    /// Constructor of NoiseMonitor.
+    /// </summary>
+    /// <param name="listener">: function called when new progress is published (may be empty)</param>
+    /// <param name="notificationInterval">: minimal time between two calls of the listener in seconds</param>
+    /// <param name="recordChanges">: true if border pixel changes are recorded (live preview)</param>
+    NoiseMonitor(const std::function<void()>& listener = {}, const double notificationInterval = 0.1, const bool recordChanges = false);
+
+    NoiseMonitor(const NoiseMonitor&) = delete;
+    NoiseMonitor& operator=(const NoiseMonitor&) = delete;
+
+    /// <summary>
+    /// Requesting the run to stop. It stops after the current chain code; an iteration that is cut short this way is
+    /// recorded in all outputs as the last iteration of the run (only its first chain codes are noisy).
+    /// </summary>
+    void cancel();
+
+    /// <summary>
+    /// Checking whether the run was cancelled.
+    /// </summary>
+    /// <returns>True if cancel was called</returns>
+    bool isCancelled() const;
+
+    /// <summary>
+    /// Recording a pixel added to the border (called by the run).
+    /// </summary>
+    /// <param name="pixel">: added pixel</param>
+    void addPixel(const Pixel& pixel);
+
+    /// <summary>
+    /// Recording a pixel removed from the border (called by the run).
+    /// </summary>
+    /// <param name="pixel">: removed pixel</param>
+    void removePixel(const Pixel& pixel);
+
+    /// <summary>
+    /// Publishing the progress and the changes of a finished iteration (called by the run).
+    /// </summary>
+    /// <param name="progress">: progress after the iteration</param>
+    void publish(const NoiseProgress& progress);
+
+    /// <summary>
+    /// Publishing the progress and the changes of a finished chain code within an iteration (called by the run).
+    /// </summary>
+    /// <param name="chain">: number of finished chain codes of the current iteration</param>
+    /// <param name="chainCount">: number of chain codes</param>
+    void publishChain(const uint chain, const uint chainCount);
+
+    /// <summary>
+    /// Last published progress.
+    /// </summary>
+    /// <returns>Progress</returns>
+    NoiseProgress progress();
+
+    /// <summary>
+    /// Taking the changes published since the previous call (in the order they were made).
+    /// </summary>
+    /// <returns>Border pixel changes</returns>
+    std::vector<NoisePixelChange> takeChanges();
+};
@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "ChainCodeNoise.hpp"
+#include "NoisePipeline.hpp"
+
+
+namespace {
+    constexpr uint ROTATION = 256;    // Commands an iteration consumes before the next one starts its traversal.
+    constexpr uint BLOCK = 512;       // Commands a stage consumes per turn of the schedule.
+    constexpr int CELL_SHIFT = 5;     // Cells of the spatial index have 32x32 pixels.
+    constexpr short BARRIER = -1;     // Start of the chain code (windows never cross it).
+    constexpr size_t COMPACTION = 1 << 16;  // Consumed commands of a channel that are released at once.
+}
+
+
+
+void NoisePipeline::prepare() {
+    const uint contourCount = static_cast<uint>(m_ChainCodes.size());
+    m_TraversalStarts.resize(contourCount, 0);
+
+    m_Offsets.assign(1, 0);
+    for (const ChainCode& chainCode : m_ChainCodes) {
+        m_Offsets.push_back(m_Offsets.back() + static_cast<uint>(chainCode.code.size()));
+    }
+
+    // Positions of the pass input are collected per cell as ranges (a contour crosses a cell in a few runs).
+    std::unordered_map<u64, std::vector<TagInterval>> cells;
+    for (uint c = 0; c < contourCount; c++) {
+        const ChainCode& chainCode = m_ChainCodes[c];
+        const uint length = static_cast<uint>(chainCode.code.size());
+        const uint start = m_TraversalStarts[c] < length ? static_cast<uint>(m_TraversalStarts[c]) : 0;
+
+        // First stage reads the chain code from its traversal start, the barrier and the commands before the start.
+        Channel& channel = m_Input.emplace_back();
+        channel.prefix.reserve(start + 1);
+        channel.main.reserve(length - start);
+        channel.prefix.push_back({ BARRIER, m_Offsets[c] });
+        channel.marked = true;
+        channel.finished = true;
+
+        Pixel pixel = m_StartPixels[c];
+        std::vector<TagInterval>* intervals = nullptr;
+        u64 lastKey = 0;
+        for (uint j = 0; j < length; j++) {
+            const uint tag = m_Offsets[c] + j;
+            if (j == start) {
+                channel.markPixel = pixel;
+            }
+            (j < start ? channel.prefix : channel.main).push_back({ chainCode.code[j], tag });
+
+            const u64 key = cellKey(pixel.x >> CELL_SHIFT, pixel.y >> CELL_SHIFT);
+            if (intervals == nullptr || key != lastKey) {
+                intervals = &cells[key];
+                lastKey = key;
+            }
+            if (!intervals->empty() && intervals->back().contour == c && intervals->back().last + 1 == tag) {
+                intervals->back().last = tag;
+            }
+            else {
+                intervals->push_back({ c, tag, tag });
+            }
+
+            pixel = ChainCodeFunctions::chainCodeMove(chainCode.type, chainCode.code[j], pixel);
+        }
+        if (length == 0) {
+            channel.markPixel = pixel;
+        }
+    }
+
+    // Spatial index is only used by the stages after the first one.
+    if (m_Stages.size() < 2) {
+        return;
+    }
+
+    // Pixels move by at most (window + 1) per iteration, and a stage conflicts with an earlier one within
+    // 2 * (window + 1) + 1 pixels of its future decisions, which spread by (window + 1) per stage between them.
+    // Every cell therefore lists the positions that start within this reach of the cell during the pass.
+    const int move = static_cast<int>(m_Window) + 1;
+    const int stages = static_cast<int>(m_Stages.size());
+    const int reach = (2 * stages + 1) * move + 1;
+    const int radius = (reach + (1 << CELL_SHIFT) - 1) >> CELL_SHIFT;
+
+    for (const auto& [key, intervals] : cells) {
+        const int x = static_cast<int>(static_cast<uint>(key >> 32));
+        const int y = static_cast<int>(static_cast<uint>(key));
+        for (int dy = -radius; dy <= radius; dy++) {
+            for (int dx = -radius; dx <= radius; dx++) {
+                std::vector<TagInterval>& dilated = m_Cells[cellKey(x + dx, y + dy)];
+                dilated.insert(dilated.end(), intervals.begin(), intervals.end());
+            }
+        }
+    }
+
+    // Overlapping and adjacent ranges of a contour are merged, so a stage usually checks one or two ranges.
+    for (auto& [key, intervals] : m_Cells) {
+        std::sort(intervals.begin(), intervals.end(), [](const TagInterval& a, const TagInterval& b) {
+            return a.first < b.first;
+        });
+
+        size_t count = 0;
+        for (const TagInterval& interval : intervals) {
+            if (count > 0 && intervals[count - 1].contour == interval.contour && interval.first <= intervals[count - 1].last + 1) {
+                intervals[count - 1].last = std::max(intervals[count - 1].last, interval.last);
+            }
+            else {
+                intervals[count++] = interval;
+            }
+        }
+        intervals.resize(count);
+    }
+}
+
+bool NoisePipeline::advance(const uint index) {
+    Stage& stage = m_Stages[index];
+    std::deque<Channel>& inputs = index == 0 ? m_Input : m_Stages[index - 1].output;
+    const ChainCodeType type = m_ChainCodes[0].type;
+
+    std::vector<Pixel>& windowPixels = m_WindowPixels;
+    std::vector<Pixel>& newPixels = m_NewPixels;
+    short window[KGRAM_MAX_WINDOW];
+
+    bool progress = false;
+    for (uint step = 0; step < BLOCK && !stage.done; step++) {
+        // Traversal of a contour starts once the previous stage has set its mark.
+        if (!stage.started) {
+            if (inputs.empty() || !inputs.front().marked) {
+                break;
+            }
+            stage.started = true;
+            stage.inPrefix = false;
+            stage.prefixHead = 0;
+            stage.pixel = inputs.front().markPixel;
+            stage.consumed = 0;
+            stage.approved = false;
+            stage.output.emplace_back();
+        }
+
+        Channel& input = inputs.front();
+        Channel& output = stage.output.back();
+
+        // Commands of the traversal: the main part of the input, then (once it is finished) its prefix.
+        const size_t mainLeft = stage.inPrefix ? 0 : input.main.size() - input.head;
+        const size_t left = input.finished ? mainLeft + input.prefix.size() - stage.prefixHead : mainLeft;
+        auto at = [&](const size_t offset) -> const PipelineCommand& {
+            return offset < mainLeft ? input.main[input.head + offset] : input.prefix[stage.prefixHead + offset - mainLeft];
+        };
+        auto consume = [&](const uint count) {
+            for (uint i = 0; i < count; i++) {
+                const PipelineCommand& command = at(i);
+                if (stage.consumed == 0 && command.command != BARRIER) {
+                    stage.startTag = command.tag;
+                }
+                stage.lastTag = command.tag;
+                stage.consumed += command.command != BARRIER;
+            }
+            if (count <= mainLeft) {
+                input.head += count;
+            }
+            else {
+                input.head += mainLeft;
+                stage.inPrefix = true;
+                stage.prefixHead += count - mainLeft;
+            }
+        };
+        auto emit = [&](const short command, const uint tag) {
+            (output.marked ? output.main : output.prefix).push_back({ command, tag });
+            stage.commands += command != BARRIER;
+        };
+
+        if (left == 0) {
+            if (!input.finished) {
+                break;
+            }
+
+            // Contour is finished; a mark that was not reached (short contour) is set at the end.
+            if (!output.marked) {
+                output.marked = true;
+                output.markPixel = stage.pixel;
+            }
+            output.finished = true;
+            inputs.pop_front();
+            stage.started = false;
+            stage.contour++;
+            stage.done = stage.contour == m_ChainCodes.size();
+            progress = true;
+            continue;
+        }
+
+        const PipelineCommand first = at(0);
+        if (first.command == BARRIER) {
+            emit(BARRIER, first.tag);
+            consume(1);
+            stage.pixel = m_StartPixels[stage.contour];
+            progress = true;
+            continue;
+        }
+
+        // Decisions are made on whole windows before the barrier and the end of the traversal.
+        bool decision = true;
+        if (left < m_Window) {
+            if (!input.finished) {
+                break;
+            }
+            decision = false;
+        }
+        for (uint j = 0; decision && j < m_Window; j++) {
+            window[j] = at(j).command;
+            decision = window[j] != BARRIER;
+        }
+
+        if (decision && index > 0) {
+            // Stage waits until no earlier stage can change the border pixels around the decision.
+            const u64 cell = cellKey(stage.pixel.x >> CELL_SHIFT, stage.pixel.y >> CELL_SHIFT);
+            if (!stage.approved || stage.approvedCell != cell) {
+                if (!isSafe(index, stage.pixel)) {
+                    break;
+                }
+                stage.approved = true;
+                stage.approvedCell = cell;
+            }
+        }
+
+        bool replaced = false;
+        if (decision && stage.random(stage.generator) < m_NoiseProbability) {
+            const bool firstTable = stage.random(stage.generator) < 0.5;
+
+            // Replacement and its new pixels (pair tables or k-gram tables, as in the sequential procedures).
+            std::vector<short> pairReplacement;
+            const KGramReplacement* kGramReplacement = nullptr;
+            newPixels.clear();
+            if (m_Window == 2) {
+                pairReplacement = m_Noise.m_LUT.findReplacement(type, firstTable, window[0], window[1]);
+                if (!pairReplacement.empty()) {
+                    newPixels = m_Noise.chainCodeSegmentToPixels(type, stage.pixel, pairReplacement);
+                }
+            }
+            else {
+                kGramReplacement = &m_Noise.m_LUT.findReplacement(type, firstTable, window, m_Window);
+                for (uint j = 0; j + 1 < kGramReplacement->length; j++) {
+                    newPixels.emplace_back(stage.pixel.x + kGramReplacement->footprint[j][0], stage.pixel.y + kGramReplacement->footprint[j][1]);
+                }
+            }
+
+            if (!pairReplacement.empty() || (kGramReplacement != nullptr && kGramReplacement->length > 0)) {
+                windowPixels[0] = stage.pixel;
+                for (uint j = 0; j < m_Window; j++) {
+                    windowPixels[j + 1] = ChainCodeFunctions::chainCodeMove(type, window[j], windowPixels[j]);
+                }
+
+                if (!m_Noise.wouldPixelsCauseSelfTouchingArea(type, newPixels, m_BorderPixels, windowPixels, 1)) {
+                    for (uint j = 1; j < m_Window; j++) {
+                        m_Noise.removeBorderPixel(m_BorderPixels, windowPixels[j]);
+                    }
+                    for (const Pixel& newPixel : newPixels) {
+                        m_Noise.addBorderPixel(m_BorderPixels, newPixel);
+                    }
+
+                    if (m_Window == 2) {
+                        for (const short command : pairReplacement) {
+                            emit(command, first.tag);
+                        }
+                    }
+                    else {
+                        for (uint j = 0; j < kGramReplacement->length; j++) {
+                            emit(kGramReplacement->code[j], first.tag);
+                        }
+                    }
+                    consume(m_Window);
+                    stage.pixel = windowPixels[m_Window];
+                    replaced = true;
+                }
+            }
+        }
+
+        if (!replaced) {
+            emit(first.command, first.tag);
+            consume(1);
+            stage.pixel = ChainCodeFunctions::chainCodeMove(type, first.command, stage.pixel);
+        }
+
+        // Next stage starts where this one has consumed ROTATION commands.
+        if (!output.marked && stage.consumed >= ROTATION) {
+            output.marked = true;
+            output.markPixel = stage.pixel;
+        }
+
+        // Consumed commands of the input are released.
+        if (input.head >= COMPACTION && 2 * input.head >= input.main.size()) {
+            input.main.erase(input.main.begin(), input.main.begin() + input.head);
+            input.head = 0;
+        }
+        progress = true;
+    }
+
+    return progress;
+}
+
+bool NoisePipeline::isSafe(const uint index, const Pixel& pixel) const {
+    const auto cell = m_Cells.find(cellKey(pixel.x >> CELL_SHIFT, pixel.y >> CELL_SHIFT));
+    if (cell == m_Cells.end()) {
+        return true;
+    }
+
+    // Later stages are behind their predecessor, so the predecessor is the last stage that can still pass the positions.
+    const Stage& previous = m_Stages[index - 1];
+    for (const TagInterval& interval : cell->second) {
+        if (!hasPassed(previous, interval)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NoisePipeline::hasPassed(const Stage& stage, const TagInterval& interval) const {
+    if (stage.done || stage.contour > interval.contour) {
+        return true;
+    }
+    if (stage.contour < interval.contour || !stage.started || stage.consumed == 0) {
+        return false;
+    }
+
+    // Positions are passed in the order of the traversal; the first position is only passed with the whole contour
+    // (commands of its replacement may end the traversal), the last consumed one may still have unconsumed commands.
+    const uint first = m_Offsets[interval.contour];
+    const uint length = m_Offsets[interval.contour + 1] - first;
+    auto offset = [&](const uint tag) {
+        return (tag - first + length - (stage.startTag - first)) % length;
+    };
+    const uint begin = offset(interval.first);
+    const uint end = offset(interval.last);
+    return begin > 0 && begin <= end && end < offset(stage.lastTag);
+}
+
+u64 NoisePipeline::cellKey(const int x, const int y) {
+    return (static_cast<u64>(static_cast<uint>(x)) << 32) | static_cast<uint>(y);
+}
+
+
+
+NoisePipeline::NoisePipeline(ChainCodeNoise& noise, std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, std::vector<u64>& traversalStarts, const double noiseProbability, const std::vector<uint>& seeds)
+    : m_Noise(noise), m_ChainCodes(chainCodes), m_StartPixels(startPixels), m_BorderPixels(borderPixels), m_TraversalStarts(traversalStarts), m_NoiseProbability(noiseProbability), m_Window(noise.m_ReplacementWindow), m_Stages(seeds.size()), m_WindowPixels(m_Window + 1) {
+    m_NewPixels.reserve(KGRAM_MAX_REPLACEMENT - 1);
+    for (size_t i = 0; i < seeds.size(); i++) {
+        m_Stages[i].generator.seed(seeds[i]);
+    }
+}
+
+std::vector<u64> NoisePipeline::run() {
+    std::vector<u64> commandCounts;
+    if (m_Stages.empty() || m_ChainCodes.empty()) {
+        return commandCounts;
+    }
+    prepare();
+
+    // Stages advance by blocks in turn; the first stage never waits, so the pass always finishes.
+    while (!m_Stages.back().done) {
+        bool progress = false;
+        for (uint i = 0; i < m_Stages.size(); i++) {
+            progress |= advance(i);
+        }
+        if (!progress) {
+            throw std::logic_error("Noise pipeline stalled.");
+        }
+    }
+
+    // Emission of the last stage starts at its traversal start; chain codes start after the barrier.
+    const std::deque<Channel>& output = m_Stages.back().output;
+    for (uint c = 0; c < m_ChainCodes.size(); c++) {
+        std::vector<PipelineCommand> emission = output[c].prefix;
+        emission.insert(emission.end(), output[c].main.begin(), output[c].main.end());
+        const size_t barrier = std::find_if(emission.begin(), emission.end(), [](const PipelineCommand& command) {
+            return command.command == BARRIER;
+        }) - emission.begin();
+
+        std::vector<short>& code = m_ChainCodes[c].code;
+        code.clear();
+        code.reserve(emission.size() - 1);
+        for (size_t j = barrier + 1; j < emission.size(); j++) {
+            code.push_back(emission[j].command);
+        }
+        for (size_t j = 0; j < barrier; j++) {
+            code.push_back(emission[j].command);
+        }
+
+        // Mark of the last stage is where the first iteration of the next pass starts.
+        const size_t mark = output[c].prefix.size();
+        m_TraversalStarts[c] = code.empty() ? 0 : (mark > barrier ? mark - barrier - 1 : emission.size() - barrier - 1 + mark) % code.size();
+    }
+
+    for (const Stage& stage : m_Stages) {
+        commandCounts.push_back(stage.commands);
+    }
+    return commandCounts;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <deque>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+class ChainCodeNoise;
+
+
+/// <summary>
+/// Command of a pipeline stream, tagged with the position (in all contours of the pass input) it derives from.
+/// </summary>
+struct PipelineCommand {
+    short command;  // Chain code command (-1 marks the start of the chain code).
+    uint tag;       // Position of the pass input (replacement commands inherit the tag of their first pixel).
+};
+
+
+/// <summary>
+/// Several noise iterations advancing along the chain codes as staggered wavefronts in one thread: each iteration
+/// (stage) consumes the commands emitted by the previous one a short distance behind it, so the chain codes and the
+/// border pixels around the wavefronts stay in the cache instead of being streamed once per iteration.
+///
+/// Iterations use their own random streams, and each iteration starts its traversal of a contour where the previous
+/// iteration had consumed a fixed number of commands, so the closing part of an iteration is never where the next
+/// one starts. The results are those of running the iterations one after another (a pass of one iteration): a
+/// stage only decides at a pixel once no earlier stage can still change the border pixels it reads or changes.
+/// This is checked on a spatial index of the pass input, in which every cell lists the positions of the contours
+/// that can come close to it during the pass; the stage waits until its predecessor has passed all of them (which
+/// only happens where contours fold back onto themselves or pass close to another contour).
+/// </summary>
+class NoisePipeline {
+private:
+    // Emission of a stage for one contour. The next stage reads it from the mark to the end and then from the
+    // start to the mark.
+    struct Channel {
+        std::vector<PipelineCommand> prefix;  // Emission before the mark.
+        std::vector<PipelineCommand> main;    // Emission after the mark.
+        size_t head = 0;                      // Next command of main read by the next stage.
+        bool marked = false;                  // True once the next stage can start.
+        Pixel markPixel;                      // Pixel at the mark.
+        bool finished = false;                // True once the emission of the contour is complete.
+    };
+
+    // Iteration of the pass.
+    struct Stage {
+        std::mt19937 generator;
+        std::uniform_real_distribution<> random = std::uniform_real_distribution<>(0.0, 1.0);
+        std::deque<Channel> output;   // Emission of each contour (the front one is read by the next stage).
+        uint contour = 0;             // Contour of the traversal.
+        bool started = false;         // True if the traversal of the contour has started.
+        bool inPrefix = false;        // True if the traversal reads the prefix of the input channel.
+        size_t prefixHead = 0;        // Next command of the prefix.
+        Pixel pixel;                  // Pixel at the read position.
+        u64 consumed = 0;             // Number of commands consumed in the contour.
+        uint startTag = 0;            // Tag of the first consumed command of the contour.
+        uint lastTag = 0;             // Tag of the last consumed command of the contour.
+        u64 commands = 0;             // Number of commands emitted in all contours.
+        u64 approvedCell = 0;         // Cell of the spatial index where the stage may decide.
+        bool approved = false;
+        bool done = false;            // True once all contours are finished.
+    };
+
+    // Range of pass input positions of one contour.
+    struct TagInterval {
+        uint contour;
+        uint first;
+        uint last;
+    };
+
+    ChainCodeNoise& m_Noise;
+    std::vector<ChainCode>& m_ChainCodes;
+    const std::vector<Pixel>& m_StartPixels;
+    std::unordered_set<Pixel>& m_BorderPixels;
+    std::vector<u64>& m_TraversalStarts;
+    double m_NoiseProbability;
+    uint m_Window;
+
+    std::vector<uint> m_Offsets;                 // Tag of the first command of each contour.
+    std::deque<Channel> m_Input;                 // Pass input, read by the first stage.
+    std::vector<Stage> m_Stages;
+    std::unordered_map<u64, std::vector<TagInterval>> m_Cells;  // Positions that can come close to each cell.
+    std::vector<Pixel> m_WindowPixels;           // Pixels of the replaced window.
+    std::vector<Pixel> m_NewPixels;              // Pixels introduced by the replacement.
+
+    /// <summary>
+    /// Building the input channels and the spatial index of the pass input.
+    /// </summary>
+    void prepare();
+
+    /// <summary>
+    /// Advancing a stage by a block of commands (until it waits for input or for its predecessor).
+    /// </summary>
+    /// <param name="index">: index of the stage</param>
+    /// <returns>True if the stage made progress</returns>
+    bool advance(const uint index);
+
+    /// <summary>
+    /// Checking whether a stage may decide at a pixel (its predecessor has passed all positions close to the pixel's cell).
+    /// </summary>
+    /// <param name="index">: index of the stage</param>
+    /// <param name="pixel">: pixel of the decision</param>
+    /// <returns>True if the stage may decide</returns>
+    bool isSafe(const uint index, const Pixel& pixel) const;
+
+    /// <summary>
+    /// Checking whether a stage has consumed all commands of a range of positions.
+    /// </summary>
+    /// <param name="stage">: stage</param>
+    /// <param name="interval">: range of positions</param>
+    /// <returns>True if the range is passed</returns>
+    bool hasPassed(const Stage& stage, const TagInterval& interval) const;
+
+    /// <summary>
+    /// Key of a cell of the spatial index.
+    /// </summary>
+    static u64 cellKey(const int x, const int y);
+
+public:
+    /// <summary>
+    /// Constructor of a pass.
+    /// </summary>
+    /// <param name="noise">: noise engine (replacement tables, self-touching checks, statistics and monitor)</param>
+    /// <param name="chainCodes">: chain codes that are modified</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="traversalStarts">: command where the traversal of each contour starts (updated for the next pass)</param>
+    /// <param name="noiseProbability">: probability of the noise</param>
+    /// <param name="seeds">: seeds of the random streams of the iterations of the pass</param>
+    NoisePipeline(ChainCodeNoise& noise, std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel>& borderPixels, std::vector<u64>& traversalStarts, const double noiseProbability, const std::vector<uint>& seeds);
+
+    /// <summary>
+    /// Running the iterations of the pass.
+    /// </summary>
+    /// <returns>Number of commands of all chain codes after each iteration</returns>
+    std::vector<u64> run();
+};
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "NoiseProbabilityField.hpp"
+
+
+namespace {
+    // Division rounding towards negative infinity (pixels left of or below the origin).
+    int floorDivide(const int value, const int divisor) {
+        return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+    }
+}
+
+
+
+NoiseProbabilityField::NoiseProbabilityField(const int originX, const int originY, const uint width, const uint height, const uint cellSize, const double probability, const double outside) :
+    m_OriginX(originX),
+    m_OriginY(originY),
+    m_CellSize(std::max(cellSize, 1u)),
+    m_Width(width),
+    m_Height(height),
+    m_Outside(outside),
+    m_Cells(static_cast<size_t>(width) * height, static_cast<float>(probability)),
+    m_BlocksX((width + BLOCK - 1) / BLOCK),
+    m_BlocksY((height + BLOCK - 1) / BLOCK),
+    m_BlockMax(static_cast<size_t>(m_BlocksX) * m_BlocksY, static_cast<float>(probability))
+{
+    if (!(probability >= 0.0 && probability <= 1.0 && outside >= 0.0 && outside <= 1.0)) {
+        throw std::logic_error("Noise probability must be within [0, 1].");
+    }
+}
+
+void NoiseProbabilityField::updateBlock(const uint blockX, const uint blockY) {
+    float maximum = 0.0f;
+    for (uint y = blockY * BLOCK; y < std::min((blockY + 1) * BLOCK, m_Height); y++) {
+        for (uint x = blockX * BLOCK; x < std::min((blockX + 1) * BLOCK, m_Width); x++) {
+            maximum = std::max(maximum, m_Cells[static_cast<size_t>(y) * m_Width + x]);
+        }
+    }
+    m_BlockMax[static_cast<size_t>(blockY) * m_BlocksX + blockX] = maximum;
+}
+
+void NoiseProbabilityField::setProbability(const uint cellX, const uint cellY, const double probability) {
+    if (cellX >= m_Width || cellY >= m_Height) {
+        throw std::logic_error("Cell is outside of the probability field.");
+    }
+    if (!(probability >= 0.0 && probability <= 1.0)) {
+        throw std::logic_error("Noise probability must be within [0, 1].");
+    }
+
+    float& cell = m_Cells[static_cast<size_t>(cellY) * m_Width + cellX];
+    const float previous = cell;
+    cell = static_cast<float>(probability);
+
+    // A raised cell raises the maximum directly; a lowered one may have been the maximum of its block.
+    float& maximum = m_BlockMax[static_cast<size_t>(cellY / BLOCK) * m_BlocksX + cellX / BLOCK];
+    if (cell >= maximum) {
+        maximum = cell;
+    }
+    else if (previous >= maximum) {
+        updateBlock(cellX / BLOCK, cellY / BLOCK);
+    }
+}
+
+void NoiseProbabilityField::setRegion(const Pixel& minPixel, const Pixel& maxPixel, const double probability) {
+    const int cellSize = static_cast<int>(m_CellSize);
+    const int minX = std::max(floorDivide(minPixel.x - m_OriginX, cellSize), 0);
+    const int minY = std::max(floorDivide(minPixel.y - m_OriginY, cellSize), 0);
+    const int maxX = std::min(floorDivide(maxPixel.x - m_OriginX, cellSize), static_cast<int>(m_Width) - 1);
+    const int maxY = std::min(floorDivide(maxPixel.y - m_OriginY, cellSize), static_cast<int>(m_Height) - 1);
+    for (int y = minY; y <= maxY; y++) {
+        for (int x = minX; x <= maxX; x++) {
+            setProbability(x, y, probability);
+        }
+    }
+}
+
+void NoiseProbabilityField::setContourWeights(const std::vector<double>& weights) {
+    for (const double weight : weights) {
+        if (!(weight >= 0.0 && weight <= 1.0)) {
+            throw std::logic_error("Contour weight must be within [0, 1].");
+        }
+    }
+    m_ContourWeights = weights;
+}
+
+double NoiseProbabilityField::contourWeight(const size_t contour) const {
+    return contour < m_ContourWeights.size() ? m_ContourWeights[contour] : 1.0;
+}
+
+double NoiseProbabilityField::probability(const Pixel& pixel) const {
+    const int cellSize = static_cast<int>(m_CellSize);
+    const int x = floorDivide(pixel.x - m_OriginX, cellSize);
+    const int y = floorDivide(pixel.y - m_OriginY, cellSize);
+    if (x < 0 || y < 0 || x >= static_cast<int>(m_Width) || y >= static_cast<int>(m_Height)) {
+        return m_Outside;
+    }
+    return m_Cells[static_cast<size_t>(y) * m_Width + x];
+}
+
+double NoiseProbabilityField::blockMax(const int x, const int y) const {
+    const int span = static_cast<int>(m_CellSize * BLOCK);
+    const int blockX = floorDivide(x - m_OriginX, span);
+    const int blockY = floorDivide(y - m_OriginY, span);
+    if (blockX < 0 || blockY < 0 || blockX >= static_cast<int>(m_BlocksX) || blockY >= static_cast<int>(m_BlocksY)) {
+        return m_Outside;
+    }
+
+    // A trailing block reaches past the raster, where its pixels have the probability outside of it.
+    const double maximum = m_BlockMax[static_cast<size_t>(blockY) * m_BlocksX + blockX];
+    if (static_cast<uint>(blockX + 1) * BLOCK > m_Width || static_cast<uint>(blockY + 1) * BLOCK > m_Height) {
+        return std::max(maximum, m_Outside);
+    }
+    return maximum;
+}
+
+double NoiseProbabilityField::maxProbability(const Pixel& start, const int dx, const int dy, const u64 length) const {
+    const int span = static_cast<int>(m_CellSize * BLOCK);
+    double bound = 0.0;
+
+    // Jumping from block to block: each step ends at the first pixel past a block boundary in X or Y.
+    u64 t = 0;
+    while (true) {
+        const int x = start.x + dx * static_cast<int>(t);
+        const int y = start.y + dy * static_cast<int>(t);
+        bound = std::max(bound, blockMax(x, y));
+        if (bound >= 1.0 || (dx == 0 && dy == 0)) {
+            break;
+        }
+
+        u64 step = length - t + 1;
+        if (dx != 0) {
+            const int local = x - m_OriginX - floorDivide(x - m_OriginX, span) * span;
+            step = std::min<u64>(step, dx > 0 ? span - local : local + 1);
+        }
+        if (dy != 0) {
+            const int local = y - m_OriginY - floorDivide(y - m_OriginY, span) * span;
+            step = std::min<u64>(step, dy > 0 ? span - local : local + 1);
+        }
+        t += step;
+        if (t > length) {
+            break;
+        }
+    }
+
+    return bound;
+}
+
+NoiseProbabilityField NoiseProbabilityField::readCsv(const std::string& file, const int originX, const int originY, const uint cellSize, const double outside) {
+    std::ifstream in(file);
+    if (!in.is_open()) {
+        throw std::logic_error("File could not be found or opened.");
+    }
+
+    std::vector<std::vector<double>> rows;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::stringstream values(line);
+        std::vector<double> row;
+        for (std::string value; std::getline(values, value, ',');) {
+            row.push_back(std::stod(value));
+        }
+        if (!row.empty()) {
+            rows.push_back(row);
+        }
+    }
+
+    const uint width = rows.empty() ? 0 : static_cast<uint>(rows[0].size());
+    NoiseProbabilityField field(originX, originY, width, static_cast<uint>(rows.size()), cellSize, 0.0, outside);
+    for (uint y = 0; y < rows.size(); y++) {
+        if (rows[y].size() != width) {
+            throw std::logic_error("Rows of the probability field have different lengths.");
+        }
+        for (uint x = 0; x < width; x++) {
+            field.setProbability(x, y, rows[y][x]);
+        }
+    }
+
+    return field;
+}
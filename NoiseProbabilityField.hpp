@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Spatially varying noise probability: a raster of cells (each cell covers cellSize x cellSize pixels) with a
+/// probability for the pixels in it, and a probability outside of the raster. Maxima of blocks of 8x8 cells are
+/// kept up to date as cells change, so an upper bound of the probability along a straight run of pixels costs
+/// one lookup per block the run crosses. Zero cells are protected zones (no replacement starts in them). Contours
+/// can be weighted as well: the probability at a pixel of a contour is that of its cell times the contour weight.
+/// </summary>
+class NoiseProbabilityField {
+private:
+    static constexpr uint BLOCK = 8;  // Cells per side of a block.
+
+    int m_OriginX;                // Pixel coordinates of the lower left corner of the raster.
+    int m_OriginY;
+    uint m_CellSize;              // Pixels per side of a cell.
+    uint m_Width;                 // Number of cells in X.
+    uint m_Height;                // Number of cells in Y.
+    double m_Outside;             // Probability outside of the raster.
+    std::vector<float> m_Cells;   // Probabilities of the cells (row 0 is the lowest).
+    uint m_BlocksX;
+    uint m_BlocksY;
+    std::vector<float> m_BlockMax;  // Maximal probability of each block of cells.
+    std::vector<double> m_ContourWeights;  // Weights of the contours by index (contours past the end have weight 1).
+
+    /// <summary>
+    /// Recalculating the maximum of a block.
+    /// </summary>
+    /// <param name="blockX">: X index of the block</param>
+    /// <param name="blockY">: Y index of the block</param>
+    void updateBlock(const uint blockX, const uint blockY);
+
+    /// <summary>
+    /// Maximal probability of the block that contains the pixel (with the outside probability if the block reaches
+    /// past the raster).
+    /// </summary>
+    double blockMax(const int x, const int y) const;
+
+public:
+    /// <summary>
+    /// Constructor of a field with all cells set to the same probability.
+    /// </summary>
+    /// <param name="originX">: X coordinate of the lower left pixel of the raster</param>
+    /// <param name="originY">: Y coordinate of the lower left pixel of the raster</param>
+    /// <param name="width">: number of cells in X</param>
+    /// <param name="height">: number of cells in Y</param>
+    /// <param name="cellSize">: pixels per side of a cell</param>
+    /// <param name="probability">: probability of the cells</param>
+    /// <param name="outside">: probability outside of the raster</param>
+    NoiseProbabilityField(const int originX, const int originY, const uint width, const uint height, const uint cellSize = 1, const double probability = 0.0, const double outside = 0.0);
+
+    /// <summary>
+    /// Setting the probability of a cell (the maximum of its block is updated).
+    /// </summary>
+    /// <param name="cellX">: X index of the cell</param>
+    /// <param name="cellY">: Y index of the cell</param>
+    /// <param name="probability">: probability [0-1]</param>
+    void setProbability(const uint cellX, const uint cellY, const double probability);
+
+    /// <summary>
+    /// Setting the probability of all cells that intersect a rectangle of pixels.
+    /// </summary>
+    /// <param name="minPixel">: lower left pixel of the rectangle</param>
+    /// <param name="maxPixel">: upper right pixel of the rectangle</param>
+    /// <param name="probability">: probability [0-1]</param>
+    void setRegion(const Pixel& minPixel, const Pixel& maxPixel, const double probability);
+
+    /// <summary>
+    /// Setting the weights of the contours (chain codes by their index), which scale the probability along them.
+    /// </summary>
+    /// <param name="weights">: weight of each contour [0-1] (contours without a weight keep weight 1)</param>
+    void setContourWeights(const std::vector<double>& weights);
+
+    /// <summary>
+    /// Weight of a contour.
+    /// </summary>
+    /// <param name="contour">: index of the contour</param>
+    /// <returns>Weight [0-1]</returns>
+    double contourWeight(const size_t contour) const;
+
+    /// <summary>
+    /// Probability at a pixel.
+    /// </summary>
+    /// <param name="pixel">: pixel</param>
+    /// <returns>Probability</returns>
+    double probability(const Pixel& pixel) const;
+
+    /// <summary>
+    /// Upper bound of the probability at the pixels start + t * (dx, dy) for t in [0, length].
+    /// </summary>
+    /// <param name="start">: first pixel</param>
+    /// <param name="dx">: X step [-1, 1]</param>
+    /// <param name="dy">: Y step [-1, 1]</param>
+    /// <param name="length">: number of steps</param>
+    /// <returns>Maximum of the blocks crossed by the pixels</returns>
+    double maxProbability(const Pixel& start, const int dx, const int dy, const u64 length) const;
+
+    /// <summary>
+    /// Reading a field from a CSV file with one row of cell probabilities per line (the first line is the lowest row).
+    /// </summary>
+    /// <param name="file">: path to the CSV file</param>
+    /// <param name="originX">: X coordinate of the lower left pixel of the raster</param>
+    /// <param name="originY">: Y coordinate of the lower left pixel of the raster</param>
+    /// <param name="cellSize">: pixels per side of a cell</param>
+    /// <param name="outside">: probability outside of the raster</param>
+    /// <returns>Probability field</returns>
+    static NoiseProbabilityField readCsv(const std::string& file, const int originX, const int originY, const uint cellSize = 1, const double outside = 0.0);
+};
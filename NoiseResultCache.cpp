@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "BinaryFormat.hpp"
+#include "NoiseResultCache.hpp"
+
+
+namespace {
+    constexpr char MAGIC[4] = { 'C', 'C', 'N', 'I' };
+    constexpr unsigned char VERSION = 1;
+    constexpr size_t HEADER_SIZE = 24;  // Magic, version, padding, clock, number of records.
+
+    static_assert(sizeof(NoiseCacheRecord) == 32, "Cache index records must be packed.");
+
+    constexpr u64 FNV_OFFSET = 14695981039346656037ull;
+    constexpr u64 FNV_PRIME = 1099511628211ull;
+
+    void hashBytes(u64& hash, const void* data, const size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+        }
+    }
+
+    template <typename T>
+    void hashValue(u64& hash, const T value) {
+        hashBytes(hash, &value, sizeof(value));
+    }
+
+    // Pixels are mixed one by one and summed, so the hash of a set does not depend on the order of its buckets.
+    u64 pixelHash(const Pixel& pixel) {
+        u64 value = (static_cast<u64>(static_cast<uint32_t>(pixel.x)) << 32) | static_cast<uint32_t>(pixel.y);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    bool recordLess(const NoiseCacheRecord& first, const NoiseCacheRecord& second) {
+        return first.key < second.key || (first.key == second.key && first.iterations < second.iterations);
+    }
+}
+
+
+
+std::string NoiseResultCache::indexFile() const {
+    return (std::filesystem::path(m_Directory) / "index.bin").string();
+}
+
+std::string NoiseResultCache::resultFile(const u64 key, const uint iterations) const {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << key << std::dec << "_" << iterations << ".ccr";
+    return (std::filesystem::path(m_Directory) / ss.str()).string();
+}
+
+size_t NoiseResultCache::recordCount() const {
+    return m_Index == nullptr ? 0 : (m_Index->size() - HEADER_SIZE) / sizeof(NoiseCacheRecord);
+}
+
+NoiseCacheRecord NoiseResultCache::record(const size_t index) const {
+    NoiseCacheRecord record;
+    std::memcpy(&record, m_Index->data() + HEADER_SIZE + index * sizeof(NoiseCacheRecord), sizeof(record));
+
+    const auto use = m_Uses.find(index);
+    if (use != m_Uses.end()) {
+        record.lastUse = use->second;
+    }
+    return record;
+}
+
+std::vector<NoiseCacheRecord> NoiseResultCache::records() const {
+    std::vector<NoiseCacheRecord> records;
+    records.reserve(recordCount());
+    for (size_t i = 0; i < recordCount(); i++) {
+        records.push_back(record(i));
+    }
+    return records;
+}
+
+void NoiseResultCache::writeIndex(const std::vector<NoiseCacheRecord>& records) {
+    std::vector<unsigned char> data(HEADER_SIZE + records.size() * sizeof(NoiseCacheRecord), 0);
+    std::memcpy(data.data(), MAGIC, 4);
+    data[4] = VERSION;
+    const u64 count = records.size();
+    std::memcpy(data.data() + 8, &m_Clock, sizeof(m_Clock));
+    std::memcpy(data.data() + 16, &count, sizeof(count));
+    if (!records.empty()) {
+        std::memcpy(data.data() + HEADER_SIZE, records.data(), records.size() * sizeof(NoiseCacheRecord));
+    }
+
+    // Mapped file cannot be replaced (on Windows), so it is released first.
+    m_Index.reset();
+    m_Uses.clear();
+    BinaryFormat::writeFileAtomically(indexFile(), data);
+    m_Index = std::make_unique<MappedFile>(indexFile());
+}
+
+
+
+NoiseResultCache::NoiseResultCache(const std::string& directory, const u64 maxBytes) :
+    m_Directory(directory),
+    m_MaxBytes(maxBytes)
+{
+    std::filesystem::create_directories(m_Directory);
+    if (!std::filesystem::exists(indexFile())) {
+        return;
+    }
+
+    m_Index = std::make_unique<MappedFile>(indexFile());
+    if (m_Index->size() < HEADER_SIZE || !std::equal(m_Index->data(), m_Index->data() + 4, MAGIC) || m_Index->data()[4] != VERSION) {
+        throw std::logic_error("File is not a noise cache index.");
+    }
+    std::memcpy(&m_Clock, m_Index->data() + 8, sizeof(m_Clock));
+}
+
+NoiseResultCache::~NoiseResultCache() {
+    if (m_Uses.empty()) {
+        return;
+    }
+
+    // Recency of the looked up results is not essential, so a failed write is ignored.
+    try {
+        writeIndex(records());
+    }
+    catch (const std::exception&) {
+    }
+}
+
+u64 NoiseResultCache::key(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, const std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const uint replacementWindow, const std::string& generatorState) {
+    u64 hash = FNV_OFFSET;
+    hashValue(hash, static_cast<u64>(chainCodes.size()));
+    for (size_t i = 0; i < chainCodes.size(); i++) {
+        const ChainCode& chainCode = chainCodes[i];
+        hashValue(hash, static_cast<int>(chainCode.type));
+        hashValue(hash, chainCode.startX);
+        hashValue(hash, chainCode.startY);
+        hashValue(hash, chainCode.initialDirection);
+        hashValue(hash, startPixels[i].x);
+        hashValue(hash, startPixels[i].y);
+        hashValue(hash, static_cast<u64>(chainCode.code.size()));
+        hashBytes(hash, chainCode.code.data(), chainCode.code.size() * sizeof(short));
+    }
+
+    u64 borderHash = 0;
+    for (const Pixel& pixel : borderPixels) {
+        borderHash += pixelHash(pixel);
+    }
+    hashValue(hash, static_cast<u64>(borderPixels.size()));
+    hashValue(hash, borderHash);
+    hashValue(hash, noiseProbability);
+    hashValue(hash, replacementWindow);
+    hashBytes(hash, generatorState.data(), generatorState.size());
+
+    return hash;
+}
+
+bool NoiseResultCache::find(const u64 key, const uint iterations, NoiseCheckpoint& result) {
+    // Binary search in the mapped index for the last record that is not greater than the request.
+    size_t first = 0;
+    size_t last = recordCount();
+    const NoiseCacheRecord request = { key, iterations, 0, 0, 0 };
+    while (first < last) {
+        const size_t middle = first + (last - first) / 2;
+        if (recordLess(request, record(middle))) {
+            last = middle;
+        }
+        else {
+            first = middle + 1;
+        }
+    }
+    if (first == 0 || record(first - 1).key != key) {
+        return false;
+    }
+
+    // Result files removed from outside of the cache are treated as misses.
+    const NoiseCacheRecord found = record(first - 1);
+    try {
+        const MappedFile file(resultFile(found.key, found.iterations));
+        result = NoiseCheckpoint::decode(file.data(), file.size());
+    }
+    catch (const std::logic_error&) {
+        return false;
+    }
+
+    m_Uses[first - 1] = ++m_Clock;
+    return true;
+}
+
+void NoiseResultCache::store(const u64 key, const NoiseCheckpoint& result) {
+    const std::vector<unsigned char> data = result.encode();
+    BinaryFormat::writeFileAtomically(resultFile(key, result.iteration), data);
+
+    // Record of the result replaces the previous one with the same key and number of iterations.
+    std::vector<NoiseCacheRecord> records = this->records();
+    const NoiseCacheRecord stored = { key, result.iteration, 0, data.size(), ++m_Clock };
+    const auto position = std::lower_bound(records.begin(), records.end(), stored, recordLess);
+    if (position != records.end() && position->key == key && position->iterations == result.iteration) {
+        *position = stored;
+    }
+    else {
+        records.insert(position, stored);
+    }
+
+    // Least recently used results are evicted until the cache fits into its limit (the new result is kept).
+    u64 totalSize = 0;
+    for (const NoiseCacheRecord& record : records) {
+        totalSize += record.size;
+    }
+    while (totalSize > m_MaxBytes && records.size() > 1) {
+        const auto evicted = std::min_element(records.begin(), records.end(), [](const NoiseCacheRecord& first, const NoiseCacheRecord& second) {
+            return first.lastUse < second.lastUse;
+        });
+        std::error_code error;
+        std::filesystem::remove(resultFile(evicted->key, evicted->iterations), error);
+        totalSize -= evicted->size;
+        records.erase(evicted);
+    }
+
+    writeIndex(records);
+}
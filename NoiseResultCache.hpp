@@ -0,0 +1,113 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "MappedFile.hpp"
+#include "NoiseCheckpoint.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Record of the cache index (one cached result).
+/// </summary>
+struct NoiseCacheRecord {
+    u64 key;          // Hash of the input chain codes and run parameters.
+    uint iterations;  // Number of iterations of the cached result.
+    uint reserved;    // Padding (zero).
+    u64 size;         // Size of the result file in bytes.
+    u64 lastUse;      // Logical time of the last lookup or store (least recently used results are evicted first).
+};
+
+
+
+/// <summary>
+/// On-disk cache of noise results. Each result is a checkpoint (noisy chain codes, generator state and
+/// per-iteration command counts) stored in its own file; the memory-mapped index lists the results sorted
+/// by key and number of iterations. A lookup returns the longest cached run that does not exceed the
+/// requested number of iterations, which is then continued as a resumed run.
+/// </summary>
+class NoiseResultCache {
+private:
+    std::string m_Directory;                // Directory of the cache.
+    u64 m_MaxBytes;                         // Size limit of all cached results.
+    std::unique_ptr<MappedFile> m_Index;    // Mapped index file (null if the cache is empty).
+    u64 m_Clock = 0;                        // Logical time of the last use.
+    std::unordered_map<size_t, u64> m_Uses; // Last use of records looked up since the index was written.
+
+    std::string indexFile() const;
+    std::string resultFile(const u64 key, const uint iterations) const;
+
+    /// <summary>
+    /// Number of records of the mapped index.
+    /// </summary>
+    size_t recordCount() const;
+
+    /// <summary>
+    /// Reading a record of the mapped index.
+    /// </summary>
+    /// <param name="index">: index of the record</param>
+    /// <returns>Record</returns>
+    NoiseCacheRecord record(const size_t index) const;
+
+    /// <summary>
+    /// All records of the index, including the uses that were not written yet.
+    /// </summary>
+    /// <returns>Records sorted by key and number of iterations</returns>
+    std::vector<NoiseCacheRecord> records() const;
+
+    /// <summary>
+    /// Replacing the index file with the given records and mapping it again.
+    /// </summary>
+    /// <param name="records">: records sorted by key and number of iterations</param>
+    void writeIndex(const std::vector<NoiseCacheRecord>& records);
+
+public:
+    /// <summary>
+    /// Opening the cache (the directory is created if it does not exist).
+    /// </summary>
+    /// <param name="directory">: directory of the cache</param>
+    /// <param name="maxBytes">: size limit of all cached results</param>
+    NoiseResultCache(const std::string& directory, const u64 maxBytes = u64(1) << 30);
+
+    NoiseResultCache(const NoiseResultCache&) = delete;
+    NoiseResultCache& operator=(const NoiseResultCache&) = delete;
+
+    /// <summary>
+    /// Writing the uses of the looked up results into the index.
+    /// </summary>
+    ~NoiseResultCache();
+
+    /// <summary>
+    /// Key of a noise run (64-bit FNV-1a hash of the input and of everything the run depends on).
+    /// </summary>
+    /// <param name="chainCodes">: input chain codes</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    /// <param name="borderPixels">: border pixels at the start of the run (independent of their order)</param>
+    /// <param name="noiseProbability">: probability of the noise</param>
+    /// <param name="replacementWindow">: number of commands replaced at once</param>
+    /// <param name="generatorState">: serialized state of the random number generator at the start of the run</param>
+    /// <returns>Key</returns>
+    static u64 key(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, const std::unordered_set<Pixel>& borderPixels, const double noiseProbability, const uint replacementWindow, const std::string& generatorState);
+
+    /// <summary>
+    /// Looking up the longest cached result of the run that does not exceed the given number of iterations.
+    /// </summary>
+    /// <param name="key">: key of the run</param>
+    /// <param name="iterations">: requested number of iterations</param>
+    /// <param name="result">: cached result (output)</param>
+    /// <returns>True if a result was found</returns>
+    bool find(const u64 key, const uint iterations, NoiseCheckpoint& result);
+
+    /// <summary>
+    /// Storing a result, evicting the least recently used results if the size limit is exceeded.
+    /// </summary>
+    /// <param name="key">: key of the run</param>
+    /// <param name="result">: result after its last iteration</param>
+    void store(const u64 key, const NoiseCheckpoint& result);
+};
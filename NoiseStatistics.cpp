@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "NoiseStatistics.hpp"
+
+
+void NoiseStatistics::updateHistogram(std::vector<uint>& counts, int& offset, const int coordinate, const bool increase) {
+    // Extending the histogram, so it covers the coordinate.
+    if (counts.empty()) {
+        offset = coordinate;
+    }
+    if (coordinate < offset) {
+        counts.insert(counts.begin(), offset - coordinate, 0);
+        offset = coordinate;
+    }
+    if (coordinate - offset >= static_cast<int>(counts.size())) {
+        counts.resize(coordinate - offset + 1, 0);
+    }
+
+    uint& count = counts[coordinate - offset];
+    if (increase) {
+        count++;
+    }
+    else if (count > 0) {
+        count--;
+    }
+}
+
+uint NoiseStatistics::distance(const Pixel& pixel) const {
+    // Original border lies within the field, so the Manhattan distance of an outside pixel
+    // is its distance from the field plus the distance stored at the nearest field cell.
+    const int x = std::clamp(pixel.x - m_FieldOrigin.x, 0, m_FieldWidth - 1);
+    const int y = std::clamp(pixel.y - m_FieldOrigin.y, 0, m_FieldHeight - 1);
+    const uint outside = std::abs(pixel.x - m_FieldOrigin.x - x) + std::abs(pixel.y - m_FieldOrigin.y - y);
+
+    return outside + m_Distances[static_cast<size_t>(y) * m_FieldWidth + x];
+}
+
+
+
+NoiseStatistics::NoiseStatistics(const NoiseTargetMetric metric, const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, const std::unordered_set<Pixel>& borderPixels, const uint compressionOrder) :
+    m_Metric(metric),
+    m_Coder(chainCodes.empty() ? ChainCodeType::F8 : chainCodes[0].type, compressionOrder)
+{
+    if (chainCodes.empty() || borderPixels.empty()) {
+        throw std::logic_error("Chain code vector is empty.");
+    }
+
+    if (m_Metric == NoiseTargetMetric::fractalDimension) {
+        // Histograms of the first chain code (the only one used for the bounding box).
+        Pixel pixel = startPixels[0];
+        updateHistogram(m_Columns, m_ColumnOffset, pixel.x, true);
+        updateHistogram(m_Rows, m_RowOffset, pixel.y, true);
+        for (const short direction : chainCodes[0].code) {
+            pixel = ChainCodeFunctions::chainCodeMove(chainCodes[0].type, direction, pixel);
+            updateHistogram(m_Columns, m_ColumnOffset, pixel.x, true);
+            updateHistogram(m_Rows, m_RowOffset, pixel.y, true);
+        }
+    }
+    else if (m_Metric == NoiseTargetMetric::meanDisplacement) {
+        // Bounding box of the original border.
+        Pixel minPixel = *borderPixels.begin();
+        Pixel maxPixel = minPixel;
+        for (const Pixel& pixel : borderPixels) {
+            minPixel = Pixel(std::min(minPixel.x, pixel.x), std::min(minPixel.y, pixel.y));
+            maxPixel = Pixel(std::max(maxPixel.x, pixel.x), std::max(maxPixel.y, pixel.y));
+        }
+        m_FieldOrigin = minPixel;
+        m_FieldWidth = maxPixel.x - minPixel.x + 1;
+        m_FieldHeight = maxPixel.y - minPixel.y + 1;
+
+        // Two-pass Manhattan distance transform.
+        const uint infinity = m_FieldWidth + m_FieldHeight;
+        m_Distances.assign(static_cast<size_t>(m_FieldWidth) * m_FieldHeight, infinity);
+        for (const Pixel& pixel : borderPixels) {
+            m_Distances[static_cast<size_t>(pixel.y - minPixel.y) * m_FieldWidth + (pixel.x - minPixel.x)] = 0;
+        }
+        for (int y = 0; y < m_FieldHeight; y++) {
+            uint* row = &m_Distances[static_cast<size_t>(y) * m_FieldWidth];
+            for (int x = 0; x < m_FieldWidth; x++) {
+                if (y > 0) {
+                    row[x] = std::min(row[x], row[x - m_FieldWidth] + 1);
+                }
+                if (x > 0) {
+                    row[x] = std::min(row[x], row[x - 1] + 1);
+                }
+            }
+        }
+        for (int y = m_FieldHeight - 1; y >= 0; y--) {
+            uint* row = &m_Distances[static_cast<size_t>(y) * m_FieldWidth];
+            for (int x = m_FieldWidth - 1; x >= 0; x--) {
+                if (y < m_FieldHeight - 1) {
+                    row[x] = std::min(row[x], row[x + m_FieldWidth] + 1);
+                }
+                if (x < m_FieldWidth - 1) {
+                    row[x] = std::min(row[x], row[x + 1] + 1);
+                }
+            }
+        }
+
+        // Original border pixels have zero distance.
+        m_PixelCount = borderPixels.size();
+    }
+}
+
+void NoiseStatistics::setCurrentChain(const uint index) {
+    m_CurrentChain = index;
+}
+
+void NoiseStatistics::addPixel(const Pixel& pixel) {
+    if (m_Metric == NoiseTargetMetric::fractalDimension && m_CurrentChain == 0) {
+        updateHistogram(m_Columns, m_ColumnOffset, pixel.x, true);
+        updateHistogram(m_Rows, m_RowOffset, pixel.y, true);
+    }
+    else if (m_Metric == NoiseTargetMetric::meanDisplacement) {
+        m_DistanceSum += distance(pixel);
+        m_PixelCount++;
+    }
+}
+
+void NoiseStatistics::removePixel(const Pixel& pixel) {
+    if (m_Metric == NoiseTargetMetric::fractalDimension && m_CurrentChain == 0) {
+        updateHistogram(m_Columns, m_ColumnOffset, pixel.x, false);
+        updateHistogram(m_Rows, m_RowOffset, pixel.y, false);
+    }
+    else if (m_Metric == NoiseTargetMetric::meanDisplacement) {
+        m_DistanceSum -= distance(pixel);
+        m_PixelCount--;
+    }
+}
+
+double NoiseStatistics::value(const std::vector<ChainCode>& chainCodes) {
+    if (m_Metric == NoiseTargetMetric::fractalDimension) {
+        uint occupiedPixels = 0;
+        for (const ChainCode& chainCode : chainCodes) {
+            occupiedPixels += chainCode.code.size();
+        }
+
+        // Extent of the occupied columns and rows.
+        auto extent = [](const std::vector<uint>& counts) {
+            const auto first = std::find_if(counts.begin(), counts.end(), [](const uint count) { return count > 0; });
+            const auto last = std::find_if(counts.rbegin(), counts.rend(), [](const uint count) { return count > 0; });
+            return first == counts.end() ? 0.0 : static_cast<double>((counts.rend() - last - 1) - (first - counts.begin()));
+        };
+        const double pixelsByLongerSide = std::max(extent(m_Columns), extent(m_Rows));
+
+        return std::log(occupiedPixels) / std::log(pixelsByLongerSide);
+    }
+    else if (m_Metric == NoiseTargetMetric::meanDisplacement) {
+        return m_PixelCount == 0 ? 0.0 : m_DistanceSum / m_PixelCount;
+    }
+
+    return m_Coder.compressedSize(chainCodes).totalBits();
+}
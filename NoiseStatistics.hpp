@@ -0,0 +1,100 @@
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+#include "ArithmeticCoder.hpp"
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Metric that is driven towards a target value by the adaptive noise run.
+/// </summary>
+enum class NoiseTargetMetric {
+    fractalDimension,  // Fractal dimension (as in NoiseAnalyzer::fractalDimension).
+    meanDisplacement,  // Mean Manhattan distance of the border pixels from the original border.
+    compressedSize     // Compressed size in bits (adaptive arithmetic coder estimate).
+};
+
+
+
+/// <summary>
+/// Statistics of the noisy border that are updated incrementally with each replacement,
+/// so the target metric is evaluated without rasterizing the chain codes.
+/// </summary>
+class NoiseStatistics {
+private:
+    NoiseTargetMetric m_Metric;     // Evaluated metric.
+    uint m_CurrentChain = 0;        // Index of the chain code that is being modified.
+
+    // Number of pixels of the first chain code in each column and row (bounding box for the fractal dimension).
+    std::vector<uint> m_Columns;
+    std::vector<uint> m_Rows;
+    int m_ColumnOffset = 0;         // Coordinate of the first column.
+    int m_RowOffset = 0;            // Coordinate of the first row.
+
+    // Manhattan distance field of the original border within its bounding box (mean displacement).
+    std::vector<uint> m_Distances;
+    Pixel m_FieldOrigin;            // Coordinates of the first cell of the field.
+    int m_FieldWidth = 0;
+    int m_FieldHeight = 0;
+    double m_DistanceSum = 0.0;     // Sum of distances of the current border pixels.
+    u64 m_PixelCount = 0;           // Number of current border pixels.
+
+    ArithmeticCoder m_Coder;        // Coder for the compressed size estimate.
+
+
+    /// <summary>
+    /// Changing the count of pixels in a column or a row, extending the histogram if needed.
+    /// </summary>
+    /// <param name="counts">: histogram of columns or rows</param>
+    /// <param name="offset">: coordinate of the first histogram entry</param>
+    /// <param name="coordinate">: coordinate of the pixel</param>
+    /// <param name="increase">: true if the pixel is added, false if it is removed</param>
+    static void updateHistogram(std::vector<uint>& counts, int& offset, const int coordinate, const bool increase);
+
+    /// <summary>
+    /// Distance of a pixel from the nearest pixel of the original border.
+    /// </summary>
+    /// <param name="pixel">: pixel</param>
+    /// <returns>Manhattan distance</returns>
+    uint distance(const Pixel& pixel) const;
+
+public:
+    /// <summary>
+    /// Initialization of the statistics from the original border.
+    /// </summary>
+    /// <param name="metric">: evaluated metric</param>
+    /// <param name="chainCodes">: original chain codes</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="compressionOrder">: context order of the arithmetic coder</param>
+    NoiseStatistics(const NoiseTargetMetric metric, const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, const std::unordered_set<Pixel>& borderPixels, const uint compressionOrder = 2);
+
+    /// <summary>
+    /// Setting the chain code that is modified by the following updates.
+    /// </summary>
+    /// <param name="index">: index of the chain code</param>
+    void setCurrentChain(const uint index);
+
+    /// <summary>
+    /// Updating the statistics with a pixel added to the border.
+    /// </summary>
+    /// <param name="pixel">: added pixel</param>
+    void addPixel(const Pixel& pixel);
+
+    /// <summary>
+    /// Updating the statistics with a pixel removed from the border.
+    /// </summary>
+    /// <param name="pixel">: removed pixel</param>
+    void removePixel(const Pixel& pixel);
+
+    /// <summary>
+    /// Current value of the metric.
+    /// </summary>
+    /// <param name="chainCodes">: current chain codes</param>
+    /// <returns>Metric value</returns>
+    double value(const std::vector<ChainCode>& chainCodes);
+};
@@ -0,0 +1,49 @@
+#include <exception>
+#include <utility>
+
+#include "NoiseWorker.hpp"
+
+
+NoiseWorker::NoiseWorker(ChainCodeNoise& chainCodeNoise, const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel> borderPixels, const double noiseProbability, const uint numberOfIterations, const std::string& name, QObject* parent) :
+    QThread(parent),
+    m_ChainCodeNoise(chainCodeNoise),
+    m_ChainCodes(chainCodes),
+    m_StartPixels(startPixels),
+    m_BorderPixels(std::move(borderPixels)),
+    m_NoiseProbability(noiseProbability),
+    m_NumberOfIterations(numberOfIterations),
+    m_Name(name),
+    m_Monitor([this]() { emit progressed(); }, 0.1, true)
+{}
+
+void NoiseWorker::run() {
+    // Exceptions must not leave the thread, the message is passed to the GUI instead.
+    m_ChainCodeNoise.setMonitor(&m_Monitor);
+    try {
+        m_ChainCodes = m_ChainCodeNoise.applyNoise(m_ChainCodes, m_StartPixels, m_BorderPixels, m_NoiseProbability, m_NumberOfIterations, m_Name);
+    }
+    catch (const std::exception& exception) {
+        m_Error = exception.what();
+    }
+    m_ChainCodeNoise.setMonitor(nullptr);
+}
+
+void NoiseWorker::cancel() {
+    m_Monitor.cancel();
+}
+
+bool NoiseWorker::isCancelled() const {
+    return m_Monitor.isCancelled();
+}
+
+NoiseMonitor& NoiseWorker::monitor() {
+    return m_Monitor;
+}
+
+const std::vector<ChainCode>& NoiseWorker::result() const {
+    return m_ChainCodes;
+}
+
+const std::string& NoiseWorker::error() const {
+    return m_Error;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QThread>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "ChainCodeNoise.hpp"
+#include "NoiseMonitor.hpp"
+
+
+/// <summary>
+/// Thread that runs ChainCodeNoise::applyNoise outside of the GUI thread. Progress is reported by the throttled
+/// progressed signal (the receiver takes it, with the border changes, from the monitor), the run is stopped by
+/// cancel, and the noisy chain codes are available once the thread is finished.
+/// </summary>
+class NoiseWorker : public QThread {
+    Q_OBJECT
+
+// PRIVATE VARIABLES
+private:
+    ChainCodeNoise& m_ChainCodeNoise;          // Noise algorithm (not used by anybody else during the run).
+    std::vector<ChainCode> m_ChainCodes;       // Input chain codes, replaced by the noisy ones.
+    std::vector<Pixel> m_StartPixels;          // Starting pixels of the chain codes.
+    std::unordered_set<Pixel> m_BorderPixels;  // Hash table of border pixels.
+    double m_NoiseProbability;                 // Probability of the noise.
+    uint m_NumberOfIterations;                 // Number of algorithm iterations.
+    std::string m_Name;                        // Name of the chain code group.
+    NoiseMonitor m_Monitor;                    // Progress, cancellation and border changes of the run.
+    std::string m_Error;                       // Message of the exception that stopped the run (empty if none).
+
+// SIGNALS
+signals:
+    /// <summary>
+    /// New progress was published (at most once per notification interval, emitted from the worker thread).
+    /// </summary>
+    void progressed();
+
+// PRIVATE METHODS
+private:
+    /// <summary>
+    /// Running the noise application.
+    /// </summary>
+    void run() override;
+
+// PUBLIC METHODS
+public:
+    /// <summary>
+    /// Constructor of the noise worker.
+    /// </summary>
+    /// <param name="chainCodeNoise">: noise algorithm</param>
+    /// <param name="chainCodes">: given chain codes</param>
+    /// <param name="startPixels">: starting pixels of each given chain code</param>
+    /// <param name="borderPixels">: hash table of border pixels</param>
+    /// <param name="noiseProbability">: probability of the noise</param>
+    /// <param name="numberOfIterations">: number of algorithm iterations</param>
+    /// <param name="name">: name of chain code group</param>
+    /// <param name="parent">: parent object</param>
+    NoiseWorker(ChainCodeNoise& chainCodeNoise, const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels, std::unordered_set<Pixel> borderPixels, const double noiseProbability, const uint numberOfIterations, const std::string& name, QObject* parent = nullptr);
+
+    /// <summary>
+    /// Requesting the run to stop after the current chain code.
+    /// </summary>
+    void cancel();
+
+    /// <summary>
+    /// Checking whether the run was cancelled.
+    /// </summary>
+    /// <returns>True if cancel was called</returns>
+    bool isCancelled() const;
+
+    /// <summary>
+    /// Monitor of the run (source of the progress and of the border changes).
+    /// </summary>
+    /// <returns>Monitor</returns>
+    NoiseMonitor& monitor();
+
+    /// <summary>
+    /// Noisy chain codes (valid once the thread is finished).
+    /// </summary>
+    /// <returns>Vector of noisified chain codes</returns>
+    const std::vector<ChainCode>& result() const;
+
+    /// <summary>
+    /// Message of the exception that stopped the run.
+    /// </summary>
+    /// <returns>Message (empty if the run did not fail)</returns>
+    const std::string& error() const;
+};
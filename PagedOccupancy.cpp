@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include "PagedOccupancy.hpp"
+
+
+namespace {
+    constexpr uint MIN_FRAMES = 16;
+    constexpr int TILE_MASK = (1 << PagedOccupancy::TILE_SHIFT) - 1;
+
+    u64 tileKey(const int x, const int y) {
+        return (static_cast<u64>(static_cast<uint>(x)) << 32) | static_cast<uint>(y);
+    }
+}
+
+
+
+PagedOccupancy::PagedOccupancy(const std::string& file, const size_t memoryBudget) :
+    m_MaxFrames(static_cast<uint>(std::max<size_t>(MIN_FRAMES, memoryBudget / TILE_BYTES))),
+    m_FileName(file)
+{
+    m_Bits.reset(new u64[static_cast<size_t>(m_MaxFrames) * TILE_WORDS]);
+    m_Frames.reserve(m_MaxFrames);
+    m_File.open(file, std::ios_base::in | std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!m_File.is_open()) {
+        throw std::logic_error("File of the paged tiles could not be created.");
+    }
+}
+
+PagedOccupancy::~PagedOccupancy() {
+    m_File.close();
+    std::error_code error;
+    std::filesystem::remove(m_FileName, error);
+}
+
+uint PagedOccupancy::freeFrame() {
+    if (m_Frames.size() < m_MaxFrames) {
+        m_Frames.emplace_back();
+        return static_cast<uint>(m_Frames.size() - 1);
+    }
+
+    // Clock sweep: frames used since the last pass of the hand get a second chance.
+    while (m_Frames[m_Hand].used) {
+        m_Frames[m_Hand].used = false;
+        m_Hand = (m_Hand + 1) % m_Frames.size();
+    }
+    const uint frame = static_cast<uint>(m_Hand);
+    m_Hand = (m_Hand + 1) % m_Frames.size();
+
+    // Writing the victim if it changed since it was loaded.
+    Frame& victim = m_Frames[frame];
+    TileEntry& entry = m_Tiles.find(victim.key)->second;
+    if (victim.dirty) {
+        if (entry.slot == NONE) {
+            entry.slot = m_Slots++;
+        }
+        m_File.seekp(static_cast<std::streamoff>(entry.slot) * TILE_BYTES);
+        m_File.write(reinterpret_cast<const char*>(&m_Bits[static_cast<size_t>(frame) * TILE_WORDS]), TILE_BYTES);
+        if (!m_File) {
+            throw std::logic_error("Tile could not be written.");
+        }
+        m_Writes++;
+    }
+    entry.frame = NONE;
+    if (m_LastFrame == frame) {
+        m_LastKey = ~0ull;
+        m_LastFrame = NONE;
+    }
+
+    return frame;
+}
+
+uint PagedOccupancy::frameOf(const Pixel& pixel, const bool create) {
+    const u64 key = tileKey(pixel.x >> TILE_SHIFT, pixel.y >> TILE_SHIFT);
+    if (key == m_LastKey) {
+        m_Frames[m_LastFrame].used = true;
+        return m_LastFrame;
+    }
+
+    auto found = m_Tiles.find(key);
+    if (found == m_Tiles.end()) {
+        if (!create) {
+            return NONE;
+        }
+        found = m_Tiles.emplace(key, TileEntry()).first;
+    }
+
+    uint frame = found->second.frame;
+    if (frame == NONE) {
+        // Paging the tile in.
+        frame = freeFrame();
+        TileEntry& entry = found->second;
+        u64* bits = &m_Bits[static_cast<size_t>(frame) * TILE_WORDS];
+        if (entry.slot == NONE) {
+            std::memset(bits, 0, TILE_BYTES);
+        }
+        else {
+            m_File.seekg(static_cast<std::streamoff>(entry.slot) * TILE_BYTES);
+            m_File.read(reinterpret_cast<char*>(bits), TILE_BYTES);
+            if (!m_File) {
+                throw std::logic_error("Tile could not be read.");
+            }
+            m_Loads++;
+        }
+        entry.frame = frame;
+        m_Frames[frame].key = key;
+        m_Frames[frame].dirty = false;
+    }
+
+    m_Frames[frame].used = true;
+    m_LastKey = key;
+    m_LastFrame = frame;
+    return frame;
+}
+
+std::pair<u64*, u64> PagedOccupancy::bit(const uint frame, const Pixel& pixel) const {
+    const size_t index = static_cast<size_t>(pixel.y & TILE_MASK) * (1 << TILE_SHIFT) + (pixel.x & TILE_MASK);
+    return { &m_Bits[static_cast<size_t>(frame) * TILE_WORDS + index / 64], 1ull << (index % 64) };
+}
+
+bool PagedOccupancy::contains(const Pixel& pixel) {
+    const uint frame = frameOf(pixel, false);
+    if (frame == NONE) {
+        return false;
+    }
+    const auto [word, mask] = bit(frame, pixel);
+    return (*word & mask) != 0;
+}
+
+bool PagedOccupancy::insert(const Pixel& pixel) {
+    const uint frame = frameOf(pixel, true);
+    const auto [word, mask] = bit(frame, pixel);
+    if ((*word & mask) != 0) {
+        return false;
+    }
+    *word |= mask;
+    m_Frames[frame].dirty = true;
+    return true;
+}
+
+bool PagedOccupancy::erase(const Pixel& pixel) {
+    const uint frame = frameOf(pixel, false);
+    if (frame == NONE) {
+        return false;
+    }
+    const auto [word, mask] = bit(frame, pixel);
+    if ((*word & mask) == 0) {
+        return false;
+    }
+    *word &= ~mask;
+    m_Frames[frame].dirty = true;
+    return true;
+}
+
+u64 PagedOccupancy::tiles() const {
+    return m_Tiles.size();
+}
+
+u64 PagedOccupancy::loads() const {
+    return m_Loads;
+}
+
+u64 PagedOccupancy::writes() const {
+    return m_Writes;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Set of border pixels stored as bit tiles of 128x128 pixels, of which only as many as fit into the memory
+/// budget are kept in memory. Other tiles are paged out to a file, chosen by the clock algorithm (tiles used
+/// since the last sweep of the hand are kept); tiles that did not change since they were loaded are dropped
+/// without writing. Contours visit tiles in long sequences, so most lookups hit the last used tile.
+/// </summary>
+class PagedOccupancy {
+private:
+    static constexpr uint NONE = 0xFFFFFFFF;
+
+    // Location of a tile (in memory and in the file).
+    struct TileEntry {
+        uint frame = NONE;  // Frame of the resident tile.
+        uint slot = NONE;   // Slot of the tile in the file (assigned when the tile is first written).
+    };
+
+    // Memory slot of a resident tile.
+    struct Frame {
+        u64 key = 0;
+        bool used = false;   // Reference bit of the clock algorithm.
+        bool dirty = false;  // True if the tile changed since it was loaded.
+    };
+
+    std::unique_ptr<u64[]> m_Bits;               // Bits of the frames (allocated once, touched as frames fill up).
+    std::vector<Frame> m_Frames;                 // Frames in use.
+    uint m_MaxFrames;
+    size_t m_Hand = 0;                           // Position of the clock hand.
+    std::unordered_map<u64, TileEntry> m_Tiles;  // All tiles with a set pixel.
+    std::string m_FileName;
+    std::fstream m_File;
+    uint m_Slots = 0;                            // Number of slots in the file.
+    u64 m_LastKey = ~0ull;                       // Tile of the last lookup (the frame is valid while it is resident).
+    uint m_LastFrame = NONE;
+    u64 m_Loads = 0;
+    u64 m_Writes = 0;
+
+    /// <summary>
+    /// Frame of the tile that contains the pixel, paging the tile in if needed.
+    /// </summary>
+    /// <param name="pixel">: pixel</param>
+    /// <param name="create">: true - an empty tile is created if there is none</param>
+    /// <returns>Index of the frame, NONE if the tile does not exist</returns>
+    uint frameOf(const Pixel& pixel, const bool create);
+
+    /// <summary>
+    /// Freeing a frame for a tile (a new frame while the budget allows it, otherwise the victim of the clock).
+    /// </summary>
+    /// <returns>Index of the frame</returns>
+    uint freeFrame();
+
+    /// <summary>
+    /// Bit of the pixel in its frame.
+    /// </summary>
+    /// <param name="frame">: index of the frame</param>
+    /// <param name="pixel">: pixel</param>
+    /// <returns>Word with the bit and the mask of the bit</returns>
+    std::pair<u64*, u64> bit(const uint frame, const Pixel& pixel) const;
+
+public:
+    static constexpr int TILE_SHIFT = 7;                                       // Tiles of 128x128 pixels.
+    static constexpr size_t TILE_WORDS = (1 << TILE_SHIFT) * (1 << TILE_SHIFT) / 64;
+    static constexpr size_t TILE_BYTES = TILE_WORDS * sizeof(u64);
+
+    /// <summary>
+    /// Constructor of PagedOccupancy.
+    /// </summary>
+    /// <param name="file">: path to the file of the paged-out tiles (removed by the destructor)</param>
+    /// <param name="memoryBudget">: memory for the resident tiles in bytes (at least 16 tiles are kept)</param>
+    PagedOccupancy(const std::string& file, const size_t memoryBudget);
+
+    PagedOccupancy(const PagedOccupancy&) = delete;
+    PagedOccupancy& operator=(const PagedOccupancy&) = delete;
+
+    /// <summary>
+    /// Destructor that removes the file of the paged-out tiles.
+    /// </summary>
+    ~PagedOccupancy();
+
+    /// <summary>
+    /// Checking whether the pixel is in the set.
+    /// </summary>
+    bool contains(const Pixel& pixel);
+
+    /// <summary>
+    /// Adding a pixel.
+    /// </summary>
+    /// <returns>True if the pixel was not in the set</returns>
+    bool insert(const Pixel& pixel);
+
+    /// <summary>
+    /// Removing a pixel.
+    /// </summary>
+    /// <returns>True if the pixel was in the set</returns>
+    bool erase(const Pixel& pixel);
+
+    /// <summary>
+    /// Number of tiles with a set pixel.
+    /// </summary>
+    u64 tiles() const;
+
+    /// <summary>
+    /// Number of tiles read from the file.
+    /// </summary>
+    u64 loads() const;
+
+    /// <summary>
+    /// Number of tiles written to the file.
+    /// </summary>
+    u64 writes() const;
+};
@@ -0,0 +1,42 @@
+#include "RepeatedPixels.hpp"
+
+
+void RepeatedPixels::clear() {
+    m_Visits.clear();
+}
+
+size_t RepeatedPixels::size() const {
+    return m_Visits.size();
+}
+
+void RepeatedPixels::count(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels) {
+    m_Visits.clear();
+    std::unordered_set<Pixel> pixels;
+    for (size_t i = 0; i < chainCodes.size(); i++) {
+        Pixel pixel = startPixels[i];
+        for (const short command : chainCodes[i].code) {
+            pixel = ChainCodeFunctions::chainCodeMove(chainCodes[i].type, command, pixel);
+            insert(pixels, pixel);
+        }
+        if (!(pixel == startPixels[i])) {
+            insert(pixels, startPixels[i]);
+        }
+    }
+}
+
+void RepeatedPixels::count(const std::vector<RunLengthChainCode>& chainCodes, const std::vector<Pixel>& startPixels) {
+    m_Visits.clear();
+    std::unordered_set<Pixel> pixels;
+    for (size_t i = 0; i < chainCodes.size(); i++) {
+        Pixel pixel = startPixels[i];
+        for (const ChainCodeRun& run : chainCodes[i].runs()) {
+            for (uint j = 0; j < run.length; j++) {
+                pixel = ChainCodeFunctions::chainCodeMove(chainCodes[i].type(), run.command, pixel);
+                insert(pixels, pixel);
+            }
+        }
+        if (!(pixel == startPixels[i])) {
+            insert(pixels, startPixels[i]);
+        }
+    }
+}
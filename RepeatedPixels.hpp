@@ -0,0 +1,102 @@
+#pragma once
+
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+#include "RunLengthChainCode.hpp"
+
+
+/// <summary>
+/// Visits of border pixels that more than one position of the contours lies on (a contour that touches itself in
+/// the input, contours that share a pixel). A set of border pixels cannot tell them apart, so a replacement that
+/// moves one visit away would erase a pixel that is still on the border. Replacements insert and erase the pixels
+/// through this class, which keeps such a pixel until its last visit is gone; the border pixels then remain equal
+/// to the pixels traced from the chain codes after any number of replacements.
+/// Positions of a contour are the pixels after each of its commands, and its starting pixel if it is not closed.
+/// </summary>
+class RepeatedPixels {
+private:
+    std::unordered_map<Pixel, uint> m_Visits;  // Visits of each repeated pixel beyond the first.
+
+public:
+    /// <summary>
+    /// Removing all visits.
+    /// </summary>
+    void clear();
+
+    /// <summary>
+    /// Number of pixels with more than one visit.
+    /// </summary>
+    size_t size() const;
+
+    /// <summary>
+    /// Counting the visits of the positions of chain codes (the border pixels themselves are not changed).
+    /// </summary>
+    /// <param name="chainCodes">: chain codes (F4 or F8)</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    void count(const std::vector<ChainCode>& chainCodes, const std::vector<Pixel>& startPixels);
+
+    /// <summary>
+    /// Counting the visits of the positions of run-length encoded chain codes.
+    /// </summary>
+    /// <param name="chainCodes">: run-length encoded chain codes (F4 or F8)</param>
+    /// <param name="startPixels">: starting pixels of each chain code</param>
+    void count(const std::vector<RunLengthChainCode>& chainCodes, const std::vector<Pixel>& startPixels);
+
+    /// <summary>
+    /// Adding a visit of a pixel.
+    /// </summary>
+    /// <param name="borderPixels">: border pixels (unordered_set or an occupancy with insert and erase)</param>
+    /// <param name="pixel">: visited pixel</param>
+    /// <returns>True if the pixel was added to the border pixels, false if it was there already</returns>
+    template<typename Set>
+    bool insert(Set& borderPixels, const Pixel& pixel);
+
+    /// <summary>
+    /// Removing a visit of a pixel.
+    /// </summary>
+    /// <param name="borderPixels">: border pixels (unordered_set or an occupancy with insert and erase)</param>
+    /// <param name="pixel">: pixel that is left</param>
+    /// <returns>True if the pixel was removed from the border pixels, false if it is still visited</returns>
+    template<typename Set>
+    bool erase(Set& borderPixels, const Pixel& pixel);
+};
+
+
+
+template<typename Set>
+bool RepeatedPixels::insert(Set& borderPixels, const Pixel& pixel) {
+    // Hash sets report the insertion with the iterator, occupancies return it directly.
+    bool inserted;
+    if constexpr (std::is_same_v<Set, std::unordered_set<Pixel>>) {
+        inserted = borderPixels.insert(pixel).second;
+    }
+    else {
+        inserted = borderPixels.insert(pixel);
+    }
+
+    if (!inserted) {
+        m_Visits[pixel]++;
+    }
+    return inserted;
+}
+
+template<typename Set>
+bool RepeatedPixels::erase(Set& borderPixels, const Pixel& pixel) {
+    // Most contours never visit a pixel twice, so the common case costs no lookup.
+    if (!m_Visits.empty()) {
+        const auto found = m_Visits.find(pixel);
+        if (found != m_Visits.end()) {
+            if (--found->second == 0) {
+                m_Visits.erase(found);
+            }
+            return false;
+        }
+    }
+    return borderPixels.erase(pixel) > 0;
+}
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "ChainCodeTranscoder.hpp"
+#include "RunLengthChainCode.hpp"
+
+
+RunLengthChainCode::RunLengthChainCode(const ChainCodeType type, const int startX, const int startY, const short initialDirection) :
+    m_Type(type),
+    m_StartX(startX),
+    m_StartY(startY),
+    m_InitialDirection(initialDirection)
+{
+}
+
+RunLengthChainCode::RunLengthChainCode(const ChainCode& chainCode) :
+    RunLengthChainCode(chainCode.type, chainCode.startX, chainCode.startY, chainCode.initialDirection)
+{
+    for (const short command : chainCode.code) {
+        append(command);
+    }
+}
+
+ChainCode RunLengthChainCode::toChainCode() const {
+    ChainCode chainCode("", m_Type, m_StartX, m_StartY, m_InitialDirection);
+    chainCode.code.reserve(m_Size);
+    for (const ChainCodeRun& run : m_Runs) {
+        chainCode.code.insert(chainCode.code.end(), run.length, run.command);
+    }
+
+    return chainCode;
+}
+
+std::vector<Pixel> RunLengthChainCode::toCoordinates() const {
+    // Relative chain codes are decoded to F4 first.
+    if (m_Type == ChainCodeType::VCC || m_Type == ChainCodeType::ThreeOT) {
+        return RunLengthChainCode(ChainCodeTranscoder::transcode(toChainCode(), ChainCodeType::F4)).toCoordinates();
+    }
+
+    std::vector<Pixel> coordinates;
+    coordinates.reserve(m_Size + 1);
+    int x = m_StartX;
+    int y = m_StartY;
+    coordinates.push_back(Pixel(x, y));
+
+    // The step of a run is determined once and the run is filled with it.
+    for (const ChainCodeRun& run : m_Runs) {
+        const Pixel step = moveRun(m_Type, run.command, 1, Pixel(0, 0));
+        for (uint i = 0; i < run.length; i++) {
+            x += step.x;
+            y += step.y;
+            coordinates.push_back(Pixel(x, y));
+        }
+    }
+
+    return coordinates;
+}
+
+std::pair<Pixel, Pixel> RunLengthChainCode::boundingBox() const {
+    if (m_Type == ChainCodeType::VCC || m_Type == ChainCodeType::ThreeOT) {
+        return RunLengthChainCode(ChainCodeTranscoder::transcode(toChainCode(), ChainCodeType::F4)).boundingBox();
+    }
+
+    // Coordinates change monotonically within a run, so the extremes lie at the ends of the runs.
+    Pixel pixel(m_StartX, m_StartY);
+    Pixel minPixel(pixel);
+    Pixel maxPixel(pixel);
+    for (const ChainCodeRun& run : m_Runs) {
+        pixel = moveRun(m_Type, run.command, run.length, pixel);
+        minPixel.x = std::min(minPixel.x, pixel.x);
+        minPixel.y = std::min(minPixel.y, pixel.y);
+        maxPixel.x = std::max(maxPixel.x, pixel.x);
+        maxPixel.y = std::max(maxPixel.y, pixel.y);
+    }
+
+    return { minPixel, maxPixel };
+}
+
+Pixel RunLengthChainCode::endPixel() const {
+    if (m_Type == ChainCodeType::VCC || m_Type == ChainCodeType::ThreeOT) {
+        return RunLengthChainCode(ChainCodeTranscoder::transcode(toChainCode(), ChainCodeType::F4)).endPixel();
+    }
+
+    Pixel pixel(m_StartX, m_StartY);
+    for (const ChainCodeRun& run : m_Runs) {
+        pixel = moveRun(m_Type, run.command, run.length, pixel);
+    }
+
+    return pixel;
+}
+
+void RunLengthChainCode::append(const short command, const u64 count) {
+    if (count == 0) {
+        return;
+    }
+    m_Size += count;
+
+    // Extending the last run (runs longer than the length type are split).
+    u64 remaining = count;
+    if (!m_Runs.empty() && m_Runs.back().command == command) {
+        const u64 added = std::min<u64>(remaining, std::numeric_limits<uint>::max() - m_Runs.back().length);
+        m_Runs.back().length += static_cast<uint>(added);
+        remaining -= added;
+    }
+    while (remaining > 0) {
+        const u64 length = std::min<u64>(remaining, std::numeric_limits<uint>::max());
+        m_Runs.push_back({ command, static_cast<uint>(length) });
+        remaining -= length;
+    }
+}
+
+RunLengthChainCode RunLengthChainCode::emptyCopy() const {
+    return RunLengthChainCode(m_Type, m_StartX, m_StartY, m_InitialDirection);
+}
+
+const std::vector<ChainCodeRun>& RunLengthChainCode::runs() const {
+    return m_Runs;
+}
+
+ChainCodeType RunLengthChainCode::type() const {
+    return m_Type;
+}
+
+u64 RunLengthChainCode::size() const {
+    return m_Size;
+}
+
+size_t RunLengthChainCode::memoryBytes() const {
+    return sizeof(RunLengthChainCode) + m_Runs.capacity() * sizeof(ChainCodeRun);
+}
+
+Pixel RunLengthChainCode::moveRun(const ChainCodeType type, const short command, const u64 length, const Pixel& pixel) {
+    int dx = 0;
+    int dy = 0;
+
+    // F8 chain code.
+    if (type == ChainCodeType::F8) {
+        if (command < 0 || command > 7) {
+            throw std::logic_error("Invalid chain code command.");
+        }
+        static const int DX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+        static const int DY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+        dx = DX[command];
+        dy = DY[command];
+    }
+    // F4 chain code.
+    else if (type == ChainCodeType::F4) {
+        if (command < 0 || command > 3) {
+            throw std::logic_error("Invalid chain code command.");
+        }
+        static const int DX[4] = { 1, 0, -1, 0 };
+        static const int DY[4] = { 0, 1, 0, -1 };
+        dx = DX[command];
+        dy = DY[command];
+    }
+    else {
+        throw std::logic_error("Invalid chain code type.");
+    }
+
+    const int steps = static_cast<int>(length);
+    return Pixel(pixel.x + dx * steps, pixel.y + dy * steps);
+}
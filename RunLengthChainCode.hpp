@@ -0,0 +1,117 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Run of equal chain code commands.
+/// </summary>
+struct ChainCodeRun {
+    short command;  // Repeated command.
+    uint length;    // Number of repetitions.
+};
+
+
+
+/// <summary>
+/// Run-length encoded chain code. Shapes dominated by straight runs (lines, rectangles, scanned contours) are
+/// stored as a few runs, so decoding, the bounding box and moving along the contour handle a whole run at once.
+/// Neighbouring runs never have the same command.
+/// </summary>
+class RunLengthChainCode {
+private:
+    std::vector<ChainCodeRun> m_Runs;
+    ChainCodeType m_Type;
+    int m_StartX;
+    int m_StartY;
+    short m_InitialDirection;
+    u64 m_Size = 0;  // Number of commands.
+
+public:
+    /// <summary>
+    /// Constructor of an empty chain code.
+    /// </summary>
+    /// <param name="type">: type of the chain code</param>
+    /// <param name="startX">: X start coordinate</param>
+    /// <param name="startY">: Y start coordinate</param>
+    /// <param name="initialDirection">: F4 direction preceding the first command (VCC and 3OT only)</param>
+    RunLengthChainCode(const ChainCodeType type, const int startX, const int startY, const short initialDirection = 0);
+
+    /// <summary>
+    /// Encoding a chain code.
+    /// </summary>
+    /// <param name="chainCode">: chain code</param>
+    RunLengthChainCode(const ChainCode& chainCode);
+
+    /// <summary>
+    /// Decoding into a chain code.
+    /// </summary>
+    /// <returns>Chain code</returns>
+    ChainCode toChainCode() const;
+
+    /// <summary>
+    /// Transforming the chain code to the vector of coordinates (each run is filled with one step).
+    /// </summary>
+    /// <returns>Vector of pixels</returns>
+    std::vector<Pixel> toCoordinates() const;
+
+    /// <summary>
+    /// Extreme coordinates of the chain code, which lie at the ends of the runs.
+    /// </summary>
+    /// <returns>Pixel(xMin, yMin), Pixel(xMax, yMax)</returns>
+    std::pair<Pixel, Pixel> boundingBox() const;
+
+    /// <summary>
+    /// Last pixel of the chain code.
+    /// </summary>
+    /// <returns>Pixel</returns>
+    Pixel endPixel() const;
+
+    /// <summary>
+    /// Appending repetitions of a command (merged with the last run if it has the same command).
+    /// </summary>
+    /// <param name="command">: chain code command</param>
+    /// <param name="count">: number of repetitions</param>
+    void append(const short command, const u64 count = 1);
+
+    /// <summary>
+    /// Empty chain code with the type and start of this one.
+    /// </summary>
+    /// <returns>Empty chain code</returns>
+    RunLengthChainCode emptyCopy() const;
+
+    /// <summary>
+    /// Runs of the chain code.
+    /// </summary>
+    const std::vector<ChainCodeRun>& runs() const;
+
+    /// <summary>
+    /// Type of the chain code.
+    /// </summary>
+    ChainCodeType type() const;
+
+    /// <summary>
+    /// Number of commands.
+    /// </summary>
+    u64 size() const;
+
+    /// <summary>
+    /// Memory used by the runs in bytes.
+    /// </summary>
+    size_t memoryBytes() const;
+
+    /// <summary>
+    /// Moving by a run of commands (F4 and F8).
+    /// </summary>
+    /// <param name="type">: chain code type</param>
+    /// <param name="command">: command of the run</param>
+    /// <param name="length">: length of the run</param>
+    /// <param name="pixel">: starting pixel</param>
+    /// <returns>Pixel at the end of the run</returns>
+    static Pixel moveRun(const ChainCodeType type, const short command, const u64 length, const Pixel& pixel);
+};
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "SharedChainCode.hpp"
+
+
+SharedChainCode::SharedChainCode(const ChainCodeType type, const int startX, const int startY, const short initialDirection) :
+    m_Type(type),
+    m_StartX(startX),
+    m_StartY(startY),
+    m_InitialDirection(initialDirection)
+{
+}
+
+SharedChainCode::SharedChainCode(const ChainCode& chainCode, const uint chunkSize) :
+    SharedChainCode(chainCode.type, chainCode.startX, chainCode.startY, chainCode.initialDirection)
+{
+    if (chunkSize == 0) {
+        throw std::logic_error("Chunk size must be positive.");
+    }
+
+    for (size_t i = 0; i < chainCode.code.size(); i += chunkSize) {
+        const size_t end = std::min(chainCode.code.size(), i + chunkSize);
+        appendChunk(std::make_shared<const Chunk>(chainCode.code.begin() + i, chainCode.code.begin() + end));
+    }
+}
+
+ChainCode SharedChainCode::toChainCode() const {
+    ChainCode chainCode("", m_Type, m_StartX, m_StartY, m_InitialDirection);
+    chainCode.code.reserve(m_Size);
+    for (const std::shared_ptr<const Chunk>& chunk : m_Chunks) {
+        chainCode.code.insert(chainCode.code.end(), chunk->begin(), chunk->end());
+    }
+
+    return chainCode;
+}
+
+void SharedChainCode::appendChunk(const std::shared_ptr<const Chunk>& chunk) {
+    if (chunk->empty()) {
+        return;
+    }
+    m_Chunks.push_back(chunk);
+    m_Size += chunk->size();
+}
+
+SharedChainCode SharedChainCode::emptyCopy() const {
+    return SharedChainCode(m_Type, m_StartX, m_StartY, m_InitialDirection);
+}
+
+const std::vector<std::shared_ptr<const SharedChainCode::Chunk>>& SharedChainCode::chunks() const {
+    return m_Chunks;
+}
+
+ChainCodeType SharedChainCode::type() const {
+    return m_Type;
+}
+
+u64 SharedChainCode::size() const {
+    return m_Size;
+}
+
+size_t SharedChainCode::memoryBytes(std::unordered_set<const void*>& counted) const {
+    size_t bytes = sizeof(SharedChainCode) + m_Chunks.capacity() * sizeof(std::shared_ptr<const Chunk>);
+    for (const std::shared_ptr<const Chunk>& chunk : m_Chunks) {
+        if (counted.insert(chunk.get()).second) {
+            bytes += sizeof(Chunk) + chunk->capacity() * sizeof(short);
+        }
+    }
+
+    return bytes;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+
+
+/// <summary>
+/// Chain code whose commands are stored in immutable chunks. Copies share the chunks, so a snapshot costs one
+/// pointer per chunk, and a noise iteration allocates only the chunks in which a replacement was applied.
+/// </summary>
+class SharedChainCode {
+public:
+    using Chunk = std::vector<short>;
+
+private:
+    std::vector<std::shared_ptr<const Chunk>> m_Chunks;
+    ChainCodeType m_Type;
+    int m_StartX;
+    int m_StartY;
+    short m_InitialDirection;
+    u64 m_Size = 0;  // Number of commands.
+
+public:
+    /// <summary>
+    /// Constructor of an empty chain code.
+    /// </summary>
+    /// <param name="type">: type of the chain code</param>
+    /// <param name="startX">: X start coordinate</param>
+    /// <param name="startY">: Y start coordinate</param>
+    /// <param name="initialDirection">: F4 direction preceding the first command (VCC and 3OT only)</param>
+    SharedChainCode(const ChainCodeType type, const int startX, const int startY, const short initialDirection = 0);
+
+    /// <summary>
+    /// Splitting a chain code into chunks.
+    /// </summary>
+    /// <param name="chainCode">: chain code</param>
+    /// <param name="chunkSize">: number of commands per chunk</param>
+    SharedChainCode(const ChainCode& chainCode, const uint chunkSize = 256);
+
+    /// <summary>
+    /// Joining the chunks into a chain code.
+    /// </summary>
+    /// <returns>Chain code</returns>
+    ChainCode toChainCode() const;
+
+    /// <summary>
+    /// Appending a chunk (empty chunks are ignored).
+    /// </summary>
+    /// <param name="chunk">: chunk of commands</param>
+    void appendChunk(const std::shared_ptr<const Chunk>& chunk);
+
+    /// <summary>
+    /// Empty chain code with the type and start of this one.
+    /// </summary>
+    /// <returns>Empty chain code</returns>
+    SharedChainCode emptyCopy() const;
+
+    /// <summary>
+    /// Chunks of the chain code.
+    /// </summary>
+    const std::vector<std::shared_ptr<const Chunk>>& chunks() const;
+
+    /// <summary>
+    /// Type of the chain code.
+    /// </summary>
+    ChainCodeType type() const;
+
+    /// <summary>
+    /// Number of commands.
+    /// </summary>
+    u64 size() const;
+
+    /// <summary>
+    /// Adding the memory of the chunks that were not counted yet.
+    /// </summary>
+    /// <param name="counted">: chunks that were already counted (updated)</param>
+    /// <returns>Number of bytes of the chunk list and the newly counted chunks</returns>
+    size_t memoryBytes(std::unordered_set<const void*>& counted) const;
+};
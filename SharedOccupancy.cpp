@@ -0,0 +1,119 @@
+#include "SharedOccupancy.hpp"
+
+
+u64 SharedOccupancy::regionKey(const Pixel& pixel) {
+    const int shift = TILE_SHIFT + REGION_SHIFT;
+    return (static_cast<u64>(static_cast<uint>(pixel.x >> shift)) << 32) | static_cast<uint>(pixel.y >> shift);
+}
+
+u64 SharedOccupancy::tileKey(const Pixel& pixel) {
+    return (static_cast<u64>(static_cast<uint>(pixel.x >> TILE_SHIFT)) << 32) | static_cast<uint>(pixel.y >> TILE_SHIFT);
+}
+
+size_t SharedOccupancy::tileIndex(const Pixel& pixel) {
+    const int mask = REGION_SIZE - 1;
+    return static_cast<size_t>(((pixel.y >> TILE_SHIFT) & mask) * REGION_SIZE + ((pixel.x >> TILE_SHIFT) & mask));
+}
+
+SharedOccupancy::SharedOccupancy() :
+    m_Regions(std::make_shared<Regions>())
+{}
+
+SharedOccupancy::SharedOccupancy(const std::unordered_set<Pixel>& pixels) :
+    SharedOccupancy()
+{
+    for (const Pixel& pixel : pixels) {
+        insert(pixel);
+    }
+}
+
+const SharedOccupancy::Tile* SharedOccupancy::findTile(const Pixel& pixel) const {
+    const u64 key = tileKey(pixel);
+    if (key == m_LastKey) {
+        return m_LastTile;
+    }
+
+    const auto found = m_Regions->find(regionKey(pixel));
+    const Tile* tile = found == m_Regions->end() ? nullptr : found->second->tiles[tileIndex(pixel)].get();
+    if (tile != nullptr) {
+        m_LastKey = key;
+        m_LastTile = tile;
+    }
+    return tile;
+}
+
+SharedOccupancy::Tile* SharedOccupancy::writableTile(const Pixel& pixel, const bool create) {
+    // A copy only writes to blocks it owns alone; shared blocks are copied on the way down.
+    auto found = m_Regions->find(regionKey(pixel));
+    if (found == m_Regions->end() && !create) {
+        return nullptr;
+    }
+    if (m_Regions.use_count() > 1) {
+        m_Regions = std::make_shared<Regions>(*m_Regions);
+        found = m_Regions->find(regionKey(pixel));
+    }
+    if (found == m_Regions->end()) {
+        found = m_Regions->emplace(regionKey(pixel), std::make_shared<Region>()).first;
+    }
+
+    std::shared_ptr<Region>& region = found->second;
+    std::shared_ptr<Tile>& existing = region->tiles[tileIndex(pixel)];
+    if (existing == nullptr && !create) {
+        return nullptr;
+    }
+    if (region.use_count() > 1) {
+        region = std::make_shared<Region>(*region);
+    }
+    std::shared_ptr<Tile>& tile = region->tiles[tileIndex(pixel)];
+    if (tile == nullptr) {
+        tile = std::make_shared<Tile>();
+    }
+    else if (tile.use_count() > 1) {
+        tile = std::make_shared<Tile>(*tile);
+    }
+
+    m_LastKey = tileKey(pixel);
+    m_LastTile = tile.get();
+    return tile.get();
+}
+
+bool SharedOccupancy::contains(const Pixel& pixel) const {
+    const Tile* tile = findTile(pixel);
+    return tile != nullptr && (tile->rows[pixel.y & (TILE_SIZE - 1)] >> (pixel.x & (TILE_SIZE - 1)) & 1) != 0;
+}
+
+bool SharedOccupancy::insert(const Pixel& pixel) {
+    if (contains(pixel)) {
+        return false;
+    }
+    writableTile(pixel, true)->rows[pixel.y & (TILE_SIZE - 1)] |= 1u << (pixel.x & (TILE_SIZE - 1));
+    return true;
+}
+
+bool SharedOccupancy::erase(const Pixel& pixel) {
+    if (!contains(pixel)) {
+        return false;
+    }
+    writableTile(pixel, false)->rows[pixel.y & (TILE_SIZE - 1)] &= ~(1u << (pixel.x & (TILE_SIZE - 1)));
+    return true;
+}
+
+size_t SharedOccupancy::memoryBytes(std::unordered_set<const void*>& counted) const {
+    size_t bytes = 0;
+    if (counted.insert(m_Regions.get()).second) {
+        bytes += sizeof(Regions) + m_Regions->size() * (sizeof(Regions::value_type) + 2 * sizeof(void*)) + m_Regions->bucket_count() * sizeof(void*);
+    }
+    for (const auto& [key, region] : *m_Regions) {
+        if (!counted.insert(region.get()).second) {
+            continue;
+        }
+        bytes += sizeof(Region);
+        for (const std::shared_ptr<Tile>& tile : region->tiles) {
+            if (tile != nullptr && counted.insert(tile.get()).second) {
+                bytes += sizeof(Tile);
+            }
+        }
+    }
+
+    return bytes;
+}
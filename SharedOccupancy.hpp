@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Constants.hpp"
+#include "Pixel.hpp"
+
+
+/// <summary>
+/// Set of border pixels as bit tiles of 32x32 pixels, grouped into regions of 4x4 tiles. Copies share the
+/// regions and tiles (copying is O(1)); a copy that changes a pixel first copies the index of the regions, the
+/// region and the tile it writes to, if they are shared with another copy. Set pixels shared by all copies are
+/// therefore stored once, and every copy adds only the tiles it changed.
+/// </summary>
+class SharedOccupancy {
+private:
+    // Contours are thin, so blocks are small: a change copies at most a tile (128 B) and a region (256 B).
+    static constexpr int TILE_SHIFT = 5;    // Tiles of 32x32 pixels.
+    static constexpr int REGION_SHIFT = 2;  // Regions of 4x4 tiles.
+    static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+    static constexpr int REGION_SIZE = 1 << REGION_SHIFT;
+
+    struct Tile {
+        std::array<uint, TILE_SIZE> rows{};  // Row 0 is the lowest, bit 0 the leftmost pixel.
+    };
+    struct Region {
+        std::array<std::shared_ptr<Tile>, REGION_SIZE * REGION_SIZE> tiles;  // Tiles of the region (null if empty).
+    };
+    using Regions = std::unordered_map<u64, std::shared_ptr<Region>>;
+
+    std::shared_ptr<Regions> m_Regions;
+    mutable u64 m_LastKey = ~0ull;          // Tile of the last lookup.
+    mutable const Tile* m_LastTile = nullptr;
+
+    static u64 regionKey(const Pixel& pixel);
+    static u64 tileKey(const Pixel& pixel);
+    static size_t tileIndex(const Pixel& pixel);
+
+    /// <summary>
+    /// Tile that contains the pixel (read only).
+    /// </summary>
+    /// <returns>Tile, nullptr if there is none</returns>
+    const Tile* findTile(const Pixel& pixel) const;
+
+    /// <summary>
+    /// Tile that contains the pixel, copied first if it is shared with another copy.
+    /// </summary>
+    /// <param name="pixel">: pixel</param>
+    /// <param name="create">: true - an empty tile is created if there is none</param>
+    /// <returns>Tile, nullptr if there is none</returns>
+    Tile* writableTile(const Pixel& pixel, const bool create);
+
+public:
+    /// <summary>
+    /// Constructor of an empty set.
+    /// </summary>
+    SharedOccupancy();
+
+    /// <summary>
+    /// Constructor of a set with the given pixels.
+    /// </summary>
+    /// <param name="pixels">: border pixels</param>
+    SharedOccupancy(const std::unordered_set<Pixel>& pixels);
+
+    /// <summary>
+    /// Checking whether the pixel is in the set.
+    /// </summary>
+    bool contains(const Pixel& pixel) const;
+
+    /// <summary>
+    /// Adding a pixel.
+    /// </summary>
+    /// <returns>True if the pixel was not in the set</returns>
+    bool insert(const Pixel& pixel);
+
+    /// <summary>
+    /// Removing a pixel.
+    /// </summary>
+    /// <returns>True if the pixel was in the set</returns>
+    bool erase(const Pixel& pixel);
+
+    /// <summary>
+    /// Adding the memory of the blocks (index, regions and tiles) that were not counted yet.
+    /// </summary>
+    /// <param name="counted">: blocks that were already counted (updated)</param>
+    /// <returns>Number of bytes of the newly counted blocks</returns>
+    size_t memoryBytes(std::unordered_set<const void*>& counted) const;
+};
@@ -0,0 +1,235 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "ChainCodeNoise.hpp"
+#include "StreamingNoise.hpp"
+
+
+namespace {
+    // Sequential reader of a file through a buffer of fixed size.
+    class ChunkReader {
+    private:
+        std::ifstream m_In;
+        std::vector<char> m_Buffer;
+        size_t m_Position = 0;
+        size_t m_Size = 0;
+
+    public:
+        ChunkReader(const std::string& file, const size_t chunkSize) :
+            m_In(file, std::ios_base::binary),
+            m_Buffer(chunkSize)
+        {
+            if (!m_In.is_open()) {
+                throw std::logic_error("File could not be found or opened.");
+            }
+        }
+
+        // Next character, -1 at the end of the file.
+        int get() {
+            if (m_Position == m_Size) {
+                m_In.read(m_Buffer.data(), m_Buffer.size());
+                m_Size = static_cast<size_t>(m_In.gcount());
+                m_Position = 0;
+                if (m_Size == 0) {
+                    return -1;
+                }
+            }
+            return static_cast<unsigned char>(m_Buffer[m_Position++]);
+        }
+
+        // Characters up to the delimiter (false if the file ends before it).
+        bool field(const char delimiter, std::string& value) {
+            value.clear();
+            for (int character = get(); character != -1; character = get()) {
+                if (character == delimiter) {
+                    return true;
+                }
+                value += static_cast<char>(character);
+            }
+            return false;
+        }
+
+        // Next command of the current line, -1 at the end of the line.
+        int command() {
+            for (int character = get(); character != -1; character = get()) {
+                if (character == '\n') {
+                    return -1;
+                }
+                if (character != '\r') {
+                    return character - '0';
+                }
+            }
+            return -1;
+        }
+    };
+
+    // Sequential writer of a file through a buffer of fixed size.
+    class ChunkWriter {
+    private:
+        std::ofstream m_Out;
+        std::vector<char> m_Buffer;
+        size_t m_Size = 0;
+
+    public:
+        ChunkWriter(const std::string& file, const size_t chunkSize) :
+            m_Out(file, std::ios_base::binary | std::ios_base::trunc),
+            m_Buffer(chunkSize)
+        {
+            if (!m_Out.is_open()) {
+                throw std::logic_error("File could not be created.");
+            }
+        }
+
+        void put(const char character) {
+            if (m_Size == m_Buffer.size()) {
+                flush();
+            }
+            m_Buffer[m_Size++] = character;
+        }
+
+        void write(const std::string& text) {
+            for (const char character : text) {
+                put(character);
+            }
+        }
+
+        void flush() {
+            m_Out.write(m_Buffer.data(), m_Size);
+            m_Size = 0;
+            if (!m_Out) {
+                throw std::logic_error("File cannot be written.");
+            }
+        }
+    };
+
+    // Reading the header of the next chain code (false at the end of the file), as readChainCodeFile does.
+    template<typename Header>
+    bool readHeader(ChunkReader& reader, Header& header) {
+        std::string value;
+        while (true) {
+            const bool found = reader.field(';', value);
+            value.erase(0, value.find_first_not_of("\r\n"));
+            if (!found) {
+                return false;
+            }
+            if (!value.empty()) {
+                break;
+            }
+        }
+        header.type = ChainCodeFunctions::stringToType(value);
+        if (header.type != ChainCodeType::F4 && header.type != ChainCodeType::F8) {
+            throw std::logic_error("Noise can only be applied to F4 and F8 chain codes.");
+        }
+
+        reader.field(';', header.orientation);
+        reader.field(',', value);
+        header.startX = std::stoi(value);
+        reader.field(';', value);
+        header.startY = -std::stoi(value);
+        reader.field(';', value);
+        header.initialDirection = 0;
+        header.headerValue = static_cast<int>(std::strtol(value.c_str(), nullptr, 10));
+
+        return true;
+    }
+
+    void checkFileHeader(ChunkReader& reader) {
+        std::string firstLine;
+        reader.field('\n', firstLine);
+        while (!firstLine.empty() && firstLine.back() == '\r') {
+            firstLine.pop_back();
+        }
+        if (firstLine != "CC Multi") {
+            throw std::logic_error("Invalid header of the chain code.");
+        }
+    }
+}
+
+
+
+StreamingNoise::StreamingNoise(ChainCodeNoise& noise, const size_t memoryBudget, const size_t chunkSize) :
+    m_Noise(noise),
+    m_MemoryBudget(memoryBudget),
+    m_ChunkSize(chunkSize)
+{}
+
+u64 StreamingNoise::traceBorderPixels(const std::string& file, PagedOccupancy& occupancy, RepeatedPixels& repeatedPixels) const {
+    ChunkReader reader(file, m_ChunkSize);
+    checkFileHeader(reader);
+
+    // Positions are counted as in RepeatedPixels::count: the starting pixel only if the contour is not closed.
+    u64 chainCodes = 0;
+    Header header;
+    while (readHeader(reader, header)) {
+        const Pixel startPixel(header.startX, header.startY);
+        Pixel pixel = startPixel;
+        for (int command = reader.command(); command != -1; command = reader.command()) {
+            pixel = ChainCodeFunctions::chainCodeMove(header.type, command, pixel);
+            repeatedPixels.insert(occupancy, pixel);
+        }
+        if (!(pixel == startPixel)) {
+            repeatedPixels.insert(occupancy, startPixel);
+        }
+        chainCodes++;
+    }
+
+    return chainCodes;
+}
+
+u64 StreamingNoise::runIteration(const std::string& inputFile, const std::string& outputFile, PagedOccupancy& occupancy, RepeatedPixels& repeatedPixels, const double noiseProbability) {
+    ChunkReader reader(inputFile, m_ChunkSize);
+    checkFileHeader(reader);
+    ChunkWriter writer(outputFile, m_ChunkSize);
+    writer.write("CC Multi\n");
+
+    u64 commands = 0;
+
+    Header header;
+    while (readHeader(reader, header)) {
+        writer.write(ChainCodeFunctions::typeToString(header.type) + ";" + header.orientation + ";" + std::to_string(header.startX) + "," + std::to_string(-header.startY) + ";" + std::to_string(header.headerValue) + ";");
+
+        const auto source = [&]() {
+            return reader.command();
+        };
+        const auto sink = [&](const short command, const u64) {
+            writer.put(static_cast<char>('0' + command));
+        };
+        commands += m_Noise.streamNoise(header.type, Pixel(header.startX, header.startY), source, sink, occupancy, repeatedPixels, m_Noise.m_Generator, noiseProbability);
+        writer.put('\n');
+    }
+    writer.flush();
+
+    return commands;
+}
+
+StreamingNoiseReport StreamingNoise::run(const std::string& inputFile, const std::string& outputFile, const double noiseProbability, const uint numberOfIterations) {
+    // The read and write buffers are taken from the budget, the rest holds the occupancy tiles.
+    const size_t buffers = 2 * m_ChunkSize;
+    PagedOccupancy occupancy(outputFile + ".tiles", m_MemoryBudget > buffers ? m_MemoryBudget - buffers : 0);
+
+    // Pixels visited more than once are few and stay in memory next to the tiles.
+    RepeatedPixels repeatedPixels;
+    StreamingNoiseReport report;
+    report.chainCodes = traceBorderPixels(inputFile, occupancy, repeatedPixels);
+
+    // Iterations alternate between two intermediate files; the last one writes the output.
+    std::string currentFile = inputFile;
+    for (uint iteration = 0; iteration < numberOfIterations; iteration++) {
+        const std::string nextFile = iteration + 1 == numberOfIterations ? outputFile : outputFile + ".part" + std::to_string(iteration % 2);
+        report.commands = runIteration(currentFile, nextFile, occupancy, repeatedPixels, noiseProbability);
+        if (currentFile != inputFile) {
+            std::filesystem::remove(currentFile);
+        }
+        currentFile = nextFile;
+    }
+    if (numberOfIterations == 0) {
+        std::filesystem::copy_file(inputFile, outputFile, std::filesystem::copy_options::overwrite_existing);
+    }
+
+    report.tiles = occupancy.tiles();
+    report.tileLoads = occupancy.loads();
+    report.tileWrites = occupancy.writes();
+    return report;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ChainCode.hpp"
+#include "Constants.hpp"
+#include "PagedOccupancy.hpp"
+#include "Pixel.hpp"
+#include "RepeatedPixels.hpp"
+
+
+class ChainCodeNoise;
+
+
+/// <summary>
+/// Summary of an out-of-core noise run.
+/// </summary>
+struct StreamingNoiseReport {
+    u64 chainCodes = 0;   // Number of chain codes.
+    u64 commands = 0;     // Number of commands of the noisy chain codes.
+    u64 tiles = 0;        // Number of occupancy tiles.
+    u64 tileLoads = 0;    // Tiles read back from the tile file.
+    u64 tileWrites = 0;   // Tiles written to the tile file.
+};
+
+
+
+/// <summary>
+/// Noise applied to a chain code file without loading it: the chain codes are read in chunks, the noisy chain
+/// codes are written as they are produced and the border pixels are kept in paged occupancy tiles, so the memory
+/// does not depend on the size of the input. Each iteration is a pass from the previous output to the next one.
+/// The replacements are decided exactly as in applyNoise with the same generator, so a seeded run produces the
+/// same chain codes as the in-memory engine.
+/// </summary>
+class StreamingNoise {
+private:
+    // Chain code header of the text format.
+    struct Header {
+        ChainCodeType type;
+        std::string orientation;
+        int startX;
+        int startY;            // Y start coordinate (negated, as read by readChainCodeFile).
+        short initialDirection;
+        int headerValue;       // Fourth header field (written back as read).
+    };
+
+    ChainCodeNoise& m_Noise;
+    size_t m_MemoryBudget;
+    size_t m_ChunkSize;
+
+    /// <summary>
+    /// Adding the pixels of all chain codes of a file to the occupancy.
+    /// </summary>
+    /// <param name="file">: chain code file</param>
+    /// <param name="occupancy">: border pixels (output)</param>
+    /// <param name="repeatedPixels">: visits of the border pixels by more than one position (output)</param>
+    /// <returns>Number of chain codes</returns>
+    u64 traceBorderPixels(const std::string& file, PagedOccupancy& occupancy, RepeatedPixels& repeatedPixels) const;
+
+    /// <summary>
+    /// Running one iteration from a file to another.
+    /// </summary>
+    /// <param name="inputFile">: chain codes before the iteration</param>
+    /// <param name="outputFile">: chain codes after the iteration</param>
+    /// <param name="occupancy">: border pixels</param>
+    /// <param name="repeatedPixels">: visits of the border pixels by more than one position</param>
+    /// <param name="noiseProbability">: probability of the noise</param>
+    /// <returns>Number of commands written</returns>
+    u64 runIteration(const std::string& inputFile, const std::string& outputFile, PagedOccupancy& occupancy, RepeatedPixels& repeatedPixels, const double noiseProbability);
+
+public:
+    /// <summary>
+    /// Constructor of StreamingNoise.
+    /// </summary>
+    /// <param name="noise">: noise engine (replacement tables, window and generator)</param>
+    /// <param name="memoryBudget">: memory for the occupancy tiles and the buffers in bytes</param>
+    /// <param name="chunkSize">: size of the read and write buffers in bytes</param>
+    StreamingNoise(ChainCodeNoise& noise, const size_t memoryBudget, const size_t chunkSize = 1 << 20);
+
+    /// <summary>
+    /// Applying noise to a chain code file.
+    /// </summary>
+    /// <param name="inputFile">: chain code file (F4 or F8)</param>
+    /// <param name="outputFile">: file of the noisy chain codes</param>
+    /// <param name="noiseProbability">: probability of the noise</param>
+    /// <param name="numberOfIterations">: number of algorithm iterations</param>
+    /// <returns>Summary of the run</returns>
+    StreamingNoiseReport run(const std::string& inputFile, const std::string& outputFile, const double noiseProbability, const uint numberOfIterations);
+};
@@ -1,13 +1,65 @@
-#include <QScrollBar>
+#include <algorithm>
+#include <cmath>
+#include <QGraphicsScene>
 #include <QMessageBox>
+#include <QPainter>
+#include <QScrollBar>
 #include <QWheelEvent>
+#include <unordered_set>
 
 #include "Visualizator.hpp"
 
 
 Visualizator::Visualizator(QWidget* parent) : QGraphicsView(parent)
-{}
+{
+    // Scene holds no items, the border is drawn as its background.
+    setScene(new QGraphicsScene(this));
+    m_TileCache.setMaxCost(TILE_CACHE_SIZE);
+}
+
+void Visualizator::setBorder(const std::vector<std::vector<Pixel>>& coordinates, const uint maxXCoordinate, const uint maxYCoordinate) {
+    m_Tiles = BorderTiles(coordinates, maxXCoordinate, maxYCoordinate, SCENE_PADDING);
+    m_TileCache.clear();
 
+    scene()->setSceneRect(0, 0, SCENE_SCALE * m_Tiles.width(), SCENE_SCALE * m_Tiles.height());
+    scene()->update();
+}
+
+void Visualizator::updateBorder(const std::vector<NoisePixelChange>& changes) {
+    // Tiles of the finest level that contain a changed pixel.
+    const int64_t finestSpan = BorderTiles::tileSpan(MAX_LEVEL);
+    std::unordered_set<quint64> dirtyTiles;
+    for (const NoisePixelChange& change : changes) {
+        if (change.added) {
+            m_Tiles.addPixel(change.pixel);
+        }
+        else {
+            m_Tiles.removePixel(change.pixel);
+        }
+
+        const Pixel pixel = m_Tiles.toView(change.pixel);
+        if (m_Tiles.contains(pixel)) {
+            dirtyTiles.insert((static_cast<quint64>(pixel.y / finestSpan) << 32) | static_cast<quint64>(pixel.x / finestSpan));
+        }
+    }
+
+    // Tiles are nested, so the dirty tiles of a coarser level are the halved coordinates of the finer ones.
+    const int currentLevel = levelOfDetail();
+    for (int level = MAX_LEVEL; level >= MIN_LEVEL && !dirtyTiles.empty(); level--) {
+        const double tileSide = SCENE_SCALE * static_cast<double>(BorderTiles::tileSpan(level));
+        std::unordered_set<quint64> coarserTiles;
+        for (const quint64 tile : dirtyTiles) {
+            const int tileX = static_cast<int>(tile & 0xFFFFFFFF);
+            const int tileY = static_cast<int>(tile >> 32);
+            m_TileCache.remove(tileKey(level, tileX, tileY));
+            if (level == currentLevel) {
+                scene()->update(tileX * tileSide, tileY * tileSide, tileSide, tileSide);
+            }
+            coarserTiles.insert((static_cast<quint64>(tileY / 2) << 32) | static_cast<quint64>(tileX / 2));
+        }
+        dirtyTiles.swap(coarserTiles);
+    }
+}
 
 void Visualizator::mousePressEvent(QMouseEvent* event) {
     if (event->button() == Qt::LeftButton) {
@@ -43,16 +95,59 @@ void Visualizator::mouseMoveEvent(QMouseEvent* event) {
 }
 
 void Visualizator::wheelEvent(QWheelEvent* event) {
+    // Zoom is multiplicative, so the whole range (from large shapes to single pixels) is reachable.
     if (event->angleDelta().y() > 0) {
-        if (m_Scale <= MAX_SCALE) {
-            m_Scale += 0.1;
-        }
+        m_Scale = std::min(m_Scale * ZOOM_STEP, MAX_SCALE);
     }
     else {
-        if (m_Scale >= MIN_SCALE) {
-            m_Scale -= 0.1;
-        }
+        m_Scale = std::max(m_Scale / ZOOM_STEP, MIN_SCALE);
     }
 
     setTransform(QTransform().scale(m_Scale, m_Scale));
-}
\ No newline at end of file
+}
+
+quint64 Visualizator::tileKey(const int level, const int tileX, const int tileY) {
+    return (static_cast<quint64>(level - MIN_LEVEL) << 56) | (static_cast<quint64>(tileY) << 28) | static_cast<quint64>(tileX);
+}
+
+int Visualizator::levelOfDetail() const {
+    const double screenPixels = SCENE_SCALE * transform().m11();
+    return std::clamp(static_cast<int>(std::floor(std::log2(screenPixels))), MIN_LEVEL, MAX_LEVEL);
+}
+
+void Visualizator::drawBackground(QPainter* painter, const QRectF& rect) {
+    painter->fillRect(rect, Qt::white);
+
+    // Tiles of the level that intersect the exposed area.
+    const int level = levelOfDetail();
+    const double tileSide = SCENE_SCALE * std::ldexp(static_cast<double>(BorderTiles::TILE_SIZE), -level);
+    const int tileCountX = static_cast<int>(BorderTiles::tileCount(level, m_Tiles.width()));
+    const int tileCountY = static_cast<int>(BorderTiles::tileCount(level, m_Tiles.height()));
+    const int firstX = std::max(static_cast<int>(std::floor(rect.left() / tileSide)), 0);
+    const int lastX = std::min(static_cast<int>(std::floor(rect.right() / tileSide)), tileCountX - 1);
+    const int firstY = std::max(static_cast<int>(std::floor(rect.top() / tileSide)), 0);
+    const int lastY = std::min(static_cast<int>(std::floor(rect.bottom() / tileSide)), tileCountY - 1);
+
+    for (int tileY = firstY; tileY <= lastY; tileY++) {
+        for (int tileX = firstX; tileX <= lastX; tileX++) {
+            const quint64 key = tileKey(level, tileX, tileY);
+
+            QImage* tile = m_TileCache.object(key);
+            if (tile == nullptr) {
+                QImage image(BorderTiles::TILE_SIZE, BorderTiles::TILE_SIZE, QImage::Format_Grayscale8);
+                if (m_Tiles.rasterizeTile(level, tileX, tileY, image.scanLine(0), image.bytesPerLine())) {
+                    tile = new QImage(std::move(image));
+                    m_TileCache.insert(key, tile, static_cast<int>(tile->sizeInBytes()));
+                }
+                else {
+                    tile = new QImage();
+                    m_TileCache.insert(key, tile, 1);
+                }
+            }
+
+            if (!tile->isNull()) {
+                painter->drawImage(QRectF(tileX * tileSide, tileY * tileSide, tileSide, tileSide), *tile);
+            }
+        }
+    }
+}
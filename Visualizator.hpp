@@ -1,15 +1,30 @@
 #pragma once
 
+#include <QCache>
 #include <QGraphicsView>
+#include <QImage>
+#include <vector>
+
+#include "BorderTiles.hpp"
+#include "NoiseMonitor.hpp"
+#include "Pixel.hpp"
 
 
 // CONSTANTS
-const double MIN_SCALE = 0.4;
+const double MIN_SCALE = 0.002;
 const double MAX_SCALE = 10.0;
+const double ZOOM_STEP = 1.1;          // Scale change per wheel step.
+const uint SCENE_SCALE = 2;            // Size of a border pixel in scene units.
+const uint SCENE_PADDING = 50;         // Padding around the border in border pixels.
+const int MIN_LEVEL = -8;              // Coarsest level of detail (256 x 256 border pixels per tile pixel).
+const int MAX_LEVEL = 5;               // Finest level of detail (32 x 32 tile pixels per border pixel).
+const int TILE_CACHE_SIZE = 64 << 20;  // Memory of the cached tiles in bytes.
 
 
 /// <summary>
 /// Enhanced QGraphicsView with translation and zoom features.
+/// The border is drawn as the background of the scene from tiles of the level of detail that matches
+/// the zoom; only tiles in the exposed area are rasterized, and recently used ones are kept in a cache.
 /// </summary>
 class Visualizator : public QGraphicsView {
 private:
@@ -17,6 +32,8 @@ private:
     double m_MouseX = 0.0;      // Mouse X position.
     double m_MouseY = 0.0;      // Mouse Y position.
     double m_Scale = 1.0;       // Current scale.
+    BorderTiles m_Tiles;        // Spatial index of the border.
+    QCache<quint64, QImage> m_TileCache;  // Rasterized tiles (empty tiles are stored as null images).
 
 
 private:
@@ -44,11 +61,49 @@ private:
     /// <param name="event">: QWheelEvent</param>
     void wheelEvent(QWheelEvent* event);
 
+    /// <summary>
+    /// Drawing the border tiles that intersect the exposed area.
+    /// </summary>
+    /// <param name="painter">: painter of the viewport</param>
+    /// <param name="rect">: exposed area in scene coordinates</param>
+    void drawBackground(QPainter* painter, const QRectF& rect);
+
+    /// <summary>
+    /// Level of detail that matches the current zoom (a tile pixel covers at least one screen pixel,
+    /// so no border pixel is lost when the tile is drawn).
+    /// </summary>
+    /// <returns>Level of detail</returns>
+    int levelOfDetail() const;
+
+    /// <summary>
+    /// Key of a tile in the tile cache.
+    /// </summary>
+    /// <param name="level">: level of detail</param>
+    /// <param name="tileX">: column of the tile</param>
+    /// <param name="tileY">: row of the tile</param>
+    /// <returns>Key</returns>
+    static quint64 tileKey(const int level, const int tileX, const int tileY);
+
 public:
     /// <summary>
     /// Constructor of the Visualizator widget.
     /// </summary>
     /// <param name="parent">: QGraphicsView parent widget</param>
     Visualizator(QWidget* parent);
+
+    /// <summary>
+    /// Setting the displayed border (the tile cache is cleared).
+    /// </summary>
+    /// <param name="coordinates">: coordinates of each chain code</param>
+    /// <param name="maxXCoordinate">: maximal X coordinate of the border</param>
+    /// <param name="maxYCoordinate">: maximal Y coordinate of the border</param>
+    void setBorder(const std::vector<std::vector<Pixel>>& coordinates, const uint maxXCoordinate, const uint maxYCoordinate);
+
+    /// <summary>
+    /// Applying border pixel changes of a running noise application. Only the cached tiles that contain
+    /// a changed pixel are dropped, and only their area of the view is repainted.
+    /// </summary>
+    /// <param name="changes">: border pixel changes (in the order they were made)</param>
+    void updateBorder(const std::vector<NoisePixelChange>& changes);
 };
 
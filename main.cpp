@@ -1,10 +1,76 @@
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
 #include "MainWindow.hpp"
+#include "NoiseDaemon.hpp"
 #include <QtWidgets/QApplication>
 
 
+// Running the job daemon: --daemon socket [--threads n] [--queue n] [--datasets n]. No QApplication is created.
+int runDaemon(int argc, char* argv[]) {
+    const char* usage = "Usage: ChainCodeNoise --daemon socket [--threads n] [--queue n] [--datasets n]";
+    if (argc < 3) {
+        std::cerr << usage << std::endl;
+        return 1;
+    }
+
+    uint threads = 0;
+    size_t queueCapacity = 0;
+    size_t maxDatasets = 256;
+    try {
+        // Values are whole non-negative numbers; unknown options and options without a value are errors.
+        const auto number = [](const std::string& value, const u64 maximum) {
+            if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.size() > 19 || std::stoull(value) > maximum) {
+                throw std::logic_error("Invalid value " + value + ".");
+            }
+            return std::stoull(value);
+        };
+        for (int i = 3; i < argc; i += 2) {
+            const std::string argument = argv[i];
+            if (argument != "--threads" && argument != "--queue" && argument != "--datasets") {
+                throw std::logic_error("Unknown option " + argument + ".");
+            }
+            if (i + 1 == argc) {
+                throw std::logic_error("Missing value of " + argument + ".");
+            }
+            if (argument == "--threads") {
+                threads = static_cast<uint>(number(argv[i + 1], std::numeric_limits<uint>::max()));
+            }
+            else if (argument == "--queue") {
+                queueCapacity = number(argv[i + 1], std::numeric_limits<size_t>::max());
+            }
+            else {
+                maxDatasets = number(argv[i + 1], std::numeric_limits<size_t>::max());
+            }
+        }
+    }
+    catch (const std::exception& exception) {
+        std::cerr << "[ERROR] " << exception.what() << std::endl << usage << std::endl;
+        return 1;
+    }
+
+    try {
+        NoiseDaemon daemon(argv[2], threads, queueCapacity, maxDatasets);
+        std::cerr << "[INFO] Listening on " << argv[2] << std::endl;
+        daemon.run();
+    }
+    catch (const std::exception& exception) {
+        std::cerr << "[ERROR] " << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+
 int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--daemon") {
+        return runDaemon(argc, argv);
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
     return a.exec();
-}
\ No newline at end of file
+}